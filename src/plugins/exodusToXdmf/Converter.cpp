@@ -0,0 +1,265 @@
+//==============================================================================
+// This software developed by Stellar Science Ltd Co and the U.S. Government.
+// Copyright (C) 2010 Stellar Science. Government-purpose rights granted.
+//
+// This file is part of XDM
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+#include <exodusToXdmf/Converter.hpp>
+
+#include <xdmExodus/ExodusData.hpp>
+#include <xdmExodus/Reader.hpp>
+
+#include <xdmf/XmfWriter.hpp>
+
+#include <xdmGrid/Domain.hpp>
+#include <xdmGrid/Grid.hpp>
+
+#include <xdm/ItemVisitor.hpp>
+#include <xdm/MemoryAdapter.hpp>
+#include <xdm/ParallelErrorCapture.hpp>
+#include <xdm/PrimitiveType.hpp>
+#include <xdm/SerializeDataOperation.hpp>
+#include <xdm/UniformDataItem.hpp>
+
+#include <algorithm>
+#include <set>
+#include <stdexcept>
+
+namespace exodusToXdmf {
+
+namespace {
+
+typedef std::vector< xdm::RefPtr< xdm::UniformDataItem > > DataItemList;
+
+// Collect the data items that must be written for the current step, in tree order, with the
+// number of bytes each of them takes in memory. Items reached more than once are collected
+// the first time only.
+class CollectDataToWrite : public xdm::ItemVisitor {
+public:
+  CollectDataToWrite( DataItemList& items, std::vector< std::size_t >& sizes ) :
+    mItems( items ), mSizes( sizes ), mCollected() {}
+
+  virtual void apply( xdm::UniformDataItem& item ) {
+    if ( !item.data() || !item.serializationRequired() || item.alreadyWritten() ) {
+      return;
+    }
+    if ( ! mCollected.insert( &item ).second ) {
+      return;
+    }
+    std::size_t size = xdm::typeSize( item.dataType() );
+    const xdm::DataShape<>& shape = item.dataspace();
+    for ( xdm::DataShape<>::size_type i = 0; i < shape.rank(); ++i ) {
+      size *= shape[i];
+    }
+    mItems.push_back( xdm::RefPtr< xdm::UniformDataItem >( &item ) );
+    mSizes.push_back( size );
+  }
+
+private:
+  DataItemList& mItems;
+  std::vector< std::size_t >& mSizes;
+  std::set< const xdm::UniformDataItem* > mCollected;
+};
+
+// Read the values of the items [begin, end) that are read on demand.
+void loadData( const DataItemList& items, std::size_t begin, std::size_t end ) {
+  for ( std::size_t i = begin; i < end; ++i ) {
+    xdm::RefPtr< const xdm::MemoryAdapter > data = items[i]->data();
+    data->array();
+  }
+}
+
+// Write the items [begin, end), freeing the values of those read from the Exodus file as soon
+// as they are written.
+void writeData(
+  const DataItemList& items,
+  std::size_t begin,
+  std::size_t end,
+  xdm::SerializeDataOperation& serializer ) {
+
+  for ( std::size_t i = begin; i < end; ++i ) {
+    items[i]->accept( serializer );
+    xdm::MemoryAdapter* data = items[i]->data().get();
+    if ( xdmExodus::ExodusData< double >* values =
+      dynamic_cast< xdmExodus::ExodusData< double >* >( data ) ) {
+      values->release();
+    } else if ( xdmExodus::ExodusData< int >* indices =
+      dynamic_cast< xdmExodus::ExodusData< int >* >( data ) ) {
+      indices->release();
+    }
+  }
+}
+
+// An XmfWriter that writes the data items of a step in batches bounded by a memory budget,
+// reading each batch while the one before it is written.
+class StreamingXmfWriter : public xdmf::XmfWriter {
+public:
+  StreamingXmfWriter( std::size_t memoryBudget, bool overlapReads ) :
+    xdmf::XmfWriter(),
+    mMemoryBudget( memoryBudget ),
+    mOverlapReads( overlapReads ) {
+  }
+
+protected:
+  virtual std::size_t writeGridData( xdm::RefPtr< xdmGrid::Grid > grid ) {
+    DataItemList items;
+    std::vector< std::size_t > sizes;
+    collectDataToWrite( *grid, items, sizes );
+
+    // Two batches are held at once while reading one and writing the other.
+    std::vector< std::size_t > batchEnds;
+    partitionByMemoryBudget(
+      sizes,
+      mOverlapReads ? mMemoryBudget / 2 : mMemoryBudget,
+      batchEnds );
+
+    xdm::SerializeDataOperation serializer( mode() );
+    if ( ! batchEnds.empty() ) {
+      loadData( items, 0, batchEnds[0] );
+    }
+    std::size_t batchBegin = 0;
+    for ( std::size_t batch = 0; batch < batchEnds.size(); ++batch ) {
+      std::size_t batchEnd = batchEnds[batch];
+      std::size_t nextEnd = ( batch + 1 < batchEnds.size() ) ? batchEnds[batch + 1] : batchEnd;
+#ifdef _OPENMP
+      // The Exodus reads are serialized by the plugin; the HDF5 writes all happen in the
+      // writing section. Exceptions may not leave a section, so they are rethrown after it.
+      xdm::ParallelErrorCapture error;
+      #pragma omp parallel sections if ( mOverlapReads )
+      {
+        #pragma omp section
+        {
+          try {
+            writeData( items, batchBegin, batchEnd, serializer );
+          } catch ( ... ) {
+            error.capture();
+          }
+        }
+        #pragma omp section
+        {
+          try {
+            loadData( items, batchEnd, nextEnd );
+          } catch ( ... ) {
+            error.capture();
+          }
+        }
+      }
+      error.rethrow();
+#else
+      writeData( items, batchBegin, batchEnd, serializer );
+      loadData( items, batchEnd, nextEnd );
+#endif
+      batchBegin = batchEnd;
+    }
+    return serializer.bytesWritten();
+  }
+
+private:
+  std::size_t mMemoryBudget;
+  bool mOverlapReads;
+};
+
+} // namespace anon
+
+const std::size_t Converter::kDefaultMemoryBudget;
+
+Converter::Converter() :
+  mMemoryBudget( kDefaultMemoryBudget ),
+  mOverlapReads( true ),
+  mBytesWritten( 0 ) {
+}
+
+Converter::~Converter() {
+}
+
+void Converter::setMemoryBudget( std::size_t bytes ) {
+  mMemoryBudget = bytes;
+}
+
+std::size_t Converter::memoryBudget() const {
+  return mMemoryBudget;
+}
+
+void Converter::setOverlapReads( bool overlap ) {
+  mOverlapReads = overlap;
+}
+
+bool Converter::overlapReads() const {
+  return mOverlapReads;
+}
+
+std::size_t Converter::convert(
+  const xdm::FileSystemPath& exodusFile,
+  const xdm::FileSystemPath& xdmfFile ) {
+
+  mBytesWritten = 0;
+
+  // The values of variables, attributes, and maps are not read here, only described.
+  xdmExodus::ExodusReader reader;
+  xdm::RefPtr< xdmGrid::Domain > domain =
+    xdm::dynamic_pointer_cast< xdmGrid::Domain >( reader.readItem( exodusFile ) );
+  if ( !domain || domain->xdm::ObjectCompositionMixin< xdmGrid::Grid >::numberOfChildren() == 0 ) {
+    throw std::runtime_error( "No grid was read from the Exodus file at " +
+      exodusFile.pathString() );
+  }
+  xdm::RefPtr< xdmGrid::Grid > grid = xdm::child< xdmGrid::Grid >( *domain, 0 );
+
+  std::size_t numberOfSteps = std::max< std::size_t >( reader.numberOfTimeSteps( exodusFile ), 1 );
+  StreamingXmfWriter writer( mMemoryBudget, mOverlapReads );
+  writer.open( xdmfFile, xdm::Dataset::kCreate );
+  for ( std::size_t step = 0; step < numberOfSteps; ++step ) {
+    reader.update( domain, exodusFile, step );
+    writer.write( grid, step );
+    mBytesWritten += writer.bytesWritten();
+  }
+  writer.close();
+  return numberOfSteps;
+}
+
+std::size_t Converter::bytesWritten() const {
+  return mBytesWritten;
+}
+
+void partitionByMemoryBudget(
+  const std::vector< std::size_t >& sizes,
+  std::size_t budget,
+  std::vector< std::size_t >& batchEnds ) {
+
+  std::size_t batchSize = 0;
+  for ( std::size_t i = 0; i < sizes.size(); ++i ) {
+    // Empty items never start a batch of their own.
+    if ( sizes[i] > 0 && batchSize > 0 && batchSize + sizes[i] > budget ) {
+      batchEnds.push_back( i );
+      batchSize = 0;
+    }
+    batchSize += sizes[i];
+  }
+  if ( ! sizes.empty() ) {
+    batchEnds.push_back( sizes.size() );
+  }
+}
+
+void collectDataToWrite(
+  xdm::Item& item,
+  std::vector< xdm::RefPtr< xdm::UniformDataItem > >& items,
+  std::vector< std::size_t >& sizes ) {
+
+  CollectDataToWrite collect( items, sizes );
+  item.accept( collect );
+}
+
+} // namespace exodusToXdmf
@@ -0,0 +1,108 @@
+//==============================================================================
+// This software developed by Stellar Science Ltd Co and the U.S. Government.
+// Copyright (C) 2010 Stellar Science. Government-purpose rights granted.
+//
+// This file is part of XDM
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+#ifndef exodusToXdmf_Converter_hpp
+#define exodusToXdmf_Converter_hpp
+
+#include <xdm/FileSystem.hpp>
+#include <xdm/Forward.hpp>
+#include <xdm/RefPtr.hpp>
+
+#include <vector>
+
+namespace exodusToXdmf {
+
+/// Converts an ExodusII file to an XDMF temporal collection with its heavy data in HDF5.
+///
+/// The mesh is read once and every time step of the Exodus file becomes a step of the
+/// collection. The spatial collection of the mesh is written; the Exodus sets, which the
+/// reader keeps in a collection of their own, are not. The values of Exodus variables,
+/// attributes, and maps are read from the Exodus file one data item at a time, in the order
+/// of the blocks, and released as soon as they have been written, so the memory they take is
+/// bounded by a budget rather than by the size of the file. The coordinates and connectivity of the mesh are read with the mesh and
+/// stay in memory for the whole conversion.
+///
+/// With OpenMP support (XDM_OPENMP), the next batch of data items is read from the Exodus
+/// file while the current batch is written to HDF5. Exodus files in the netCDF-4 format are
+/// read through HDF5 themselves, which is only safe from two threads at once when HDF5 is
+/// built thread safe; turn overlapping off to convert those files otherwise.
+class Converter {
+public:
+  Converter();
+  ~Converter();
+
+  /// The default number of bytes of data items held in memory at once.
+  static const std::size_t kDefaultMemoryBudget = 256 * 1024 * 1024;
+
+  /// Set the number of bytes of data items held in memory at once. While overlapping reads
+  /// and writes, the batch being read and the batch being written share the budget. A data
+  /// item larger than the budget is still converted, on its own.
+  void setMemoryBudget( std::size_t bytes );
+  /// Get the number of bytes of data items held in memory at once.
+  std::size_t memoryBudget() const;
+
+  /// Set whether to read the next batch of data items while writing the current one.
+  void setOverlapReads( bool overlap );
+  /// Determine if the next batch of data items is read while writing the current one.
+  bool overlapReads() const;
+
+  /// Convert every time step of an Exodus file. A file without time steps is written as a
+  /// collection with a single step holding the mesh.
+  /// @param exodusFile The ExodusII file to read.
+  /// @param xdmfFile The XDMF file to write. The heavy data is written next to it, to the
+  /// same path with ".h5" appended.
+  /// @return The number of steps written.
+  /// @throws std::runtime_error if the Exodus file could not be read.
+  /// @throws xdmFormat::WriteError if the XDMF file could not be written.
+  std::size_t convert( const xdm::FileSystemPath& exodusFile, const xdm::FileSystemPath& xdmfFile );
+
+  /// Get the number of bytes of heavy data written by the last conversion.
+  std::size_t bytesWritten() const;
+
+private:
+  std::size_t mMemoryBudget;
+  bool mOverlapReads;
+  std::size_t mBytesWritten;
+};
+
+/// Divide a sequence of data items into consecutive batches that each take at most a budget
+/// of memory. An item larger than the budget is put in a batch of its own.
+/// @param sizes The size in bytes of each item, in order.
+/// @param budget The maximum number of bytes in a batch.
+/// @param batchEnds Filled with one past the index of the last item of each batch.
+void partitionByMemoryBudget(
+  const std::vector< std::size_t >& sizes,
+  std::size_t budget,
+  std::vector< std::size_t >& batchEnds );
+
+/// Collect the data items of a tree that must be written for the current step, in tree
+/// order, with the number of bytes each of them takes in memory. An item shared by several
+/// grids, such as the geometry of the blocks, is collected once, where it is first found.
+/// @param item The tree to search.
+/// @param items Filled with the data items to write.
+/// @param sizes Filled with the size in bytes of each item.
+void collectDataToWrite(
+  xdm::Item& item,
+  std::vector< xdm::RefPtr< xdm::UniformDataItem > >& items,
+  std::vector< std::size_t >& sizes );
+
+} // namespace exodusToXdmf
+
+#endif // exodusToXdmf_Converter_hpp
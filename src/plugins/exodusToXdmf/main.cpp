@@ -0,0 +1,83 @@
+//==============================================================================
+// This software developed by Stellar Science Ltd Co and the U.S. Government.
+// Copyright (C) 2010 Stellar Science. Government-purpose rights granted.
+//
+// This file is part of XDM
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+/**
+ * Command line program to convert an ExodusII file to an XDMF temporal
+ * collection with its heavy data in HDF5.
+ */
+
+#include <exodusToXdmf/Converter.hpp>
+
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+
+namespace {
+
+void printUsage( const char* program ) {
+  std::cerr << "Usage: " << program
+    << " [--memory-budget <megabytes>] [--no-overlap] <input.exo> <output.xmf>" << std::endl;
+  std::cerr << "  --memory-budget  Megabytes of Exodus data to hold in memory at once"
+    << " (default " << exodusToXdmf::Converter::kDefaultMemoryBudget / ( 1024 * 1024 )
+    << ")." << std::endl;
+  std::cerr << "  --no-overlap     Do not read the next data while writing the current"
+    << " data." << std::endl;
+}
+
+} // namespace anon
+
+int main( int argc, char* argv[] ) {
+  exodusToXdmf::Converter converter;
+
+  int arg = 1;
+  for ( ; arg < argc && argv[arg][0] == '-'; ++arg ) {
+    if ( std::strcmp( argv[arg], "--memory-budget" ) == 0 && arg + 1 < argc ) {
+      long megabytes = std::atol( argv[++arg] );
+      if ( megabytes <= 0 ) {
+        std::cerr << argv[arg] << ": The memory budget must be a positive number." << std::endl;
+        return -1;
+      }
+      converter.setMemoryBudget( static_cast< std::size_t >( megabytes ) * 1024 * 1024 );
+    } else if ( std::strcmp( argv[arg], "--no-overlap" ) == 0 ) {
+      converter.setOverlapReads( false );
+    } else {
+      printUsage( argv[0] );
+      return -1;
+    }
+  }
+  if ( argc - arg != 2 ) {
+    printUsage( argv[0] );
+    return -1;
+  }
+
+  try {
+    std::size_t steps = converter.convert(
+      xdm::FileSystemPath( argv[arg] ),
+      xdm::FileSystemPath( argv[arg + 1] ) );
+    std::cout << "Wrote " << steps << " steps and " << converter.bytesWritten()
+      << " bytes of data to " << argv[arg + 1] << std::endl;
+  } catch ( const std::exception& e ) {
+    std::cerr << argv[arg] << ": " << e.what() << std::endl;
+    return -1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,221 @@
+//==============================================================================
+// This software developed by Stellar Science Ltd Co and the U.S. Government.
+// Copyright (C) 2010 Stellar Science. Government-purpose rights granted.
+//
+// This file is part of XDM
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+#define BOOST_TEST_MODULE Converter
+#include <boost/test/unit_test.hpp>
+
+#include <exodusToXdmf/Converter.hpp>
+
+#include <xdmGrid/Attribute.hpp>
+#include <xdmGrid/CollectionGrid.hpp>
+#include <xdmGrid/UniformGrid.hpp>
+
+#include <xdm/ArrayAdapter.hpp>
+#include <xdm/FileSystem.hpp>
+#include <xdm/UniformDataItem.hpp>
+#include <xdm/VectorStructuredArray.hpp>
+
+#include <exodusII.h>
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+BOOST_AUTO_TEST_CASE( settings ) {
+  exodusToXdmf::Converter converter;
+  BOOST_CHECK_EQUAL( exodusToXdmf::Converter::kDefaultMemoryBudget, converter.memoryBudget() );
+  BOOST_CHECK( converter.overlapReads() );
+  converter.setMemoryBudget( 1024 );
+  converter.setOverlapReads( false );
+  BOOST_CHECK_EQUAL( 1024u, converter.memoryBudget() );
+  BOOST_CHECK( ! converter.overlapReads() );
+}
+
+BOOST_AUTO_TEST_CASE( partitionByMemoryBudget ) {
+  std::vector< std::size_t > sizes;
+  sizes.push_back( 40 );
+  sizes.push_back( 50 );
+  sizes.push_back( 20 );
+  sizes.push_back( 300 );
+  sizes.push_back( 0 );
+  sizes.push_back( 100 );
+
+  // The item larger than the budget gets a batch of its own, and the empty item
+  // joins the batch before it.
+  std::vector< std::size_t > batchEnds;
+  exodusToXdmf::partitionByMemoryBudget( sizes, 100, batchEnds );
+  BOOST_REQUIRE_EQUAL( 4u, batchEnds.size() );
+  BOOST_CHECK_EQUAL( 2u, batchEnds[0] );
+  BOOST_CHECK_EQUAL( 3u, batchEnds[1] );
+  BOOST_CHECK_EQUAL( 5u, batchEnds[2] );
+  BOOST_CHECK_EQUAL( 6u, batchEnds[3] );
+
+  batchEnds.clear();
+  exodusToXdmf::partitionByMemoryBudget( std::vector< std::size_t >(), 100, batchEnds );
+  BOOST_CHECK( batchEnds.empty() );
+}
+
+// A data item of doubles that must be written.
+xdm::RefPtr< xdm::UniformDataItem > makeDoubles( std::size_t size ) {
+  xdm::RefPtr< xdm::UniformDataItem > item(
+    new xdm::UniformDataItem( xdm::primitiveType::kDouble, xdm::makeShape( size ) ) );
+  item->setData( xdm::makeRefPtr( new xdm::ArrayAdapter(
+    xdm::makeRefPtr( new xdm::VectorStructuredArray< double >( size ) ), true ) ) );
+  return item;
+}
+
+// An attribute of a grid holding a data item.
+void addAttribute( xdmGrid::Grid& grid, xdm::RefPtr< xdm::UniformDataItem > item ) {
+  xdm::RefPtr< xdmGrid::Attribute > attribute(
+    new xdmGrid::Attribute( xdmGrid::Attribute::kScalar, xdmGrid::Attribute::kElement ) );
+  attribute->setDataItem( item );
+  grid.addAttribute( attribute );
+}
+
+BOOST_AUTO_TEST_CASE( collectDataToWrite ) {
+  // Two grids share an item, as the blocks of an Exodus file share its geometry.
+  xdm::RefPtr< xdm::UniformDataItem > shared = makeDoubles( 10 );
+  xdm::RefPtr< xdm::UniformDataItem > first = makeDoubles( 2 );
+  xdm::RefPtr< xdm::UniformDataItem > second = makeDoubles( 3 );
+  xdm::RefPtr< xdmGrid::UniformGrid > firstGrid( new xdmGrid::UniformGrid );
+  addAttribute( *firstGrid, shared );
+  addAttribute( *firstGrid, first );
+  xdm::RefPtr< xdmGrid::UniformGrid > secondGrid( new xdmGrid::UniformGrid );
+  addAttribute( *secondGrid, shared );
+  addAttribute( *secondGrid, second );
+  xdmGrid::CollectionGrid collection;
+  collection.appendGrid( firstGrid );
+  collection.appendGrid( secondGrid );
+
+  // The shared item is collected and counted once, where it is first found.
+  std::vector< xdm::RefPtr< xdm::UniformDataItem > > items;
+  std::vector< std::size_t > sizes;
+  exodusToXdmf::collectDataToWrite( collection, items, sizes );
+  BOOST_REQUIRE_EQUAL( 3u, items.size() );
+  BOOST_REQUIRE_EQUAL( 3u, sizes.size() );
+  BOOST_CHECK( items[0] == shared );
+  BOOST_CHECK( items[1] == first );
+  BOOST_CHECK( items[2] == second );
+  BOOST_CHECK_EQUAL( 10 * sizeof( double ), sizes[0] );
+  BOOST_CHECK_EQUAL( 2 * sizeof( double ), sizes[1] );
+  BOOST_CHECK_EQUAL( 3 * sizeof( double ), sizes[2] );
+}
+
+BOOST_AUTO_TEST_CASE( missingFile ) {
+  exodusToXdmf::Converter converter;
+  BOOST_CHECK_THROW(
+    converter.convert(
+      xdm::FileSystemPath( "Converter.missingFile.exo" ),
+      xdm::FileSystemPath( "Converter.missingFile.xmf" ) ),
+    std::runtime_error );
+  BOOST_CHECK( ! xdm::exists( xdm::FileSystemPath( "Converter.missingFile.xmf" ) ) );
+}
+
+// The converted file holds a row of two hexahedra with an element variable at a few time
+// steps.
+const int kSteps = 3;
+const int kHexes = 2;
+const int kNodes = 4 * ( kHexes + 1 );
+const int kBlockId = 10;
+
+double stepTime( int step ) {
+  return 0.5 * ( step + 1 );
+}
+
+void writeExodusFile( const xdm::FileSystemPath& path ) {
+  int wordSize = sizeof( double );
+  int exodusFileId = ex_create( path.pathString().c_str(), EX_CLOBBER, &wordSize, &wordSize );
+  BOOST_REQUIRE( exodusFileId >= 0 );
+  BOOST_REQUIRE( ex_put_init( exodusFileId, "converter", 3, kNodes, kHexes, 1, 0, 0 ) >= 0 );
+
+  // Each slice of 4 nodes along x is shared by the hexes on either side of it.
+  std::vector< double > x( kNodes ), y( kNodes ), z( kNodes );
+  for ( int node = 0; node < kNodes; ++node ) {
+    const int corner = node % 4;
+    x[ node ] = node / 4;
+    y[ node ] = ( corner == 1 || corner == 2 ) ? 1.0 : 0.0;
+    z[ node ] = ( corner > 1 ) ? 1.0 : 0.0;
+  }
+  BOOST_REQUIRE( ex_put_coord( exodusFileId, &x[0], &y[0], &z[0] ) >= 0 );
+
+  std::vector< int > connectivity( 8 * kHexes );
+  for ( int hex = 0; hex < kHexes; ++hex ) {
+    for ( int corner = 0; corner < 8; ++corner ) {
+      connectivity[ 8 * hex + corner ] = 4 * ( hex + corner / 4 ) + corner % 4 + 1;
+    }
+  }
+  BOOST_REQUIRE( ex_put_block( exodusFileId, EX_ELEM_BLOCK, kBlockId, "HEX8",
+    kHexes, 8, 0, 0, 0 ) >= 0 );
+  BOOST_REQUIRE( ex_put_conn( exodusFileId, EX_ELEM_BLOCK, kBlockId,
+    &connectivity[0], 0, 0 ) >= 0 );
+
+  char temperature[] = "temperature";
+  char* variableNames[] = { temperature };
+  BOOST_REQUIRE( ex_put_var_param( exodusFileId, "e", 1 ) >= 0 );
+  BOOST_REQUIRE( ex_put_var_names( exodusFileId, "e", 1, variableNames ) >= 0 );
+  for ( int step = 0; step < kSteps; ++step ) {
+    double time = stepTime( step );
+    BOOST_REQUIRE( ex_put_time( exodusFileId, step + 1, &time ) >= 0 );
+    std::vector< double > values( kHexes, 10.0 * step );
+    BOOST_REQUIRE( ex_put_var( exodusFileId, step + 1, EX_ELEM_BLOCK, 1, kBlockId,
+      kHexes, &values[0] ) >= 0 );
+  }
+  ex_close( exodusFileId );
+}
+
+BOOST_AUTO_TEST_CASE( convert ) {
+  xdm::FileSystemPath exodusPath( "Converter.convert.exo" );
+  xdm::FileSystemPath xdmfPath( "Converter.convert.xmf" );
+  xdm::FileSystemPath hdfPath( "Converter.convert.xmf.h5" );
+  writeExodusFile( exodusPath );
+
+  // A budget smaller than the values of a step splits them into several batches.
+  exodusToXdmf::Converter converter;
+  converter.setMemoryBudget( 64 );
+  BOOST_CHECK_EQUAL( std::size_t( kSteps ), converter.convert( exodusPath, xdmfPath ) );
+  BOOST_CHECK( converter.bytesWritten() > 0 );
+  BOOST_REQUIRE( xdm::exists( xdmfPath ) );
+  BOOST_CHECK( xdm::exists( hdfPath ) );
+
+  std::ifstream xdmfFile( xdmfPath.pathString().c_str() );
+  std::stringstream contents;
+  contents << xdmfFile.rdbuf();
+  xdmfFile.close();
+  const std::string xdmf = contents.str();
+  BOOST_CHECK( xdmf.find( "Temporal" ) != std::string::npos );
+  BOOST_CHECK( xdmf.find( "Hexahedron" ) != std::string::npos );
+  BOOST_CHECK( xdmf.find( "temperature" ) != std::string::npos );
+  for ( int step = 0; step < kSteps; ++step ) {
+    std::ostringstream time;
+    time << "Value='" << stepTime( step ) << "'";
+    BOOST_CHECK_MESSAGE( xdmf.find( time.str() ) != std::string::npos,
+      "Missing the time of step " << step );
+  }
+
+  xdm::remove( exodusPath );
+  xdm::remove( xdmfPath );
+  xdm::remove( hdfPath );
+}
+
+} // namespace
@@ -20,7 +20,9 @@
 //------------------------------------------------------------------------------
 
 #include <xdmExodus/Blocks.hpp>
+#include <xdmExodus/ExodusData.hpp>
 #include <xdmExodus/Helpers.hpp>
+#include <xdmExodus/ReadableExodusFile.hpp>
 #include <xdmExodus/Variable.hpp>
 
 #include <xdmGrid/Attribute.hpp>
@@ -30,10 +32,79 @@
 
 #include <xdm/VectorStructuredArray.hpp>
 
-
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
 
 namespace xdmExodus {
 
+namespace {
+
+// The number of connectivity values widened at a time when writing a block.
+const std::size_t kConnectivityChunkSize = 1 << 16;
+
+// The Exodus element type names, the shapes they stand for, and the number of nodes of a
+// linear element of that shape. Exodus only compares the start of the names.
+struct ExodusShape {
+  const char* prefix;
+  xdmGrid::ElementShape::Type shape;
+  std::size_t linearNodes;
+};
+
+const ExodusShape kExodusShapes[] = {
+  { "SPHERE", xdmGrid::ElementShape::Vertex, 1 },
+  { "CIRCLE", xdmGrid::ElementShape::Vertex, 1 },
+  { "BAR", xdmGrid::ElementShape::Curve, 2 },
+  { "BEAM", xdmGrid::ElementShape::Curve, 2 },
+  { "TRUSS", xdmGrid::ElementShape::Curve, 2 },
+  { "EDGE", xdmGrid::ElementShape::Curve, 2 },
+  { "TRI", xdmGrid::ElementShape::Triangle, 3 },
+  { "QUAD", xdmGrid::ElementShape::Quadrilateral, 4 },
+  { "SHELL", xdmGrid::ElementShape::Quadrilateral, 4 },
+  { "TET", xdmGrid::ElementShape::Tetrahedron, 4 },
+  { "PYRAMID", xdmGrid::ElementShape::Pyramid, 5 },
+  { "WEDGE", xdmGrid::ElementShape::Wedge, 6 },
+  { "HEX", xdmGrid::ElementShape::Hexahedron, 8 }
+};
+
+const std::size_t kNumberOfExodusShapes = sizeof( kExodusShapes ) / sizeof( ExodusShape );
+
+// Get the element topology of an Exodus element type, such as "HEX8" or "tetra". Elements
+// with more nodes than a linear element of their shape are second order.
+xdm::RefPtr< const xdmGrid::ElementTopology > exodusElementTopology(
+  const std::string& entryType,
+  std::size_t nodesPerEntry ) {
+
+  std::string type( entryType );
+  for ( std::string::iterator c = type.begin(); c != type.end(); ++c ) {
+    *c = std::toupper( *c );
+  }
+  for ( std::size_t i = 0; i < kNumberOfExodusShapes; ++i ) {
+    if ( type.compare( 0, std::strlen( kExodusShapes[i].prefix ), kExodusShapes[i].prefix ) == 0 ) {
+      return xdmGrid::elementFactory(
+        kExodusShapes[i].shape, nodesPerEntry > kExodusShapes[i].linearNodes ? 2 : 1 );
+    }
+  }
+  throw std::runtime_error( "Unsupported Exodus element type " + entryType + "." );
+}
+
+// Get the Exodus element type name of an element topology.
+std::string exodusShapeString( const xdmGrid::ElementTopology& element ) {
+  for ( std::size_t i = 0; i < kNumberOfExodusShapes; ++i ) {
+    if ( kExodusShapes[i].shape == element.shape() ) {
+      std::ostringstream name;
+      name << kExodusShapes[i].prefix << element.numberOfNodes();
+      return name.str();
+    }
+  }
+  throw std::runtime_error( "The element shape has no Exodus element type." );
+}
+
+} // anon namespace
+
 std::size_t Block::entryGlobalOffset() const {
   return mOffset;
 }
@@ -43,7 +114,8 @@ void Block::setEntryGlobalOffset( std::size_t offset ) {
 }
 
 std::size_t Block::numberOfEntries() const {
-  return topology()->numberOfElements();
+  // A block that has not been read or filled yet has no topology and no entries.
+  return topology() ? topology()->numberOfElements() : 0;
 }
 
 void Block::addVariable( xdm::RefPtr< Variable > variable ) {
@@ -51,32 +123,27 @@ void Block::addVariable( xdm::RefPtr< Variable > variable ) {
   addAttribute( variable );
 }
 
-void Block::readAttributes( int exodusFileId, std::size_t attributesPerEntry ) {
+void Block::readAttributes(
+  xdm::RefPtr< ReadableExodusFile > file,
+  std::size_t attributesPerEntry ) {
+
   std::vector< ExodusString > attributeNames( attributesPerEntry );
   char* attributeNamesCharArray[ attributesPerEntry ];
   vectorToCharStarArray( attributeNames, attributeNamesCharArray );
-  EXODUS_CALL(
-    ex_get_attr_names(
-      exodusFileId,
-      exodusObjectType(),
-      id(),
-      attributeNamesCharArray ),
-    "Could not read attribute names." );
+  // Exceptions may not leave a critical section, so the status is checked after it.
+  int status;
+#ifdef _OPENMP
+  #pragma omp critical( xdmExodus_library )
+#endif
+  status = ex_get_attr_names(
+    file->id(), static_cast< ex_entity_type >( exodusObjectType() ), id(), attributeNamesCharArray );
+  EXODUS_CALL( status, "Could not read attribute names." );
 
   for ( std::size_t attributeIndex = 0; attributeIndex < attributesPerEntry; ++attributeIndex ) {
-    xdm::RefPtr< xdm::VectorStructuredArray< double > > attribute(
-      new xdm::VectorStructuredArray< double >( numberOfEntries() ) );
-    EXODUS_CALL(
-      ex_get_one_attr(
-        exodusFileId,
-        exodusObjectType(),
-        id(),
-        attributeIndex + 1,
-        attribute->data() ),
-      "Could not read attribute values." );
-
-    xdm::RefPtr< xdm::UniformDataItem > dataItem = makeDataItem(
-      attribute, xdm::primitiveType::kDouble, numberOfEntries() );
+    xdm::RefPtr< xdm::UniformDataItem > dataItem(
+      new xdm::UniformDataItem( xdm::primitiveType::kDouble, xdm::makeShape( numberOfEntries() ) ) );
+    dataItem->setData( xdm::makeRefPtr( new AttributeData(
+      file, exodusObjectType(), id(), (int)attributeIndex, numberOfEntries() ) ) );
     xdm::RefPtr< xdmGrid::Attribute > attr(
       new xdmGrid::Attribute( xdmGrid::Attribute::kScalar, xdmGrid::Attribute::kElement ) );
     attr->setDataItem( dataItem );
@@ -98,9 +165,9 @@ void Block::writeAttributes( int exodusFileId ) {
     EXODUS_CALL(
       ex_put_one_attr(
         exodusFileId,
-        exodusObjectType(),
+        static_cast< ex_entity_type >( exodusObjectType() ),
         id(),
-        (int)attIndex,
+        (int)attIndex + 1, // Exodus numbers the attributes from 1.
         (void*)attribs[ attIndex ]->dataItem()->typedArray< double >()->begin() ),
       "Unable to write block attribute values." );
 
@@ -109,23 +176,25 @@ void Block::writeAttributes( int exodusFileId ) {
     char* attributeNamesCharArray[ attributeNames.size() ];
     vectorToCharStarArray( attributeNames, attributeNamesCharArray );
     EXODUS_CALL(
-      ex_put_attr_names( exodusFileId, exodusObjectType(), id(), attributeNamesCharArray ),
+      ex_put_attr_names( exodusFileId, static_cast< ex_entity_type >( exodusObjectType() ), id(),
+        attributeNamesCharArray ),
       "Unable to write block attribute names." );
   }
 }
 
 std::vector< xdm::RefPtr< xdmGrid::Attribute > > Block::attributes() {
   std::vector< xdm::RefPtr< xdmGrid::Attribute > > attribs;
-  for ( Iterator attIt = begin(); attIt != end(); ++attIt ) {
+  for ( AttributeIterator attIt = beginAttributes(); attIt != endAttributes(); ++attIt ) {
     xdm::RefPtr< Variable > variable = xdm::dynamic_pointer_cast< Variable >( *attIt );
     if ( ! variable.valid() ) {
       attribs.push_back( *attIt );
     }
   }
+  return attribs;
 }
 
 void Block::readFromFile(
-  int exodusFileId,
+  xdm::RefPtr< ReadableExodusFile > file,
   int exodusObjectId,
   std::string blockName,
   xdm::RefPtr< xdmGrid::Geometry > geom,
@@ -133,6 +202,7 @@ void Block::readFromFile(
   const std::size_t numberOfVariables,
   const std::vector< ExodusString >& variableNames ) {
 
+  const int exodusFileId = file->id();
   setId( exodusObjectId );
   setName( blockName );
   setGeometry( geom );
@@ -143,59 +213,70 @@ void Block::readFromFile(
   int facesPerEntry = 0;
   int attributesPerEntry = 0;
   ExodusString entryType; // e.g. TET4, HEX8
-  EXODUS_CALL(
-    ex_get_block(
-      exodusFileId,
-      exodusObjectType(),
-      id(),
-      entryType.ptr(),
-      &numberOfEntries,
-      &nodesPerEntry,
-      &edgesPerEntry,
-      &facesPerEntry,
-      &attributesPerEntry ),
-    "Could not read block params." );
-
-  std::vector< int > nodeConnections( numberOfEntries * nodesPerEntry );
-  std::vector< int > edgeConnections( numberOfEntries * edgesPerEntry );
-  std::vector< int > faceConnections( numberOfEntries * facesPerEntry );
-  EXODUS_CALL(
-    ex_get_conn(
+  // Blocks may be read concurrently, but the Exodus library is not thread safe, so the calls
+  // into it are serialized. Exceptions may not leave a critical section, so the status is
+  // checked after it.
+  int status;
+#ifdef _OPENMP
+  #pragma omp critical( xdmExodus_library )
+#endif
+  status = ex_get_block(
+    exodusFileId,
+    static_cast< ex_entity_type >( exodusObjectType() ),
+    id(),
+    entryType.ptr(),
+    &numberOfEntries,
+    &nodesPerEntry,
+    &edgesPerEntry,
+    &facesPerEntry,
+    &attributesPerEntry );
+  EXODUS_CALL( status, "Could not read block params." );
+
+  // Read the node connectivity straight into the storage of the topology and shift it to zero
+  // base in place. Exodus stores 32 bit ints, which the topology keeps rather than widening.
+  xdm::RefPtr< xdm::VectorStructuredArray< int > > nodeConnectivity(
+    new xdm::VectorStructuredArray< int >( numberOfEntries * nodesPerEntry ) );
+  if ( nodeConnectivity->size() > 0 ) {
+    // TODO: do something with edge/face lists for element blocks. Until then, they are not
+    // read.
+#ifdef _OPENMP
+    #pragma omp critical( xdmExodus_library )
+#endif
+    status = ex_get_conn(
       exodusFileId,
-      exodusObjectType(),
+      static_cast< ex_entity_type >( exodusObjectType() ),
       id(),
-      &nodeConnections[0],
-      &edgeConnections[0],
-      &faceConnections[0] ),
-    "Could not read connectivity." );
-
-  // TODO: do something with edge/face lists for element blocks.
+      nodeConnectivity->begin(),
+      0,
+      0 );
+    EXODUS_CALL( status, "Could not read connectivity." );
+    shiftToZeroBase( nodeConnectivity->begin(), nodeConnectivity->size() );
+  }
 
-  xdm::RefPtr< xdm::VectorStructuredArray< std::size_t > > nodeConnectivity(
-    new xdm::VectorStructuredArray< std::size_t >( nodeConnections.size() ) );
-  convertToZeroBase( nodeConnections, nodeConnectivity->begin() );
   xdm::RefPtr< xdm::UniformDataItem > dataItem = makeDataItem(
-    nodeConnectivity, xdm::primitiveType::kLongUnsignedInt, numberOfEntries, nodesPerEntry );
+    nodeConnectivity, xdm::primitiveType::kInt, numberOfEntries, nodesPerEntry );
   xdm::RefPtr< xdmGrid::UnstructuredTopology > topo(
     new xdmGrid::UnstructuredTopology() );
   topo->setConnectivity( dataItem );
   topo->setNumberOfElements( numberOfEntries );
-//  topo->setElementType( xdmGrid::exodusElementType( nodesPerEntry, entryType.string() ) );
+  if ( numberOfEntries > 0 ) {
+    topo->setElementTopology( exodusElementTopology( entryType.string(), nodesPerEntry ) );
+  }
   topo->setNodeOrdering( xdmGrid::NodeOrderingConvention::ExodusII );
   setTopology( topo );
 
   // Read Exodus attributes for this block.
   if ( attributesPerEntry > 0 ) {
-    readAttributes( exodusFileId, attributesPerEntry );
+    readAttributes( file, attributesPerEntry );
   }
 
   // Read the results variables. For XDM, these will just be additional attributes.
   if ( numberOfVariables > 0 ) {
     setupVariables( beginTruthTable, numberOfVariables, variableNames );
 
-    // Fill the variables with the data from the first time step. If data from another step
-    // is needed, the user can call update().
-    readTimeStep( exodusFileId, 0 );
+    // Start the variables at the first time step. Their values are read when they are
+    // first used. If data from another step is needed, the user can call update().
+    readTimeStep( file, 0 );
   }
 }
 
@@ -203,29 +284,63 @@ void Block::writeToFile( int exodusFileId, int* variableTruthTable ) {
   // First get the attributes.
   std::vector< xdm::RefPtr< xdmGrid::Attribute > > attribs = attributes();
 
+  // A block without entries has no element type.
+  std::string entryType( "NULL" );
+  std::size_t nodesPerEntry = 0;
+  if ( numberOfEntries() > 0 ) {
+    xdm::RefPtr< const xdmGrid::ElementTopology > element = topology()->elementTopology( 0 );
+    entryType = exodusShapeString( *element );
+    nodesPerEntry = element->numberOfNodes();
+  }
   EXODUS_CALL(
     ex_put_block(
       exodusFileId,
-      exodusObjectType(),
+      static_cast< ex_entity_type >( exodusObjectType() ),
       id(),
-      xdmGrid::exodusShapeString( topology()->elementType( 0 ) ).c_str(),
+      entryType.c_str(),
       (int)numberOfEntries(),
-      (int)topology()->elementType( 0 ).nodesPerElement(),
+      (int)nodesPerEntry,
       0, // edges per entry
       0, // faces per entry
       (int)attribs.size() ),
     "Unable to write block parameters." );
 
-  std::vector< int > connections;
-  for ( std::size_t entry = 0; entry < numberOfEntries(); ++entry ) {
-    xdmGrid::ConstElementConnectivity entryNodes = topology()->elementConnections( entry );
-    for ( std::size_t node = 0; node < entryNodes.size(); ++node ) {
-      connections.push_back( (int)entryNodes[ node ] + 1 );
+  // Exodus wants one-based ints, and this library writes the connectivity of a block in a
+  // single call. Connectivity stored as ints is shifted to one base in place for the write
+  // and shifted back afterwards, so it is not copied. Anything else is widened a chunk of
+  // entries at a time into the one int array that is written.
+  const std::size_t numberOfConnections = numberOfEntries() * nodesPerEntry;
+  xdm::RefPtr< xdmGrid::UnstructuredTopology > unstructured =
+    xdm::dynamic_pointer_cast< xdmGrid::UnstructuredTopology >( topology() );
+  if ( numberOfConnections == 0 ) {
+    // There are no entries to write.
+  } else if ( unstructured && unstructured->connectivityType() == xdm::primitiveType::kInt ) {
+    int* connections = unstructured->connectivityArray< int >();
+    shiftToOneBase( connections, numberOfConnections );
+    const int status = ex_put_conn(
+      exodusFileId, static_cast< ex_entity_type >( exodusObjectType() ), id(),
+      connections, 0, 0 );
+    shiftToZeroBase( connections, numberOfConnections );
+    EXODUS_CALL( status, "Unable to write block connectivity." );
+  } else {
+    std::vector< int > connections( numberOfConnections );
+    const std::size_t chunkEntries =
+      std::max< std::size_t >( 1, kConnectivityChunkSize / nodesPerEntry );
+    std::vector< std::size_t > chunk( chunkEntries * nodesPerEntry );
+    for ( std::size_t first = 0; first < numberOfEntries(); first += chunkEntries ) {
+      const std::size_t count = std::min( chunkEntries, numberOfEntries() - first );
+      topology()->gatherConnections( first, count, &chunk[0] );
+      copyToOneBase( &chunk[0], count * nodesPerEntry, &connections[ first * nodesPerEntry ] );
     }
+    EXODUS_CALL(
+      ex_put_conn(
+        exodusFileId, static_cast< ex_entity_type >( exodusObjectType() ), id(),
+        &connections[0], 0, 0 ),
+      "Unable to write block connectivity." );
   }
-  EXODUS_CALL( ex_put_conn( exodusFileId, exodusObjectType(), id(), &connections[0], 0, 0 ),
-    "Unable to write block connectivity." );
-  EXODUS_CALL( ex_put_name( exodusFileId, exodusObjectType(), id(), name().c_str() ),
+  EXODUS_CALL(
+    ex_put_name(
+      exodusFileId, static_cast< ex_entity_type >( exodusObjectType() ), id(), name().c_str() ),
     "Unable to write block name." );
 
   // Write the Exodus attributes.
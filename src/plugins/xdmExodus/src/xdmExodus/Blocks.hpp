@@ -33,6 +33,7 @@
 
 namespace xdmExodus {
 
+class ReadableExodusFile;
 class Variable;
 
 /// An Exodus block is an integer array of offsets into the nodal coordinate array. The offsets
@@ -54,7 +55,7 @@ public:
   virtual std::vector< xdm::RefPtr< xdmGrid::Attribute > > attributes();
 
   virtual void readFromFile(
-    int exodusFileId,
+    xdm::RefPtr< ReadableExodusFile > file,
     int exodusObjectId,
     std::string blockName,
     xdm::RefPtr< xdmGrid::Geometry > geom,
@@ -65,7 +66,11 @@ public:
   virtual void writeToFile( int exodusFileId, int* variableTruthTable );
 
 protected:
-  virtual void readAttributes( int exodusFileId, std::size_t attributesPerEntry );
+  /// Set up the Exodus attributes of the block. Their values are read from the file when
+  /// they are first requested.
+  virtual void readAttributes(
+    xdm::RefPtr< ReadableExodusFile > file,
+    std::size_t attributesPerEntry );
   virtual void writeAttributes( int exodusFileId );
 
 private:
@@ -0,0 +1,187 @@
+//==============================================================================
+// This software developed by Stellar Science Ltd Co and the U.S. Government.
+// Copyright (C) 2010 Stellar Science. Government-purpose rights granted.
+//
+// This file is part of XDM
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+#include <xdmExodus/ExodusData.hpp>
+#include <xdmExodus/Helpers.hpp>
+#include <xdmExodus/ReadableExodusFile.hpp>
+
+#include <vector>
+
+namespace xdmExodus {
+
+VariableData::VariableData(
+  int exodusObjectType,
+  int variableIndex,
+  int objectId,
+  std::size_t numberOfEntries ) :
+  ExodusData< double >( xdm::RefPtr< ReadableExodusFile >(), numberOfEntries ),
+  mExodusObjectType( exodusObjectType ),
+  mVariableIndex( variableIndex ),
+  mObjectId( objectId ),
+  mTimeStep( 0 ) {
+  setIsDynamic( true );
+}
+
+VariableData::~VariableData() {
+}
+
+void VariableData::setTimeStep( xdm::RefPtr< ReadableExodusFile > newFile, std::size_t timeStep ) {
+  if ( newFile != file() ) {
+    setFile( newFile );
+  } else if ( timeStep != mTimeStep ) {
+    unload();
+  }
+  mTimeStep = timeStep;
+}
+
+std::size_t VariableData::timeStep() const {
+  return mTimeStep;
+}
+
+void VariableData::readValues( int exodusFileId, double* values, std::size_t count ) const {
+  EXODUS_CALL(
+    ex_get_var(
+      exodusFileId,
+      (int)( mTimeStep + 1 ),
+      static_cast< ex_entity_type >( mExodusObjectType ),
+      mVariableIndex,
+      mObjectId,
+      (int)count,
+      values ),
+    "Could not read variable values." );
+}
+
+AttributeData::AttributeData(
+  xdm::RefPtr< ReadableExodusFile > file,
+  int exodusObjectType,
+  int objectId,
+  int attributeIndex,
+  std::size_t numberOfEntries ) :
+  ExodusData< double >( file, numberOfEntries ),
+  mExodusObjectType( exodusObjectType ),
+  mObjectId( objectId ),
+  mAttributeIndex( attributeIndex ) {
+}
+
+AttributeData::~AttributeData() {
+}
+
+void AttributeData::readValues( int exodusFileId, double* values, std::size_t count ) const {
+  EXODUS_CALL(
+    ex_get_one_attr(
+      exodusFileId,
+      static_cast< ex_entity_type >( mExodusObjectType ),
+      mObjectId,
+      mAttributeIndex + 1,
+      values ),
+    "Could not read attribute values." );
+}
+
+DistributionFactorData::DistributionFactorData(
+  xdm::RefPtr< ReadableExodusFile > file,
+  int exodusObjectType,
+  int objectId,
+  std::size_t numberOfEntries ) :
+  ExodusData< double >( file, numberOfEntries ),
+  mExodusObjectType( exodusObjectType ),
+  mObjectId( objectId ) {
+}
+
+DistributionFactorData::~DistributionFactorData() {
+}
+
+void DistributionFactorData::readValues(
+  int exodusFileId,
+  double* values,
+  std::size_t count ) const {
+
+  EXODUS_CALL(
+    ex_get_set_dist_fact(
+      exodusFileId,
+      static_cast< ex_entity_type >( mExodusObjectType ),
+      mObjectId,
+      values ),
+    "Could not read set distribution factors." );
+}
+
+SetEntryData::SetEntryData(
+  xdm::RefPtr< ReadableExodusFile > file,
+  int exodusObjectType,
+  int objectId,
+  std::size_t numberOfEntries,
+  bool extraFlags ) :
+  ExodusData< int >( file, numberOfEntries ),
+  mExodusObjectType( exodusObjectType ),
+  mObjectId( objectId ),
+  mExtraFlags( extraFlags ) {
+}
+
+SetEntryData::~SetEntryData() {
+}
+
+void SetEntryData::readValues( int exodusFileId, int* values, std::size_t count ) const {
+  if ( mExtraFlags ) {
+    // Exodus always reads the entries along with the flags.
+    std::vector< int > entries( count );
+    EXODUS_CALL(
+      ex_get_set(
+        exodusFileId,
+        static_cast< ex_entity_type >( mExodusObjectType ),
+        mObjectId,
+        &entries[0],
+        values ),
+      "Could not read set." );
+  } else {
+    EXODUS_CALL(
+      ex_get_set(
+        exodusFileId,
+        static_cast< ex_entity_type >( mExodusObjectType ),
+        mObjectId,
+        values,
+        0 ),
+      "Could not read set." );
+    shiftToZeroBase( values, count );
+  }
+}
+
+MapData::MapData(
+  xdm::RefPtr< ReadableExodusFile > file,
+  int exodusObjectType,
+  int objectId,
+  std::size_t numberOfEntries ) :
+  ExodusData< int >( file, numberOfEntries ),
+  mExodusObjectType( exodusObjectType ),
+  mObjectId( objectId ) {
+}
+
+MapData::~MapData() {
+}
+
+void MapData::readValues( int exodusFileId, int* values, std::size_t count ) const {
+  EXODUS_CALL(
+    ex_get_num_map(
+      exodusFileId,
+      static_cast< ex_entity_type >( mExodusObjectType ),
+      mObjectId,
+      values ),
+    "Could not read map." );
+}
+
+} // namespace xdmExodus
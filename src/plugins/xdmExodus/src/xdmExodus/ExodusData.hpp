@@ -0,0 +1,242 @@
+//==============================================================================
+// This software developed by Stellar Science Ltd Co and the U.S. Government.
+// Copyright (C) 2010 Stellar Science. Government-purpose rights granted.
+//
+// This file is part of XDM
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+#ifndef xdmExodus_ExodusData_hpp
+#define xdmExodus_ExodusData_hpp
+
+#include <xdmExodus/ReadableExodusFile.hpp>
+
+#include <xdm/Dataset.hpp>
+#include <xdm/DataSelectionMap.hpp>
+#include <xdm/MemoryAdapter.hpp>
+#include <xdm/ParallelErrorCapture.hpp>
+#include <xdm/RefPtr.hpp>
+#include <xdm/VectorStructuredArray.hpp>
+
+namespace xdmExodus {
+
+/// MemoryAdapter for the values of an Exodus object that are read from the file the first
+/// time they are requested, rather than when the file is opened. Values that are never
+/// requested are never read or held in memory. Without a file, the values are simply held
+/// in memory, which is how they are filled for writing.
+///
+/// The values of different items may be requested from several threads at once; the reads
+/// from the file are serialized. A single item must not be loaded from two threads at once.
+template< typename T >
+class ExodusData : public xdm::MemoryAdapter {
+public:
+  /// Construct with the file to read the values from, which may be null, and the number of
+  /// values.
+  ExodusData( xdm::RefPtr< ReadableExodusFile > file, std::size_t numberOfEntries ) :
+    xdm::MemoryAdapter(),
+    mFile( file ),
+    mNumberOfEntries( numberOfEntries ),
+    mValues(),
+    mIsLoaded( false ) {
+  }
+
+  virtual ~ExodusData() {}
+
+  /// Get the values, reading them from the file if they have not been read yet.
+  virtual xdm::RefPtr< const xdm::StructuredArray > array() const {
+    if ( ! mValues ) {
+      mValues = new xdm::VectorStructuredArray< T >( mNumberOfEntries );
+    }
+    if ( mFile && ! mIsLoaded ) {
+      if ( mNumberOfEntries > 0 ) {
+        // Values of different items may be requested concurrently, but the Exodus library is
+        // not thread safe. Exceptions may not leave a critical section, so they are rethrown
+        // after it.
+        xdm::ParallelErrorCapture error;
+#ifdef _OPENMP
+        #pragma omp critical( xdmExodus_library )
+#endif
+        try {
+          readValues( mFile->id(), mValues->begin(), mNumberOfEntries );
+        } catch ( ... ) {
+          error.capture();
+        }
+        error.rethrow();
+      }
+      mIsLoaded = true;
+    }
+    return mValues;
+  }
+
+  using xdm::MemoryAdapter::array;
+
+  /// Get the file the values are read from, which may be null.
+  xdm::RefPtr< ReadableExodusFile > file() const { return mFile; }
+
+  /// Determine if the values have been read from the file.
+  bool isLoaded() const { return mIsLoaded; }
+
+  /// Free the memory held for the values. Values read from a file are read again when next
+  /// requested; values without a file are lost.
+  void release() {
+    mValues.reset();
+    mIsLoaded = false;
+  }
+
+protected:
+  /// Set the file to read the values from. The values are read again when next requested.
+  void setFile( xdm::RefPtr< ReadableExodusFile > file ) {
+    mFile = file;
+    unload();
+  }
+
+  /// Read the values again when they are next requested.
+  void unload() {
+    // Keep the storage to read the next values into.
+    mIsLoaded = false;
+  }
+
+  /// Read the values from an open Exodus file.
+  virtual void readValues( int exodusFileId, T* values, std::size_t count ) const = 0;
+
+  virtual void writeImplementation( xdm::Dataset* dataset ) {
+    xdm::RefPtr< xdm::StructuredArray > values = array();
+    dataset->serialize( values.get(), xdm::DataSelectionMap() );
+  }
+
+  virtual void readImplementation( xdm::Dataset* dataset ) {
+    xdm::RefPtr< xdm::StructuredArray > values = array();
+    dataset->deserialize( values.get(), xdm::DataSelectionMap() );
+  }
+
+private:
+  xdm::RefPtr< ReadableExodusFile > mFile;
+  std::size_t mNumberOfEntries;
+  // Allocated when the values are first requested.
+  mutable xdm::RefPtr< xdm::VectorStructuredArray< T > > mValues;
+  mutable bool mIsLoaded;
+};
+
+/// The values of an Exodus variable on the entries of a block or set at one time step.
+class VariableData : public ExodusData< double > {
+public:
+  VariableData(
+    int exodusObjectType,
+    int variableIndex,
+    int objectId,
+    std::size_t numberOfEntries );
+  virtual ~VariableData();
+
+  /// Select the time step to read the values from. If the file or the time step differ from
+  /// the current ones, the values are read again when next requested.
+  void setTimeStep( xdm::RefPtr< ReadableExodusFile > file, std::size_t timeStep );
+
+  /// Get the time step the values are read from.
+  std::size_t timeStep() const;
+
+protected:
+  virtual void readValues( int exodusFileId, double* values, std::size_t count ) const;
+
+private:
+  int mExodusObjectType;
+  int mVariableIndex;
+  int mObjectId;
+  std::size_t mTimeStep;
+};
+
+/// The values of one Exodus attribute on the entries of a block.
+class AttributeData : public ExodusData< double > {
+public:
+  AttributeData(
+    xdm::RefPtr< ReadableExodusFile > file,
+    int exodusObjectType,
+    int objectId,
+    int attributeIndex,
+    std::size_t numberOfEntries );
+  virtual ~AttributeData();
+
+protected:
+  virtual void readValues( int exodusFileId, double* values, std::size_t count ) const;
+
+private:
+  int mExodusObjectType;
+  int mObjectId;
+  int mAttributeIndex;
+};
+
+/// The distribution factors of an Exodus set, one per entry.
+class DistributionFactorData : public ExodusData< double > {
+public:
+  DistributionFactorData(
+    xdm::RefPtr< ReadableExodusFile > file,
+    int exodusObjectType,
+    int objectId,
+    std::size_t numberOfEntries );
+  virtual ~DistributionFactorData();
+
+protected:
+  virtual void readValues( int exodusFileId, double* values, std::size_t count ) const;
+
+private:
+  int mExodusObjectType;
+  int mObjectId;
+};
+
+/// The entries of an Exodus set, as zero-based indices into the nodes, edges, faces, or
+/// elements of the file, or the extra flags that come with the entries of edge, face, and
+/// side sets.
+class SetEntryData : public ExodusData< int > {
+public:
+  /// @param extraFlags true to read the extra flags instead of the entries.
+  SetEntryData(
+    xdm::RefPtr< ReadableExodusFile > file,
+    int exodusObjectType,
+    int objectId,
+    std::size_t numberOfEntries,
+    bool extraFlags );
+  virtual ~SetEntryData();
+
+protected:
+  virtual void readValues( int exodusFileId, int* values, std::size_t count ) const;
+
+private:
+  int mExodusObjectType;
+  int mObjectId;
+  bool mExtraFlags;
+};
+
+/// The values of an Exodus number map, the global ids of the nodes, edges, faces, or
+/// elements of the file.
+class MapData : public ExodusData< int > {
+public:
+  MapData(
+    xdm::RefPtr< ReadableExodusFile > file,
+    int exodusObjectType,
+    int objectId,
+    std::size_t numberOfEntries );
+  virtual ~MapData();
+
+protected:
+  virtual void readValues( int exodusFileId, int* values, std::size_t count ) const;
+
+private:
+  int mExodusObjectType;
+  int mObjectId;
+};
+
+} // namespace xdmExodus
+
+#endif // xdmExodus_ExodusData_hpp
+
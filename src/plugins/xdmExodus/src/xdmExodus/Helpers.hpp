@@ -18,12 +18,15 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 //
 //------------------------------------------------------------------------------
+#ifndef xdmExodus_Helpers_hpp
+#define xdmExodus_Helpers_hpp
 
 #include <xdmGrid/UnstructuredTopology.hpp>
 #include <xdmGrid/ElementTopology.hpp>
 
 #include <xdm/ArrayAdapter.hpp>
 #include <xdm/RefPtr.hpp>
+#include <xdm/UniformDataItem.hpp>
 
 #include <exodusII.h>
 
@@ -32,15 +35,18 @@
 #include <functional>
 #include <map>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
 /// Const types and some functions that are useful when working with ExodusII files.
 
 #define EXODUS_CALL( functionCall, errorString ) \
-  if ( (#functionCall) < 0 ) { \
-    throw std::runtime_error( (#errorString) ); \
-  }
+  do { \
+    if ( (functionCall) < 0 ) { \
+      throw std::runtime_error( errorString ); \
+    } \
+  } while ( 0 )
 
 namespace xdmExodus {
 
@@ -49,11 +55,11 @@ struct ExodusString {
   ExodusString() {}
 
   ExodusString( const std::string& str ) {
-    std::strcpy( raw, str.substr( 0, MAX_STR_LENGTH + 1 ).c_str() );
+    std::strcpy( raw, str.substr( 0, MAX_STR_LENGTH ).c_str() );
   }
 
   ExodusString( const char* str ){
-    std::strcpy( raw, std::string( str ).substr( 0, MAX_STR_LENGTH + 1 ).c_str() );
+    std::strcpy( raw, std::string( str ).substr( 0, MAX_STR_LENGTH ).c_str() );
   }
 
   char raw[ MAX_STR_LENGTH + 1 ];
@@ -64,31 +70,45 @@ struct ExodusString {
 };
 
 /// Get a char** that points to the individual strings in a std::vector< ExodusString >.
-void vectorToCharStarArray( std::vector< ExodusString >& input, char* output[] ) {
+inline void vectorToCharStarArray( std::vector< ExodusString >& input, char* output[] ) {
   std::transform( input.begin(), input.end(), output,
     std::mem_fun_ref( &ExodusString::ptr ) );
 }
 
-/// Do two conversions: int -> size_t and also move the base to zero. Exodus numbering starts at
-/// 1, so this subtracts 1 from all values to give zero-based indexing.
-template< typename OutputIterator >
-void convertToZeroBase( const std::vector< int >& vecWithExodusOrdering, OutputIterator oBegin ) {
-  std::transform( vecWithExodusOrdering.begin(), vecWithExodusOrdering.end(), oBegin,
-    std::bind2nd( std::minus< std::size_t >(), 1 ) );
+/// Move Exodus indices to zero-based indexing in place. Exodus numbering starts at 1, so this
+/// subtracts 1 from every value. The loop is kept simple so that the compiler vectorizes it.
+inline void shiftToZeroBase( int* values, std::size_t count ) {
+  for ( std::size_t i = 0; i < count; ++i ) {
+    values[i] -= 1;
+  }
+}
+
+/// This is the inverse of shiftToZeroBase, moving zero-based indices to Exodus numbering in
+/// place.
+inline void shiftToOneBase( int* values, std::size_t count ) {
+  for ( std::size_t i = 0; i < count; ++i ) {
+    values[i] += 1;
+  }
 }
 
-/// This is the inverse of convertToZeroBase.
-template< typename OutputIterator >
-void convertToOneBase( const std::vector< std::size_t >& vecWithBaseZeroOrdering, OutputIterator oBegin ) {
-  std::transform( vecWithBaseZeroOrdering.begin(), vecWithBaseZeroOrdering.end(), oBegin,
-    std::bind2nd( std::plus< int >(), 1 ) );
+/// Like shiftToOneBase, but copies zero-based indices of any integer type to an int array with
+/// Exodus numbering.
+template< typename IndexT >
+void copyToOneBase( const IndexT* values, std::size_t count, int* out ) {
+  for ( std::size_t i = 0; i < count; ++i ) {
+    out[i] = static_cast< int >( values[i] ) + 1;
+  }
 }
 
+/// The number of nodes whose coordinates are converted between one array per dimension and
+/// interlaced coordinates at a time. This bounds the scratch memory of the conversion.
+const std::size_t kCoordinateChunkSize = 1 << 16;
+
 const std::size_t kNumberOfObjectTypes = 12;
 
-bool objectIsBlock( std::size_t i ) { return i >= 0 && i < 3; }
-bool objectIsSet( std::size_t i ) { return i > 2 && i < 8; }
-bool objectIsMap( std::size_t i ) { return i >= 8 && i < kNumberOfObjectTypes; }
+inline bool objectIsBlock( std::size_t i ) { return i >= 0 && i < 3; }
+inline bool objectIsSet( std::size_t i ) { return i > 2 && i < 8; }
+inline bool objectIsMap( std::size_t i ) { return i >= 8 && i < kNumberOfObjectTypes; }
 
 /// These are the flags that Exodus uses to signify edge blocks, node sets, etc.
 const int kObjectTypes[ kNumberOfObjectTypes ] = {
@@ -125,7 +145,7 @@ const int kInquireObjectSizes[ kNumberOfObjectTypes ] = {
   EX_INQ_ELEM_MAP
 };
 
-const char* kObjectTypeChar[ kNumberOfObjectTypes ] = {
+const char* const kObjectTypeChar[ kNumberOfObjectTypes ] = {
   "L",
   "F",
   "E",
@@ -142,7 +162,7 @@ const char* kObjectTypeChar[ kNumberOfObjectTypes ] = {
 
 // Helpers that create a UniformDataItem from a StructuredArray. This is done frequently.
 // First version takes one dimension.
-xdm::RefPtr< xdm::UniformDataItem > makeDataItem(
+inline xdm::RefPtr< xdm::UniformDataItem > makeDataItem(
   xdm::RefPtr< xdm::StructuredArray > vector,
   xdm::primitiveType::Value primType,
   std::size_t firstExtent ) {
@@ -150,10 +170,11 @@ xdm::RefPtr< xdm::UniformDataItem > makeDataItem(
   xdm::RefPtr< xdm::UniformDataItem > dataItem(
     new xdm::UniformDataItem( primType, xdm::makeShape( firstExtent ) ) );
   dataItem->setData( xdm::makeRefPtr( new xdm::ArrayAdapter( vector ) ) );
+  return dataItem;
 }
 
 // Second version takes two dimensions.
-xdm::RefPtr< xdm::UniformDataItem > makeDataItem(
+inline xdm::RefPtr< xdm::UniformDataItem > makeDataItem(
   xdm::RefPtr< xdm::StructuredArray > vector,
   xdm::primitiveType::Value primType,
   std::size_t firstExtent,
@@ -162,7 +183,10 @@ xdm::RefPtr< xdm::UniformDataItem > makeDataItem(
   xdm::RefPtr< xdm::UniformDataItem > dataItem(
     new xdm::UniformDataItem( primType, xdm::makeShape( firstExtent, secondExtent ) ) );
   dataItem->setData( xdm::makeRefPtr( new xdm::ArrayAdapter( vector ) ) );
+  return dataItem;
 }
 
 } // namespace xdmExodus
 
+#endif // xdmExodus_Helpers_hpp
+
@@ -0,0 +1,85 @@
+//==============================================================================
+// This software developed by Stellar Science Ltd Co and the U.S. Government.
+// Copyright (C) 2010 Stellar Science. Government-purpose rights granted.
+//
+// This file is part of XDM
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+#include <xdmExodus/Maps.hpp>
+#include <xdmExodus/ExodusData.hpp>
+#include <xdmExodus/Helpers.hpp>
+#include <xdmExodus/ReadableExodusFile.hpp>
+#include <xdmExodus/Variable.hpp>
+
+#include <xdm/UniformDataItem.hpp>
+
+namespace xdmExodus {
+
+Map::Map() :
+  xdmGrid::Attribute( xdmGrid::Attribute::kGlobalId, xdmGrid::Attribute::kNode ),
+  mNumberOfEntries( 0 ) {
+}
+
+std::size_t Map::numberOfEntries() const {
+  return mNumberOfEntries;
+}
+
+void Map::readFromFile(
+  xdm::RefPtr< ReadableExodusFile > file,
+  int exodusObjectId,
+  std::string name,
+  std::size_t numberOfEntries ) {
+
+  setId( exodusObjectId );
+  setName( name );
+  mNumberOfEntries = numberOfEntries;
+
+  switch ( exodusObjectType() ) {
+    case EX_EDGE_MAP:
+      setCentering( xdmGrid::Attribute::kEdge );
+      break;
+    case EX_FACE_MAP:
+      setCentering( xdmGrid::Attribute::kFace );
+      break;
+    case EX_ELEM_MAP:
+      setCentering( xdmGrid::Attribute::kElement );
+      break;
+    default:
+      setCentering( xdmGrid::Attribute::kNode );
+  }
+
+  xdm::RefPtr< xdm::UniformDataItem > dataItem(
+    new xdm::UniformDataItem( xdm::primitiveType::kInt, xdm::makeShape( mNumberOfEntries ) ) );
+  dataItem->setData( xdm::makeRefPtr(
+    new MapData( file, exodusObjectType(), id(), mNumberOfEntries ) ) );
+  setDataItem( dataItem );
+}
+
+xdm::RefPtr< Map > mapFactory( int exodusObjectType ) {
+  switch ( exodusObjectType ) {
+    case EX_NODE_MAP:
+      return xdm::makeRefPtr( new NodeMap );
+    case EX_EDGE_MAP:
+      return xdm::makeRefPtr( new EdgeMap );
+    case EX_FACE_MAP:
+      return xdm::makeRefPtr( new FaceMap );
+    case EX_ELEM_MAP:
+      return xdm::makeRefPtr( new ElementMap );
+  }
+  return xdm::RefPtr< Map >( NULL );
+}
+
+} // namespace xdmExodus
@@ -23,14 +23,39 @@
 
 #include <xdmExodus/Object.hpp>
 
+#include <xdmGrid/Attribute.hpp>
 
+#include <xdm/RefPtr.hpp>
+
+#include <string>
 
 namespace xdmExodus {
 
+class ReadableExodusFile;
+
 /// An Exodus map is not really an object, but it inherits from Object to grab some of
-/// the Exodus type lookup functionality.
+/// the Exodus type lookup functionality. A number map gives the global id of each node,
+/// edge, face, or element, so it is a global id Attribute of the grid holding all of the
+/// nodes or entries of its type. The values are read when they are first requested.
 class Map :
-  public Object {
+  public Object,
+  public xdmGrid::Attribute {
+public:
+  Map();
+
+  virtual std::size_t numberOfEntries() const;
+
+  /// Set up the map from an open file. The values of the map are read from the file when
+  /// they are first requested.
+  /// @param numberOfEntries The number of nodes, edges, faces, or elements in the file.
+  virtual void readFromFile(
+    xdm::RefPtr< ReadableExodusFile > file,
+    int exodusObjectId,
+    std::string name,
+    std::size_t numberOfEntries );
+
+private:
+  std::size_t mNumberOfEntries;
 };
 
 class NodeMap : public Map {
@@ -53,6 +78,8 @@ protected:
   virtual int exodusObjectTypeIndex() const { return 11; }
 };
 
+xdm::RefPtr< Map > mapFactory( int exodusObjectType );
+
 } // namespace xdmExodus
 
 #endif // xdmExodus_Maps_hpp
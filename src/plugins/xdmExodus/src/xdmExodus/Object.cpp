@@ -21,6 +21,7 @@
 
 #include <xdmExodus/Object.hpp>
 #include <xdmExodus/Helpers.hpp>
+#include <xdmExodus/ReadableExodusFile.hpp>
 #include <xdmExodus/Variable.hpp>
 
 #include <xdm/RefPtr.hpp>
@@ -46,6 +47,10 @@ std::vector< xdm::RefPtr< Variable > > Object::variables() {
   return mVariables;
 }
 
+std::size_t Object::numberOfVariables() const {
+  return mVariables.size();
+}
+
 void Object::setupVariables(
   std::vector< int >::const_iterator beginTruthTable,
   const std::size_t numberOfVariables,
@@ -56,9 +61,10 @@ void Object::setupVariables(
       continue;
     }
 
+    // Exodus numbers the variables from 1.
     xdm::RefPtr< Variable > variable( new Variable(
       exodusObjectType(),
-      variableIndex,
+      variableIndex + 1,
       id(),
       numberOfEntries() ) );
     variable->setName( variableNames[ variableIndex ].string() );
@@ -66,10 +72,10 @@ void Object::setupVariables(
   }
 }
 
-void Object::readTimeStep( int exodusFileId, std::size_t timeStep ) {
+void Object::readTimeStep( xdm::RefPtr< ReadableExodusFile > file, std::size_t timeStep ) {
   typedef std::vector< xdm::RefPtr< Variable > >::iterator VariableIterator;
   for ( VariableIterator var = mVariables.begin(); var != mVariables.end(); ++var ) {
-    (*var)->readTimeStep( exodusFileId, timeStep );
+    (*var)->readTimeStep( file, timeStep );
   }
 }
 
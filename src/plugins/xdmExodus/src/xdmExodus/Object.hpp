@@ -30,6 +30,7 @@
 namespace xdmExodus {
 
 class ExodusString;
+class ReadableExodusFile;
 class Variable;
 
 /// An Exodus object refers to an array of values describing a block or set in a NetCDF file.
@@ -56,6 +57,9 @@ public:
 
   std::vector< xdm::RefPtr< Variable > > variables();
 
+  /// Get the number of Variables added to the Object.
+  std::size_t numberOfVariables() const;
+
   void setupVariables(
     std::vector< int >::const_iterator beginTruthTable,
     const std::size_t numberOfVariables,
@@ -63,10 +67,11 @@ public:
 
   virtual void writeToFile( int exodusFileId, int* variableTruthTable ) {}
 
-  /// Read the data for the variables at a specific time step.
+  /// Read the data for the variables at a specific time step. The values of each variable
+  /// are read from the file when they are first requested.
   /// @pre A call to setupVariables to make sure the variables exist in the data structure.
   /// @post The Variables in the Object have values corresponding to @arg timeStep.
-  virtual void readTimeStep( int exodusFileId, std::size_t timeStep );
+  virtual void readTimeStep( xdm::RefPtr< ReadableExodusFile > file, std::size_t timeStep );
 
   virtual void writeTimeStep( int exodusFileId, std::size_t timeStep );
 
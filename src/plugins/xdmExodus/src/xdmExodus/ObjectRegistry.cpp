@@ -0,0 +1,111 @@
+//==============================================================================
+// This software developed by Stellar Science Ltd Co and the U.S. Government.
+// Copyright (C) 2010 Stellar Science. Government-purpose rights granted.
+//
+// This file is part of XDM
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+#include <xdmExodus/ObjectRegistry.hpp>
+
+#include <xdmExodus/Object.hpp>
+
+#include <xdmGrid/Grid.hpp>
+
+#include <xdm/DataItem.hpp>
+#include <xdm/Item.hpp>
+#include <xdm/ItemVisitor.hpp>
+
+#include <set>
+
+namespace xdmExodus {
+
+// Fill a registry with the objects and grids of a tree in one pass. Data items hold
+// neither, so they are not descended into.
+class GatherObjectsVisitor : public xdm::ItemVisitor {
+public:
+  GatherObjectsVisitor( ObjectRegistry& registry ) :
+    mRegistry( registry ),
+    mVisited() {
+  }
+
+  virtual void apply( xdm::Item& item ) {
+    if ( ! mVisited.insert( &item ).second ) {
+      return;
+    }
+    if ( Object* object = dynamic_cast< Object* >( &item ) ) {
+      mRegistry.mObjects.push_back( object );
+      mRegistry.mObjectsByType[ object->exodusObjectType() ].push_back( object );
+    }
+    if ( xdmGrid::Grid* grid = dynamic_cast< xdmGrid::Grid* >( &item ) ) {
+      mRegistry.mGrids.push_back( grid );
+    }
+    traverse( item );
+  }
+
+  virtual void apply( xdm::DataItem& ) {
+  }
+
+private:
+  ObjectRegistry& mRegistry;
+  std::set< xdm::Item* > mVisited;
+};
+
+ObjectRegistry::ObjectRegistry() :
+  mRoot(),
+  mObjects(),
+  mObjectsByType(),
+  mGrids() {
+}
+
+ObjectRegistry::~ObjectRegistry() {
+}
+
+void ObjectRegistry::gather( xdm::RefPtr< xdm::Item > root ) {
+  clear();
+  mRoot = root;
+  if ( mRoot ) {
+    GatherObjectsVisitor visitor( *this );
+    mRoot->accept( visitor );
+  }
+}
+
+void ObjectRegistry::clear() {
+  mRoot.reset();
+  mObjects.clear();
+  mObjectsByType.clear();
+  mGrids.clear();
+}
+
+xdm::RefPtr< xdm::Item > ObjectRegistry::root() const {
+  return mRoot;
+}
+
+const std::vector< Object* >& ObjectRegistry::objects() const {
+  return mObjects;
+}
+
+const std::vector< Object* >& ObjectRegistry::objects( int exodusObjectType ) const {
+  static const std::vector< Object* > kNoObjects;
+  std::map< int, std::vector< Object* > >::const_iterator found =
+    mObjectsByType.find( exodusObjectType );
+  return found == mObjectsByType.end() ? kNoObjects : found->second;
+}
+
+const std::vector< xdmGrid::Grid* >& ObjectRegistry::grids() const {
+  return mGrids;
+}
+
+} // namespace xdmExodus
@@ -0,0 +1,78 @@
+//==============================================================================
+// This software developed by Stellar Science Ltd Co and the U.S. Government.
+// Copyright (C) 2010 Stellar Science. Government-purpose rights granted.
+//
+// This file is part of XDM
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+#ifndef xdmExodus_ObjectRegistry_hpp
+#define xdmExodus_ObjectRegistry_hpp
+
+#include <xdmGrid/Forward.hpp>
+
+#include <xdm/Forward.hpp>
+#include <xdm/RefPtr.hpp>
+
+#include <map>
+#include <vector>
+
+namespace xdmExodus {
+
+class Object;
+
+/// The Exodus objects and grids of an item tree, gathered by type in a single traversal.
+/// Readers and writers step the same tree through time many times, so they gather it once
+/// and then go straight to the blocks, sets, and grids they work on at each step rather than
+/// searching the tree and casting every item again.
+///
+/// The registry holds a reference to the root of the tree, which keeps the objects alive.
+/// Items added to the tree after it was gathered are not seen until it is gathered again.
+class ObjectRegistry {
+public:
+  ObjectRegistry();
+  ~ObjectRegistry();
+
+  /// Gather the Exodus objects and grids of a tree, including its root, replacing the ones
+  /// held. An item that appears in the tree more than once is gathered once.
+  void gather( xdm::RefPtr< xdm::Item > root );
+
+  /// Release the tree and its objects.
+  void clear();
+
+  /// Get the root of the gathered tree, which is null if nothing was gathered.
+  xdm::RefPtr< xdm::Item > root() const;
+
+  /// Get every Exodus object in the tree, in tree order.
+  const std::vector< Object* >& objects() const;
+
+  /// Get the Exodus objects of one type (EX_ELEM_BLOCK, EX_NODE_SET, ...), in tree order.
+  const std::vector< Object* >& objects( int exodusObjectType ) const;
+
+  /// Get every grid in the tree, in tree order.
+  const std::vector< xdmGrid::Grid* >& grids() const;
+
+private:
+  friend class GatherObjectsVisitor;
+
+  xdm::RefPtr< xdm::Item > mRoot;
+  std::vector< Object* > mObjects;
+  std::map< int, std::vector< Object* > > mObjectsByType;
+  std::vector< xdmGrid::Grid* > mGrids;
+};
+
+} // namespace xdmExodus
+
+#endif // xdmExodus_ObjectRegistry_hpp
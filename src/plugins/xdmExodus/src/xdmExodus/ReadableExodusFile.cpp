@@ -0,0 +1,97 @@
+//==============================================================================
+// This software developed by Stellar Science Ltd Co and the U.S. Government.
+// Copyright (C) 2010 Stellar Science. Government-purpose rights granted.
+//
+// This file is part of XDM
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+#include <xdmExodus/ReadableExodusFile.hpp>
+#include <xdmExodus/Helpers.hpp>
+
+#include <stdexcept>
+
+namespace xdmExodus {
+
+ReadableExodusFile::ReadableExodusFile( const xdm::FileSystemPath& path ) :
+  mPath( path ),
+  mFileId( -1 ),
+  mTimes() {
+
+  if ( ! exists( path ) ) {
+    throw std::runtime_error( "The Exodus file does not exist at " + path.pathString() );
+  }
+
+  // Open the file and get the id.
+  float version;
+  int doubleWordSize = sizeof( double );
+  int storedDataWordSize = 0;
+  mFileId = ex_open(
+    path.pathString().c_str(),
+    EX_READ,
+    &doubleWordSize,
+    &storedDataWordSize,
+    &version );
+  if ( mFileId < 0 ) {
+    throw std::runtime_error( "Could not open ExodusII file at " + path.pathString() );
+  }
+
+  // Read the time values of every step up front.
+  try {
+    int numberOfTimeSteps = 0;
+    EXODUS_CALL( ex_inquire( mFileId, EX_INQ_TIME, &numberOfTimeSteps, 0, 0 ), "Unable to read"
+      " number of time steps." );
+    if ( numberOfTimeSteps > 0 ) {
+      mTimes.resize( numberOfTimeSteps );
+      EXODUS_CALL( ex_get_all_times( mFileId, &mTimes[0] ), "Could not read time steps." );
+    }
+  } catch ( ... ) {
+    close();
+    throw;
+  }
+}
+
+ReadableExodusFile::~ReadableExodusFile() {
+  close();
+}
+
+void ReadableExodusFile::close() {
+  if ( mFileId >= 0 ) {
+    try {
+      ex_close( mFileId );
+    } catch ( ... ) {
+      // Should probably log this or something.
+    }
+    mFileId = -1;
+  }
+}
+
+const xdm::FileSystemPath& ReadableExodusFile::path() const {
+  return mPath;
+}
+
+int ReadableExodusFile::id() const {
+  return mFileId;
+}
+
+std::size_t ReadableExodusFile::numberOfTimeSteps() const {
+  return mTimes.size();
+}
+
+double ReadableExodusFile::timeValue( std::size_t timeStep ) const {
+  return mTimes.at( timeStep );
+}
+
+} // namespace xdmExodus
@@ -0,0 +1,67 @@
+//==============================================================================
+// This software developed by Stellar Science Ltd Co and the U.S. Government.
+// Copyright (C) 2010 Stellar Science. Government-purpose rights granted.
+//
+// This file is part of XDM
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+#ifndef xdmExodus_ReadableExodusFile_hpp
+#define xdmExodus_ReadableExodusFile_hpp
+
+#include <xdm/FileSystem.hpp>
+#include <xdm/ReferencedObject.hpp>
+
+#include <vector>
+
+namespace xdmExodus {
+
+/// An ExodusII file opened for reading. The number of time steps and the time value of
+/// each step are read when the file is opened. The file is closed when the last reference
+/// to it is released, so items whose values are read on demand keep their file open.
+class ReadableExodusFile : public xdm::ReferencedObject {
+public:
+  /// Open the ExodusII file at a path.
+  /// @throws std::runtime_error if the file does not exist or could not be opened.
+  explicit ReadableExodusFile( const xdm::FileSystemPath& path );
+  virtual ~ReadableExodusFile();
+
+  /// Get the path the file was opened from.
+  const xdm::FileSystemPath& path() const;
+
+  /// Get the Exodus id of the open file.
+  int id() const;
+
+  /// Get the number of time steps in the file.
+  std::size_t numberOfTimeSteps() const;
+
+  /// Get the time value of a time step.
+  double timeValue( std::size_t timeStep ) const;
+
+private:
+  ReadableExodusFile( const ReadableExodusFile& );
+  ReadableExodusFile& operator=( const ReadableExodusFile& );
+
+  void close();
+
+  xdm::FileSystemPath mPath;
+  int mFileId;
+  std::vector< double > mTimes;
+};
+
+} // namespace xdmExodus
+
+#endif // xdmExodus_ReadableExodusFile_hpp
+
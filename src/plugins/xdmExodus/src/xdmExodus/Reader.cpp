@@ -22,20 +22,31 @@
 
 #include <xdmExodus/Blocks.hpp>
 #include <xdmExodus/Helpers.hpp>
+#include <xdmExodus/Maps.hpp>
+#include <xdmExodus/Object.hpp>
+#include <xdmExodus/ReadableExodusFile.hpp>
 #include <xdmExodus/Sets.hpp>
 #include <xdmExodus/Variable.hpp>
 
 #include <xdmGrid/CollectionGrid.hpp>
 #include <xdmGrid/Domain.hpp>
+#include <xdmGrid/ElementTopology.hpp>
+#include <xdmGrid/InterlacedGeometry.hpp>
 #include <xdmGrid/MultiArrayGeometry.hpp>
 #include <xdmGrid/Time.hpp>
+#include <xdmGrid/UniformGrid.hpp>
+#include <xdmGrid/UnstructuredTopology.hpp>
 
 #include <xdm/FileSystem.hpp>
-#include <xdm/ItemVisitor.hpp>
+#include <xdm/ParallelErrorCapture.hpp>
 #include <xdm/UniformDataItem.hpp>
 #include <xdm/VectorStructuredArray.hpp>
 
+#include <algorithm>
 #include <cassert>
+#include <map>
+#include <sstream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -43,115 +54,120 @@ namespace xdmExodus {
 
 namespace {
 
-xdm::RefPtr< xdmGrid::Geometry > readGeometry( int exodusFileId, const ex_init_params& gridParameters ) {
-  // Read the nodes. For Exodus, there is only one set of nodes per file.
-  std::vector< xdm::RefPtr< xdm::VectorStructuredArray< double > > > xyzCoords( 3 );
-  xdm::RefPtr< xdmGrid::MultiArrayGeometry > geom(
-    new xdmGrid::MultiArrayGeometry( gridParameters.num_dim ) );
-  for( std::size_t dim = 0; dim < gridParameters.num_dim; ++dim ) {
-    xyzCoords[ dim ] = new xdm::VectorStructuredArray< double >( gridParameters.num_nodes );
-    xdm::RefPtr< xdm::UniformDataItem > dataItem = makeDataItem(
-      xyzCoords[ dim ], xdm::primitiveType::kDouble, gridParameters.num_nodes );
-    geom->setCoordinateValues( dim, dataItem );
+// Read the coordinates of the nodes [firstNode, firstNode + numberOfNodes) into one array per
+// dimension. The arrays of dimensions that are not wanted may be null.
+void readCoordinateArrays(
+  int exodusFileId,
+  std::size_t firstNode,
+  std::size_t numberOfNodes,
+  double* x,
+  double* y,
+  double* z ) {
+
+  if ( numberOfNodes == 0 ) {
+    return;
   }
-
   EXODUS_CALL(
-    ex_get_coord( exodusFileId, xyzCoords[0]->data(), xyzCoords[1]->data(), xyzCoords[2]->data() ),
-    "Could not read node coordinates from Exouds file." );
-
-  return geom;
+    ex_get_n_coord( exodusFileId, static_cast< int >( firstNode + 1 ),
+      static_cast< int >( numberOfNodes ), x, y, z ),
+    "Could not read node coordinates from Exodus file." );
 }
 
-// An RAII class to handle an Exodus file. However, the behavior may be unpredictable if more than
-// one of these exist in the same scope with the same file.
-class ReadableExodusFile {
-public:
-  ReadableExodusFile( const xdm::FileSystemPath& exodusFileName ) :
-    mFileId( -1 ) {
-
-    if ( ! exists( exodusFileName ) ) {
-      std::runtime_error( "The Exodus file does not exist at " + exodusFileName.pathString() );
-    }
+// Read the coordinates of the nodes [firstNode, firstNode + numberOfNodes) interlaced into a
+// single array. The file holds one array per dimension, so the nodes are read and interlaced
+// a chunk at a time.
+void readInterlacedCoordinateArray(
+  int exodusFileId,
+  unsigned int dimension,
+  std::size_t firstNode,
+  std::size_t numberOfNodes,
+  double* xyz ) {
 
-    // Open the file and get the id.
-    float version;
-    int doubleWordSize = sizeof( double );
-    int storedDataWordSize = 0;
-    mFileId = ex_open(
-      exodusFileName.pathString().c_str(),
-      EX_READ,
-      &doubleWordSize,
-      &storedDataWordSize,
-      &version );
-    if ( mFileId < 0 ) {
-      throw std::runtime_error( "Could not open ExodusII file at " + exodusFileName.pathString() );
-    }
+  if ( numberOfNodes == 0 || dimension == 0 ) {
+    return;
+  }
+  const std::size_t chunkSize = std::min( numberOfNodes, kCoordinateChunkSize );
+  std::vector< std::vector< double > > chunk( dimension, std::vector< double >( chunkSize ) );
+  double* arrays[3] = { 0, 0, 0 };
+  for ( unsigned int dim = 0; dim < dimension && dim < 3; ++dim ) {
+    arrays[ dim ] = &chunk[ dim ][0];
   }
 
-  ~ReadableExodusFile() {
-    if ( mFileId >= 0 ) {
-      try {
-        ex_close( mFileId );
-      } catch ( ... ) {
-        // Should probably log this or something.
+  for ( std::size_t begin = 0; begin < numberOfNodes; begin += chunkSize ) {
+    const std::size_t count = std::min( chunkSize, numberOfNodes - begin );
+    readCoordinateArrays( exodusFileId, firstNode + begin, count, arrays[0], arrays[1], arrays[2] );
+    double* out = xyz + begin * dimension;
+    for ( std::size_t node = 0; node < count; ++node ) {
+      for ( unsigned int dim = 0; dim < dimension; ++dim ) {
+        out[ node * dimension + dim ] = chunk[ dim ][ node ];
       }
     }
   }
+}
 
-  int id() const { return mFileId; }
-
-private:
-  int mFileId;
-};
+xdm::RefPtr< xdmGrid::Geometry > readGeometry(
+  int exodusFileId,
+  const ex_init_params& gridParameters,
+  ExodusReader::CoordinateLayout layout ) {
 
-// This visitor can be used to traverse a tree that contains Variables. After the visitor
-// is applied, all Variables contain the data from the requested time step. Dynamic casting
-// is required here because the ItemVisitor does not know about xdmGrid or xdmExodus.
-class UpdateVariableVisitor : public xdm::ItemVisitor {
-public:
-  UpdateVariableVisitor( int exodusFileId, std::size_t timeStep ) :
-    mTimeStep( timeStep ),
-    mFileId( exodusFileId ),
-    mSomethingWasUpdated( false ) {}
-
-  virtual ~UpdateVariableVisitor() {}
-
-  virtual void apply( xdm::Item& item ) {
-    Variable* variable = dynamic_cast< Variable* >( &item );
-    if ( variable ) {
-      variable->readTimeStep( mFileId, mTimeStep );
-      mSomethingWasUpdated = true;
-    }
+  // Read the nodes. For Exodus, there is only one set of nodes per file.
+  const std::size_t numberOfNodes = gridParameters.num_nodes;
+  const unsigned int dimension = gridParameters.num_dim;
+
+  if ( layout == ExodusReader::kInterlacedCoordinates ) {
+    xdm::RefPtr< xdm::VectorStructuredArray< double > > xyz(
+      new xdm::VectorStructuredArray< double >( numberOfNodes * dimension ) );
+    readInterlacedCoordinateArray( exodusFileId, dimension, 0, numberOfNodes, xyz->begin() );
+    xdm::RefPtr< xdmGrid::InterlacedGeometry > geom( new xdmGrid::InterlacedGeometry( dimension ) );
+    geom->setCoordinateValues(
+      makeDataItem( xyz, xdm::primitiveType::kDouble, numberOfNodes, dimension ) );
+    geom->setNumberOfNodes( numberOfNodes );
+    return geom;
   }
 
-  bool somethingWasUpdated() const { return mSomethingWasUpdated; }
-
-private:
-  std::size_t mTimeStep;
-  int mFileId;
-  bool mSomethingWasUpdated;
-};
+  // The coordinates are read straight into the arrays of the geometry.
+  std::vector< xdm::RefPtr< xdm::VectorStructuredArray< double > > > xyzCoords( 3 );
+  xdm::RefPtr< xdmGrid::MultiArrayGeometry > geom(
+    new xdmGrid::MultiArrayGeometry( dimension ) );
+  for( std::size_t dim = 0; dim < dimension; ++dim ) {
+    xyzCoords[ dim ] = new xdm::VectorStructuredArray< double >( numberOfNodes );
+    xdm::RefPtr< xdm::UniformDataItem > dataItem = makeDataItem(
+      xyzCoords[ dim ], xdm::primitiveType::kDouble, numberOfNodes );
+    geom->setCoordinateValues( dim, dataItem );
+  }
+  readCoordinateArrays(
+    exodusFileId,
+    0,
+    numberOfNodes,
+    xyzCoords[0] ? xyzCoords[0]->begin() : 0,
+    xyzCoords[1] ? xyzCoords[1]->begin() : 0,
+    xyzCoords[2] ? xyzCoords[2]->begin() : 0 );
 
-// This visitor can be used to traverse a tree that contains xdmGrid::Grids. After the
-// visitor is applied, all Grids will have the Time attached to them. Dynamic casting
-// is required here because ItemVisitor does not know about xdmGrid.
-class UpdateTimeVisitor : public xdm::ItemVisitor {
-public:
-  UpdateTimeVisitor( xdm::RefPtr< xdmGrid::Time > time ) :
-    mTime( time ) {}
+  return geom;
+}
 
-  virtual ~UpdateTimeVisitor() {}
+// Get a count from ex_inquire.
+std::size_t inquireCount( int exodusFileId, int inquiry ) {
+  int count = 0;
+  EXODUS_CALL( ex_inquire( exodusFileId, inquiry, &count, 0, 0 ),
+    "Could not inquire about the Exodus file." );
+  return count;
+}
 
-  virtual void apply( xdm::Item& item ) {
-    xdmGrid::Grid* grid = dynamic_cast< xdmGrid::Grid* >( &item );
-    if ( grid ) {
-      grid->setTime( mTime );
-    }
+// Throw if the nodes [firstNode, firstNode + numberOfNodes) are not all in a file.
+void checkNodeRange(
+  const ReadableExodusFile& file,
+  std::size_t firstNode,
+  std::size_t numberOfNodes ) {
+
+  const std::size_t fileNodes = inquireCount( file.id(), EX_INQ_NODES );
+  if ( firstNode > fileNodes || numberOfNodes > fileNodes - firstNode ) {
+    std::ostringstream message;
+    message << "The nodes [" << firstNode << ", " << firstNode + numberOfNodes
+      << ") are not in the " << fileNodes << " nodes of " << file.path().pathString();
+    throw std::runtime_error( message.str() );
   }
-
-private:
-  xdm::RefPtr< xdmGrid::Time > mTime;
-};
+}
 
 struct ObjectGroupData {
   std::size_t numberOfObjects;
@@ -178,24 +194,23 @@ bool readObjectGroupData(
   std::size_t objectTypeIndex ) {
 
   // Get the number of instances of this type of object.
-  EXODUS_CALL(
-    ex_inquire( exodusFileId, kInquireObjectSizes[ objectTypeIndex ], &group.numberOfObjects, 0, 0 ),
-    "The number of objects could not be determined." );
-
+  group.numberOfObjects = inquireCount( exodusFileId, kInquireObjectSizes[ objectTypeIndex ] );
   if ( group.numberOfObjects < 1 ) {
     return false;
   }
 
   // Get the "ID" of all of the instances.
   group.objectIds.resize( group.numberOfObjects );
-  EXODUS_CALL( ex_get_ids( exodusFileId, kObjectTypes[ objectTypeIndex ], &group.objectIds[0] ),
+  EXODUS_CALL( ex_get_ids( exodusFileId,
+    static_cast< ex_entity_type >( kObjectTypes[ objectTypeIndex ] ), &group.objectIds[0] ),
     "Could not read object IDs." );
 
   // Get the names of the instances, if they are named.
   group.objectNames.resize( group.numberOfObjects );
   char* objectNamesCharArray[ group.numberOfObjects ];
   vectorToCharStarArray( group.objectNames, objectNamesCharArray );
-  EXODUS_CALL( ex_get_names( exodusFileId, kObjectTypes[ objectTypeIndex ], objectNamesCharArray ),
+  EXODUS_CALL( ex_get_names( exodusFileId,
+    static_cast< ex_entity_type >( kObjectTypes[ objectTypeIndex ] ), objectNamesCharArray ),
     "Could not read object names." );
 
   // For blocks and sets, get the variable information if there are time series.
@@ -203,9 +218,11 @@ bool readObjectGroupData(
     ( objectIsBlock( objectTypeIndex ) || objectIsSet( objectTypeIndex ) ) ) {
 
     // Get the number of variables for this type of block or set.
+    int numberOfVariables = 0;
     EXODUS_CALL(
-      ex_get_var_param( exodusFileId, kObjectTypeChar[ objectTypeIndex ], &group.numberOfVariables ),
+      ex_get_var_param( exodusFileId, kObjectTypeChar[ objectTypeIndex ], &numberOfVariables ),
       "Could not read number of variables." );
+    group.numberOfVariables = numberOfVariables;
 
     // The truth table gives a 1 or 0 denoting whether or not a particular variable is used
     // for each instance of this object type. For example, if there are 3 element blocks and
@@ -231,6 +248,62 @@ bool readObjectGroupData(
   return true;
 }
 
+// Read one block of a group.
+void readBlock(
+  Block& block,
+  xdm::RefPtr< ReadableExodusFile > file,
+  const ObjectGroupData& group,
+  std::size_t objectInstance,
+  xdm::RefPtr< xdmGrid::Geometry > geom ) {
+
+  block.readFromFile(
+    file,
+    group.objectIds[ objectInstance ],
+    group.objectNames[ objectInstance ].string(),
+    geom,
+    group.variableTruthTable.begin() + objectInstance * group.numberOfVariables,
+    group.numberOfVariables,
+    group.variableNames );
+}
+
+// Read all of the blocks of a group, in the order of the group.
+std::vector< xdm::RefPtr< Block > > readBlocks(
+  xdm::RefPtr< ReadableExodusFile > file,
+  std::size_t objectTypeIndex,
+  const ObjectGroupData& group,
+  xdm::RefPtr< xdmGrid::Geometry > geom ) {
+
+  std::vector< xdm::RefPtr< Block > > blocks( group.numberOfObjects );
+  for ( std::size_t i = 0; i < blocks.size(); ++i ) {
+    blocks[i] = blockFactory( kObjectTypes[ objectTypeIndex ] );
+  }
+
+#ifdef _OPENMP
+  // The blocks are independent, so set them up concurrently. Their calls into the Exodus
+  // library are serialized, so one thread at a time reads from the file while the others
+  // convert connectivity and build topologies and attributes. Exceptions may not propagate
+  // out of an OpenMP region. Record the first one and rethrow it once all threads have
+  // joined.
+  xdm::ParallelErrorCapture error;
+  long numberOfBlocks = static_cast< long >( blocks.size() );
+  #pragma omp parallel for schedule( dynamic ) if ( numberOfBlocks > 1 )
+  for ( long i = 0; i < numberOfBlocks; ++i ) {
+    try {
+      readBlock( *blocks[i], file, group, i, geom );
+    } catch ( ... ) {
+      error.capture();
+    }
+  }
+  error.rethrow();
+#else
+  for ( std::size_t i = 0; i < blocks.size(); ++i ) {
+    readBlock( *blocks[i], file, group, i, geom );
+  }
+#endif
+
+  return blocks;
+}
+
 // Fill an array with increasing ints and turn it into a data item.
 xdm::RefPtr< xdm::UniformDataItem >
 iotaArrayOfSizeT( const std::size_t& size, const std::size_t beginWith = 0 ) {
@@ -248,26 +321,134 @@ iotaArrayOfSizeT( const std::size_t& size, const std::size_t beginWith = 0 ) {
   return returnItem;
 }
 
+// Throw if the time steps [firstStep, endStep) are not all in a file.
+void checkStepRange( const ReadableExodusFile& file, std::size_t firstStep, std::size_t endStep ) {
+  if ( firstStep > endStep || endStep > file.numberOfTimeSteps() ) {
+    std::ostringstream message;
+    message << "The time steps [" << firstStep << ", " << endStep << ") are not in the "
+      << file.numberOfTimeSteps() << " steps of " << file.path().pathString();
+    throw std::runtime_error( message.str() );
+  }
+}
+
+// Get the number of entries in the blocks or sets of a type that precede an object in the file.
+// Exodus numbers the entries of all of the blocks (or sets) of a type consecutively when
+// reading the history of a single entry.
+std::size_t entryOffsetOfObject( int exodusFileId, int exodusObjectType, int objectId ) {
+  const int* typeIterator = std::find(
+    kObjectTypes, kObjectTypes + kNumberOfObjectTypes, exodusObjectType );
+  const std::size_t objectTypeIndex = typeIterator - kObjectTypes;
+  if ( objectTypeIndex == kNumberOfObjectTypes ) {
+    // Nodal and global variables are numbered directly.
+    return 0;
+  }
+
+  int numberOfObjects = 0;
+  EXODUS_CALL(
+    ex_inquire( exodusFileId, kInquireObjectSizes[ objectTypeIndex ], &numberOfObjects, 0, 0 ),
+    "The number of objects could not be determined." );
+  if ( numberOfObjects < 1 ) {
+    return 0;
+  }
+  std::vector< int > objectIds( numberOfObjects );
+  EXODUS_CALL(
+    ex_get_ids( exodusFileId, static_cast< ex_entity_type >( exodusObjectType ), &objectIds[0] ),
+    "Could not read object IDs." );
+
+  std::size_t offset = 0;
+  for ( std::vector< int >::const_iterator id = objectIds.begin();
+    id != objectIds.end() && *id != objectId; ++id ) {
+    int numberOfEntries = 0;
+    if ( objectIsBlock( objectTypeIndex ) ) {
+      EXODUS_CALL(
+        ex_get_block( exodusFileId, static_cast< ex_entity_type >( exodusObjectType ), *id,
+          0, &numberOfEntries, 0, 0, 0, 0 ),
+        "Could not read block parameters." );
+    } else {
+      int numberOfDistributionFactors = 0;
+      EXODUS_CALL(
+        ex_get_set_param( exodusFileId, static_cast< ex_entity_type >( exodusObjectType ), *id,
+          &numberOfEntries, &numberOfDistributionFactors ),
+        "Could not read set parameters." );
+    }
+    offset += numberOfEntries;
+  }
+  return offset;
+}
+
 } // anon namespace
 
-ExodusReader::ExodusReader() {
+const std::size_t ExodusReader::kDefaultOpenFileLimit;
+
+ExodusReader::ExodusReader() :
+  mOpenFileLimit( kDefaultOpenFileLimit ),
+  mCoordinateLayout( kSeparateCoordinates ),
+  mOpenFiles(),
+  mRegistry() {
 }
 
 ExodusReader::~ExodusReader() {
 }
 
+void ExodusReader::setOpenFileLimit( std::size_t limit ) {
+  mOpenFileLimit = limit;
+  while ( mOpenFiles.size() > mOpenFileLimit ) {
+    mOpenFiles.pop_back();
+  }
+}
+
+std::size_t ExodusReader::openFileLimit() const {
+  return mOpenFileLimit;
+}
+
+void ExodusReader::setCoordinateLayout( CoordinateLayout layout ) {
+  mCoordinateLayout = layout;
+}
+
+ExodusReader::CoordinateLayout ExodusReader::coordinateLayout() const {
+  return mCoordinateLayout;
+}
+
+void ExodusReader::closeFiles() {
+  mOpenFiles.clear();
+  // The objects of the last tree keep its file open.
+  mRegistry.clear();
+}
+
+xdm::RefPtr< ReadableExodusFile > ExodusReader::openFile(
+  const xdm::FileSystemPath& path ) const {
+
+  for ( OpenFileList::iterator file = mOpenFiles.begin(); file != mOpenFiles.end(); ++file ) {
+    if ( (*file)->path().pathString() == path.pathString() ) {
+      // Move the file to the front of the list.
+      xdm::RefPtr< ReadableExodusFile > result = *file;
+      mOpenFiles.erase( file );
+      mOpenFiles.push_front( result );
+      return result;
+    }
+  }
+
+  xdm::RefPtr< ReadableExodusFile > result( new ReadableExodusFile( path ) );
+  if ( mOpenFileLimit > 0 ) {
+    mOpenFiles.push_front( result );
+    // Close the least recently used files.
+    while ( mOpenFiles.size() > mOpenFileLimit ) {
+      mOpenFiles.pop_back();
+    }
+  }
+  return result;
+}
+
 xdm::RefPtr< xdm::Item > ExodusReader::readItem( const xdm::FileSystemPath& path ) {
 
-  // Open the file and get some info.
-  ReadableExodusFile file( path );
-  int fileId = file.id();
+  // Open the file and get some info. The file stays open for later updates.
+  xdm::RefPtr< ReadableExodusFile > file = openFile( path );
+  int fileId = file->id();
 
   // Get the mesh parameters and time steps.
   ex_init_params gridParameters;
   EXODUS_CALL( ex_get_init_ext( fileId, &gridParameters ), "Unable to read Exodus file parameters." );
-  int numberOfTimeSteps = 0;
-  EXODUS_CALL( ex_inquire( fileId, EX_INQ_TIME, &numberOfTimeSteps, 0, 0 ), "Unable to read"
-    " number of time steps." );
+  std::size_t numberOfTimeSteps = file->numberOfTimeSteps();
 
   // The Item returned is an xdmGrid::Domain.
   xdm::RefPtr< xdmGrid::Domain > domain( new xdmGrid::Domain );
@@ -276,12 +457,17 @@ xdm::RefPtr< xdm::Item > ExodusReader::readItem( const xdm::FileSystemPath& path
 
   // The sets and maps refer to internal ordering of nodes, edges, faces, and elements. We
   // need to make a superset for each of these object types. Then, the sets and maps will
-  // refer to their respective supersets.
+  // refer to their respective supersets, which are keyed by Exodus object type. The blocks
+  // of each type are held by the collection that is their superset.
   xdm::RefPtr< xdmGrid::UniformGrid > globalNodeSet( new xdmGrid::UniformGrid );
-  std::vector< xdm::RefPtr< xdmGrid::ReferencingGrid > > globalSets( kNumberOfObjectTypes );
-  globalSets[ EX_EDGE_BLOCK ] = xdm::makeRefPtr( new xdmGrid::ReferencingGrid );
-  globalSets[ EX_FACE_BLOCK ] = xdm::makeRefPtr( new xdmGrid::ReferencingGrid );
-  globalSets[ EX_ELEM_BLOCK ] = xdm::makeRefPtr( new xdmGrid::ReferencingGrid );
+  globalNodeSet->setName( "nodes" );
+  std::map< int, xdm::RefPtr< xdmGrid::CollectionGrid > > globalSets;
+  globalSets[ EX_EDGE_BLOCK ] = xdm::makeRefPtr( new xdmGrid::CollectionGrid );
+  globalSets[ EX_FACE_BLOCK ] = xdm::makeRefPtr( new xdmGrid::CollectionGrid );
+  globalSets[ EX_ELEM_BLOCK ] = xdm::makeRefPtr( new xdmGrid::CollectionGrid );
+  globalSets[ EX_EDGE_BLOCK ]->setName( "edgeBlocks" );
+  globalSets[ EX_FACE_BLOCK ]->setName( "faceBlocks" );
+  globalSets[ EX_ELEM_BLOCK ]->setName( "elementBlocks" );
   globalSets[ EX_EDGE_SET ] = globalSets[ EX_EDGE_BLOCK ];
   globalSets[ EX_FACE_SET ] = globalSets[ EX_FACE_BLOCK ];
   globalSets[ EX_SIDE_SET ] = globalSets[ EX_ELEM_BLOCK ];
@@ -290,18 +476,21 @@ xdm::RefPtr< xdm::Item > ExodusReader::readItem( const xdm::FileSystemPath& path
   globalSets[ EX_FACE_MAP ] = globalSets[ EX_FACE_BLOCK ];
   globalSets[ EX_ELEM_MAP ] = globalSets[ EX_ELEM_BLOCK ];
 
-  spatialCollection->appendChild( globalNodeSet );
-  spatialCollection->appendChild( globalSets[ EX_EDGE_BLOCK ] );
-  spatialCollection->appendChild( globalSets[ EX_FACE_BLOCK ] );
-  spatialCollection->appendChild( globalSets[ EX_ELEM_BLOCK ] );
+  spatialCollection->appendGrid( globalNodeSet );
+
+  // The sets only refer to the nodes and entries of the spatial collection, so they are kept
+  // out of it, where they would be counted as elements again.
+  xdm::RefPtr< xdmGrid::CollectionGrid > setCollection( new xdmGrid::CollectionGrid );
+  setCollection->setName( "sets" );
+  bool hasSets = false;
 
   //---------------NODES-------------------
-  xdm::RefPtr< xdmGrid::Geometry > geom = readGeometry( fileId, gridParameters );
+  xdm::RefPtr< xdmGrid::Geometry > geom = readGeometry( fileId, gridParameters, mCoordinateLayout );
   xdm::RefPtr< xdm::UniformDataItem > nodeConn = iotaArrayOfSizeT( geom->numberOfNodes() );
   xdm::RefPtr< xdmGrid::UnstructuredTopology > nodeTopo( new xdmGrid::UnstructuredTopology );
   nodeTopo->setConnectivity( nodeConn );
   nodeTopo->setNumberOfElements( geom->numberOfNodes() );
-//  nodeTopo->setElementType( xdmGrid::ElementType::Polyvertex );
+  nodeTopo->setElementTopology( xdmGrid::elementFactory( xdmGrid::ElementShape::Vertex, 1 ) );
   globalNodeSet->setGeometry( geom );
   globalNodeSet->setTopology( nodeTopo );
 
@@ -317,77 +506,45 @@ xdm::RefPtr< xdm::Item > ExodusReader::readItem( const xdm::FileSystemPath& path
     // (nodes, edges, faces, elements), or maps. They all contain integer arrays. These arrays
     // represent the connectivity info in the case of blocks, the collection info in the case
     // of sets, or the ordering info for edges/faces/elements in the case of maps.
+    std::vector< xdm::RefPtr< Block > > blocks;
+    if ( objectIsBlock( objectTypeIndex ) ) {
+      blocks = readBlocks( file, objectTypeIndex, group, geom );
+      spatialCollection->appendGrid( globalSets[ kObjectTypes[ objectTypeIndex ] ] );
+    }
+
     std::size_t globalOffset = 0;
     for ( std::size_t objectInstance = 0; objectInstance < group.numberOfObjects; ++objectInstance ) {
 
       if ( objectIsBlock( objectTypeIndex ) ) {
 
-        xdm::RefPtr< Block > block = blockFactory( kObjectTypes[ objectTypeIndex ] );
-        block->readFromFile(
-          fileId,
-          group.objectIds[ objectInstance ],
-          group.objectNames[ objectInstance ].string(),
-          geom,
-          group.variableTruthTable.begin() + objectInstance * group.numberOfVariables,
-          group.numberOfVariables,
-          group.variableNames );
-
+        // The blocks were read above.
+        const xdm::RefPtr< Block >& block = blocks[ objectInstance ];
         block->setEntryGlobalOffset( globalOffset );
         globalOffset += block->numberOfEntries();
 
-        spatialCollection->appendChild( block );
-
-        globalSets[ objectTypeIndex ]->appendReferenceGrid( block );
+        globalSets[ kObjectTypes[ objectTypeIndex ] ]->appendGrid( block );
 
       } else if ( objectIsSet( objectTypeIndex ) ) {
 
-        // Since there can only be one distribution factor per entry, this number can be either
-        // zero or numberOfEntries.
-        int numberOfEntries = 0;
-        int numberOfDistributionFactors;
-        EXODUS_CALL(
-          ex_get_set_param(
-            fileId,
-            kObjectTypes[ objectTypeIndex ],
-            group.objectIds[ objectInstance ],
-            &numberOfEntries,
-            &numberOfDistributionFactors ),
-          "Could not read set parameters." );
-
-        std::vector< int > setEntries( numberOfEntries );
-        // setExtra contains an int for each entry. The use of this int is only specified for
-        // side sets, where the entry refers to the particular element and the extra int refers
-        // to a specific side in that element. However, edge and face sets can also use this
-        // extra int to specify things like direction (-1/+1).
-        std::vector< int > setExtra;
-        int* extraPtr = 0;
-        if ( kObjectTypes[ objectTypeIndex ] != EX_NODE_SET &&
-             kObjectTypes[ objectTypeIndex ] != EX_ELEM_SET ) {
-          setExtra.resize( numberOfEntries );
-          extraPtr = &setExtra[0];
-        }
-        EXODUS_CALL(
-          ex_get_set(
-            fileId,
-            kObjectTypes[ objectTypeIndex ],
-            group.objectIds[ objectInstance ],
-            &setEntries[0],
-            extraPtr ),
-          "Could not read set." );
-
-        // TODO: We need an XDM grid that holds a set, probably an XDMF SubSet Grid, which
-        // we don't have yet.
-
-        if ( numberOfDistributionFactors > 0 ) {
-          std::vector< double > distributionFactors( numberOfDistributionFactors );
-          EXODUS_CALL(
-            ex_get_set_dist_fact(
-              fileId,
-              kObjectTypes[ objectTypeIndex ],
-              group.objectIds[ objectInstance ] ),
-            "Could not read set distribution factors." );
+        // Only the size of the set is read here. Its entries, flags, and distribution
+        // factors are read when they are first requested.
+        xdm::RefPtr< Set > set = setFactory( kObjectTypes[ objectTypeIndex ] );
+        set->readFromFile(
+          file,
+          group.objectIds[ objectInstance ],
+          group.objectNames[ objectInstance ].string(),
+          group.variableTruthTable.begin() + objectInstance * group.numberOfVariables,
+          group.numberOfVariables,
+          group.variableNames );
+        if ( kObjectTypes[ objectTypeIndex ] == EX_NODE_SET ) {
+          set->setReferencedGrid( globalNodeSet );
+        } else {
+          set->setReferencedGrid( globalSets[ kObjectTypes[ objectTypeIndex ] ] );
         }
 
+        setCollection->appendGrid( set );
+        hasSets = true;
+
       } else if ( objectIsMap( objectTypeIndex ) ) {
 
         int numberOfEntries = 0;
@@ -406,36 +563,144 @@ xdm::RefPtr< xdm::Item > ExodusReader::readItem( const xdm::FileSystemPath& path
             break;
         }
         if ( numberOfEntries > 0 ) {
-          std::vector< int > map( numberOfEntries );
-          EXODUS_CALL(
-            ex_get_num_map(
-              fileId,
-              kObjectTypes[ objectTypeIndex ],
-              group.objectIds[ objectInstance ],
-              &map[0] ),
-            "Could not read map." );
+          // The map holds the global ids of all of the nodes or entries of its type, so it
+          // is an attribute of the grid that holds them. It is read when first requested.
+          xdm::RefPtr< Map > map = mapFactory( kObjectTypes[ objectTypeIndex ] );
+          map->readFromFile(
+            file,
+            group.objectIds[ objectInstance ],
+            group.objectNames[ objectInstance ].string(),
+            numberOfEntries );
+          if ( kObjectTypes[ objectTypeIndex ] == EX_NODE_MAP ) {
+            globalNodeSet->addAttribute( map );
+          } else {
+            globalSets[ kObjectTypes[ objectTypeIndex ] ]->addAttribute( map );
+          }
         }
-
-        // TODO: We need an XDM grid that holds a map, probably an XDMF SubSet Grid, which
-        // we don't have yet. This is even worse than sets, because these maps use Exodus
-        // internal node numbering, and we do not have a way to store that info. Maybe create
-        // a special Topology that holds a ref impl class that can point to elements/faces/edges
-        // that exist in any of the other topologies.
       }
 
     } // object Index
   } // objectTypeIndex
 
+  if ( hasSets ) {
+    domain->addGrid( setCollection );
+  }
+
+  // Gather the objects now so that the updates of the tree go straight to them.
+  mRegistry.gather( domain );
   return domain;
 }
 
 std::size_t ExodusReader::numberOfTimeSteps( const xdm::FileSystemPath& path ) const {
-  ReadableExodusFile file( path );
-  int exodusFileId = file.id();
-  int numberOfTimeSteps = 0;
-  EXODUS_CALL( ex_inquire( exodusFileId, EX_INQ_TIME, &numberOfTimeSteps, 0, 0 ), "Unable to read"
-    " number of time steps." );
-  return numberOfTimeSteps;
+  return openFile( path )->numberOfTimeSteps();
+}
+
+std::size_t ExodusReader::numberOfNodes( const xdm::FileSystemPath& path ) const {
+  return inquireCount( openFile( path )->id(), EX_INQ_NODES );
+}
+
+unsigned int ExodusReader::dimension( const xdm::FileSystemPath& path ) const {
+  return inquireCount( openFile( path )->id(), EX_INQ_DIM );
+}
+
+void ExodusReader::readCoordinates(
+  const xdm::FileSystemPath& path,
+  std::size_t firstNode,
+  std::size_t numberOfNodes,
+  double* x,
+  double* y,
+  double* z ) const {
+
+  xdm::RefPtr< ReadableExodusFile > file = openFile( path );
+  checkNodeRange( *file, firstNode, numberOfNodes );
+  readCoordinateArrays( file->id(), firstNode, numberOfNodes, x, y, z );
+}
+
+void ExodusReader::readInterlacedCoordinates(
+  const xdm::FileSystemPath& path,
+  std::size_t firstNode,
+  std::size_t numberOfNodes,
+  double* xyz ) const {
+
+  xdm::RefPtr< ReadableExodusFile > file = openFile( path );
+  checkNodeRange( *file, firstNode, numberOfNodes );
+  readInterlacedCoordinateArray(
+    file->id(), inquireCount( file->id(), EX_INQ_DIM ), firstNode, numberOfNodes, xyz );
+}
+
+std::vector< double > ExodusReader::readVariableHistory(
+  const xdm::FileSystemPath& path,
+  int exodusObjectType,
+  int variableIndex,
+  int objectId,
+  std::size_t entry,
+  std::size_t firstStep,
+  std::size_t endStep ) const {
+
+  xdm::RefPtr< ReadableExodusFile > file = openFile( path );
+  checkStepRange( *file, firstStep, endStep );
+
+  std::vector< double > history( endStep - firstStep );
+  if ( history.empty() ) {
+    return history;
+  }
+
+  // Exodus entry numbers and time steps start at 1.
+  const std::size_t entryNumber =
+    entryOffsetOfObject( file->id(), exodusObjectType, objectId ) + entry + 1;
+  EXODUS_CALL(
+    ex_get_var_time(
+      file->id(),
+      static_cast< ex_entity_type >( exodusObjectType ),
+      variableIndex,
+      (int)entryNumber,
+      (int)( firstStep + 1 ),
+      (int)endStep,
+      &history[0] ),
+    "Could not read the variable history." );
+  return history;
+}
+
+std::vector< double > ExodusReader::readVariableHistories(
+  const xdm::FileSystemPath& path,
+  int exodusObjectType,
+  int variableIndex,
+  int objectId,
+  const std::vector< std::size_t >& entries,
+  std::size_t firstStep,
+  std::size_t endStep ) const {
+
+  xdm::RefPtr< ReadableExodusFile > file = openFile( path );
+  checkStepRange( *file, firstStep, endStep );
+
+  const std::size_t numberOfSteps = endStep - firstStep;
+  std::vector< double > histories( entries.size() * numberOfSteps );
+  if ( histories.empty() ) {
+    return histories;
+  }
+
+  // Read the part of the block that covers every entry once per step and pick the entries
+  // out of it, rather than reading each entry through time separately.
+  const std::size_t firstEntry = *std::min_element( entries.begin(), entries.end() );
+  const std::size_t endEntry = *std::max_element( entries.begin(), entries.end() ) + 1;
+  std::vector< double > values( endEntry - firstEntry );
+  for ( std::size_t step = 0; step < numberOfSteps; ++step ) {
+    EXODUS_CALL(
+      ex_get_n_var(
+        file->id(),
+        (int)( firstStep + step + 1 ),
+        static_cast< ex_entity_type >( exodusObjectType ),
+        variableIndex,
+        objectId,
+        (int)( firstEntry + 1 ),
+        (int)values.size(),
+        &values[0] ),
+      "Could not read variable values." );
+    for ( std::size_t i = 0; i < entries.size(); ++i ) {
+      histories[ i * numberOfSteps + step ] = values[ entries[i] - firstEntry ];
+    }
+  }
+  return histories;
 }
 
 bool ExodusReader::update(
@@ -444,30 +709,39 @@ bool ExodusReader::update(
   std::size_t timeStep ) {
 
   // First make sure we have enough time steps to process the update.
-  if ( timeStep >= numberOfTimeSteps( path ) ) {
+  xdm::RefPtr< ReadableExodusFile > file = openFile( path );
+  if ( timeStep >= file->numberOfTimeSteps() ) {
     return false;
   }
 
-  // Open the Exodus file.
-  ReadableExodusFile file( path );
-  int exodusFileId = file.id();
-
   // Get the time at this step so that we can attach it to the grids.
-  double timeAtThisStep = 0.0;
-  EXODUS_CALL( ex_get_time( exodusFileId, (int)( timeStep + 1 ), &timeAtThisStep ),
-    "Could not read time step." );
   xdm::RefPtr< xdmGrid::Time > time( new xdmGrid::Time );
-  time->setValue( timeAtThisStep );
+  time->setValue( file->timeValue( timeStep ) );
+
+  // A tree that was not read or updated last is searched for its objects once.
+  if ( mRegistry.root() != item ) {
+    mRegistry.gather( item );
+  }
 
-  // Attach the time to anything that is an xdmGrid::Grid.
-  UpdateTimeVisitor gridVisitor( time );
-  item->traverse( gridVisitor );
+  // Attach the time to every grid.
+  const std::vector< xdmGrid::Grid* >& grids = mRegistry.grids();
+  for ( std::vector< xdmGrid::Grid* >::const_iterator grid = grids.begin();
+    grid != grids.end(); ++grid ) {
+    (*grid)->setTime( time );
+  }
 
-  // Read the variables at this time step.
-  UpdateVariableVisitor varVisitor( exodusFileId, timeStep );
-  item->traverse( varVisitor );
+  // Select this time step for the variables. Their values are read when they are used.
+  bool somethingWasUpdated = false;
+  const std::vector< Object* >& objects = mRegistry.objects();
+  for ( std::vector< Object* >::const_iterator object = objects.begin();
+    object != objects.end(); ++object ) {
+    if ( (*object)->numberOfVariables() > 0 ) {
+      (*object)->readTimeStep( file, timeStep );
+      somethingWasUpdated = true;
+    }
+  }
 
-  return varVisitor.somethingWasUpdated();
+  return somethingWasUpdated;
 }
 
 
@@ -21,20 +21,78 @@
 #ifndef xdmExodus_Reader_hpp
 #define xdmExodus_Reader_hpp
 
+#include <xdmExodus/ObjectRegistry.hpp>
+
 #include <xdmFormat/Reader.hpp>
 
+#include <xdm/RefPtr.hpp>
 
+#include <list>
+#include <vector>
 
 namespace xdmExodus {
 
+class ReadableExodusFile;
+
 /// Class for reading an ExodusII file. Uses the ExodusII library functions to read
 /// an unstructured grid from an ExodusII file complete with nodes and element blocks
 /// for now.
+///
+/// The reader keeps the files it reads open between calls, so that stepping an item tree
+/// through time with update() costs only the variable reads. The number of time steps and
+/// their time values are read once, when a file is opened. A small number of files are
+/// held open, and the least recently used file is closed when another one is opened.
+/// Time steps appended to a file while it is held open are not seen until closeFiles()
+/// is called.
+///
+/// The values of Exodus attributes, variables, sets, and number maps are read when they are
+/// first requested, and variables are read again only when requested after update() selects
+/// another step. Items keep a reference to the file they read from, so a file stays open
+/// until both the reader and the items read from it have released it.
+///
+/// The blocks, sets, and grids of the last tree read or updated are kept in an
+/// ObjectRegistry, so a step goes straight to the variables and grids it changes instead of
+/// searching the tree. The reader holds that tree until another one is read or updated, or
+/// closeFiles() is called.
+///
+/// With OpenMP support (XDM_OPENMP), the blocks of a file are set up concurrently. The
+/// Exodus library is not thread safe, so its calls are serialized and only the conversion
+/// and construction of the blocks runs in parallel.
 class ExodusReader {
 public:
   ExodusReader();
   virtual ~ExodusReader();
 
+  /// The layouts the node coordinates of a file can be read into.
+  enum CoordinateLayout {
+    /// One array per dimension, held by an xdmGrid::MultiArrayGeometry. This is how the
+    /// coordinates are stored in the file.
+    kSeparateCoordinates,
+    /// A single array holding the coordinates of each node together, held by an
+    /// xdmGrid::InterlacedGeometry.
+    kInterlacedCoordinates
+  };
+
+  /// The default maximum number of files held open by a reader.
+  static const std::size_t kDefaultOpenFileLimit = 4;
+
+  /// Set the maximum number of files held open between calls. A limit of zero closes
+  /// every file before the call that opened it returns.
+  void setOpenFileLimit( std::size_t limit );
+  /// Get the maximum number of files held open between calls.
+  std::size_t openFileLimit() const;
+
+  /// Set the layout of the geometry built by readItem. The default is kSeparateCoordinates.
+  /// Interlaced coordinates are converted a chunk of nodes at a time as they are read, so
+  /// the mesh is never held in both layouts.
+  void setCoordinateLayout( CoordinateLayout layout );
+  /// Get the layout of the geometry built by readItem.
+  CoordinateLayout coordinateLayout() const;
+
+  /// Release all of the files held open by the reader, along with the last tree read or
+  /// updated. A file is closed once no item read from it remains.
+  void closeFiles();
+
   /// Read a complete ExodusII file.
   /// ExodusII files are structured around a single invariant geometry with invariant topologies.
   /// If the geometry or topology must change, then additional ExodusII files are necessary. In
@@ -44,8 +102,11 @@ public:
   /// an xdmGrid::Attribute.
   ///
   /// This reader creates a Domain with a single spatial CollectionGrid underneath that contains
-  /// all of the Exodus blocks, sets, and maps. If there is dynamic information (variables) then
-  /// readItem will set up these variables, but a call to update() is needed to read a time step.
+  /// all of the Exodus blocks and maps. The Exodus sets refer to the nodes and entries of the
+  /// spatial collection rather than adding elements of their own, so they are held by a
+  /// second CollectionGrid of the Domain, named "sets", which is only present if the file has
+  /// sets. If there is dynamic information (variables) then readItem will set up these
+  /// variables, but a call to update() is needed to read a time step.
   ///
   /// The example below shows a result that might be obtained when reading a thermal mesh.
   ///
@@ -64,6 +125,9 @@ public:
   ///       Topology (one block)
   ///       Attribute (variable 1 for each element)
   ///          ...
+  ///   CollectionGrid (the sets)
+  ///     Set (refers to the nodes or to one of the collections of blocks)
+  ///          ...
   /// @return an xdmGrid::Domain
   virtual xdm::RefPtr< xdm::Item > readItem( const xdm::FileSystemPath& path );
 
@@ -79,6 +143,89 @@ public:
   /// Get the number of time steps in the ExodusII file.
   std::size_t numberOfTimeSteps( const xdm::FileSystemPath& path ) const;
 
+  /// Get the number of nodes in the ExodusII file.
+  std::size_t numberOfNodes( const xdm::FileSystemPath& path ) const;
+
+  /// Get the number of coordinates of each node in the ExodusII file.
+  unsigned int dimension( const xdm::FileSystemPath& path ) const;
+
+  /// Read the coordinates of a range of nodes into arrays provided by the caller, one per
+  /// dimension, without building an item tree. A large mesh can be read a range at a time
+  /// to bound the memory used.
+  /// @param path The ExodusII file.
+  /// @param firstNode The zero-based index of the first node to read.
+  /// @param numberOfNodes The number of nodes to read.
+  /// @param x, y, z Arrays with room for numberOfNodes values, or null to skip a dimension.
+  /// @throws std::runtime_error if the nodes are not in the file.
+  void readCoordinates(
+    const xdm::FileSystemPath& path,
+    std::size_t firstNode,
+    std::size_t numberOfNodes,
+    double* x,
+    double* y,
+    double* z ) const;
+
+  /// Read the coordinates of a range of nodes interlaced into an array provided by the
+  /// caller. The coordinates are converted kCoordinateChunkSize nodes at a time, so only a
+  /// small scratch buffer is used besides the caller's array.
+  /// @param xyz An array with room for numberOfNodes * dimension( path ) values.
+  /// @see readCoordinates
+  void readInterlacedCoordinates(
+    const xdm::FileSystemPath& path,
+    std::size_t firstNode,
+    std::size_t numberOfNodes,
+    double* xyz ) const;
+
+  /// Read the values of a variable on a single entry of a block or set over a range of time
+  /// steps, without building an item tree. The whole history is read in one call to the
+  /// Exodus library.
+  /// @param path The ExodusII file.
+  /// @param exodusObjectType The Exodus type of the object (EX_ELEM_BLOCK, EX_NODAL, ...).
+  /// @param variableIndex The one-based Exodus index of the variable, as used by Variable.
+  /// @param objectId The Exodus id of the block or set. Ignored for nodal and global variables.
+  /// @param entry The zero-based index of the entry in the block or set, or the node index for
+  ///        nodal variables.
+  /// @param firstStep The first time step to read.
+  /// @param endStep One past the last time step to read.
+  /// @return The value of the variable at each time step in [firstStep, endStep).
+  /// @throws std::runtime_error if the steps are not in the file or the values could not be read.
+  std::vector< double > readVariableHistory(
+    const xdm::FileSystemPath& path,
+    int exodusObjectType,
+    int variableIndex,
+    int objectId,
+    std::size_t entry,
+    std::size_t firstStep,
+    std::size_t endStep ) const;
+
+  /// Read the values of a variable on many entries of a single block or set over a range of
+  /// time steps. Each time step is read once for the range of the block covering all of the
+  /// entries, so probing many entries of a block costs one pass over the steps rather than one
+  /// per entry.
+  /// @param entries The zero-based indices of the entries in the block or set.
+  /// @return The histories of the entries, in the order of the entries, each holding
+  ///         endStep - firstStep values.
+  /// @see readVariableHistory
+  std::vector< double > readVariableHistories(
+    const xdm::FileSystemPath& path,
+    int exodusObjectType,
+    int variableIndex,
+    int objectId,
+    const std::vector< std::size_t >& entries,
+    std::size_t firstStep,
+    std::size_t endStep ) const;
+
+private:
+  /// Get the open file at a path, opening it if it is not already held open.
+  xdm::RefPtr< ReadableExodusFile > openFile( const xdm::FileSystemPath& path ) const;
+
+  std::size_t mOpenFileLimit;
+  CoordinateLayout mCoordinateLayout;
+  // The files held open, most recently used first.
+  typedef std::list< xdm::RefPtr< ReadableExodusFile > > OpenFileList;
+  mutable OpenFileList mOpenFiles;
+  // The objects of the last tree read or updated.
+  ObjectRegistry mRegistry;
 };
 
 } // namespace xdmExodus
@@ -19,13 +19,79 @@
 //
 //------------------------------------------------------------------------------
 #include <xdmExodus/Sets.hpp>
+#include <xdmExodus/ExodusData.hpp>
 #include <xdmExodus/Helpers.hpp>
+#include <xdmExodus/ReadableExodusFile.hpp>
 #include <xdmExodus/Variable.hpp>
 
+#include <xdmGrid/Attribute.hpp>
+#include <xdmGrid/Element.hpp>
+
+#include <xdm/UniformDataItem.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
 namespace xdmExodus {
 
+Set::Set() :
+  mNumberOfEntries( 0 ),
+  mReferencedGrid(),
+  mEntries(),
+  mDistributionFactors(),
+  mExtraFlags(),
+  mEntryRanges(),
+  mHasEntryRanges( false ) {
+}
+
 std::size_t Set::numberOfEntries() const {
-  return numberOfElements();
+  return mNumberOfEntries;
+}
+
+void Set::setReferencedGrid( xdm::RefPtr< xdmGrid::Grid > grid ) {
+  mReferencedGrid = grid;
+}
+
+xdm::RefPtr< xdmGrid::Grid > Set::referencedGrid() const {
+  return mReferencedGrid;
+}
+
+xdm::RefPtr< xdmGrid::Attribute > Set::createAttribute(
+  xdmGrid::Attribute::Center center,
+  xdmGrid::Attribute::Type type,
+  const std::string& name,
+  xdm::primitiveType::Value dataType ) {
+
+  xdm::DataShape<> attributeSpace;
+  attributeSpace.push_back( mNumberOfEntries );
+  switch ( type ) {
+    case xdmGrid::Attribute::kScalar:
+      break;
+    case xdmGrid::Attribute::kVector:
+      attributeSpace.push_back( 3 );
+      break;
+    default:
+      throw std::runtime_error( "Only scalar and vector set attributes are supported." );
+  }
+
+  xdm::RefPtr< xdmGrid::Attribute > attribute( new xdmGrid::Attribute( type, center ) );
+  attribute->setName( name );
+  attribute->setDataItem(
+    xdm::makeRefPtr( new xdm::UniformDataItem( dataType, attributeSpace ) ) );
+  addAttribute( attribute );
+  return attribute;
+}
+
+std::size_t Set::numberOfElements() const {
+  return mNumberOfEntries;
+}
+
+xdmGrid::Element Set::element( const std::size_t& elementIndex ) const {
+  if ( ! mReferencedGrid || ! mEntries ) {
+    throw std::runtime_error( "The Exodus set does not refer to a grid." );
+  }
+  return mReferencedGrid->element( mEntries->typedArray< int >()->begin()[ elementIndex ] );
 }
 
 void Set::addVariable( xdm::RefPtr< Variable > variable ) {
@@ -33,10 +99,126 @@ void Set::addVariable( xdm::RefPtr< Variable > variable ) {
   addAttribute( variable );
 }
 
+void Set::readFromFile(
+  xdm::RefPtr< ReadableExodusFile > file,
+  int exodusObjectId,
+  std::string name,
+  std::vector< int >::const_iterator beginTruthTable,
+  const std::size_t numberOfVariables,
+  const std::vector< ExodusString >& variableNames ) {
+
+  setId( exodusObjectId );
+  setName( name );
+
+  // Since there can only be one distribution factor per entry, this number can be either
+  // zero or numberOfEntries.
+  int numberOfEntries = 0;
+  int numberOfDistributionFactors = 0;
+  // Exceptions may not leave a critical section, so the status is checked after it.
+  int status;
+#ifdef _OPENMP
+  #pragma omp critical( xdmExodus_library )
+#endif
+  status = ex_get_set_param(
+    file->id(),
+    static_cast< ex_entity_type >( exodusObjectType() ),
+    id(),
+    &numberOfEntries,
+    &numberOfDistributionFactors );
+  EXODUS_CALL( status, "Could not read set parameters." );
+  mNumberOfEntries = numberOfEntries;
+  mEntryRanges.clear();
+  mHasEntryRanges = false;
+
+  mEntries = new xdm::UniformDataItem(
+    xdm::primitiveType::kInt, xdm::makeShape( mNumberOfEntries ) );
+  mEntries->setData( xdm::makeRefPtr(
+    new SetEntryData( file, exodusObjectType(), id(), mNumberOfEntries, false ) ) );
+
+  // The extra int of each entry is only specified for side sets, where it refers to a
+  // specific side of the element. However, edge and face sets can also use it to specify
+  // things like direction (-1/+1).
+  mExtraFlags.reset();
+  if ( exodusObjectType() != EX_NODE_SET && exodusObjectType() != EX_ELEM_SET ) {
+    mExtraFlags = new xdm::UniformDataItem(
+      xdm::primitiveType::kInt, xdm::makeShape( mNumberOfEntries ) );
+    mExtraFlags->setData( xdm::makeRefPtr(
+      new SetEntryData( file, exodusObjectType(), id(), mNumberOfEntries, true ) ) );
+  }
+
+  mDistributionFactors.reset();
+  if ( numberOfDistributionFactors > 0 ) {
+    mDistributionFactors = new xdm::UniformDataItem(
+      xdm::primitiveType::kDouble, xdm::makeShape( numberOfDistributionFactors ) );
+    mDistributionFactors->setData( xdm::makeRefPtr( new DistributionFactorData(
+      file, exodusObjectType(), id(), numberOfDistributionFactors ) ) );
+  }
+
+  // Read the results variables. For XDM, these will just be additional attributes.
+  if ( numberOfVariables > 0 ) {
+    setupVariables( beginTruthTable, numberOfVariables, variableNames );
+    readTimeStep( file, 0 );
+  }
+}
+
 void Set::writeToFile( int exodusFileId, int* variableTruthTable ) {
 
 }
 
+xdm::RefPtr< xdm::UniformDataItem > Set::entries() {
+  return mEntries;
+}
+
+bool Set::contains( std::size_t entry ) {
+  if ( ! mHasEntryRanges ) {
+    if ( mEntries && mNumberOfEntries > 0 ) {
+      // Entries read from the file only to build the runs are released again afterwards.
+      xdm::RefPtr< SetEntryData > data =
+        xdm::dynamic_pointer_cast< SetEntryData >( mEntries->data() );
+      const bool releaseEntries = data && data->file() && ! data->isLoaded();
+
+      // Collect the runs in the order of the entries, then sort the runs and merge them.
+      const int* values = mEntries->typedArray< int >()->begin();
+      for ( std::size_t i = 0; i < mNumberOfEntries; ++i ) {
+        const std::size_t index = values[i];
+        if ( ! mEntryRanges.empty() && index == mEntryRanges.back().second ) {
+          ++mEntryRanges.back().second;
+        } else {
+          mEntryRanges.push_back( EntryRange( index, index + 1 ) );
+        }
+      }
+      std::sort( mEntryRanges.begin(), mEntryRanges.end() );
+      std::vector< EntryRange >::iterator merged = mEntryRanges.begin();
+      for ( std::vector< EntryRange >::const_iterator range = mEntryRanges.begin() + 1;
+        range != mEntryRanges.end(); ++range ) {
+        if ( range->first <= merged->second ) {
+          merged->second = std::max( merged->second, range->second );
+        } else {
+          *++merged = *range;
+        }
+      }
+      mEntryRanges.erase( merged + 1, mEntryRanges.end() );
+      std::vector< EntryRange >( mEntryRanges ).swap( mEntryRanges );
+
+      if ( releaseEntries ) {
+        data->release();
+      }
+    }
+    mHasEntryRanges = true;
+  }
+
+  // Find the last run that begins at or before the entry.
+  std::vector< EntryRange >::const_iterator range = std::upper_bound(
+    mEntryRanges.begin(),
+    mEntryRanges.end(),
+    EntryRange( entry, std::numeric_limits< std::size_t >::max() ) );
+  if ( range == mEntryRanges.begin() ) {
+    return false;
+  }
+  --range;
+  return entry < range->second;
+}
+
 void Set::setDistributionFactors( xdm::RefPtr< xdm::UniformDataItem > factors ) {
   mDistributionFactors = factors;
 }
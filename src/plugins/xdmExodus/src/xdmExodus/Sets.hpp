@@ -23,25 +23,80 @@
 
 #include <xdmExodus/Object.hpp>
 
-#include <xdmGrid/ReferencingGrid.hpp>
+#include <xdmGrid/Grid.hpp>
 
+#include <xdm/Forward.hpp>
 
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace xdmExodus {
 
+class ExodusString;
+class ReadableExodusFile;
+
 /// An Exodus set is an integer array of offsets into internal element, face, edge, or node
 /// IDs. Note that these are *internal* IDs, which can only be determined by reading the
 /// elements/faces/edges sequentially from file and numbering them beginning with 1.
+///
+/// A set read from a file holds only its size until its entries, extra flags, or
+/// distribution factors are requested, and then reads just the values that were asked for.
+///
+/// The elements of a set are those of the grid its entries refer to, which is not part of
+/// the set and is not traversed with it.
 class Set :
   public Object,
-  public xdmGrid::ReferencingGrid {
+  public xdmGrid::Grid {
+public:
+  Set();
 
   virtual std::size_t numberOfEntries() const;
 
+  /// Set the grid holding the nodes, edges, faces, or elements the entries refer to.
+  void setReferencedGrid( xdm::RefPtr< xdmGrid::Grid > grid );
+  /// Get the grid the entries refer to, which may be null.
+  xdm::RefPtr< xdmGrid::Grid > referencedGrid() const;
+
+  /// Create an attribute with one value per entry of the set.
+  virtual xdm::RefPtr< xdmGrid::Attribute > createAttribute(
+    xdmGrid::Attribute::Center center,
+    xdmGrid::Attribute::Type type,
+    const std::string& name,
+    xdm::primitiveType::Value dataType );
+
+  /// Get the number of entries in the set.
+  virtual std::size_t numberOfElements() const;
+
+  /// Get the element of the referenced grid that an entry refers to.
+  /// @throws std::runtime_error if the set does not refer to a grid.
+  virtual xdmGrid::Element element( const std::size_t& elementIndex ) const;
+
   virtual void addVariable( xdm::RefPtr< Variable > variable );
 
+  /// Set up the set from an open file. The values of the set are read from the file when
+  /// they are first requested.
+  virtual void readFromFile(
+    xdm::RefPtr< ReadableExodusFile > file,
+    int exodusObjectId,
+    std::string name,
+    std::vector< int >::const_iterator beginTruthTable,
+    const std::size_t numberOfVariables,
+    const std::vector< ExodusString >& variableNames );
+
   virtual void writeToFile( int exodusFileId, int* variableTruthTable );
 
+  /// Get the entries of the set, as zero-based indices into the nodes, edges, faces, or
+  /// elements of the file.
+  xdm::RefPtr< xdm::UniformDataItem > entries();
+
+  /// Determine if an entry is in the set. The first call reads the entries and reduces them
+  /// to a sorted list of runs of consecutive entries, which is searched by this and later
+  /// calls. Sets are usually made of a few long runs, so the list is small. Only the runs
+  /// are kept: entries that were read from the file for this are released again, and are
+  /// read once more if they are requested later.
+  bool contains( std::size_t entry );
+
   /// Set the distribution factors for this set. There is one factor per
   /// entry in the set or zero factors.
   void setDistributionFactors( xdm::RefPtr< xdm::UniformDataItem > factors );
@@ -60,8 +115,17 @@ class Set :
   xdm::RefPtr< xdm::UniformDataItem > extraFlags();
 
 private:
+  // A run of consecutive entries [first, second).
+  typedef std::pair< std::size_t, std::size_t > EntryRange;
+
+  std::size_t mNumberOfEntries;
+  xdm::RefPtr< xdmGrid::Grid > mReferencedGrid;
+  xdm::RefPtr< xdm::UniformDataItem > mEntries;
   xdm::RefPtr< xdm::UniformDataItem > mDistributionFactors;
   xdm::RefPtr< xdm::UniformDataItem > mExtraFlags;
+  // Built by the first call to contains().
+  std::vector< EntryRange > mEntryRanges;
+  bool mHasEntryRanges;
 };
 
 class NodeSet : public Set {
@@ -19,10 +19,10 @@
 //
 //------------------------------------------------------------------------------
 #include <xdmExodus/Variable.hpp>
+#include <xdmExodus/ExodusData.hpp>
 #include <xdmExodus/Helpers.hpp>
+#include <xdmExodus/ReadableExodusFile.hpp>
 
-#include <xdm/ArrayAdapter.hpp>
-#include <xdm/VectorStructuredArray.hpp>
 #include <xdm/UniformDataItem.hpp>
 
 
@@ -38,28 +38,17 @@ Variable::Variable(
   xdmGrid::Attribute( xdmGrid::Attribute::kScalar, xdmGrid::Attribute::kElement ),
   mExodusObjectType( exodusObjectType ),
   mVariableIndex( variableIndex ),
-  mObjectId( objectId ) {
+  mObjectId( objectId ),
+  mData( new VariableData( exodusObjectType, variableIndex, objectId, numberOfEntries ) ) {
 
-  xdm::RefPtr< xdm::VectorStructuredArray< double > > data(
-    new xdm::VectorStructuredArray< double >( numberOfEntries ) );
   xdm::RefPtr< xdm::UniformDataItem > dataItem(
     new xdm::UniformDataItem( xdm::primitiveType::kDouble, xdm::makeShape( numberOfEntries ) ) );
-  dataItem->setData( xdm::makeRefPtr( new xdm::ArrayAdapter( data ) ) );
-  dataItem->data()->setIsDynamic( true );
+  dataItem->setData( mData );
   setDataItem( dataItem );
 }
 
-void Variable::readTimeStep( int exodusFileId, std::size_t timeStep ) {
-  EXODUS_CALL(
-    ex_get_var(
-      exodusFileId,
-      (int)( timeStep + 1 ),
-      mExodusObjectType,
-      mVariableIndex,
-      mObjectId,
-      (int)dataItem()->data()->array()->size(),
-      dataItem()->data()->array()->data() ),
-    "Could not read variable values." );
+void Variable::readTimeStep( xdm::RefPtr< ReadableExodusFile > file, std::size_t timeStep ) {
+  mData->setTimeStep( file, timeStep );
 }
 
 void Variable::writeTimeStep( int exodusFileId, std::size_t timeStep ) {
@@ -67,7 +56,7 @@ void Variable::writeTimeStep( int exodusFileId, std::size_t timeStep ) {
     ex_put_var(
       exodusFileId,
       (int)( timeStep + 1 ),
-      mExodusObjectType,
+      static_cast< ex_entity_type >( mExodusObjectType ),
       mVariableIndex,
       mObjectId,
       (int)dataItem()->data()->array()->size(),
@@ -23,25 +23,27 @@
 
 #include <xdmGrid/Attribute.hpp>
 
-#include <xdm/NamespaceMacro.hpp>
-
-XDM_NAMESPACE_BEGIN
-template< typename T > class VectorStructuredArray;
-XDM_NAMESPACE_END
-
-
+#include <xdm/RefPtr.hpp>
 
 namespace xdmExodus {
 
+class ReadableExodusFile;
+class VariableData;
+
+/// An Exodus result variable on the entries of a block or set. The values of the variable
+/// are read from the file when they are first requested for the current time step.
 class Variable : public xdmGrid::Attribute {
 public:
+  /// @param variableIndex The one-based Exodus index of the variable.
   Variable(
     int exodusObjectType,
     int variableIndex,
     int objectId,
     std::size_t numberOfEntries );
 
-  void readTimeStep( int exodusFileId, std::size_t timeStep );
+  /// Select the time step of the values. The values are read from the file the next time
+  /// the data item's array is requested, so variables that are never used are never read.
+  void readTimeStep( xdm::RefPtr< ReadableExodusFile > file, std::size_t timeStep );
 
   void writeTimeStep( int exodusFileId, std::size_t timeStep );
 
@@ -51,6 +53,7 @@ private:
   int mExodusObjectType;
   int mVariableIndex;
   int mObjectId;
+  xdm::RefPtr< VariableData > mData;
 };
 
 } // namespace xdmExodus
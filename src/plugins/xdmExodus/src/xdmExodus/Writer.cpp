@@ -20,21 +20,26 @@
 //------------------------------------------------------------------------------
 #include <xdmExodus/Blocks.hpp>
 #include <xdmExodus/Helpers.hpp>
+#include <xdmExodus/Object.hpp>
 #include <xdmExodus/Variable.hpp>
 #include <xdmExodus/Writer.hpp>
 
 #include <xdmGrid/Geometry.hpp>
+#include <xdmGrid/MultiArrayGeometry.hpp>
 #include <xdmGrid/Time.hpp>
 #include <xdmGrid/Topology.hpp>
 #include <xdmGrid/ElementTopology.hpp>
 
+#include <xdmFormat/IoExcept.hpp>
+
 #include <xdm/FileSystem.hpp>
 #include <xdm/Item.hpp>
-#include <xdm/ItemVisitor.hpp>
 #include <xdm/RefPtr.hpp>
 #include <xdm/UniformDataItem.hpp>
 #include <xdm/TypedStructuredArray.hpp>
 
+#include <algorithm>
+#include <cstring>
 #include <map>
 #include <string>
 #include <vector>
@@ -43,135 +48,54 @@ namespace xdmExodus {
 
 namespace {
 
-// An RAII class to handle an Exodus file. However, the behavior may be unpredictable if more than
-// one of these exist in the same scope with the same file.
-class WritableExodusFile {
-public:
-  WritableExodusFile( const xdm::FileSystemPath& exodusFileName ) :
-    mFileId( -1 ) {
-
-    // Open the file and get the id.
-    int doubleWordSize = sizeof( double );
-    int storedDataWordSize = sizeof( double );
-    mFileId = ex_create(
-      exodusFileName.pathString().c_str(),
-      EX_CLOBBER,
-      &doubleWordSize,
-      &storedDataWordSize );
-    if ( mFileId < 0 ) {
-      throw std::runtime_error( "Could not create ExodusII file at " + exodusFileName.pathString() );
-    }
-  }
-
-  ~WritableExodusFile() {
-    if ( mFileId >= 0 ) {
-      try {
-        ex_close( mFileId );
-      } catch ( ... ) {
-        // Should probably log this or something.
-      }
-    }
-  }
-
-  int id() const { return mFileId; }
-
-private:
-  int mFileId;
-};
-
 typedef std::map< int, std::string > VariableNameMap;
 
-class VariableNamesVisitor : public xdm::ItemVisitor {
-public:
-  virtual void apply( xdm::Item& item ) {
-    Variable* variable = dynamic_cast< Variable* >( &item );
-    if ( variable ) {
-      mNames[ variable->id() ] = variable->name();
+// Get the names of the variables of a list of objects, keyed by variable id.
+VariableNameMap variableNames( const std::vector< Object* >& objects ) {
+  VariableNameMap names;
+  for ( std::vector< Object* >::const_iterator object = objects.begin();
+    object != objects.end(); ++object ) {
+    std::vector< xdm::RefPtr< Variable > > variables = (*object)->variables();
+    for ( std::size_t i = 0; i < variables.size(); ++i ) {
+      names[ variables[i]->id() ] = variables[i]->name();
     }
   }
+  return names;
+}
 
-  const VariableNameMap& names() const { return mNames; }
-
-private:
-  VariableNameMap mNames;
-};
-
-// T is expected to be a type inheriting from Object so that we can call numberOfEntries() and
-// count variables.
-template< typename T >
-class GatherExodusObjectsVisitor : public xdm::ItemVisitor {
-public:
-  GatherExodusObjectsVisitor() : mEntryCount( 0 ) {}
-
-  virtual void apply( xdm::Item& item ) {
-    T* dynamicCastResult = dynamic_cast< T* >( &item );
-    if ( dynamicCastResult ) {
-      mPointers.push_back( dynamicCastResult );
-      mEntryCount += dynamicCastResult->numberOfEntries();
-      VariableNamesVisitor countVarVisitor;
-      dynamicCastResult->traverse( countVarVisitor );
-      mNames.insert( countVarVisitor.names().begin(), countVarVisitor.names().end() );
-    }
-  }
-
-  std::vector< Object* >& pointers() { return mPointers; }
-  std::size_t totalNumberOfEntries() const { return mEntryCount; }
-  const VariableNameMap& names() const { return mNames; }
-
-  int maxVariableId() const {
-    if ( mNames.size() > 0 ) {
-      return mNames.rbegin()->first;
-    } else {
-      return 0;
-    }
+// Get the total number of entries in a list of objects.
+std::size_t totalNumberOfEntries( const std::vector< Object* >& objects ) {
+  std::size_t count = 0;
+  for ( std::vector< Object* >::const_iterator object = objects.begin();
+    object != objects.end(); ++object ) {
+    count += (*object)->numberOfEntries();
   }
-
-private:
-  VariableNameMap mNames;
-  std::vector< Object* > mPointers;
-  std::size_t mEntryCount;
-};
-
-class FindTimeVisitor : public xdm::ItemVisitor {
-public:
-  virtual void apply( xdm::Item& item ) {
-    if ( ! mTime.valid() ) {
-      xdmGrid::Grid* grid = dynamic_cast< xdmGrid::Grid* >( &item );
-      if ( grid ) {
-        if ( grid->time().valid() ) {
-          mTime = grid->time();
-        }
-      }
-    }
-  }
-
-  xdm::RefPtr< xdmGrid::Time > time() { return mTime; }
-
-private:
-  xdm::RefPtr< xdmGrid::Time > mTime;
-};
+  return count;
+}
 
 void writeBlockData(
   int exodusFileId,
   int exodusObjectType,
-  const VariableNameMap& variableNames,
-  std::vector< Object* >& objects ) {
+  const std::vector< Object* >& objects ) {
+
+  const VariableNameMap names = variableNames( objects );
 
   // Write the Exodus variable data for this block.
   std::size_t numberOfVariables = 0;
-  if ( ! variableNames.empty() ) {
-    numberOfVariables = variableNames.rbegin()->first;
+  if ( ! names.empty() ) {
+    numberOfVariables = names.rbegin()->first;
     EXODUS_CALL(
-      ex_put_variable_param( exodusFileId, exodusObjectType, numberOfVariables ),
+      ex_put_variable_param(
+        exodusFileId, static_cast< ex_entity_type >( exodusObjectType ), numberOfVariables ),
       "Unable to write edge result variable parameters." );
   }
-  for ( VariableNameMap::const_iterator nameIt = variableNames.begin();
-    nameIt != variableNames.end(); ++nameIt ) {
+  for ( VariableNameMap::const_iterator nameIt = names.begin();
+    nameIt != names.end(); ++nameIt ) {
 
     EXODUS_CALL(
       ex_put_variable_name(
         exodusFileId,
-        exodusObjectType,
+        static_cast< ex_entity_type >( exodusObjectType ),
         nameIt->first,
         nameIt->second.c_str() ),
       "Unable to write variable name." );
@@ -186,82 +110,95 @@ void writeBlockData(
   }
 
   // Writing the truth table before trying to write variables makes the writing
-  // much faster because only one allocation is performed by NetCDF.
-  EXODUS_CALL(
-   ex_put_truth_table(
-    exodusFileId,
-    exodusObjectType,
-    objects.size(),
-    numberOfVariables,
-    &variableTruthTable[0] ),
-  "Unable to write variable truth table." );
+  // much faster because only one allocation is performed by NetCDF. There is no table
+  // without variables.
+  if ( numberOfVariables > 0 ) {
+    EXODUS_CALL(
+      ex_put_truth_table(
+        exodusFileId,
+        static_cast< ex_entity_type >( exodusObjectType ),
+        objects.size(),
+        numberOfVariables,
+        &variableTruthTable[0] ),
+      "Unable to write variable truth table." );
+  }
 }
 
-} // anon namespace
-
-ExodusWriter::ExodusWriter() {
-}
+// Write the node coordinates. Coordinates held in one array per dimension, as in the file,
+// are written directly. Those of any other geometry are gathered and separated a chunk of
+// nodes at a time.
+void writeCoordinates( int exodusFileId, xdmGrid::Geometry& geom ) {
+  const unsigned int dimension = geom.dimension();
+  if ( xdmGrid::MultiArrayGeometry* arrays = dynamic_cast< xdmGrid::MultiArrayGeometry* >( &geom ) ) {
+    std::vector< void* > geomPtrs( 3, NULL );
+    for ( std::size_t dim = 0; dim < dimension; ++dim ) {
+      geomPtrs[ dim ] = arrays->child( dim )->data()->array()->data();
+    }
+    EXODUS_CALL( ex_put_coord( exodusFileId, geomPtrs[0], geomPtrs[1], geomPtrs[2] ),
+      "Unable to write coordinates." );
+    return;
+  }
 
-ExodusWriter::~ExodusWriter() {
+  const std::size_t numberOfNodes = geom.numberOfNodes();
+  if ( numberOfNodes == 0 || dimension == 0 ) {
+    return;
+  }
+  const std::size_t chunkSize = std::min( numberOfNodes, kCoordinateChunkSize );
+  std::vector< std::size_t > nodeIndices( chunkSize );
+  std::vector< double > interlaced( chunkSize * dimension );
+  std::vector< std::vector< double > > chunk( 3, std::vector< double >( chunkSize ) );
+  for ( std::size_t begin = 0; begin < numberOfNodes; begin += chunkSize ) {
+    const std::size_t count = std::min( chunkSize, numberOfNodes - begin );
+    for ( std::size_t node = 0; node < count; ++node ) {
+      nodeIndices[ node ] = begin + node;
+    }
+    geom.gatherNodes( &nodeIndices[0], count, &interlaced[0] );
+    for ( std::size_t node = 0; node < count; ++node ) {
+      for ( unsigned int dim = 0; dim < dimension && dim < 3; ++dim ) {
+        chunk[ dim ][ node ] = interlaced[ node * dimension + dim ];
+      }
+    }
+    EXODUS_CALL(
+      ex_put_n_coord( exodusFileId, static_cast< int >( begin + 1 ), static_cast< int >( count ),
+        &chunk[0][0],
+        dimension > 1 ? &chunk[1][0] : 0,
+        dimension > 2 ? &chunk[2][0] : 0 ),
+      "Unable to write coordinates." );
+  }
 }
 
-void ExodusWriter::writeItem( xdm::RefPtr< xdm::Item > item, const xdm::FileSystemPath& path ) {
-
-  WritableExodusFile file( path );
+// Write the nodes and blocks of a tree, along with the variable definitions. This is
+// everything in the file except for the time steps.
+void writeMesh( int exodusFileId, const std::string& title, const ObjectRegistry& objects ) {
 
-  std::size_t timeStep = 0;
+  const std::vector< Object* >& edgeBlocks = objects.objects( EX_EDGE_BLOCK );
+  const std::vector< Object* >& faceBlocks = objects.objects( EX_FACE_BLOCK );
+  const std::vector< Object* >& elementBlocks = objects.objects( EX_ELEM_BLOCK );
 
   ex_init_params meshParams;
-  std::strcpy( meshParams.title, item->name().substr( 0, MAX_LINE_LENGTH + 1 ).c_str() );
-
-  // First make up collections of pointers to everything that we know about. For now,
-  // that is just Blocks.
-  GatherExodusObjectsVisitor< EdgeBlock > edgeBlockGatherVisitor;
-  GatherExodusObjectsVisitor< FaceBlock > faceBlockGatherVisitor;
-  GatherExodusObjectsVisitor< ElementBlock > elementBlockGatherVisitor;
-  item->traverse( edgeBlockGatherVisitor );
-  item->traverse( faceBlockGatherVisitor );
-  item->traverse( elementBlockGatherVisitor );
-  meshParams.num_edge_blk = edgeBlockGatherVisitor.pointers().size();
-  meshParams.num_face_blk = faceBlockGatherVisitor.pointers().size();
-  meshParams.num_elem_blk = elementBlockGatherVisitor.pointers().size();
-
-  if ( meshParams.num_edge_blk + meshParams.num_face_blk + meshParams.num_elem_blk < 1 ) {
-    // There is nothing to write.
-    return;
-  }
+  std::strcpy( meshParams.title, title.substr( 0, MAX_LINE_LENGTH ).c_str() );
+
+  meshParams.num_edge_blk = edgeBlocks.size();
+  meshParams.num_face_blk = faceBlocks.size();
+  meshParams.num_elem_blk = elementBlocks.size();
 
   // There is only one Geometry (one unique set of nodes). To find it, we just need to find
   // the first one.
   xdmGrid::Geometry* geom;
   if ( meshParams.num_edge_blk > 0 ) {
-    geom = dynamic_cast< Block* >( edgeBlockGatherVisitor.pointers().front() )->geometry().get();
+    geom = dynamic_cast< Block* >( edgeBlocks.front() )->geometry().get();
   } else if ( meshParams.num_face_blk > 0 ) {
-    geom = dynamic_cast< Block* >( faceBlockGatherVisitor.pointers().front() )->geometry().get();
+    geom = dynamic_cast< Block* >( faceBlocks.front() )->geometry().get();
   } else {
-    geom = dynamic_cast< Block* >( elementBlockGatherVisitor.pointers().front() )->geometry().get();
+    geom = dynamic_cast< Block* >( elementBlocks.front() )->geometry().get();
   }
   meshParams.num_dim = geom->dimension();
   meshParams.num_nodes = geom->numberOfNodes();
-  std::vector< void* > geomPtrs( 3, NULL );
-  for ( std::size_t dim = 0; dim < meshParams.num_dim; ++dim ) {
-    geomPtrs[ dim ] = geom->child( dim )->data()->array()->data();
-  }
-  EXODUS_CALL( ex_put_coord( file.id(), geomPtrs[0], geomPtrs[1], geomPtrs[2] ),
-    "Unable to write coordinates." );
-  std::vector< ExodusString > coordNames;
-  coordNames.push_back( "X" );
-  coordNames.push_back( "Y" );
-  coordNames.push_back( "Z" );
-  char* coordNamesCharArray[ 3 ];
-  vectorToCharStarArray( coordNames, coordNamesCharArray );
-  EXODUS_CALL( ex_put_coord_names( file.id(), coordNamesCharArray ),
-    "Unable to write coordinate names." );
 
   // Count the entries in the blocks.
-  meshParams.num_edge = edgeBlockGatherVisitor.totalNumberOfEntries();
-  meshParams.num_face = faceBlockGatherVisitor.totalNumberOfEntries();
-  meshParams.num_elem = elementBlockGatherVisitor.totalNumberOfEntries();
+  meshParams.num_edge = totalNumberOfEntries( edgeBlocks );
+  meshParams.num_face = totalNumberOfEntries( faceBlocks );
+  meshParams.num_elem = totalNumberOfEntries( elementBlocks );
 
   // Not doing sets and maps at the moment...
   meshParams.num_node_sets = 0;
@@ -274,48 +211,182 @@ void ExodusWriter::writeItem( xdm::RefPtr< xdm::Item > item, const xdm::FileSyst
   meshParams.num_face_maps = 0;
   meshParams.num_elem_maps = 0;
 
-  EXODUS_CALL( ex_put_init_ext( file.id(), &meshParams ),
+  EXODUS_CALL( ex_put_init_ext( exodusFileId, &meshParams ),
     "Unable to initialize database.\n" );
 
-  // Write the time step info, if there is any.
-  FindTimeVisitor timeVisit;
-  item->traverse( timeVisit );
-  if ( timeVisit.time() ) {
-    double timeVal = timeVisit.time()->value();
-    EXODUS_CALL( ex_put_time( file.id(), (int)( timeStep + 1 ), (void*)&timeVal ),
-      "Unable to write time value." );
-  }
+  // The coordinates can only be written once the database defines the nodes.
+  writeCoordinates( exodusFileId, *geom );
+  std::vector< ExodusString > coordNames;
+  coordNames.push_back( "X" );
+  coordNames.push_back( "Y" );
+  coordNames.push_back( "Z" );
+  char* coordNamesCharArray[ 3 ];
+  vectorToCharStarArray( coordNames, coordNamesCharArray );
+  EXODUS_CALL( ex_put_coord_names( exodusFileId, coordNamesCharArray ),
+    "Unable to write coordinate names." );
 
   // Write the blocks.
   writeBlockData(
-    file.id(),
+    exodusFileId,
     EX_EDGE_BLOCK,
-    edgeBlockGatherVisitor.names(),
-    edgeBlockGatherVisitor.pointers() );
+    edgeBlocks );
 
   writeBlockData(
-    file.id(),
+    exodusFileId,
     EX_FACE_BLOCK,
-    faceBlockGatherVisitor.names(),
-    faceBlockGatherVisitor.pointers() );
+    faceBlocks );
 
   writeBlockData(
-    file.id(),
+    exodusFileId,
     EX_ELEM_BLOCK,
-    elementBlockGatherVisitor.names(),
-    elementBlockGatherVisitor.pointers() );
+    elementBlocks );
+}
+
+} // anon namespace
+
+const std::size_t ExodusWriter::kDefaultUpdateInterval;
+
+ExodusWriter::ExodusWriter() :
+  mFileId( -1 ),
+  mPath(),
+  mMeshWritten( false ),
+  mRegistry(),
+  mObjects(),
+  mHasVariables( false ),
+  mUpdateInterval( kDefaultUpdateInterval ),
+  mStepsSinceUpdate( 0 ) {
+}
+
+ExodusWriter::~ExodusWriter() {
+  try {
+    close();
+  } catch ( ... ) {
+    // Should probably log this or something.
+  }
+}
+
+void ExodusWriter::open(
+  const xdm::FileSystemPath& path,
+  xdm::Dataset::InitializeMode mode ) {
+
+  close();
+
+  int doubleWordSize = sizeof( double );
+  int storedDataWordSize = sizeof( double );
+  if ( mode == xdm::Dataset::kModify ) {
+    // The mesh is already in the file, so only steps are appended.
+    float version;
+    mFileId = ex_open(
+      path.pathString().c_str(),
+      EX_WRITE,
+      &doubleWordSize,
+      &storedDataWordSize,
+      &version );
+    mMeshWritten = true;
+  } else {
+    mFileId = ex_create(
+      path.pathString().c_str(),
+      EX_CLOBBER,
+      &doubleWordSize,
+      &storedDataWordSize );
+    mMeshWritten = false;
+  }
+  if ( mFileId < 0 ) {
+    mFileId = -1;
+    throw xdmFormat::WriteError( "Could not open ExodusII file at " + path.pathString() );
+  }
+  mPath = path;
+}
+
+void ExodusWriter::prepareSeries( xdm::RefPtr< xdm::Item > item ) {
+  mRegistry.gather( item );
+  const std::vector< Object* >& edgeBlocks = mRegistry.objects( EX_EDGE_BLOCK );
+  const std::vector< Object* >& faceBlocks = mRegistry.objects( EX_FACE_BLOCK );
+  const std::vector< Object* >& elementBlocks = mRegistry.objects( EX_ELEM_BLOCK );
+
+  mObjects.clear();
+  mObjects.insert( mObjects.end(), edgeBlocks.begin(), edgeBlocks.end() );
+  mObjects.insert( mObjects.end(), faceBlocks.begin(), faceBlocks.end() );
+  mObjects.insert( mObjects.end(), elementBlocks.begin(), elementBlocks.end() );
+
+  if ( ! mMeshWritten && ! mObjects.empty() ) {
+    writeMesh( mFileId, item->name(), mRegistry );
+    mMeshWritten = true;
+  }
+
+  mHasVariables = false;
+  for ( std::vector< Object* >::const_iterator object = mObjects.begin();
+    object != mObjects.end(); ++object ) {
+    mHasVariables = mHasVariables || (*object)->numberOfVariables() > 0;
+  }
+}
+
+void ExodusWriter::write( xdm::RefPtr< xdm::Item > item, std::size_t seriesIndex ) {
+  if ( mFileId < 0 ) {
+    throw xdmFormat::WriteError( "The Exodus series has not been opened." );
+  }
+
+  // Only a new tree is searched for blocks.
+  if ( item != mRegistry.root() ) {
+    prepareSeries( item );
+  }
+  if ( ! mMeshWritten ) {
+    // There is nothing to write.
+    return;
+  }
+
+  // Write the time of the first grid that has one, if there is any.
+  xdm::RefPtr< const xdmGrid::Time > time;
+  const std::vector< xdmGrid::Grid* >& grids = mRegistry.grids();
+  for ( std::vector< xdmGrid::Grid* >::const_iterator grid = grids.begin();
+    grid != grids.end() && ! time.valid(); ++grid ) {
+    time = (*grid)->time();
+  }
+  if ( time.valid() ) {
+    double timeVal = time->value();
+    EXODUS_CALL( ex_put_time( mFileId, (int)( seriesIndex + 1 ), (void*)&timeVal ),
+      "Unable to write time value." );
+  }
 
   // Write the variable data for this time step.
-  for ( std::size_t blockIndex = 0; blockIndex < meshParams.num_edge_blk; ++blockIndex ) {
-    edgeBlockGatherVisitor.pointers()[ blockIndex ]->writeTimeStep( file.id(), timeStep );
+  for ( std::vector< Object* >::iterator object = mObjects.begin();
+    object != mObjects.end(); ++object ) {
+    (*object)->writeTimeStep( mFileId, seriesIndex );
   }
-  for ( std::size_t blockIndex = 0; blockIndex < meshParams.num_face_blk; ++blockIndex ) {
-    faceBlockGatherVisitor.pointers()[ blockIndex ]->writeTimeStep( file.id(), timeStep );
+
+  ++mStepsSinceUpdate;
+  if ( mUpdateInterval > 0 && mStepsSinceUpdate >= mUpdateInterval ) {
+    EXODUS_CALL( ex_update( mFileId ), "Unable to flush the Exodus file." );
+    mStepsSinceUpdate = 0;
   }
-  for ( std::size_t blockIndex = 0; blockIndex < meshParams.num_elem_blk; ++blockIndex ) {
-    elementBlockGatherVisitor.pointers()[ blockIndex ]->writeTimeStep( file.id(), timeStep );
+}
+
+void ExodusWriter::close() {
+  if ( mFileId >= 0 ) {
+    // Closing the file flushes the steps written since the last update.
+    ex_close( mFileId );
   }
+  mFileId = -1;
+  mPath = xdm::FileSystemPath();
+  mMeshWritten = false;
+  mRegistry.clear();
+  mObjects.clear();
+  mHasVariables = false;
+  mStepsSinceUpdate = 0;
+}
+
+void ExodusWriter::setUpdateInterval( std::size_t steps ) {
+  mUpdateInterval = steps;
+}
 
+std::size_t ExodusWriter::updateInterval() const {
+  return mUpdateInterval;
+}
+
+void ExodusWriter::writeItem( xdm::RefPtr< xdm::Item > item, const xdm::FileSystemPath& path ) {
+  open( path, xdm::Dataset::kCreate );
+  write( item, 0 );
+  close();
 }
 
 bool ExodusWriter::update(
@@ -323,7 +394,16 @@ bool ExodusWriter::update(
   const xdm::FileSystemPath& path,
   std::size_t timeStep ) {
 
-  // TODO: implement
+  // The first step starts a new file, replacing any file left there by an earlier run. A
+  // later step reopens the file that holds the earlier steps when another path or item was
+  // written in between. Keep the file open so that the following updates only write the
+  // variables.
+  if ( mFileId < 0 || mPath.pathString() != path.pathString() ) {
+    const bool append = timeStep > 0 && xdm::exists( path );
+    open( path, append ? xdm::Dataset::kModify : xdm::Dataset::kCreate );
+  }
+  write( item, timeStep );
+  return mHasVariables;
 }
 
 } // namespace xdmExodus
@@ -21,34 +21,93 @@
 #ifndef xdmExodus_Writer_hpp
 #define xdmExodus_Writer_hpp
 
+#include <xdmExodus/ObjectRegistry.hpp>
+
 #include <xdmFormat/Writer.hpp>
 
+#include <xdm/FileSystem.hpp>
+#include <xdm/RefPtr.hpp>
 
+#include <vector>
 
 namespace xdmExodus {
 
+class Object;
+
 /// Class for writing an ExodusII file. Uses the ExodusII library functions to write
 /// an unstructured grid to an ExodusII file complete with nodes and blocks for now.
+///
+/// A transient solution is written to a single file as a series: open() the file, write()
+/// each time step, and close() it. The nodes, blocks, and Exodus attributes are written
+/// with the first step. Every later step writes only its time value and the Exodus
+/// variables to the file, which stays open, so the cost of a step depends on the size of
+/// the variables and not on the size of the mesh. The library buffers the steps, and they
+/// are flushed to disk every updateInterval() steps and when the series is closed.
 class ExodusWriter : public xdmFormat::Writer {
 public:
   ExodusWriter();
   virtual ~ExodusWriter();
 
-  /// Write an Item to the file with the given path.
+  /// The default number of steps written between flushes of the file.
+  static const std::size_t kDefaultUpdateInterval = 16;
+
+  /// Begin a series of time steps.
+  /// @param path The file to write.
+  /// @param mode kCreate to replace any existing file, or kModify to append steps to a
+  ///        file that already contains the mesh.
+  /// @throws xdmFormat::WriteError if the file could not be opened.
+  virtual void open(
+    const xdm::FileSystemPath& path,
+    xdm::Dataset::InitializeMode mode );
+
+  /// Write a time step of the series. The first step also writes the mesh. The blocks and
+  /// grids of the tree are gathered into an ObjectRegistry when a tree is first written, so
+  /// later steps should pass the same tree with updated variable values.
+  /// @param item The tree to write.
+  /// @param seriesIndex The time step to write.
+  /// @throws xdmFormat::WriteError if the series has not been opened.
+  virtual void write( xdm::RefPtr< xdm::Item > item, std::size_t seriesIndex );
+
+  /// Flush the remaining steps and close the file.
+  virtual void close();
+
+  /// Set the number of steps written between flushes of the file to disk. An interval
+  /// of zero leaves flushing to the library until the series is closed.
+  void setUpdateInterval( std::size_t steps );
+  /// Get the number of steps written between flushes of the file to disk.
+  std::size_t updateInterval() const;
+
+  /// Write an Item to the file with the given path as a single time step.
   /// @see xdmFormat::Writer::writeItem
   virtual void writeItem( xdm::RefPtr< xdm::Item > item, const xdm::FileSystemPath& path );
 
-  /// Write an existing Item and it's subtree at a new time step. If there is no dynamic
-  /// data in the tree, then this function does nothing.
+  /// Write an existing Item and it's subtree at a new time step. The file is kept open
+  /// between updates, so a sequence of updates to the same path writes the mesh only once.
+  /// An update of the first step replaces any existing file at the path. An update of a
+  /// later step appends to the existing file, so the updates of several paths, or calls to
+  /// writeItem(), may be interleaved without losing the earlier steps.
+  /// @return false if there is no dynamic data in the tree.
   /// @see xdmFormat::Writer::update
   virtual bool update(
     xdm::RefPtr< xdm::Item > item,
     const xdm::FileSystemPath& path,
     std::size_t timeStep = 0 );
 
+private:
+  /// Find the blocks of a tree, writing the mesh if the file does not have one yet.
+  void prepareSeries( xdm::RefPtr< xdm::Item > item );
+
+  int mFileId;
+  xdm::FileSystemPath mPath;
+  bool mMeshWritten;
+  // The tree being written and the blocks in it, in the order they are written.
+  ObjectRegistry mRegistry;
+  std::vector< Object* > mObjects;
+  bool mHasVariables;
+  std::size_t mUpdateInterval;
+  std::size_t mStepsSinceUpdate;
 };
 
 } // namespace xdmExodus
 
 #endif // xdmExodus_Writer_hpp
-
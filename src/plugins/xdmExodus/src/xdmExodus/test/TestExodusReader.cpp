@@ -21,7 +21,36 @@
 #define BOOST_TEST_MODULE Geometry
 #include <boost/test/unit_test.hpp>
 
+#include <xdmExodus/Blocks.hpp>
+#include <xdmExodus/Maps.hpp>
+#include <xdmExodus/ExodusData.hpp>
+#include <xdmExodus/ReadableExodusFile.hpp>
 #include <xdmExodus/Reader.hpp>
+#include <xdmExodus/Sets.hpp>
+#include <xdmExodus/Variable.hpp>
+
+#include <xdmGrid/Domain.hpp>
+#include <xdmGrid/ElementTopology.hpp>
+#include <xdmGrid/Time.hpp>
+#include <xdmGrid/Topology.hpp>
+
+#include <xdm/FileSystem.hpp>
+#include <xdm/Item.hpp>
+#include <xdm/ItemVisitor.hpp>
+#include <xdm/TypedStructuredArray.hpp>
+#include <xdm/UniformDataItem.hpp>
+
+#include <exodusII.h>
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <stdexcept>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace {
 
@@ -29,5 +58,670 @@ BOOST_AUTO_TEST_CASE( doNothing ) {
   BOOST_CHECK_EQUAL( "foo", "foo" );
 }
 
+BOOST_AUTO_TEST_CASE( openFileLimit ) {
+  xdmExodus::ExodusReader reader;
+  BOOST_CHECK_EQUAL( xdmExodus::ExodusReader::kDefaultOpenFileLimit, reader.openFileLimit() );
+  reader.setOpenFileLimit( 0 );
+  BOOST_CHECK_EQUAL( 0u, reader.openFileLimit() );
+  reader.closeFiles();
+}
+
+BOOST_AUTO_TEST_CASE( missingFile ) {
+  xdmExodus::ExodusReader reader;
+  BOOST_CHECK_THROW(
+    reader.numberOfTimeSteps( xdm::FileSystemPath( "missingFile.exo" ) ),
+    std::runtime_error );
+}
+
+BOOST_AUTO_TEST_CASE( variableHistoryMissingFile ) {
+  xdmExodus::ExodusReader reader;
+  BOOST_CHECK_THROW(
+    reader.readVariableHistory(
+      xdm::FileSystemPath( "missingFile.exo" ), EX_ELEM_BLOCK, 1, 10, 0, 0, 1 ),
+    std::runtime_error );
+  std::vector< std::size_t > entries( 3, 0 );
+  BOOST_CHECK_THROW(
+    reader.readVariableHistories(
+      xdm::FileSystemPath( "missingFile.exo" ), EX_ELEM_BLOCK, 1, 10, entries, 0, 1 ),
+    std::runtime_error );
+}
+
+BOOST_AUTO_TEST_CASE( coordinateLayout ) {
+  xdmExodus::ExodusReader reader;
+  BOOST_CHECK_EQUAL( xdmExodus::ExodusReader::kSeparateCoordinates, reader.coordinateLayout() );
+  reader.setCoordinateLayout( xdmExodus::ExodusReader::kInterlacedCoordinates );
+  BOOST_CHECK_EQUAL( xdmExodus::ExodusReader::kInterlacedCoordinates, reader.coordinateLayout() );
+
+  double x[4], y[4], z[4], xyz[12];
+  BOOST_CHECK_THROW(
+    reader.readCoordinates( xdm::FileSystemPath( "missingFile.exo" ), 0, 4, x, y, z ),
+    std::runtime_error );
+  BOOST_CHECK_THROW(
+    reader.readInterlacedCoordinates( xdm::FileSystemPath( "missingFile.exo" ), 0, 4, xyz ),
+    std::runtime_error );
+}
+
+BOOST_AUTO_TEST_CASE( variableDataWithoutFile ) {
+  // Without a file, the values are held in memory for writing.
+  xdmExodus::VariableData data( EX_ELEM_BLOCK, 1, 10, 5 );
+  BOOST_CHECK( data.isDynamic() );
+  BOOST_CHECK( ! data.file() );
+  BOOST_CHECK_EQUAL( 5u, data.array()->size() );
+  BOOST_CHECK( ! data.isLoaded() );
+  data.setTimeStep( xdm::RefPtr< xdmExodus::ReadableExodusFile >(), 3 );
+  BOOST_CHECK_EQUAL( 3u, data.timeStep() );
+}
+
+BOOST_AUTO_TEST_CASE( setEntryDataWithoutFile ) {
+  xdmExodus::SetEntryData entries(
+    xdm::RefPtr< xdmExodus::ReadableExodusFile >(), EX_SIDE_SET, 3, 7, false );
+  BOOST_CHECK( ! entries.isDynamic() );
+  BOOST_CHECK_EQUAL( 7u, entries.array()->size() );
+  BOOST_CHECK_EQUAL( xdm::primitiveType::kInt, entries.array()->dataType() );
+  BOOST_CHECK( ! entries.isLoaded() );
+}
+
+// The coordinate of a node of a row of unit hexahedra along x. Each slice of 4 nodes is
+// shared by the hexes on either side of it.
+double hexRowCoordinate( int node, int dimension ) {
+  const int corner = node % 4;
+  switch ( dimension ) {
+    case 0:
+      return node / 4;
+    case 1:
+      return ( corner == 1 || corner == 2 ) ? 1.0 : 0.0;
+    default:
+      return ( corner > 1 ) ? 1.0 : 0.0;
+  }
+}
+
+// The zero-based node at a corner of a hex of the row, in Exodus order.
+int hexRowNode( int hex, int corner ) {
+  return 4 * ( hex + corner / 4 ) + corner % 4;
+}
+
+// Write the nodes of a row of hexahedra to an Exodus file.
+void writeHexRowNodes( int exodusFileId, int numberOfHexes ) {
+  const int numberOfNodes = 4 * ( numberOfHexes + 1 );
+  std::vector< double > x( numberOfNodes ), y( numberOfNodes ), z( numberOfNodes );
+  for ( int node = 0; node < numberOfNodes; ++node ) {
+    x[node] = hexRowCoordinate( node, 0 );
+    y[node] = hexRowCoordinate( node, 1 );
+    z[node] = hexRowCoordinate( node, 2 );
+  }
+  BOOST_REQUIRE( ex_put_coord( exodusFileId, &x[0], &y[0], &z[0] ) >= 0 );
+}
+
+// The transient file holds two blocks of two hexahedra each with an element variable at a
+// few time steps, a node set, a side set, and a node number map.
+const int kTransientSteps = 3;
+const int kTransientHexes = 2;
+const int kTransientBlockId = 10;
+const int kTransientSecondBlockId = 11;
+const int kTransientNodes = 4 * ( 2 * kTransientHexes + 1 );
+const int kTransientNodeSetId = 20;
+const int kTransientSideSetId = 30;
+const int kTransientNodeMapId = 40;
+
+// The zero-based nodes of the node set, in two runs.
+const int kTransientNodeSet[] = { 5, 0, 2, 1, 9 };
+const int kTransientNodeSetSize = sizeof( kTransientNodeSet ) / sizeof( int );
+
+// The zero-based elements and one-based sides of the side set.
+const int kTransientSideSetElements[] = { 1, 0 };
+const int kTransientSideSetSides[] = { 6, 5 };
+const int kTransientSideSetSize = sizeof( kTransientSideSetElements ) / sizeof( int );
+
+double nodeSetFactor( int entry ) {
+  return 0.5 * entry + 1.0;
+}
+
+int nodeMapId( int node ) {
+  return 100 + 3 * node;
+}
+
+double transientTime( int step ) {
+  return 0.25 * ( step + 1 );
+}
+
+// The temperature of a hex numbered across both blocks.
+double transientTemperature( int step, int hex ) {
+  return 10.0 * step + hex + 0.5;
+}
+
+// Write one of the transient blocks, holding the hexes from the first one given.
+void writeTransientBlock( int exodusFileId, int blockId, int firstHex ) {
+  std::vector< int > connectivity( 8 * kTransientHexes );
+  for ( int hex = 0; hex < kTransientHexes; ++hex ) {
+    for ( int corner = 0; corner < 8; ++corner ) {
+      connectivity[ 8 * hex + corner ] = hexRowNode( firstHex + hex, corner ) + 1;
+    }
+  }
+  BOOST_REQUIRE( ex_put_block( exodusFileId, EX_ELEM_BLOCK, blockId, "HEX8",
+    kTransientHexes, 8, 0, 0, 0 ) >= 0 );
+  BOOST_REQUIRE( ex_put_conn( exodusFileId, EX_ELEM_BLOCK, blockId,
+    &connectivity[0], 0, 0 ) >= 0 );
+}
+
+void writeTransientFile( const xdm::FileSystemPath& path ) {
+  int wordSize = sizeof( double );
+  int exodusFileId = ex_create( path.pathString().c_str(), EX_CLOBBER, &wordSize, &wordSize );
+  BOOST_REQUIRE( exodusFileId >= 0 );
+
+  ex_init_params parameters;
+  std::memset( &parameters, 0, sizeof( parameters ) );
+  std::strcpy( parameters.title, "transient" );
+  parameters.num_dim = 3;
+  parameters.num_nodes = kTransientNodes;
+  parameters.num_elem = 2 * kTransientHexes;
+  parameters.num_elem_blk = 2;
+  parameters.num_node_sets = 1;
+  parameters.num_side_sets = 1;
+  parameters.num_node_maps = 1;
+  BOOST_REQUIRE( ex_put_init_ext( exodusFileId, &parameters ) >= 0 );
+  writeHexRowNodes( exodusFileId, 2 * kTransientHexes );
+  writeTransientBlock( exodusFileId, kTransientBlockId, 0 );
+  writeTransientBlock( exodusFileId, kTransientSecondBlockId, kTransientHexes );
+
+  std::vector< int > nodes( kTransientNodeSetSize );
+  std::vector< double > factors( kTransientNodeSetSize );
+  for ( int entry = 0; entry < kTransientNodeSetSize; ++entry ) {
+    nodes[ entry ] = kTransientNodeSet[ entry ] + 1;
+    factors[ entry ] = nodeSetFactor( entry );
+  }
+  BOOST_REQUIRE( ex_put_set_param( exodusFileId, EX_NODE_SET, kTransientNodeSetId,
+    kTransientNodeSetSize, kTransientNodeSetSize ) >= 0 );
+  BOOST_REQUIRE( ex_put_set( exodusFileId, EX_NODE_SET, kTransientNodeSetId,
+    &nodes[0], 0 ) >= 0 );
+  BOOST_REQUIRE( ex_put_set_dist_fact( exodusFileId, EX_NODE_SET, kTransientNodeSetId,
+    &factors[0] ) >= 0 );
+
+  std::vector< int > elements( kTransientSideSetSize );
+  std::vector< int > sides( kTransientSideSetSides,
+    kTransientSideSetSides + kTransientSideSetSize );
+  for ( int entry = 0; entry < kTransientSideSetSize; ++entry ) {
+    elements[ entry ] = kTransientSideSetElements[ entry ] + 1;
+  }
+  BOOST_REQUIRE( ex_put_set_param( exodusFileId, EX_SIDE_SET, kTransientSideSetId,
+    kTransientSideSetSize, 0 ) >= 0 );
+  BOOST_REQUIRE( ex_put_set( exodusFileId, EX_SIDE_SET, kTransientSideSetId,
+    &elements[0], &sides[0] ) >= 0 );
+
+  std::vector< int > nodeMap( parameters.num_nodes );
+  for ( int node = 0; node < parameters.num_nodes; ++node ) {
+    nodeMap[ node ] = nodeMapId( node );
+  }
+  BOOST_REQUIRE( ex_put_num_map( exodusFileId, EX_NODE_MAP, kTransientNodeMapId,
+    &nodeMap[0] ) >= 0 );
+
+  char temperature[] = "temperature";
+  char* variableNames[] = { temperature };
+  BOOST_REQUIRE( ex_put_var_param( exodusFileId, "e", 1 ) >= 0 );
+  BOOST_REQUIRE( ex_put_var_names( exodusFileId, "e", 1, variableNames ) >= 0 );
+  for ( int step = 0; step < kTransientSteps; ++step ) {
+    double time = transientTime( step );
+    BOOST_REQUIRE( ex_put_time( exodusFileId, step + 1, &time ) >= 0 );
+    std::vector< double > values( 2 * kTransientHexes );
+    for ( int hex = 0; hex < 2 * kTransientHexes; ++hex ) {
+      values[ hex ] = transientTemperature( step, hex );
+    }
+    BOOST_REQUIRE( ex_put_var( exodusFileId, step + 1, EX_ELEM_BLOCK, 1, kTransientBlockId,
+      kTransientHexes, &values[0] ) >= 0 );
+    BOOST_REQUIRE( ex_put_var( exodusFileId, step + 1, EX_ELEM_BLOCK, 1,
+      kTransientSecondBlockId, kTransientHexes, &values[ kTransientHexes ] ) >= 0 );
+  }
+  ex_close( exodusFileId );
+}
+
+BOOST_AUTO_TEST_CASE( timeSteps ) {
+  xdm::FileSystemPath path( "ExodusReader.timeSteps.exo" );
+  writeTransientFile( path );
+
+  xdmExodus::ExodusReader reader;
+  BOOST_CHECK_EQUAL( std::size_t( kTransientSteps ), reader.numberOfTimeSteps( path ) );
+  xdm::RefPtr< xdmGrid::Domain > domain =
+    xdm::dynamic_pointer_cast< xdmGrid::Domain >( reader.readItem( path ) );
+  BOOST_REQUIRE( domain );
+  xdm::RefPtr< xdmGrid::Grid > grid = xdm::child< xdmGrid::Grid >( *domain, 0 );
+  for ( int step = 0; step < kTransientSteps; ++step ) {
+    BOOST_CHECK( reader.update( domain, path, step ) );
+    BOOST_REQUIRE( grid->time() );
+    BOOST_CHECK_EQUAL( transientTime( step ), grid->time()->value() );
+  }
+  // There is no step past the last one.
+  BOOST_CHECK( ! reader.update( domain, path, kTransientSteps ) );
+
+  grid.reset();
+  domain.reset();
+  reader.closeFiles();
+  xdm::remove( path );
+}
+
+BOOST_AUTO_TEST_CASE( variableHistory ) {
+  xdm::FileSystemPath path( "ExodusReader.variableHistory.exo" );
+  writeTransientFile( path );
+
+  xdmExodus::ExodusReader reader;
+  std::vector< double > history =
+    reader.readVariableHistory( path, EX_ELEM_BLOCK, 1, kTransientBlockId, 1, 0, kTransientSteps );
+  BOOST_REQUIRE_EQUAL( std::size_t( kTransientSteps ), history.size() );
+  for ( int step = 0; step < kTransientSteps; ++step ) {
+    BOOST_CHECK_EQUAL( transientTemperature( step, 1 ), history[ step ] );
+  }
+
+  // The histories of several entries over the last steps, in the order of the entries.
+  std::vector< std::size_t > entries;
+  entries.push_back( 1 );
+  entries.push_back( 0 );
+  std::vector< double > histories =
+    reader.readVariableHistories( path, EX_ELEM_BLOCK, 1, kTransientBlockId, entries, 1, 3 );
+  BOOST_REQUIRE_EQUAL( 4u, histories.size() );
+  BOOST_CHECK_EQUAL( transientTemperature( 1, 1 ), histories[0] );
+  BOOST_CHECK_EQUAL( transientTemperature( 2, 1 ), histories[1] );
+  BOOST_CHECK_EQUAL( transientTemperature( 1, 0 ), histories[2] );
+  BOOST_CHECK_EQUAL( transientTemperature( 2, 0 ), histories[3] );
+
+  // The entries of the second block follow those of the first one in the file.
+  history = reader.readVariableHistory(
+    path, EX_ELEM_BLOCK, 1, kTransientSecondBlockId, 1, 0, kTransientSteps );
+  BOOST_REQUIRE_EQUAL( std::size_t( kTransientSteps ), history.size() );
+  for ( int step = 0; step < kTransientSteps; ++step ) {
+    BOOST_CHECK_EQUAL( transientTemperature( step, kTransientHexes + 1 ), history[ step ] );
+  }
+  histories = reader.readVariableHistories(
+    path, EX_ELEM_BLOCK, 1, kTransientSecondBlockId, entries, 2, 3 );
+  BOOST_REQUIRE_EQUAL( 2u, histories.size() );
+  BOOST_CHECK_EQUAL( transientTemperature( 2, kTransientHexes + 1 ), histories[0] );
+  BOOST_CHECK_EQUAL( transientTemperature( 2, kTransientHexes ), histories[1] );
+
+  BOOST_CHECK_THROW(
+    reader.readVariableHistory(
+      path, EX_ELEM_BLOCK, 1, kTransientBlockId, 0, 0, kTransientSteps + 1 ),
+    std::runtime_error );
+
+  reader.closeFiles();
+  xdm::remove( path );
+}
+
+// Find the items of a type in a tree, in tree order.
+template< typename T >
+class FindItemsVisitor : public xdm::ItemVisitor {
+public:
+  FindItemsVisitor() : mItems() {}
+
+  virtual void apply( xdm::Item& item ) {
+    if ( T* found = dynamic_cast< T* >( &item ) ) {
+      mItems.push_back( found );
+    }
+    traverse( item );
+  }
+
+  std::vector< T* > mItems;
+};
+
+BOOST_AUTO_TEST_CASE( lazyVariableRead ) {
+  xdm::FileSystemPath path( "ExodusReader.lazyVariableRead.exo" );
+  writeTransientFile( path );
+
+  xdmExodus::ExodusReader reader;
+  xdm::RefPtr< xdm::Item > item = reader.readItem( path );
+  FindItemsVisitor< xdmExodus::Block > blocks;
+  item->accept( blocks );
+  BOOST_REQUIRE_EQUAL( 2u, blocks.mItems.size() );
+  std::vector< xdm::RefPtr< xdmExodus::Variable > > variables = blocks.mItems[0]->variables();
+  BOOST_REQUIRE_EQUAL( 1u, variables.size() );
+  BOOST_CHECK_EQUAL( "temperature", variables[0]->name() );
+  xdm::RefPtr< xdmExodus::VariableData > data =
+    xdm::dynamic_pointer_cast< xdmExodus::VariableData >( variables[0]->dataItem()->data() );
+  BOOST_REQUIRE( data );
+
+  // Selecting a step reads nothing until the values are requested.
+  for ( int step = kTransientSteps - 1; step >= 0; --step ) {
+    BOOST_REQUIRE( reader.update( item, path, step ) );
+    BOOST_CHECK( ! data->isLoaded() );
+    xdm::RefPtr< const xdm::TypedStructuredArray< double > > values =
+      variables[0]->dataItem()->typedArray< double >();
+    BOOST_CHECK( data->isLoaded() );
+    BOOST_REQUIRE_EQUAL( std::size_t( kTransientHexes ), values->size() );
+    for ( int hex = 0; hex < kTransientHexes; ++hex ) {
+      BOOST_CHECK_EQUAL( transientTemperature( step, hex ), values->begin()[ hex ] );
+    }
+  }
+
+  item.reset();
+  reader.closeFiles();
+  xdm::remove( path );
+}
+
+BOOST_AUTO_TEST_CASE( lazySetRead ) {
+  xdm::FileSystemPath path( "ExodusReader.lazySetRead.exo" );
+  writeTransientFile( path );
+
+  xdmExodus::ExodusReader reader;
+  xdm::RefPtr< xdm::Item > item = reader.readItem( path );
+  FindItemsVisitor< xdmExodus::NodeSet > nodeSets;
+  item->accept( nodeSets );
+  BOOST_REQUIRE_EQUAL( 1u, nodeSets.mItems.size() );
+  xdmExodus::NodeSet& nodeSet = *nodeSets.mItems[0];
+  BOOST_CHECK_EQUAL( kTransientNodeSetId, nodeSet.id() );
+  BOOST_CHECK_EQUAL( std::size_t( kTransientNodeSetSize ), nodeSet.numberOfEntries() );
+  BOOST_CHECK( ! nodeSet.extraFlags() );
+
+  // Reading the file reads only the sizes of the set.
+  xdm::RefPtr< xdmExodus::SetEntryData > entryData =
+    xdm::dynamic_pointer_cast< xdmExodus::SetEntryData >( nodeSet.entries()->data() );
+  BOOST_REQUIRE( entryData );
+  BOOST_REQUIRE( nodeSet.distributionFactors() );
+  xdm::RefPtr< xdmExodus::DistributionFactorData > factorData =
+    xdm::dynamic_pointer_cast< xdmExodus::DistributionFactorData >(
+      nodeSet.distributionFactors()->data() );
+  BOOST_REQUIRE( factorData );
+  BOOST_CHECK( ! entryData->isLoaded() );
+  BOOST_CHECK( ! factorData->isLoaded() );
+
+  // The entries are read without the factors, and shifted to zero-based indices.
+  xdm::RefPtr< const xdm::TypedStructuredArray< int > > entries =
+    nodeSet.entries()->typedArray< int >();
+  BOOST_CHECK( entryData->isLoaded() );
+  BOOST_CHECK( ! factorData->isLoaded() );
+  BOOST_REQUIRE_EQUAL( std::size_t( kTransientNodeSetSize ), entries->size() );
+  for ( int entry = 0; entry < kTransientNodeSetSize; ++entry ) {
+    BOOST_CHECK_EQUAL( kTransientNodeSet[ entry ], entries->begin()[ entry ] );
+  }
+
+  xdm::RefPtr< const xdm::TypedStructuredArray< double > > factors =
+    nodeSet.distributionFactors()->typedArray< double >();
+  BOOST_CHECK( factorData->isLoaded() );
+  BOOST_REQUIRE_EQUAL( std::size_t( kTransientNodeSetSize ), factors->size() );
+  for ( int entry = 0; entry < kTransientNodeSetSize; ++entry ) {
+    BOOST_CHECK_EQUAL( nodeSetFactor( entry ), factors->begin()[ entry ] );
+  }
+
+  // The set refers to the grid of all of the nodes.
+  BOOST_REQUIRE( nodeSet.referencedGrid() );
+  BOOST_CHECK_EQUAL( "nodes", nodeSet.referencedGrid()->name() );
+
+  // A side set has the sides as extra flags and no distribution factors.
+  FindItemsVisitor< xdmExodus::SideSet > sideSets;
+  item->accept( sideSets );
+  BOOST_REQUIRE_EQUAL( 1u, sideSets.mItems.size() );
+  xdmExodus::SideSet& sideSet = *sideSets.mItems[0];
+  BOOST_CHECK_EQUAL( kTransientSideSetId, sideSet.id() );
+  BOOST_CHECK( ! sideSet.distributionFactors() );
+  BOOST_REQUIRE( sideSet.extraFlags() );
+  xdm::RefPtr< xdmExodus::SetEntryData > flagData =
+    xdm::dynamic_pointer_cast< xdmExodus::SetEntryData >( sideSet.extraFlags()->data() );
+  BOOST_REQUIRE( flagData );
+  BOOST_CHECK( ! flagData->isLoaded() );
+  xdm::RefPtr< const xdm::TypedStructuredArray< int > > elements =
+    sideSet.entries()->typedArray< int >();
+  xdm::RefPtr< const xdm::TypedStructuredArray< int > > sides =
+    sideSet.extraFlags()->typedArray< int >();
+  BOOST_CHECK( flagData->isLoaded() );
+  BOOST_REQUIRE_EQUAL( std::size_t( kTransientSideSetSize ), elements->size() );
+  BOOST_REQUIRE_EQUAL( std::size_t( kTransientSideSetSize ), sides->size() );
+  for ( int entry = 0; entry < kTransientSideSetSize; ++entry ) {
+    BOOST_CHECK_EQUAL( kTransientSideSetElements[ entry ], elements->begin()[ entry ] );
+    BOOST_CHECK_EQUAL( kTransientSideSetSides[ entry ], sides->begin()[ entry ] );
+  }
+  BOOST_REQUIRE( sideSet.referencedGrid() );
+  BOOST_CHECK_EQUAL( "elementBlocks", sideSet.referencedGrid()->name() );
+
+  // The sets are kept in a collection of their own, so the elements of the spatial
+  // collection are only the nodes and the hexahedra.
+  xdm::RefPtr< xdmGrid::Domain > domain = xdm::dynamic_pointer_cast< xdmGrid::Domain >( item );
+  BOOST_REQUIRE( domain );
+  BOOST_REQUIRE_EQUAL( 2u,
+    domain->xdm::ObjectCompositionMixin< xdmGrid::Grid >::numberOfChildren() );
+  xdm::RefPtr< xdmGrid::Grid > spatialCollection = xdm::child< xdmGrid::Grid >( *domain, 0 );
+  BOOST_CHECK_EQUAL(
+    std::size_t( kTransientNodes + 2 * kTransientHexes ), spatialCollection->numberOfElements() );
+  xdm::RefPtr< xdmGrid::Grid > setCollection = xdm::child< xdmGrid::Grid >( *domain, 1 );
+  BOOST_CHECK_EQUAL( "sets", setCollection->name() );
+  BOOST_CHECK_EQUAL( std::size_t( kTransientNodeSetSize + kTransientSideSetSize ),
+    setCollection->numberOfElements() );
+
+  item.reset();
+  reader.closeFiles();
+  xdm::remove( path );
+}
+
+BOOST_AUTO_TEST_CASE( setContains ) {
+  xdm::FileSystemPath path( "ExodusReader.setContains.exo" );
+  writeTransientFile( path );
+
+  xdmExodus::ExodusReader reader;
+  xdm::RefPtr< xdm::Item > item = reader.readItem( path );
+  FindItemsVisitor< xdmExodus::NodeSet > nodeSets;
+  item->accept( nodeSets );
+  BOOST_REQUIRE_EQUAL( 1u, nodeSets.mItems.size() );
+  xdmExodus::NodeSet& nodeSet = *nodeSets.mItems[0];
+
+  xdm::RefPtr< xdmExodus::SetEntryData > entryData =
+    xdm::dynamic_pointer_cast< xdmExodus::SetEntryData >( nodeSet.entries()->data() );
+  BOOST_REQUIRE( entryData );
+
+  // Check every node and the ones around the runs, before and after the runs are built.
+  for ( int pass = 0; pass < 2; ++pass ) {
+    for ( int node = 0; node < kTransientNodes + 2; ++node ) {
+      const bool expected = std::find( kTransientNodeSet,
+        kTransientNodeSet + kTransientNodeSetSize, node ) !=
+        kTransientNodeSet + kTransientNodeSetSize;
+      BOOST_CHECK_EQUAL( expected, nodeSet.contains( node ) );
+    }
+    // Only the runs are kept, and the entries can still be read again.
+    BOOST_CHECK( ! entryData->isLoaded() );
+  }
+  xdm::RefPtr< const xdm::TypedStructuredArray< int > > entries =
+    nodeSet.entries()->typedArray< int >();
+  BOOST_REQUIRE_EQUAL( std::size_t( kTransientNodeSetSize ), entries->size() );
+  BOOST_CHECK( std::equal( kTransientNodeSet, kTransientNodeSet + kTransientNodeSetSize,
+    entries->begin() ) );
+
+  // An empty set contains nothing.
+  xdmExodus::NodeSet emptySet;
+  BOOST_CHECK( ! emptySet.contains( 0 ) );
+
+  item.reset();
+  reader.closeFiles();
+  xdm::remove( path );
+}
+
+BOOST_AUTO_TEST_CASE( lazyMapRead ) {
+  xdm::FileSystemPath path( "ExodusReader.lazyMapRead.exo" );
+  writeTransientFile( path );
+
+  xdmExodus::ExodusReader reader;
+  xdm::RefPtr< xdm::Item > item = reader.readItem( path );
+  FindItemsVisitor< xdmExodus::NodeMap > maps;
+  item->accept( maps );
+  BOOST_REQUIRE_EQUAL( 1u, maps.mItems.size() );
+  xdmExodus::NodeMap& map = *maps.mItems[0];
+  BOOST_CHECK_EQUAL( kTransientNodeMapId, map.id() );
+  BOOST_CHECK_EQUAL( xdmGrid::Attribute::kNode, map.centering() );
+
+  BOOST_REQUIRE_EQUAL( std::size_t( kTransientNodes ), map.numberOfEntries() );
+  xdm::RefPtr< xdmExodus::MapData > data =
+    xdm::dynamic_pointer_cast< xdmExodus::MapData >( map.dataItem()->data() );
+  BOOST_REQUIRE( data );
+  BOOST_CHECK( ! data->isLoaded() );
+  xdm::RefPtr< const xdm::TypedStructuredArray< int > > ids =
+    map.dataItem()->typedArray< int >();
+  BOOST_CHECK( data->isLoaded() );
+  BOOST_REQUIRE_EQUAL( std::size_t( kTransientNodes ), ids->size() );
+  for ( int node = 0; node < kTransientNodes; ++node ) {
+    BOOST_CHECK_EQUAL( nodeMapId( node ), ids->begin()[ node ] );
+  }
+
+  item.reset();
+  reader.closeFiles();
+  xdm::remove( path );
+}
+
+// Values whose read always fails.
+class FailingData : public xdmExodus::ExodusData< double > {
+public:
+  FailingData( xdm::RefPtr< xdmExodus::ReadableExodusFile > file ) :
+    xdmExodus::ExodusData< double >( file, 3 ) {}
+
+protected:
+  virtual void readValues( int, double*, std::size_t ) const {
+    throw std::invalid_argument( "The values could not be read." );
+  }
+};
+
+BOOST_AUTO_TEST_CASE( lazyReadError ) {
+  xdm::FileSystemPath path( "ExodusReader.lazyReadError.exo" );
+  writeTransientFile( path );
+
+  xdm::RefPtr< FailingData > data(
+    new FailingData( xdm::makeRefPtr( new xdmExodus::ReadableExodusFile( path ) ) ) );
+  // The exception leaves the serialized read with its own type where the compiler can carry
+  // it out.
+#if __cplusplus >= 201103L
+  BOOST_CHECK_THROW( data->array(), std::invalid_argument );
+#else
+  BOOST_CHECK_THROW( data->array(), std::runtime_error );
+#endif
+  BOOST_CHECK( ! data->isLoaded() );
+
+  data.reset();
+  xdm::remove( path );
+}
+
+// Write an Exodus file holding a row of hexahedra split into many small element blocks. The
+// last block may be given another element type.
+void writeManyBlockFile(
+  const xdm::FileSystemPath& path,
+  int numberOfBlocks,
+  int hexesPerBlock,
+  const char* lastBlockType = "HEX8" ) {
+
+  int wordSize = sizeof( double );
+  int exodusFileId = ex_create( path.pathString().c_str(), EX_CLOBBER, &wordSize, &wordSize );
+  BOOST_REQUIRE( exodusFileId >= 0 );
+
+  const int numberOfHexes = numberOfBlocks * hexesPerBlock;
+  BOOST_REQUIRE( ex_put_init( exodusFileId, "manyBlocks", 3, 4 * ( numberOfHexes + 1 ),
+    numberOfHexes, numberOfBlocks, 0, 0 ) >= 0 );
+  writeHexRowNodes( exodusFileId, numberOfHexes );
+
+  std::vector< int > connectivity( 8 * hexesPerBlock );
+  for ( int block = 0; block < numberOfBlocks; ++block ) {
+    const char* type = ( block + 1 == numberOfBlocks ) ? lastBlockType : "HEX8";
+    BOOST_REQUIRE( ex_put_block( exodusFileId, EX_ELEM_BLOCK, block + 1, type,
+      hexesPerBlock, 8, 0, 0, 0 ) >= 0 );
+    for ( int hex = 0; hex < hexesPerBlock; ++hex ) {
+      for ( int corner = 0; corner < 8; ++corner ) {
+        connectivity[ 8 * hex + corner ] = hexRowNode( block * hexesPerBlock + hex, corner ) + 1;
+      }
+    }
+    BOOST_REQUIRE( ex_put_conn( exodusFileId, EX_ELEM_BLOCK, block + 1,
+      &connectivity[0], 0, 0 ) >= 0 );
+  }
+  ex_close( exodusFileId );
+}
+
+BOOST_AUTO_TEST_CASE( manyBlocks ) {
+  // Enough blocks that several threads set them up at once.
+  const int kBlocks = 40;
+  const int kHexesPerBlock = 3;
+  xdm::FileSystemPath path( "ExodusReader.manyBlocks.exo" );
+  writeManyBlockFile( path, kBlocks, kHexesPerBlock );
+
+  xdmExodus::ExodusReader reader;
+  xdm::RefPtr< xdm::Item > item = reader.readItem( path );
+  BOOST_REQUIRE( item );
+  FindItemsVisitor< xdmExodus::Block > blocks;
+  item->accept( blocks );
+  BOOST_REQUIRE_EQUAL( std::size_t( kBlocks ), blocks.mItems.size() );
+
+  // The blocks keep the order of the file and share its nodes.
+  for ( int block = 0; block < kBlocks; ++block ) {
+    const xdmExodus::Block& exodusBlock = *blocks.mItems[ block ];
+    BOOST_CHECK_EQUAL( block + 1, exodusBlock.id() );
+    BOOST_CHECK( exodusBlock.geometry() == blocks.mItems[0]->geometry() );
+    BOOST_REQUIRE_EQUAL( std::size_t( kHexesPerBlock ), exodusBlock.numberOfEntries() );
+    BOOST_CHECK_EQUAL(
+      std::size_t( block * kHexesPerBlock ), exodusBlock.entryGlobalOffset() );
+    xdm::RefPtr< const xdmGrid::Topology > topology = exodusBlock.topology();
+    BOOST_CHECK_EQUAL(
+      xdmGrid::ElementShape::Hexahedron, topology->elementTopology( 0 )->shape() );
+    for ( int hex = 0; hex < kHexesPerBlock; ++hex ) {
+      for ( int corner = 0; corner < 8; ++corner ) {
+        BOOST_CHECK_EQUAL( std::size_t( hexRowNode( block * kHexesPerBlock + hex, corner ) ),
+          topology->connection( hex, corner ) );
+      }
+    }
+  }
+
+  item.reset();
+  reader.closeFiles();
+  xdm::remove( path );
+}
+
+BOOST_AUTO_TEST_CASE( unsupportedBlock ) {
+  // An error setting up one block leaves the concurrent setup of the others.
+  xdm::FileSystemPath path( "ExodusReader.unsupportedBlock.exo" );
+  writeManyBlockFile( path, 8, 2, "UNKNOWN8" );
+
+  xdmExodus::ExodusReader reader;
+  BOOST_CHECK_THROW( reader.readItem( path ), std::runtime_error );
+
+  reader.closeFiles();
+  xdm::remove( path );
+}
+
+// Read a file with a new reader and count the entries of its blocks, reporting how long the
+// read took.
+std::size_t timeBlockRead( const xdm::FileSystemPath& path, int threads ) {
+  xdmExodus::ExodusReader reader;
+#ifdef _OPENMP
+  double start = omp_get_wtime();
+#else
+  std::clock_t start = std::clock();
+#endif
+  xdm::RefPtr< xdm::Item > item = reader.readItem( path );
+#ifdef _OPENMP
+  BOOST_TEST_MESSAGE( "Reading the blocks on " << threads << " threads: "
+    << omp_get_wtime() - start << " s" );
+#else
+  BOOST_TEST_MESSAGE( "Reading the blocks on " << threads << " threads: "
+    << std::clock() - start << " clocks" );
+#endif
+
+  FindItemsVisitor< xdmExodus::Block > blocks;
+  item->accept( blocks );
+  std::size_t entries = 0;
+  for ( std::size_t block = 0; block < blocks.mItems.size(); ++block ) {
+    entries += blocks.mItems[ block ]->numberOfEntries();
+  }
+  item.reset();
+  reader.closeFiles();
+  return entries;
+}
+
+BOOST_AUTO_TEST_CASE( manyBlockBenchmark ) {
+  // Compare setting the blocks up on one thread with setting them up on all of them. The
+  // calls into the Exodus library are serialized, so only the work between them, such as
+  // shifting the connectivity and building the topologies, runs in parallel.
+  const int kBlocks = 2000;
+  const int kHexesPerBlock = 10;
+  xdm::FileSystemPath path( "ExodusReader.manyBlockBenchmark.exo" );
+  writeManyBlockFile( path, kBlocks, kHexesPerBlock );
+
+#ifdef _OPENMP
+  const int threads = omp_get_max_threads();
+  omp_set_num_threads( 1 );
+  BOOST_CHECK_EQUAL( std::size_t( kBlocks * kHexesPerBlock ), timeBlockRead( path, 1 ) );
+  omp_set_num_threads( threads );
+  BOOST_CHECK_EQUAL( std::size_t( kBlocks * kHexesPerBlock ), timeBlockRead( path, threads ) );
+#else
+  BOOST_CHECK_EQUAL( std::size_t( kBlocks * kHexesPerBlock ), timeBlockRead( path, 1 ) );
+#endif
+
+  xdm::remove( path );
+}
+
 } // namespace
 
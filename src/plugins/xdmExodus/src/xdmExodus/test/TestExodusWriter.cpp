@@ -0,0 +1,395 @@
+//==============================================================================
+// This software developed by Stellar Science Ltd Co and the U.S. Government.
+// Copyright (C) 2010 Stellar Science. Government-purpose rights granted.
+//
+// This file is part of XDM
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+#define BOOST_TEST_MODULE ExodusWriter
+#include <boost/test/unit_test.hpp>
+
+#include <xdmExodus/Blocks.hpp>
+#include <xdmExodus/Helpers.hpp>
+#include <xdmExodus/ObjectRegistry.hpp>
+#include <xdmExodus/Reader.hpp>
+#include <xdmExodus/Variable.hpp>
+#include <xdmExodus/Writer.hpp>
+
+#include <xdmGrid/Attribute.hpp>
+#include <xdmGrid/CollectionGrid.hpp>
+#include <xdmGrid/Domain.hpp>
+#include <xdmGrid/ElementTopology.hpp>
+#include <xdmGrid/MultiArrayGeometry.hpp>
+#include <xdmGrid/Time.hpp>
+#include <xdmGrid/UniformGrid.hpp>
+#include <xdmGrid/UnstructuredTopology.hpp>
+
+#include <xdmFormat/IoExcept.hpp>
+
+#include <xdm/FileSystem.hpp>
+#include <xdm/TypedStructuredArray.hpp>
+#include <xdm/UniformDataItem.hpp>
+#include <xdm/VectorStructuredArray.hpp>
+
+#include <vector>
+
+namespace {
+
+// The tree written by the tests holds a single block of hexahedra in a row along x. Each
+// slice of 4 nodes is shared by the hexes on either side of it.
+const int kHexes = 2;
+const int kNodes = 4 * ( kHexes + 1 );
+const int kBlockId = 10;
+
+double nodeCoordinate( int node, int dimension ) {
+  const int corner = node % 4;
+  switch ( dimension ) {
+    case 0:
+      return node / 4;
+    case 1:
+      return ( corner == 1 || corner == 2 ) ? 1.0 : 0.0;
+    default:
+      return ( corner > 1 ) ? 1.0 : 0.0;
+  }
+}
+
+xdm::RefPtr< xdmExodus::Block > buildHexBlock() {
+  xdm::RefPtr< xdmGrid::MultiArrayGeometry > geometry( new xdmGrid::MultiArrayGeometry( 3 ) );
+  for ( int dim = 0; dim < 3; ++dim ) {
+    xdm::RefPtr< xdm::VectorStructuredArray< double > > values(
+      new xdm::VectorStructuredArray< double >( kNodes ) );
+    for ( int node = 0; node < kNodes; ++node ) {
+      (*values)[ node ] = nodeCoordinate( node, dim );
+    }
+    geometry->setCoordinateValues(
+      dim, xdmExodus::makeDataItem( values, xdm::primitiveType::kDouble, kNodes ) );
+  }
+
+  xdm::RefPtr< xdm::VectorStructuredArray< int > > connectivity(
+    new xdm::VectorStructuredArray< int >( 8 * kHexes ) );
+  for ( int hex = 0; hex < kHexes; ++hex ) {
+    for ( int corner = 0; corner < 8; ++corner ) {
+      (*connectivity)[ 8 * hex + corner ] = 4 * ( hex + corner / 4 ) + corner % 4;
+    }
+  }
+  xdm::RefPtr< xdmGrid::UnstructuredTopology > topology( new xdmGrid::UnstructuredTopology );
+  topology->setConnectivity(
+    xdmExodus::makeDataItem( connectivity, xdm::primitiveType::kInt, kHexes, 8 ) );
+  topology->setNumberOfElements( kHexes );
+  topology->setElementTopology(
+    xdmGrid::elementFactory( xdmGrid::ElementShape::Hexahedron, 1 ) );
+  topology->setNodeOrdering( xdmGrid::NodeOrderingConvention::ExodusII );
+
+  xdm::RefPtr< xdmExodus::Block > block = xdmExodus::blockFactory( EX_ELEM_BLOCK );
+  block->setId( kBlockId );
+  block->setName( "hexes" );
+  block->setGeometry( geometry );
+  block->setTopology( topology );
+  return block;
+}
+
+xdm::RefPtr< xdmGrid::Domain > buildTree( xdm::RefPtr< xdmExodus::Block > block ) {
+  xdm::RefPtr< xdmGrid::Domain > domain( new xdmGrid::Domain );
+  xdm::RefPtr< xdmGrid::CollectionGrid > collection( new xdmGrid::CollectionGrid );
+  collection->setName( "hexRow" );
+  collection->appendGrid( block );
+  domain->addGrid( collection );
+  return domain;
+}
+
+BOOST_AUTO_TEST_CASE( updateInterval ) {
+  xdmExodus::ExodusWriter writer;
+  BOOST_CHECK_EQUAL( xdmExodus::ExodusWriter::kDefaultUpdateInterval, writer.updateInterval() );
+  writer.setUpdateInterval( 0 );
+  BOOST_CHECK_EQUAL( 0u, writer.updateInterval() );
+}
+
+BOOST_AUTO_TEST_CASE( writeBeforeOpen ) {
+  xdmExodus::ExodusWriter writer;
+  xdm::RefPtr< xdm::Item > grid( new xdmGrid::UniformGrid );
+  BOOST_CHECK_THROW( writer.write( grid, 0 ), xdmFormat::WriteError );
+  // Closing a series that was never opened does nothing.
+  writer.close();
+}
+
+BOOST_AUTO_TEST_CASE( emptySeries ) {
+  // A tree without blocks leaves an empty file and writes no steps.
+  xdm::FileSystemPath path( "ExodusWriter.emptySeries.exo" );
+  xdmExodus::ExodusWriter writer;
+  writer.open( path, xdm::Dataset::kCreate );
+  xdm::RefPtr< xdm::Item > grid( new xdmGrid::UniformGrid );
+  writer.write( grid, 0 );
+  writer.write( grid, 1 );
+  writer.close();
+  BOOST_CHECK( xdm::exists( path ) );
+  xdm::remove( path );
+}
+
+BOOST_AUTO_TEST_CASE( coordinates ) {
+  // The coordinates are written after the database is initialized, and read back intact.
+  xdm::FileSystemPath path( "ExodusWriter.coordinates.exo" );
+  xdmExodus::ExodusWriter writer;
+  writer.writeItem( buildTree( buildHexBlock() ), path );
+
+  xdmExodus::ExodusReader reader;
+  BOOST_REQUIRE_EQUAL( std::size_t( kNodes ), reader.numberOfNodes( path ) );
+  BOOST_REQUIRE_EQUAL( 3u, reader.dimension( path ) );
+  std::vector< double > x( kNodes ), y( kNodes ), z( kNodes );
+  reader.readCoordinates( path, 0, kNodes, &x[0], &y[0], &z[0] );
+  for ( int node = 0; node < kNodes; ++node ) {
+    BOOST_CHECK_EQUAL( nodeCoordinate( node, 0 ), x[ node ] );
+    BOOST_CHECK_EQUAL( nodeCoordinate( node, 1 ), y[ node ] );
+    BOOST_CHECK_EQUAL( nodeCoordinate( node, 2 ), z[ node ] );
+  }
+
+  // A range of nodes, interlaced.
+  std::vector< double > xyz( 3 * 5 );
+  reader.readInterlacedCoordinates( path, 3, 5, &xyz[0] );
+  for ( int node = 0; node < 5; ++node ) {
+    for ( int dim = 0; dim < 3; ++dim ) {
+      BOOST_CHECK_EQUAL( nodeCoordinate( node + 3, dim ), xyz[ 3 * node + dim ] );
+    }
+  }
+  BOOST_CHECK_THROW(
+    reader.readCoordinates( path, kNodes - 1, 2, &x[0], &y[0], &z[0] ), std::runtime_error );
+
+  reader.closeFiles();
+  xdm::remove( path );
+}
+
+BOOST_AUTO_TEST_CASE( connectivity ) {
+  // The int connectivity of a block is written with Exodus numbering and left zero-based.
+  xdm::FileSystemPath path( "ExodusWriter.connectivity.exo" );
+  xdm::RefPtr< xdmExodus::Block > block = buildHexBlock();
+  xdmExodus::ExodusWriter writer;
+  writer.writeItem( buildTree( block ), path );
+
+  xdmExodus::ExodusReader reader;
+  xdmExodus::ObjectRegistry registry;
+  registry.gather( reader.readItem( path ) );
+  const std::vector< xdmExodus::Object* >& blocks = registry.objects( EX_ELEM_BLOCK );
+  BOOST_REQUIRE_EQUAL( 1u, blocks.size() );
+  xdmExodus::Block* readBlock = dynamic_cast< xdmExodus::Block* >( blocks[0] );
+  BOOST_REQUIRE( readBlock );
+  for ( int hex = 0; hex < kHexes; ++hex ) {
+    for ( int corner = 0; corner < 8; ++corner ) {
+      const std::size_t node = 4 * ( hex + corner / 4 ) + corner % 4;
+      BOOST_CHECK_EQUAL( node, block->topology()->connection( hex, corner ) );
+      BOOST_CHECK_EQUAL( node, readBlock->topology()->connection( hex, corner ) );
+    }
+  }
+
+  registry.clear();
+  reader.closeFiles();
+  xdm::remove( path );
+}
+
+BOOST_AUTO_TEST_CASE( attributesAndEmptyBlock ) {
+  xdm::FileSystemPath path( "ExodusWriter.attributesAndEmptyBlock.exo" );
+  xdm::RefPtr< xdmExodus::Block > hexes = buildHexBlock();
+  xdm::RefPtr< xdm::VectorStructuredArray< double > > thickness(
+    new xdm::VectorStructuredArray< double >( kHexes ) );
+  (*thickness)[0] = 0.25;
+  (*thickness)[1] = 0.75;
+  xdm::RefPtr< xdmGrid::Attribute > attribute(
+    new xdmGrid::Attribute( xdmGrid::Attribute::kScalar, xdmGrid::Attribute::kElement ) );
+  attribute->setName( "thickness" );
+  attribute->setDataItem(
+    xdmExodus::makeDataItem( thickness, xdm::primitiveType::kDouble, kHexes ) );
+  hexes->addAttribute( attribute );
+  hexes->addVariable( xdm::makeRefPtr(
+    new xdmExodus::Variable( EX_ELEM_BLOCK, 1, kBlockId, kHexes ) ) );
+  hexes->setTime( xdm::makeRefPtr( new xdmGrid::Time( 1.0 ) ) );
+
+  // The Exodus attributes of a block leave out its variables.
+  std::vector< xdm::RefPtr< xdmGrid::Attribute > > attributes = hexes->attributes();
+  BOOST_REQUIRE_EQUAL( 1u, attributes.size() );
+  BOOST_CHECK( attributes[0] == attribute );
+
+  // A block without entries has no element type or connectivity.
+  xdm::RefPtr< xdmGrid::UnstructuredTopology > noElements( new xdmGrid::UnstructuredTopology );
+  noElements->setNumberOfElements( 0 );
+  xdm::RefPtr< xdmExodus::Block > empty = xdmExodus::blockFactory( EX_ELEM_BLOCK );
+  empty->setId( kBlockId + 1 );
+  empty->setName( "empty" );
+  empty->setTopology( noElements );
+
+  xdm::RefPtr< xdmGrid::Domain > domain( new xdmGrid::Domain );
+  xdm::RefPtr< xdmGrid::CollectionGrid > collection( new xdmGrid::CollectionGrid );
+  collection->appendGrid( hexes );
+  collection->appendGrid( empty );
+  domain->addGrid( collection );
+  xdmExodus::ExodusWriter writer;
+  writer.writeItem( domain, path );
+
+  xdmExodus::ExodusReader reader;
+  xdmExodus::ObjectRegistry registry;
+  registry.gather( reader.readItem( path ) );
+  const std::vector< xdmExodus::Object* >& blocks = registry.objects( EX_ELEM_BLOCK );
+  BOOST_REQUIRE_EQUAL( 2u, blocks.size() );
+  xdmExodus::Block* readHexes = dynamic_cast< xdmExodus::Block* >( blocks[0] );
+  xdmExodus::Block* readEmpty = dynamic_cast< xdmExodus::Block* >( blocks[1] );
+  BOOST_REQUIRE( readHexes && readEmpty );
+  BOOST_CHECK_EQUAL( std::size_t( kHexes ), readHexes->numberOfEntries() );
+  BOOST_CHECK_EQUAL( 0u, readEmpty->numberOfEntries() );
+  BOOST_CHECK_EQUAL( "empty", readEmpty->name() );
+
+  attributes = readHexes->attributes();
+  BOOST_REQUIRE_EQUAL( 1u, attributes.size() );
+  BOOST_CHECK_EQUAL( "thickness", attributes[0]->name() );
+  xdm::RefPtr< const xdm::TypedStructuredArray< double > > values =
+    attributes[0]->dataItem()->typedArray< double >();
+  BOOST_REQUIRE_EQUAL( std::size_t( kHexes ), values->size() );
+  BOOST_CHECK_EQUAL( 0.25, values->begin()[0] );
+  BOOST_CHECK_EQUAL( 0.75, values->begin()[1] );
+
+  registry.clear();
+  reader.closeFiles();
+  xdm::remove( path );
+}
+
+double stepTime( std::size_t step ) {
+  return 0.5 * step;
+}
+
+double temperature( std::size_t step, int hex ) {
+  return 10.0 * step + hex + 0.5;
+}
+
+// Add an element variable to a block.
+xdm::RefPtr< xdmExodus::Variable > addTemperature( xdm::RefPtr< xdmExodus::Block > block ) {
+  xdm::RefPtr< xdmExodus::Variable > variable(
+    new xdmExodus::Variable( EX_ELEM_BLOCK, 1, kBlockId, kHexes ) );
+  variable->setName( "temperature" );
+  block->addVariable( variable );
+  return variable;
+}
+
+// Set the time and the variable values of a block to those of a step.
+void setStep(
+  xdm::RefPtr< xdmExodus::Block > block,
+  xdm::RefPtr< xdmExodus::Variable > variable,
+  std::size_t step ) {
+
+  block->setTime( xdm::makeRefPtr( new xdmGrid::Time( stepTime( step ) ) ) );
+  double* values = variable->dataItem()->typedArray< double >()->begin();
+  for ( int hex = 0; hex < kHexes; ++hex ) {
+    values[ hex ] = temperature( step, hex );
+  }
+}
+
+// Write the steps [firstStep, endStep) of a block with an element variable through update().
+void updateSteps(
+  xdmExodus::ExodusWriter& writer,
+  const xdm::FileSystemPath& path,
+  std::size_t firstStep,
+  std::size_t endStep ) {
+
+  xdm::RefPtr< xdmExodus::Block > block = buildHexBlock();
+  xdm::RefPtr< xdmExodus::Variable > variable = addTemperature( block );
+  xdm::RefPtr< xdmGrid::Domain > domain = buildTree( block );
+
+  for ( std::size_t step = firstStep; step < endStep; ++step ) {
+    setStep( block, variable, step );
+    BOOST_CHECK( writer.update( domain, path, step ) );
+  }
+}
+
+// Check the steps of a file written by updateSteps.
+void checkSteps( const xdm::FileSystemPath& path, std::size_t numberOfSteps ) {
+  xdmExodus::ExodusReader reader;
+  BOOST_REQUIRE_EQUAL( numberOfSteps, reader.numberOfTimeSteps( path ) );
+  for ( int hex = 0; hex < kHexes; ++hex ) {
+    std::vector< double > history =
+      reader.readVariableHistory( path, EX_ELEM_BLOCK, 1, kBlockId, hex, 0, numberOfSteps );
+    for ( std::size_t step = 0; step < numberOfSteps; ++step ) {
+      BOOST_CHECK_EQUAL( temperature( step, hex ), history[ step ] );
+    }
+  }
+
+  xdm::RefPtr< xdm::Item > item = reader.readItem( path );
+  for ( std::size_t step = 0; step < numberOfSteps; ++step ) {
+    BOOST_REQUIRE( reader.update( item, path, step ) );
+    xdm::RefPtr< xdmGrid::Domain > domain = xdm::dynamic_pointer_cast< xdmGrid::Domain >( item );
+    BOOST_REQUIRE( domain );
+    xdm::RefPtr< xdmGrid::Grid > grid = xdm::child< xdmGrid::Grid >( *domain, 0 );
+    BOOST_REQUIRE( grid->time() );
+    BOOST_CHECK_EQUAL( stepTime( step ), grid->time()->value() );
+  }
+  item.reset();
+  reader.closeFiles();
+}
+
+BOOST_AUTO_TEST_CASE( roundTrip ) {
+  xdm::FileSystemPath path( "ExodusWriter.roundTrip.exo" );
+
+  // A file left at the path by an earlier run is replaced by the first update, rather than
+  // having its steps overwritten in place.
+  {
+    xdmExodus::ExodusWriter writer;
+    updateSteps( writer, path, 0, 5 );
+  }
+  checkSteps( path, 5 );
+
+  xdmExodus::ExodusWriter writer;
+  writer.setUpdateInterval( 2 );
+  updateSteps( writer, path, 0, 3 );
+  writer.close();
+  checkSteps( path, 3 );
+
+  // Steps are appended to an existing file when it is opened for that explicitly.
+  writer.open( path, xdm::Dataset::kModify );
+  updateSteps( writer, path, 3, 4 );
+  writer.close();
+  checkSteps( path, 4 );
+
+  xdm::remove( path );
+}
+
+BOOST_AUTO_TEST_CASE( alternatingPaths ) {
+  // Two series updated in turn through one writer, with a single item written between
+  // their steps. Reopening a series for a later step appends to it.
+  const std::size_t kSteps = 4;
+  xdm::FileSystemPath firstPath( "ExodusWriter.alternatingPaths.first.exo" );
+  xdm::FileSystemPath secondPath( "ExodusWriter.alternatingPaths.second.exo" );
+  xdm::FileSystemPath itemPath( "ExodusWriter.alternatingPaths.item.exo" );
+
+  xdm::RefPtr< xdmExodus::Block > firstBlock = buildHexBlock();
+  xdm::RefPtr< xdmExodus::Variable > firstVariable = addTemperature( firstBlock );
+  xdm::RefPtr< xdmGrid::Domain > first = buildTree( firstBlock );
+  xdm::RefPtr< xdmExodus::Block > secondBlock = buildHexBlock();
+  xdm::RefPtr< xdmExodus::Variable > secondVariable = addTemperature( secondBlock );
+  xdm::RefPtr< xdmGrid::Domain > second = buildTree( secondBlock );
+
+  xdmExodus::ExodusWriter writer;
+  for ( std::size_t step = 0; step < kSteps; ++step ) {
+    setStep( firstBlock, firstVariable, step );
+    BOOST_CHECK( writer.update( first, firstPath, step ) );
+    setStep( secondBlock, secondVariable, step );
+    BOOST_CHECK( writer.update( second, secondPath, step ) );
+    writer.writeItem( buildTree( buildHexBlock() ), itemPath );
+  }
+  writer.close();
+
+  checkSteps( firstPath, kSteps );
+  checkSteps( secondPath, kSteps );
+
+  xdm::remove( firstPath );
+  xdm::remove( secondPath );
+  xdm::remove( itemPath );
+}
+
+} // namespace
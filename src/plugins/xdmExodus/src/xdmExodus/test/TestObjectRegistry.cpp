@@ -0,0 +1,71 @@
+//==============================================================================
+// This software developed by Stellar Science Ltd Co and the U.S. Government.
+// Copyright (C) 2010 Stellar Science. Government-purpose rights granted.
+//
+// This file is part of XDM
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+#define BOOST_TEST_MODULE ObjectRegistry
+#include <boost/test/unit_test.hpp>
+
+#include <xdmExodus/Blocks.hpp>
+#include <xdmExodus/ObjectRegistry.hpp>
+
+#include <xdmGrid/CollectionGrid.hpp>
+#include <xdmGrid/Domain.hpp>
+
+#include <exodusII.h>
+
+namespace {
+
+BOOST_AUTO_TEST_CASE( gather ) {
+  xdm::RefPtr< xdmGrid::Domain > domain( new xdmGrid::Domain );
+  xdm::RefPtr< xdmGrid::CollectionGrid > collection( new xdmGrid::CollectionGrid );
+  domain->addGrid( collection );
+  xdm::RefPtr< xdmGrid::CollectionGrid > nested( new xdmGrid::CollectionGrid );
+  collection->appendGrid( nested );
+
+  xdm::RefPtr< xdmExodus::Block > edges = xdmExodus::blockFactory( EX_EDGE_BLOCK );
+  xdm::RefPtr< xdmExodus::Block > elements1 = xdmExodus::blockFactory( EX_ELEM_BLOCK );
+  xdm::RefPtr< xdmExodus::Block > elements2 = xdmExodus::blockFactory( EX_ELEM_BLOCK );
+  collection->appendGrid( elements1 );
+  collection->appendGrid( edges );
+  nested->appendGrid( elements2 );
+  // A block that appears twice is gathered once.
+  nested->appendGrid( elements1 );
+
+  xdmExodus::ObjectRegistry registry;
+  registry.gather( domain );
+  BOOST_CHECK( registry.root() == domain );
+  BOOST_CHECK_EQUAL( 3u, registry.objects().size() );
+  BOOST_CHECK_EQUAL( 5u, registry.grids().size() );
+
+  // Objects are gathered in tree order, so the blocks of the nested collection come first.
+  const std::vector< xdmExodus::Object* >& elementBlocks = registry.objects( EX_ELEM_BLOCK );
+  BOOST_REQUIRE_EQUAL( 2u, elementBlocks.size() );
+  BOOST_CHECK( elementBlocks[0] == elements2.get() );
+  BOOST_CHECK( elementBlocks[1] == elements1.get() );
+  BOOST_REQUIRE_EQUAL( 1u, registry.objects( EX_EDGE_BLOCK ).size() );
+  BOOST_CHECK( registry.objects( EX_EDGE_BLOCK )[0] == edges.get() );
+  BOOST_CHECK( registry.objects( EX_NODE_SET ).empty() );
+
+  registry.clear();
+  BOOST_CHECK( ! registry.root() );
+  BOOST_CHECK( registry.objects().empty() );
+  BOOST_CHECK( registry.grids().empty() );
+}
+
+} // namespace
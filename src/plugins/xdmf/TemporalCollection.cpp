@@ -22,20 +22,52 @@
 
 #include <xdmf/XdmfHelpers.hpp>
 
-#include <xdm/CollectMetadataOperation.hpp>
+#include <xdmf/impl/StreamingNodeVector.hpp>
+
+#include <xdm/FileSystem.hpp>
 #include <xdm/SerializeDataOperation.hpp>
 #include <xdm/ReferencedObject.hpp>
 #include <xdm/RefPtr.hpp>
 #include <xdm/UpdateVisitor.hpp>
+#include <xdm/ThrowMacro.hpp>
 #include <xdm/XmlObject.hpp>
 
+#include <xdmFormat/IoExcept.hpp>
+
 #include <xdmGrid/Domain.hpp>
 #include <xdmGrid/CollectionGrid.hpp>
 
+#include <algorithm>
+#include <sstream>
+
 namespace xdmf {
 
 namespace {
 
+// The XPointer child sequence of the temporal collection Grid within the
+// document written by openTemporalCollection.
+char const * const kCollectionSequence = "/1/1/1";
+
+// The comment recording the number of steps, written before the footers.
+char const * const kStepCountStart = "<!-- Steps: ";
+char const * const kStepCountEnd = " -->\n";
+// Enough room for the step count comment at the end of an existing file.
+const std::size_t kMaximumStepCountLength = 64;
+
+// Parse a step count comment that makes up the whole of the text.
+bool parseStepCount( const std::string& text, std::size_t& numberOfSteps ) {
+  const std::string start( kStepCountStart );
+  const std::string end( kStepCountEnd );
+  if ( text.size() <= start.size() + end.size()
+    || text.compare( 0, start.size(), start ) != 0
+    || text.compare( text.size() - end.size(), end.size(), end ) != 0 ) {
+    return false;
+  }
+  std::istringstream count( text.substr( start.size(), text.size() - start.size() - end.size() ) );
+  count >> numberOfSteps;
+  return count && count.eof();
+}
+
 xdm::RefPtr< xdm::XmlObject > openTemporalCollection() 
 {
   xdm::RefPtr< xdm::XmlObject > xdmf = createXdmfRoot();
@@ -59,20 +91,81 @@ TemporalCollection::TemporalCollection(
   TimeSeries( mode ),
   mFilename( metadataFile ),
   mFileStream(),
-  mXmlStream( mFileStream )
+  mXmlStream( mFileStream ),
+  mMetadataWriter( mFileStream ),
+  mFooters(),
+  mFooterPosition( 0 ),
+  mStepCountPosition( 0 ),
+  mNumberOfSteps( 0 ),
+  mDataBytesWritten( 0 )
 {
+  mMetadataWriter.addIncludeTag( "Topology" );
+  mMetadataWriter.addIncludeTag( "Geometry" );
 }
 
 TemporalCollection::~TemporalCollection()
 {
+  // The XML stream rewrites the footers when it is destroyed, so they must not
+  // land on the step count of a series that was not closed.
+  if ( mFileStream.is_open() ) {
+    mFileStream.seekp( mFooterPosition );
+  }
 }
 
 void TemporalCollection::open() 
 {
-  mFileStream.open( mFilename.c_str(), std::ios::out );
-  mFileStream << "<?xml version='1.0'?>\n";
   xdm::RefPtr< xdm::XmlObject > xdmf = openTemporalCollection();
-  mXmlStream.openContext( xdmf );
+  // Positions are byte offsets, so the file is always opened as binary.
+  if ( mode() == xdm::Dataset::kModify && xdm::exists( xdm::FileSystemPath( mFilename ) ) ) {
+    mFileStream.open( mFilename.c_str(), std::ios::in | std::ios::out | std::ios::binary );
+    mXmlStream.resumeContext( xdmf );
+    std::ostringstream footers;
+    mXmlStream.printFooters( footers );
+    mFooters = footers.str();
+
+    // The file must end with the footers of the collection, which are
+    // preceded by the step count comment.
+    mFileStream.seekg( 0, std::ios::end );
+    std::streamoff size = mFileStream.tellg();
+    std::string end( std::min( std::size_t( size ), mFooters.size() + kMaximumStepCountLength ),
+      ' ' );
+    if ( mFileStream && !end.empty() ) {
+      mFileStream.seekg( size - std::streamoff( end.size() ) );
+      mFileStream.read( &end[0], end.size() );
+    }
+    if ( !mFileStream || end.size() < mFooters.size()
+      || end.compare( end.size() - mFooters.size(), mFooters.size(), mFooters ) != 0 ) {
+      XDM_THROW( xdmFormat::WriteError(
+        "Unable to append to XDMF temporal collection " + mFilename ) );
+    }
+    mFooterPosition = size - mFooters.size();
+
+    // Count the existing steps so that new elements get the right positions.
+    // Files without a step count comment are scanned.
+    end.erase( end.size() - mFooters.size() );
+    std::size_t comment = end.rfind( kStepCountStart );
+    if ( comment != std::string::npos
+      && parseStepCount( end.substr( comment ), mNumberOfSteps ) ) {
+      mStepCountPosition = mFooterPosition - std::streamoff( end.size() - comment );
+    } else {
+      mStepCountPosition = mFooterPosition;
+      mNumberOfSteps = impl::StreamingNodeVector( xdm::FileSystemPath( mFilename ) ).size();
+    }
+    mFileStream.seekp( mStepCountPosition );
+  } else {
+    mFileStream.open( mFilename.c_str(),
+      std::ios::out | std::ios::trunc | std::ios::binary );
+    mFileStream << "<?xml version='1.0'?>\n";
+    mXmlStream.openContext( xdmf );
+    std::ostringstream footers;
+    mXmlStream.printFooters( footers );
+    mFooters = footers.str();
+    mNumberOfSteps = 0;
+    mStepCountPosition = mFileStream.tellp();
+    writeFooters();
+  }
+  mMetadataWriter.clearIncludes();
+  mMetadataWriter.setIndentLevel( int( mXmlStream.contextDepth() ) );
 }
 
 void TemporalCollection::updateGrid( xdm::RefPtr< xdmGrid::Grid > grid, std::size_t step ) {
@@ -82,22 +175,38 @@ void TemporalCollection::updateGrid( xdm::RefPtr< xdmGrid::Grid > grid, std::siz
 }
 
 void TemporalCollection::writeGridMetadata( xdm::RefPtr< xdmGrid::Grid > grid ) {
-  // write the metadata to the stream
-  xdm::CollectMetadataOperation collect;
-  grid->accept( collect );
-  xdm::RefPtr< xdm::XmlObject > xml( collect.result() );
-  mXmlStream.writeObject( xml );
+  // write the metadata to the stream as the next child of the collection.
+  std::ostringstream position;
+  position << kCollectionSequence << '/' << mNumberOfSteps + 1;
+  mMetadataWriter.setRootPosition( position.str() );
+  grid->accept( mMetadataWriter );
+  ++mNumberOfSteps;
+  mStepCountPosition = mFileStream.tellp();
+  writeFooters();
 }
 
 void TemporalCollection::writeGridData( xdm::RefPtr< xdmGrid::Grid > grid ) {
   // serialize the heavy data
   xdm::SerializeDataOperation serializer( mode() );
   grid->accept( serializer );
+  mDataBytesWritten = serializer.bytesWritten();
 }
 
 void TemporalCollection::close()
 {
+  // Keep the step count and rewrite the footers unchanged.
+  mFileStream.seekp( mFooterPosition );
   mXmlStream.closeStream();
+  mFileStream.close();
+}
+
+void TemporalCollection::writeFooters()
+{
+  mFileStream << kStepCountStart << mNumberOfSteps << kStepCountEnd;
+  mFooterPosition = mFileStream.tellp();
+  mFileStream << mFooters;
+  mFileStream.flush();
+  mFileStream.seekp( mStepCountPosition );
 }
 
 } // namespace xdmf
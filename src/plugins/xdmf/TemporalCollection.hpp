@@ -23,6 +23,7 @@
 
 #include <xdmf/TimeSeries.hpp>
 
+#include <xdm/StreamMetadataOperation.hpp>
 #include <xdm/XmlOutputStream.hpp>
 
 #include <fstream>
@@ -32,26 +33,64 @@
 
 namespace xdmf {
 
-/// Time series output that writes all grids as a temporal collection within a
-/// single XDMF file.
+/// A time series written as an XDMF temporal collection in a single XML file.
+///
+/// The file is a complete document after every step: the closing tags of the
+/// collection are written after each step's Grid and overwritten by the next
+/// step, so a step costs only its own size to append. A monitoring program
+/// can read the file while it is written, and a run that stops without
+/// closing the series leaves the steps written so far readable. With the
+/// kModify mode, an existing collection is continued rather than replaced.
+///
+/// The metadata of each step is written straight to the file with a
+/// StreamMetadataOperation rather than collected into XmlObjects first. A
+/// Topology or Geometry that is identical to one written earlier is replaced
+/// by an XInclude of the first one, so a mesh that does not change is only
+/// described once. XmfReader follows these XIncludes without expanding them.
+/// Steps appended in kModify mode only include elements written since the
+/// collection was opened. The number of steps is kept in a comment before the
+/// closing tags, so that kModify does not read the steps already written.
 class TemporalCollection : public TimeSeries {
 public:
-  /// Construct a temporal collection with  
+  /// Construct a temporal collection writing to a metadata file.
+  /// @param metadataFile The XDMF file to write.
+  /// @param mode kCreate to start a new file, kModify to append to an
+  /// existing temporal collection written by this class.
   TemporalCollection( 
     const std::string& metadataFile,
     xdm::Dataset::InitializeMode mode );
   virtual ~TemporalCollection();
 
+  /// Open the file and write the start of the document, or, in kModify mode,
+  /// position the file to append to an existing collection.
+  /// @throws xdmFormat::WriteError if the existing file does not end the way
+  /// this class ends a temporal collection.
   virtual void open();
   virtual void updateGrid( xdm::RefPtr< xdmGrid::Grid > grid, std::size_t step );
   virtual void writeGridMetadata( xdm::RefPtr< xdmGrid::Grid > grid );
   virtual void writeGridData( xdm::RefPtr< xdmGrid::Grid > grid );
   virtual void close();
 
+  /// Get the number of bytes of heavy data written by the last call to
+  /// writeGridData.
+  std::size_t dataBytesWritten() const { return mDataBytesWritten; }
+
 private:
+  // Write the step count and the footers after the last step and position the
+  // file back at the step count.
+  void writeFooters();
+
   std::string mFilename;
   std::fstream mFileStream;
   xdm::XmlOutputStream mXmlStream;
+  xdm::StreamMetadataOperation mMetadataWriter;
+  // The closing tags of the document and where they start in the file.
+  std::string mFooters;
+  std::streampos mFooterPosition;
+  // Where the step count comment before the footers starts in the file.
+  std::streampos mStepCountPosition;
+  std::size_t mNumberOfSteps;
+  std::size_t mDataBytesWritten;
 };
 
 } // namespace xdmf
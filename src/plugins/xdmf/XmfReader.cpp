@@ -4,6 +4,8 @@
 //-----------------------------------------------------------------------------
 #include <xdmf/XmfReader.hpp>
 
+#include <xdmf/impl/StepIndex.hpp>
+#include <xdmf/impl/StreamingNodeVector.hpp>
 #include <xdmf/impl/TreeBuilder.hpp>
 #include <xdmf/impl/XmlDocumentManager.hpp>
 #include <xdmf/impl/XPathQuery.hpp>
@@ -20,7 +22,9 @@
 
 #include <libxml/parser.h>
 #include <libxml/relaxng.h>
+#include <libxml/threads.h>
 #include <libxml/tree.h>
+#include <libxml/xmlreader.h>
 
 #include <sstream>
 
@@ -43,26 +47,41 @@ void structuredValidationErrorCallback( void* userData, xmlErrorPtr error ) {
   XDM_THROW( exception );
 }
 
+// The compiled XDMF schema, shared by every reader in the process. It is never
+// freed.
+xmlRelaxNGPtr gXdmfSchema = 0;
+
+// Get the compiled XDMF schema, compiling it on first use. A compiled schema
+// is only read during validation, so it may be used by several threads at once
+// as long as each has its own validation context. The libxml2 library lock
+// guards the compilation; the parser is already initialized at this point
+// because a document has been read.
+xmlRelaxNGPtr xdmfSchema() {
+  xmlLockLibrary();
+  if ( !gXdmfSchema ) {
+    xmlRelaxNGParserCtxtPtr context = xmlRelaxNGNewMemParserCtxt(
+      kXdmfRngSchema,
+      kXdmfRngSchemaLength );
+    if ( context ) {
+      gXdmfSchema = xmlRelaxNGParse( context );
+      xmlRelaxNGFreeParserCtxt( context );
+    }
+  }
+  xmlRelaxNGPtr schema = gXdmfSchema;
+  xmlUnlockLibrary();
+
+  if ( !schema ) {
+    XDM_THROW( xdmFormat::ReadError( "Error: unable to parse schema." ) );
+  }
+  return schema;
+}
+
 // Validate an XDMF document.
 bool validate( xmlDocPtr document ) {
-  xmlRelaxNGParserCtxtPtr context;
-  xmlRelaxNGPtr schemaDoc;
-  xmlRelaxNGValidCtxtPtr validation;
+  xmlRelaxNGValidCtxtPtr validation = 0;
   bool result = false;
   try {
-    context = xmlRelaxNGNewMemParserCtxt( 
-      kXdmfRngSchema, 
-      kXdmfRngSchemaLength );
-    if (!context) {
-      throw xdmFormat::ReadError( "Error: unable to parse schema." );
-    }
-          
-    schemaDoc = xmlRelaxNGParse( context );
-    if (!schemaDoc) {
-      throw xdmFormat::ReadError( "Error: unable to parse schema." );
-    }
-
-    validation = xmlRelaxNGNewValidCtxt( schemaDoc );
+    validation = xmlRelaxNGNewValidCtxt( xdmfSchema() );
     if (!validation) {
       throw xdmFormat::ReadError( "Error: unable to parse schema." );
     }
@@ -82,19 +101,15 @@ bool validate( xmlDocPtr document ) {
       throw xdmFormat::ReadError( "Error: Internal validation error." );
     }
   } catch ( ... ) {
-    if (context) xmlRelaxNGFreeParserCtxt(context);
-    if (schemaDoc) xmlRelaxNGFree(schemaDoc);
     if (validation) xmlRelaxNGFreeValidCtxt(validation);
     throw;
   }
-  if (context) xmlRelaxNGFreeParserCtxt(context);
-  if (schemaDoc) xmlRelaxNGFree(schemaDoc);
   if (validation) xmlRelaxNGFreeValidCtxt(validation);
   return result;
 }
 
-// Read an XML document at the specified path.
-xmlDoc * readDocument( const xdm::FileSystemPath& path ) {
+// Read an XML document at the specified path, optionally validating it.
+xmlDoc * readDocument( const xdm::FileSystemPath& path, bool validateDocument ) {
   // Check the file exists.
   if ( !exists( path ) ) {
     XDM_THROW( xdmFormat::ReadError( "Requested path does not exist." ) );
@@ -107,12 +122,82 @@ xmlDoc * readDocument( const xdm::FileSystemPath& path ) {
     XDM_THROW( xdmFormat::ReadError( "Unable to parse XDMF document." ) );
   }
 
-  if ( !validate( document ) ) {
-    XDM_THROW( xdmFormat::ReadError( "Invalid XDMF document." ) );
+  if ( validateDocument ) {
+    bool valid = false;
+    try {
+      valid = validate( document );
+    } catch ( ... ) {
+      xmlFreeDoc( document );
+      throw;
+    }
+    if ( !valid ) {
+      xmlFreeDoc( document );
+      XDM_THROW( xdmFormat::ReadError( "Invalid XDMF document." ) );
+    }
   }
   return document;
 }
 
+// The first error reported by a streaming parser.
+struct StreamError {
+  StreamError() : line( 0 ), reason() {}
+  int line;
+  std::string reason;
+};
+
+// Callback function to record the first error reported while validating a
+// document with a streaming parser.
+void streamErrorCallback(
+  void * userData,
+  const char * message,
+  xmlParserSeverities severity,
+  xmlTextReaderLocatorPtr locator ) {
+  StreamError& error = *static_cast< StreamError* >( userData );
+  if ( error.reason.empty() && message
+    && ( severity == XML_PARSER_SEVERITY_VALIDITY_ERROR
+      || severity == XML_PARSER_SEVERITY_ERROR ) ) {
+    error.line = xmlTextReaderLocatorLineNumber( locator );
+    error.reason = message;
+    // Drop the trailing newline of libxml2 messages.
+    error.reason.erase( error.reason.find_last_not_of( "\n" ) + 1 );
+  }
+}
+
+// Validate the XDMF document at a path with a streaming parser, so that the
+// document is never held in memory as a whole.
+void validateStream( const xdm::FileSystemPath& path ) {
+  xmlTextReaderPtr reader = xmlReaderForFile(
+    path.pathString().c_str(),
+    0,
+    XML_PARSE_NOERROR | XML_PARSE_NOWARNING | XML_PARSE_NONET );
+  if ( !reader ) {
+    XDM_THROW( xdmFormat::ReadError( "Unable to parse XDMF document." ) );
+  }
+  // The handler must be set before the schema to receive validity errors.
+  StreamError error;
+  xmlTextReaderSetErrorHandler( reader, &streamErrorCallback, &error );
+  if ( xmlTextReaderRelaxNGSetSchema( reader, xdmfSchema() ) != 0 ) {
+    xmlFreeTextReader( reader );
+    XDM_THROW( xdmFormat::ReadError( "Error: unable to parse schema." ) );
+  }
+
+  int status = 0;
+  bool valid = true;
+  while ( valid && ( status = xmlTextReaderRead( reader ) ) == 1 ) {
+    valid = xmlTextReaderIsValid( reader ) != 0;
+  }
+  valid = valid && xmlTextReaderIsValid( reader ) == 1;
+  xmlFreeTextReader( reader );
+
+  if ( status < 0 || !valid ) {
+    XDM_THROW( xdmFormat::FileReadError(
+      path.pathString(),
+      error.line,
+      0,
+      error.reason.empty() ? "Invalid XDMF document." : error.reason ) );
+  }
+}
+
 } // namespace
 
 // -----------------------------------------------------------------------------
@@ -120,6 +205,17 @@ xmlDoc * readDocument( const xdm::FileSystemPath& path ) {
 // -----------------------------------------------------------------------------
 class XmfReader::Private {
 public:
+  Private() :
+    mValidation( kValidateAll ),
+    mValidatedDocument( false ),
+    mStreaming( false ),
+    mIndexing( false ) {}
+
+  Validation mValidation;
+  // Whether this reader has already validated a document.
+  bool mValidatedDocument;
+  bool mStreaming;
+  bool mIndexing;
 };
 
 XmfReader::XmfReader() : 
@@ -130,6 +226,30 @@ XmfReader::XmfReader() :
 XmfReader::~XmfReader() {
 }
 
+void XmfReader::setValidation( Validation validation ) {
+  mImp->mValidation = validation;
+}
+
+XmfReader::Validation XmfReader::validation() const {
+  return mImp->mValidation;
+}
+
+void XmfReader::setStreaming( bool streaming ) {
+  mImp->mStreaming = streaming;
+}
+
+bool XmfReader::streaming() const {
+  return mImp->mStreaming;
+}
+
+void XmfReader::setIndexing( bool indexing ) {
+  mImp->mIndexing = indexing;
+}
+
+bool XmfReader::indexing() const {
+  return mImp->mIndexing;
+}
+
 xdmFormat::ReadResult XmfReader::readItem( const xdm::FileSystemPath& path ) {
   static const char * kTemporalCollectionExpr =
     "/Xdmf/Domain/Grid["
@@ -138,9 +258,47 @@ xdmFormat::ReadResult XmfReader::readItem( const xdm::FileSystemPath& path ) {
 
   xdm::RefPtr< xdm::Item > result;
 
+  bool validateDocument = mImp->mValidation == kValidateAll
+    || ( mImp->mValidation == kValidateFirst && !mImp->mValidatedDocument );
+
+  if ( mImp->mStreaming ) {
+    // Index the time steps and build the tree from the first one only.
+    if ( !exists( path ) ) {
+      XDM_THROW( xdmFormat::ReadError( "Requested path does not exist." ) );
+    }
+    impl::StepIndex index;
+    const bool indexed = mImp->mIndexing && index.read( path );
+    bool validatedNow = false;
+    if ( validateDocument ) {
+      if ( !indexed || !index.validated ) {
+        validateStream( path );
+        validatedNow = true;
+      }
+      mImp->mValidatedDocument = true;
+    }
+    xdm::RefPtr< impl::StreamingNodeVector > timestepNodes;
+    if ( indexed ) {
+      timestepNodes = xdm::makeRefPtr( new impl::StreamingNodeVector(
+        path, index.stepRanges, index.stepSequences ) );
+    } else {
+      timestepNodes = xdm::makeRefPtr( new impl::StreamingNodeVector( path ) );
+    }
+    if ( mImp->mIndexing && ( !indexed || validatedNow ) ) {
+      // Failing to save the index only costs a scan of the next reopen.
+      index.validated = validatedNow || ( indexed && index.validated );
+      index.stepRanges = timestepNodes->stepRanges();
+      index.stepSequences = timestepNodes->stepSequences();
+      index.write( path );
+    }
+    impl::TreeBuilder build( timestepNodes->firstStepDocument(), timestepNodes );
+    result = build.buildTree();
+    return xdmFormat::ReadResult( result, timestepNodes->size() );
+  }
+
   // Read the document.
   xdm::RefPtr< impl::XmlDocumentManager > doc(
-    new impl::XmlDocumentManager( readDocument( path ) ) );
+    new impl::XmlDocumentManager( readDocument( path, validateDocument ) ) );
+  mImp->mValidatedDocument = mImp->mValidatedDocument || validateDocument;
   xmlNode * rootNode = xmlDocGetRootElement( doc->get() );
 
   // Determine if the XDMF document contains a single time step or a temporal
@@ -32,9 +32,45 @@ namespace xdmf {
 
 class XmfReader : public xdmFormat::Reader {
 public:
+  /// Choices for validating documents against the XDMF schema. The schema is
+  /// compiled once per process, so validation costs only the check of the
+  /// document itself. Pipelines that read many documents from a trusted
+  /// producer can skip even that.
+  enum Validation {
+    kValidateAll,   ///< Validate every document read (the default).
+    kValidateFirst, ///< Validate only the first document read by this reader.
+    kValidateNone   ///< Do not validate documents.
+  };
+
   XmfReader();
   virtual ~XmfReader();
 
+  /// Set how documents are validated against the XDMF schema.
+  void setValidation( Validation validation );
+  /// Get how documents are validated against the XDMF schema.
+  Validation validation() const;
+
+  /// Set whether documents are read a time step at a time. By default the
+  /// whole document is parsed into memory and kept for every time step. When
+  /// streaming, readItem makes a single pass over the document to find the time
+  /// steps, and update parses only the requested step, so the memory used does
+  /// not grow with the number of steps. Each step must then be self-contained,
+  /// without entities or XInclude namespaces declared outside its Grid.
+  void setStreaming( bool streaming );
+  /// Determine if documents are read a time step at a time.
+  bool streaming() const;
+
+  /// Set whether streaming reads keep an index of the time steps beside the
+  /// document, in a binary file named by appending ".idx" to the document
+  /// path. When the index matches the size and modification time of the
+  /// document, readItem takes the steps from it instead of scanning the
+  /// document, and skips validating a document that was valid when it was
+  /// indexed. A missing or stale index is rebuilt from the document. This has
+  /// no effect unless streaming is set.
+  void setIndexing( bool indexing );
+  /// Determine if streaming reads keep an index of the time steps.
+  bool indexing() const;
+
   virtual xdmFormat::ReadResult readItem(
     const xdm::FileSystemPath& path );
 
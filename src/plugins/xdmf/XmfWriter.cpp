@@ -24,22 +24,66 @@
 #include <xdmf/VirtualDataset.hpp>
 
 #include <xdm/CollectMetadataOperation.hpp>
+#include <xdm/ItemVisitor.hpp>
+#include <xdm/MemoryAdapter.hpp>
 #include <xdm/SerializeDataOperation.hpp>
+#include <xdm/UniformDataItem.hpp>
 #include <xdm/XmlObject.hpp>
 #include <xdm/XmlOutputStream.hpp>
 
 #include <xdmHdf/AttachHdfDatasetOperation.hpp>
 
 #include <fstream>
+#include <vector>
 
 #include <stdexcept>
 
 namespace xdmf {
 
+namespace {
+
+// Mark static data whose dataset has already been written, so that it is not
+// written again. Static items that are written for the first time are recorded
+// in a list, so that their datasets can be recorded once the step has been
+// written.
+class MarkWrittenStaticData : public xdm::ItemVisitor {
+public:
+  MarkWrittenStaticData( const std::set< xdm::RefPtr< xdm::Dataset > >& written ) :
+    mWritten( written ),
+    mFirstWrites() {
+  }
+
+  virtual void apply( xdm::UniformDataItem& item ) {
+    xdm::RefPtr< xdm::MemoryAdapter > data = item.data();
+    if ( !data || data->isDynamic() || !item.dataset() ) {
+      item.setAlreadyWritten( false );
+      return;
+    }
+    bool written = mWritten.count( item.dataset() ) > 0;
+    item.setAlreadyWritten( written );
+    if ( !written && data->requiresWrite() ) {
+      mFirstWrites.push_back( item.dataset() );
+    }
+  }
+
+  const std::vector< xdm::RefPtr< xdm::Dataset > >& firstWrites() const {
+    return mFirstWrites;
+  }
+
+private:
+  const std::set< xdm::RefPtr< xdm::Dataset > >& mWritten;
+  std::vector< xdm::RefPtr< xdm::Dataset > > mFirstWrites;
+};
+
+} // namespace anon
+
 XmfWriter::XmfWriter() :
   xdmFormat::Writer(),
   mSeries(),
-  mIsOpen( false ) {
+  mIsOpen( false ),
+  mCurrentFilePath(),
+  mWrittenStaticData(),
+  mBytesWritten( 0 ) {
 }
 
 XmfWriter::~XmfWriter() {
@@ -55,6 +99,7 @@ void XmfWriter::open(
   mSeries = new TemporalCollection( path.pathString(), mode );
   mSeries->open();
   mIsOpen = true;
+  mWrittenStaticData.clear();
 }
 
 void XmfWriter::write( xdm::RefPtr< xdm::Item > item, std::size_t seriesIndex ) {
@@ -76,13 +121,33 @@ void XmfWriter::write( xdm::RefPtr< xdm::Item > item, std::size_t seriesIndex )
 
   mSeries->updateGrid( grid, seriesIndex );
   mSeries->writeGridMetadata( grid );
-  mSeries->writeGridData( grid );
+
+  // Write static data only once, to its shared dataset.
+  MarkWrittenStaticData markWritten( mWrittenStaticData );
+  grid->accept( markWritten );
+  mBytesWritten = writeGridData( grid );
+  mWrittenStaticData.insert(
+    markWritten.firstWrites().begin(), markWritten.firstWrites().end() );
 }
 
 void XmfWriter::close() {
   mIsOpen = false;
   mSeries->close();
   mSeries.reset();
+  mWrittenStaticData.clear();
+}
+
+std::size_t XmfWriter::bytesWritten() const {
+  return mBytesWritten;
+}
+
+std::size_t XmfWriter::writeGridData( xdm::RefPtr< xdmGrid::Grid > grid ) {
+  mSeries->writeGridData( grid );
+  return mSeries->dataBytesWritten();
+}
+
+xdm::Dataset::InitializeMode XmfWriter::mode() const {
+  return mSeries->mode();
 }
 
 } // namespace xdmf
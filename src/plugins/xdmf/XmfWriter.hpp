@@ -21,17 +21,29 @@
 #ifndef xdmf_XmfWriter_hpp
 #define xdmf_XmfWriter_hpp
 
-#include <xdmf/TimeSeries.hpp>
-
 #include <xdmFormat/Writer.hpp>
 
-#include <map>
+#include <xdm/RefPtr.hpp>
+
+#include <xdmGrid/Forward.hpp>
+
+#include <set>
 
 
 
 namespace xdmf {
 
+class TemporalCollection;
+
 /// Implementation of xdmFormat::Writer for writing XDMF files.
+///
+/// Each series is written as an XDMF temporal collection with its heavy data
+/// in an HDF5 file next to it. Data items without a dataset are given one:
+/// dynamic data is written to a group for each step, and data that is not
+/// dynamic, such as a fixed mesh, to the shared group "All". Static data is
+/// written with the first step that contains it and never again, even if its
+/// MemoryAdapter is marked as needing an update, so every step refers to the
+/// same datasets.
 class XmfWriter : public xdmFormat::Writer {
 public:
   XmfWriter();
@@ -43,10 +55,28 @@ public:
   virtual void write( xdm::RefPtr< xdm::Item > item, std::size_t seriesIndex );
   virtual void close();
 
+  /// Get the number of bytes of heavy data written by the last call to write.
+  std::size_t bytesWritten() const;
+
+protected:
+  /// Write the heavy data of a grid whose datasets have been attached and whose
+  /// metadata has been written, and get the number of bytes written. Static
+  /// data items that were written with an earlier step are marked with
+  /// xdm::UniformDataItem::setAlreadyWritten() and must be skipped. The
+  /// default serializes the data items in tree order; writers that control
+  /// when the data of an item is loaded and released reimplement this.
+  virtual std::size_t writeGridData( xdm::RefPtr< xdmGrid::Grid > grid );
+
+  /// Get the mode the series was opened with.
+  xdm::Dataset::InitializeMode mode() const;
+
 private:
-  xdm::RefPtr< TimeSeries > mSeries;
+  xdm::RefPtr< TemporalCollection > mSeries;
   bool mIsOpen;
   xdm::FileSystemPath mCurrentFilePath;
+  // The datasets of static data items that have already been written.
+  std::set< xdm::RefPtr< xdm::Dataset > > mWrittenStaticData;
+  std::size_t mBytesWritten;
 };
 
 } // namespace xdmf
@@ -36,24 +36,29 @@ Input::Input(
  const std::string& xpathExpr ) :
   mDocument( doc ),
   mNodes( stepNodes ),
-  mXPathExpr( xpathExpr ) {
+  mXPathExpr( xpathExpr ),
+  mPathKey( stepNodes->registerPath( xpathExpr ) ),
+  mLastInclude() {
 }
 
 Input::~Input() {
 }
 
 xmlNode * Input::findNode( std::size_t index ) {
-  xmlNode * gridNode = nodes()->at( index );
-  xmlDoc * doc = document()->get();
-
-  // Find the new XML node within the requested grid context.
-  XPathQuery nodeQuery( doc, gridNode, xpathExpr() );
-  if ( nodeQuery.size() == 0 ) {
+  xmlNode * node = nodes()->findNode( mPathKey, index );
+  if ( !node ) {
     std::ostringstream ss;
     ss << "XDMF object not found at series index " << index;
     XDM_THROW( xdmFormat::ReadError( ss.str() ) );
   }
-  return nodeQuery.node( 0 );
+  return node;
+}
+
+bool Input::includedContentUnchanged( std::size_t index ) {
+  const std::string& include = nodes()->findInclude( mPathKey, index );
+  bool unchanged = !include.empty() && include == mLastInclude;
+  mLastInclude = include;
+  return unchanged;
 }
 
 }
@@ -52,6 +52,11 @@ public:
   /// Find the node for this object at the given series index.
   xmlNode * findNode( std::size_t index );
 
+  /// Determine whether the node for this object at the given series index was
+  /// included with the same XInclude as the node last checked, so that its
+  /// content has not changed since.
+  bool includedContentUnchanged( std::size_t index );
+
   xdm::RefPtr< XmlDocumentManager > document() { return mDocument; }
   xdm::RefPtr< SharedNodeVector > nodes() { return mNodes; }
   const std::string& xpathExpr() const { return mXPathExpr; }
@@ -63,6 +68,8 @@ private:
   xdm::RefPtr< XmlDocumentManager > mDocument;
   xdm::RefPtr< SharedNodeVector > mNodes;
   std::string mXPathExpr;
+  std::size_t mPathKey;
+  std::string mLastInclude;
 };
 
 } // namespace impl
@@ -0,0 +1,181 @@
+//==============================================================================
+// This software developed by Stellar Science Ltd Co and the U.S. Government.
+// Copyright (C) 2009 Stellar Science. Government-purpose rights granted.
+//
+// This file is part of XDM
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+#include <xdmf/impl/StepIndex.hpp>
+
+#include <xdm/BinaryIOStream.hpp>
+#include <xdm/BinaryStreamBuffer.hpp>
+#include <xdm/BinaryStreamOperations.hpp>
+
+#include <fstream>
+#include <stdexcept>
+
+namespace xdmf {
+namespace impl {
+
+namespace {
+
+// Identifies an index file and the version of its layout.
+char const * const kIndexMagic = "XDMF step index";
+const unsigned int kIndexVersion = 2;
+
+// The extension appended to the document path to name its index.
+char const * const kIndexExtension = ".idx";
+
+// The number of bytes before the step entries of an index.
+std::size_t headerSize() {
+  return std::string( kIndexMagic ).size() + 1
+    + sizeof( unsigned int )
+    + sizeof( unsigned long ) + 2 * sizeof( long )
+    + sizeof( bool ) + sizeof( unsigned long );
+}
+
+// The number of bytes of a step entry with an empty child sequence.
+const std::size_t kMinimumStepSize = 2 * sizeof( long ) + 1;
+
+// The modification time of a file, to below a second where it is recorded.
+struct WriteTime {
+  explicit WriteTime( const xdm::FileSystemPath& path ) :
+    seconds( 0 ),
+    nanoseconds( 0 ) {
+    seconds = static_cast< long >( xdm::lastWriteTime( path, &nanoseconds ) );
+  }
+  long seconds;
+  long nanoseconds;
+};
+
+bool operator<( const WriteTime& lhs, const WriteTime& rhs ) {
+  return lhs.seconds < rhs.seconds
+    || ( lhs.seconds == rhs.seconds && lhs.nanoseconds < rhs.nanoseconds );
+}
+
+} // namespace
+
+StepIndex::StepIndex() :
+  validated( false ),
+  stepRanges(),
+  stepSequences() {
+}
+
+xdm::FileSystemPath StepIndex::indexPath( const xdm::FileSystemPath& document ) {
+  return xdm::FileSystemPath( document.pathString() + kIndexExtension );
+}
+
+bool StepIndex::read( const xdm::FileSystemPath& document ) {
+  const xdm::FileSystemPath path = indexPath( document );
+  const std::size_t indexSize = xdm::size( path );
+  if ( indexSize == 0 ) {
+    return false;
+  }
+
+  // Read the whole index with a single call and decode it from memory.
+  xdm::BinaryStreamBuffer buffer( indexSize );
+  {
+    std::ifstream file( path.pathString().c_str(), std::ios::in | std::ios::binary );
+    file.read( buffer.bufferStart(), indexSize );
+    if ( static_cast< std::size_t >( file.gcount() ) != indexSize ) {
+      return false;
+    }
+  }
+
+  xdm::BinaryIOStream stream( &buffer );
+  try {
+    std::string magic;
+    unsigned int version = 0;
+    stream >> magic >> version;
+    if ( magic != kIndexMagic || version != kIndexVersion ) {
+      return false;
+    }
+
+    // The document must not have been written since the index was. A document
+    // written within the same clock tick as its index could have changed
+    // without changing its time, so such an index is not trusted either.
+    const WriteTime documentTime( document );
+    if ( !( documentTime < WriteTime( path ) ) ) {
+      return false;
+    }
+    unsigned long documentSize = 0;
+    long documentSeconds = 0;
+    long documentNanoseconds = 0;
+    stream >> documentSize >> documentSeconds >> documentNanoseconds;
+    if ( documentSize != xdm::size( document )
+      || documentSeconds != documentTime.seconds
+      || documentNanoseconds != documentTime.nanoseconds ) {
+      return false;
+    }
+
+    unsigned long numberOfSteps = 0;
+    stream >> validated >> numberOfSteps;
+    // Check the count against the size of the file before allocating for it.
+    if ( numberOfSteps > ( indexSize - headerSize() ) / kMinimumStepSize ) {
+      return false;
+    }
+    stepRanges.resize( numberOfSteps );
+    stepSequences.clear();
+    for ( unsigned long i = 0; i < numberOfSteps; ++i ) {
+      std::string sequence;
+      stream >> stepRanges[i] >> sequence;
+      stepSequences[ sequence ] = i;
+    }
+  } catch ( const std::exception& ) {
+    // The index was truncated or corrupt.
+    validated = false;
+    stepRanges.clear();
+    stepSequences.clear();
+    return false;
+  }
+  return !stepRanges.empty();
+}
+
+bool StepIndex::write( const xdm::FileSystemPath& document ) const {
+  // The child sequence of each step, in step order.
+  std::vector< std::string > sequences( stepRanges.size() );
+  for ( StreamingNodeVector::StepSequenceMap::const_iterator it = stepSequences.begin();
+    it != stepSequences.end(); ++it ) {
+    sequences.at( it->second ) = it->first;
+  }
+
+  // Size the buffer to hold the index exactly.
+  std::size_t indexSize = headerSize();
+  for ( std::size_t i = 0; i < sequences.size(); ++i ) {
+    indexSize += 2 * sizeof( long ) + sequences[i].size() + 1;
+  }
+
+  xdm::BinaryStreamBuffer buffer( indexSize );
+  xdm::BinaryIOStream stream( &buffer );
+  stream << std::string( kIndexMagic ) << kIndexVersion;
+  stream << static_cast< unsigned long >( xdm::size( document ) );
+  const WriteTime documentTime( document );
+  stream << documentTime.seconds << documentTime.nanoseconds;
+  stream << validated << static_cast< unsigned long >( stepRanges.size() );
+  for ( std::size_t i = 0; i < stepRanges.size(); ++i ) {
+    stream << stepRanges[i] << sequences[i];
+  }
+
+  const xdm::FileSystemPath path = indexPath( document );
+  std::ofstream file(
+    path.pathString().c_str(),
+    std::ios::out | std::ios::binary | std::ios::trunc );
+  file.write( buffer.bufferStart(), indexSize );
+  return file.good();
+}
+
+} // namespace impl
+} // namespace xdmf
@@ -0,0 +1,66 @@
+//==============================================================================
+// This software developed by Stellar Science Ltd Co and the U.S. Government.
+// Copyright (C) 2009 Stellar Science. Government-purpose rights granted.
+//
+// This file is part of XDM
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+#ifndef xdmf_impl_StepIndex_hpp
+#define xdmf_impl_StepIndex_hpp
+
+#include <xdmf/impl/StreamingNodeVector.hpp>
+
+#include <xdm/FileSystem.hpp>
+
+#include <string>
+#include <vector>
+
+namespace xdmf {
+namespace impl {
+
+/// The locations of the time steps of an XDMF document, saved in a binary file
+/// beside the document so that a streaming reader can reopen the document
+/// without scanning or validating it again. The index is keyed by the size and
+/// modification time of the document and is ignored once either one changes,
+/// or if the document was not written strictly before the index.
+struct StepIndex {
+  StepIndex();
+
+  /// Get the path of the index kept beside a document.
+  static xdm::FileSystemPath indexPath( const xdm::FileSystemPath& document );
+
+  /// Read the index kept beside a document.
+  /// @return False if there is no index for the document, or if it is stale
+  /// or unreadable.
+  bool read( const xdm::FileSystemPath& document );
+
+  /// Write the index beside a document, keyed by the current size and
+  /// modification time of the document.
+  /// @return False if the index could not be written.
+  bool write( const xdm::FileSystemPath& document ) const;
+
+  /// True if the document was valid against the XDMF schema.
+  bool validated;
+  /// The byte range of the Grid element of each step.
+  std::vector< StreamingNodeVector::ByteRange > stepRanges;
+  /// Map from the XPointer child sequence of each step's Grid to its index.
+  StreamingNodeVector::StepSequenceMap stepSequences;
+};
+
+} // namespace impl
+} // namespace xdmf
+
+#endif // xdmf_impl_StepIndex_hpp
@@ -0,0 +1,375 @@
+//==============================================================================
+// This software developed by Stellar Science Ltd Co and the U.S. Government.
+// Copyright (C) 2009 Stellar Science. Government-purpose rights granted.
+//
+// This file is part of XDM
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+#include <xdmf/impl/StreamingNodeVector.hpp>
+
+#include <xdmFormat/IoExcept.hpp>
+
+#include <xdm/ThrowMacro.hpp>
+
+#include <libxml/parser.h>
+
+#include <sstream>
+#include <string>
+
+#include <cstring>
+
+namespace xdmf {
+namespace impl {
+
+namespace {
+
+char const * const kDomainTag = "Domain";
+char const * const kGridTag   = "Grid";
+char const * const kXdmfTag   = "Xdmf";
+
+// The number of bytes of the file handed to the parser at a time.
+const std::size_t kChunkSize = 64 * 1024;
+
+// State of the SAX scan that finds the step grids.
+struct StepScan {
+  xmlParserCtxtPtr context;
+  // Names of the open elements, from the root down.
+  std::vector< std::string > openElements;
+  // The 1-based positions of the open elements among their siblings, and the
+  // number of children of the innermost one.
+  std::vector< std::size_t > positions;
+  // Depth of the temporal collection Grid, or 0 before it is found.
+  std::size_t collectionDepth;
+  // Set once a temporal collection has been found.
+  bool foundCollection;
+  // Byte ranges and child sequences of the temporal collection's child grids.
+  std::vector< StreamingNodeVector::ByteRange > steps;
+  std::vector< std::string > stepSequences;
+  // Byte range and child sequence of the first Domain Grid, used when there is
+  // no collection.
+  std::vector< StreamingNodeVector::ByteRange > firstGrid;
+  std::vector< std::string > firstGridSequence;
+  // The list holding the range of the Grid being scanned, if any.
+  std::vector< StreamingNodeVector::ByteRange > * open;
+  bool failed;
+};
+
+bool nameIs( const xmlChar * name, const char * tag ) {
+  return std::strcmp( reinterpret_cast< const char * >( name ), tag ) == 0;
+}
+
+// Find the value of an attribute in the SAX2 attribute array.
+std::string attributeValue(
+  int numberOfAttributes,
+  const xmlChar ** attributes,
+  const char * name ) {
+  for ( int i = 0; i < numberOfAttributes; ++i ) {
+    const xmlChar ** attribute = attributes + 5 * i;
+    if ( nameIs( attribute[0], name ) ) {
+      return std::string(
+        reinterpret_cast< const char * >( attribute[3] ),
+        reinterpret_cast< const char * >( attribute[4] ) );
+    }
+  }
+  return std::string();
+}
+
+// Get the byte offset of the '<' that opened the element whose start tag was
+// just parsed. The parser is positioned at the end of the tag, which is still
+// in its input buffer.
+long startTagOffset( StepScan& scan ) {
+  xmlParserInputPtr input = scan.context->input;
+  const xmlChar * position = input->cur;
+  while ( position > input->base && *position != '<' ) {
+    --position;
+  }
+  if ( *position != '<' ) {
+    scan.failed = true;
+    return 0;
+  }
+  return xmlByteConsumed( scan.context ) - ( input->cur - position );
+}
+
+// Get the XPointer child sequence of the element whose start tag was just
+// parsed.
+std::string childSequence( const StepScan& scan ) {
+  std::ostringstream sequence;
+  for ( std::size_t i = 0; i + 1 < scan.positions.size(); ++i ) {
+    sequence << '/' << scan.positions[i];
+  }
+  return sequence.str();
+}
+
+void startElement(
+  void * userData,
+  const xmlChar * localName,
+  const xmlChar * /* prefix */,
+  const xmlChar * /* uri */,
+  int /* numberOfNamespaces */,
+  const xmlChar ** /* namespaces */,
+  int numberOfAttributes,
+  int /* numberOfDefaulted */,
+  const xmlChar ** attributes ) {
+
+  StepScan& scan = *static_cast< StepScan* >( userData );
+  scan.openElements.push_back( reinterpret_cast< const char * >( localName ) );
+  ++scan.positions.back();
+  scan.positions.push_back( 0 );
+  const std::size_t depth = scan.openElements.size();
+  if ( !nameIs( localName, kGridTag ) ) {
+    return;
+  }
+
+  if ( depth == 3
+    && scan.openElements[0] == kXdmfTag
+    && scan.openElements[1] == kDomainTag ) {
+    // A Grid in the Domain.
+    if ( scan.foundCollection ) {
+      return;
+    }
+    if ( attributeValue( numberOfAttributes, attributes, "GridType" ) == "Collection"
+      && attributeValue( numberOfAttributes, attributes, "CollectionType" ) == "Temporal" ) {
+      scan.foundCollection = true;
+      scan.collectionDepth = depth;
+    } else if ( scan.firstGrid.empty() ) {
+      scan.firstGrid.push_back( StreamingNodeVector::ByteRange(
+        startTagOffset( scan ), 0 ) );
+      scan.firstGridSequence.push_back( childSequence( scan ) );
+      scan.open = &scan.firstGrid;
+    }
+  } else if ( scan.collectionDepth != 0 && depth == scan.collectionDepth + 1 ) {
+    // A step of the temporal collection.
+    scan.steps.push_back( StreamingNodeVector::ByteRange(
+      startTagOffset( scan ), 0 ) );
+    scan.stepSequences.push_back( childSequence( scan ) );
+    scan.open = &scan.steps;
+  }
+}
+
+void endElement(
+  void * userData,
+  const xmlChar * localName,
+  const xmlChar * /* prefix */,
+  const xmlChar * /* uri */ ) {
+
+  StepScan& scan = *static_cast< StepScan* >( userData );
+  const std::size_t depth = scan.openElements.size();
+  scan.openElements.pop_back();
+  scan.positions.pop_back();
+  if ( !nameIs( localName, kGridTag ) ) {
+    return;
+  }
+
+  if ( scan.open
+    && ( depth == 3 || ( scan.collectionDepth != 0 && depth == scan.collectionDepth + 1 ) ) ) {
+    // The parser has just consumed the end of the element.
+    scan.open->back().second = xmlByteConsumed( scan.context );
+    scan.open = 0;
+  } else if ( depth == scan.collectionDepth ) {
+    scan.collectionDepth = 0;
+  }
+}
+
+} // namespace
+
+StreamingNodeVector::StreamingNodeVector( const xdm::FileSystemPath& path ) :
+  SharedNodeVector(),
+  mPath( path ),
+  mFile( path.pathString().c_str(), std::ios::in | std::ios::binary ),
+  mStepRanges(),
+  mStepSequences(),
+  mFirstStep(),
+  mCurrentIndex( 0 ),
+  mCurrentStep(),
+  mIncludedSteps() {
+
+  if ( !mFile ) {
+    XDM_THROW( xdmFormat::ReadError( "Requested path does not exist." ) );
+  }
+
+  xmlSAXHandler handler;
+  std::memset( &handler, 0, sizeof( handler ) );
+  handler.initialized = XML_SAX2_MAGIC;
+  handler.startElementNs = &startElement;
+  handler.endElementNs = &endElement;
+
+  StepScan scan;
+  scan.positions.push_back( 0 );
+  scan.collectionDepth = 0;
+  scan.foundCollection = false;
+  scan.open = 0;
+  scan.failed = false;
+  scan.context = xmlCreatePushParserCtxt(
+    &handler, &scan, 0, 0, path.pathString().c_str() );
+  if ( !scan.context ) {
+    XDM_THROW( xdmFormat::ReadError( "Unable to parse XDMF document." ) );
+  }
+  xmlCtxtUseOptions( scan.context, XML_PARSE_NOERROR | XML_PARSE_NOWARNING | XML_PARSE_NONET );
+
+  // Feed the file to the parser a chunk at a time.
+  std::vector< char > chunk( kChunkSize );
+  while ( !scan.failed && mFile ) {
+    mFile.read( &chunk[0], chunk.size() );
+    if ( mFile.gcount() > 0 ) {
+      xmlParseChunk( scan.context, &chunk[0], static_cast< int >( mFile.gcount() ), 0 );
+    }
+  }
+  // Keep the file open for loading the steps.
+  mFile.clear();
+  xmlParseChunk( scan.context, 0, 0, 1 );
+  bool wellFormed = scan.context->wellFormed != 0;
+  xmlFreeParserCtxt( scan.context );
+
+  if ( scan.failed || !wellFormed ) {
+    XDM_THROW( xdmFormat::ReadError( "Unable to parse XDMF document." ) );
+  }
+  if ( scan.foundCollection && scan.steps.empty() ) {
+    XDM_THROW( xdmFormat::ReadError(
+      "XDMF Temporal collection contains no time steps" ) );
+  }
+  mStepRanges.swap( scan.foundCollection ? scan.steps : scan.firstGrid );
+  const std::vector< std::string >& sequences =
+    scan.foundCollection ? scan.stepSequences : scan.firstGridSequence;
+  for ( std::size_t i = 0; i < sequences.size(); ++i ) {
+    mStepSequences[ sequences[i] ] = i;
+  }
+}
+
+StreamingNodeVector::StreamingNodeVector(
+  const xdm::FileSystemPath& path,
+  const std::vector< ByteRange >& stepRanges,
+  const StepSequenceMap& stepSequences ) :
+  SharedNodeVector(),
+  mPath( path ),
+  mFile( path.pathString().c_str(), std::ios::in | std::ios::binary ),
+  mStepRanges( stepRanges ),
+  mStepSequences( stepSequences ),
+  mFirstStep(),
+  mCurrentIndex( 0 ),
+  mCurrentStep(),
+  mIncludedSteps() {
+
+  if ( !mFile ) {
+    XDM_THROW( xdmFormat::ReadError( "Requested path does not exist." ) );
+  }
+}
+
+StreamingNodeVector::~StreamingNodeVector() {
+}
+
+std::size_t StreamingNodeVector::size() const {
+  return mStepRanges.size();
+}
+
+xmlNode * StreamingNodeVector::at( std::size_t index ) {
+  if ( index >= mStepRanges.size() ) {
+    std::ostringstream ss;
+    ss << "XDMF document has no step at series index " << index;
+    XDM_THROW( xdmFormat::ReadError( ss.str() ) );
+  }
+  if ( index == 0 ) {
+    return xmlDocGetRootElement( firstStepDocument()->get() );
+  }
+  if ( !mCurrentStep || mCurrentIndex != index ) {
+    // Release the previous step before loading the next one.
+    releaseNodes( mCurrentIndex );
+    mCurrentStep = xdm::RefPtr< XmlDocumentManager >();
+    mIncludedSteps.clear();
+    mCurrentStep = loadStep( index );
+    mCurrentIndex = index;
+  }
+  return xmlDocGetRootElement( mCurrentStep->get() );
+}
+
+xdm::RefPtr< XmlDocumentManager > StreamingNodeVector::firstStepDocument() {
+  if ( !mFirstStep ) {
+    if ( mStepRanges.empty() ) {
+      XDM_THROW( xdmFormat::ReadError( "XDMF file contains no data.") );
+    }
+    mFirstStep = loadStep( 0 );
+  }
+  return mFirstStep;
+}
+
+const StreamingNodeVector::ByteRange&
+StreamingNodeVector::stepRange( std::size_t index ) const {
+  return mStepRanges.at( index );
+}
+
+const std::vector< StreamingNodeVector::ByteRange >&
+StreamingNodeVector::stepRanges() const {
+  return mStepRanges;
+}
+
+const StreamingNodeVector::StepSequenceMap&
+StreamingNodeVector::stepSequences() const {
+  return mStepSequences;
+}
+
+xmlNode * StreamingNodeVector::findElement(
+  xmlNode * /* context */,
+  const std::vector< std::size_t >& childSequence ) {
+  // Find the step holding the element.
+  std::ostringstream prefix;
+  for ( std::size_t i = 0; i < childSequence.size(); ++i ) {
+    prefix << '/' << childSequence[i];
+    StepSequenceMap::const_iterator step = mStepSequences.find( prefix.str() );
+    if ( step == mStepSequences.end() ) {
+      continue;
+    }
+
+    xdm::RefPtr< XmlDocumentManager > document;
+    if ( step->second == 0 ) {
+      document = firstStepDocument();
+    } else if ( mCurrentStep && step->second == mCurrentIndex ) {
+      document = mCurrentStep;
+    } else {
+      xdm::RefPtr< XmlDocumentManager >& included = mIncludedSteps[ step->second ];
+      if ( !included ) {
+        included = loadStep( step->second );
+      }
+      document = included;
+    }
+    return followChildSequence(
+      xmlDocGetRootElement( document->get() ), childSequence, i + 1 );
+  }
+  return 0;
+}
+
+xdm::RefPtr< XmlDocumentManager >
+StreamingNodeVector::loadStep( std::size_t index ) {
+  const ByteRange& range = mStepRanges[index];
+  std::vector< char > buffer( range.second - range.first );
+  mFile.clear();
+  mFile.seekg( range.first );
+  if ( buffer.empty() || !mFile.read( &buffer[0], buffer.size() ) ) {
+    XDM_THROW( xdmFormat::ReadError( "Unable to read XDMF time step." ) );
+  }
+
+  xmlDoc * document = xmlReadMemory(
+    &buffer[0],
+    static_cast< int >( buffer.size() ),
+    mPath.pathString().c_str(),
+    0,
+    XML_PARSE_NOERROR | XML_PARSE_NOWARNING | XML_PARSE_NONET );
+  if ( !document ) {
+    XDM_THROW( xdmFormat::ReadError( "Unable to parse XDMF time step." ) );
+  }
+  return xdm::RefPtr< XmlDocumentManager >( new XmlDocumentManager( document ) );
+}
+
+} // namespace impl
+} // namespace xdmf
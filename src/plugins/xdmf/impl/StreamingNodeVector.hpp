@@ -0,0 +1,109 @@
+//==============================================================================
+// This software developed by Stellar Science Ltd Co and the U.S. Government.
+// Copyright (C) 2009 Stellar Science. Government-purpose rights granted.
+//
+// This file is part of XDM
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+#ifndef xdmf_impl_StreamingNodeVector_hpp
+#define xdmf_impl_StreamingNodeVector_hpp
+
+#include <xdmf/impl/XmlDocumentManager.hpp>
+
+#include <xdm/FileSystem.hpp>
+#include <xdm/RefPtr.hpp>
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace xdmf {
+namespace impl {
+
+/// Grid nodes for the steps of an XDMF document that are parsed only when they
+/// are requested. The document is scanned once with a SAX parser to record the
+/// byte range of each step's Grid element, and no DOM is built for the whole
+/// file. A step is parsed by reading its byte range back from the file, so the
+/// memory used does not depend on the number of steps.
+///
+/// The steps are the Grid children of the first temporal collection in the
+/// Domain or, if there is none, the first Domain Grid, matching the steps found
+/// by XmfReader when it reads the whole document. The first step is kept
+/// loaded because items build their paths relative to it; otherwise only the
+/// most recently requested step is held in memory.
+///
+/// Each step is parsed on its own, so it must not depend on anything declared
+/// outside its Grid element, such as entities or namespace prefixes used by
+/// XInclude. An XInclude may refer to an element of another step, which is
+/// loaded alongside the current step. The byte ranges assume an ASCII
+/// compatible encoding.
+class StreamingNodeVector : public SharedNodeVector {
+public:
+  /// Index the steps of the XDMF document at a path.
+  /// @throws xdmFormat::ReadError if the document is not well formed.
+  explicit StreamingNodeVector( const xdm::FileSystemPath& path );
+
+  /// A range of bytes [first, second) in the file.
+  typedef std::pair< long, long > ByteRange;
+  /// Map from the XPointer child sequence of each step's Grid to its index.
+  typedef std::map< std::string, std::size_t > StepSequenceMap;
+
+  /// Use steps of the XDMF document at a path that were found by an earlier
+  /// scan, such as one saved in a StepIndex, without scanning the document.
+  StreamingNodeVector(
+    const xdm::FileSystemPath& path,
+    const std::vector< ByteRange >& stepRanges,
+    const StepSequenceMap& stepSequences );
+  virtual ~StreamingNodeVector();
+
+  virtual std::size_t size() const;
+  virtual xmlNode * at( std::size_t index );
+
+  /// Get the document holding the Grid node of the first step.
+  xdm::RefPtr< XmlDocumentManager > firstStepDocument();
+
+  /// Get the range of bytes in the file holding the Grid element of a step.
+  const ByteRange& stepRange( std::size_t index ) const;
+  /// Get the ranges of bytes holding the Grid element of every step.
+  const std::vector< ByteRange >& stepRanges() const;
+  /// Get the XPointer child sequences of the Grid element of every step.
+  const StepSequenceMap& stepSequences() const;
+
+protected:
+  virtual xmlNode * findElement(
+    xmlNode * context,
+    const std::vector< std::size_t >& childSequence );
+
+private:
+  xdm::RefPtr< XmlDocumentManager > loadStep( std::size_t index );
+
+  xdm::FileSystemPath mPath;
+  std::ifstream mFile;
+  std::vector< ByteRange > mStepRanges;
+  StepSequenceMap mStepSequences;
+  xdm::RefPtr< XmlDocumentManager > mFirstStep;
+  std::size_t mCurrentIndex;
+  xdm::RefPtr< XmlDocumentManager > mCurrentStep;
+  // Other steps holding elements included by the current step.
+  std::map< std::size_t, xdm::RefPtr< XmlDocumentManager > > mIncludedSteps;
+};
+
+} // namespace impl
+} // namespace xdmf
+
+#endif // xdmf_impl_StreamingNodeVector_hpp
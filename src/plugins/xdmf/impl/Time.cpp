@@ -33,6 +33,16 @@
 namespace xdmf {
 namespace impl {
 
+namespace {
+
+// Compiled during static initialization, since times may be read from several
+// threads at once.
+const CompiledXPath kTimeTypeExpr( "@TimeType" );
+const CompiledXPath kValueExpr( "@Value" );
+const CompiledXPath kDataItemExpr( "DataItem" );
+
+} // namespace
+
 Time::Time(
   xdm::RefPtr< XmlDocumentManager > doc,
   xdm::RefPtr< SharedNodeVector > stepNodes,
@@ -45,11 +55,12 @@ Time::~Time() {
 }
 
 void Time::read( xmlNode * node, TreeBuilder& builder ) {
-  XPathQuery typeQuery( document()->get(), node, "@TimeType" );
+  XPathContext context( node->doc );
+  XPathQuery typeQuery( context, node, kTimeTypeExpr );
   std::string timeType = (typeQuery.size() > 0)?typeQuery.textValue(0):"Single";
 
   if ( timeType == "Single" ) {
-    XPathQuery valueQuery( document()->get(), node, "@Value" );
+    XPathQuery valueQuery( context, node, kValueExpr );
     if ( valueQuery.size() == 0 ) {
       XDM_THROW( xdmFormat::ReadError(
         "Single XDMF grid time specified with no Value" ) );
@@ -62,7 +73,7 @@ void Time::read( xmlNode * node, TreeBuilder& builder ) {
     }
     setValue( value );
   } else if ( timeType == "List" ) {
-    XPathQuery valuesQuery( document()->get(), node, "DataItem" );
+    XPathQuery valuesQuery( context, node, kDataItemExpr );
     if ( valuesQuery.size() == 0 ) {
       XDM_THROW( xdmFormat::ReadError( "No values found for XDMF Time." ) );
     }
@@ -31,6 +31,7 @@
 #include <xdm/ArrayAdapter.hpp>
 #include <xdm/DataShape.hpp>
 #include <xdm/Item.hpp>
+#include <xdm/ParallelErrorCapture.hpp>
 #include <xdm/VectorStructuredArray.hpp>
 
 #include <xdmFormat/IoExcept.hpp>
@@ -84,15 +85,59 @@ enum XdmfGeometryType {
   ORIGIN_OFFSET // Origin_DxDyDz
 };
 
+// The maps from XDMF attribute values to XDM types are built before main so
+// that trees can be built on several threads.
+
+// Mapping from 'GeometryType' attribute value to geometry type enum.
+typedef std::map< std::string, XdmfGeometryType > GeometryTypeMap;
+GeometryTypeMap makeGeometryTypes() {
+  GeometryTypeMap typeMap;
+  typeMap["XYZ"] = INTERLACED_3D;
+  typeMap["XY"] = INTERLACED_2D;
+  typeMap["X_Y_Z"] = MULTI_ARRAY;
+  typeMap["VXVYVZ"] = TENSOR_PRODUCT;
+  typeMap["ORIGIN_DXDYDZ"] = ORIGIN_OFFSET;
+  return typeMap;
+}
+const GeometryTypeMap sGeometryTypes = makeGeometryTypes();
+
+// Mapping from XDMF XML attribute type values to enumeration of types.
+typedef std::map< std::string, xdmGrid::Attribute::Type > AttributeTypeMap;
+AttributeTypeMap makeAttributeTypes() {
+  AttributeTypeMap typeMap;
+  typeMap["Scalar"] = xdmGrid::Attribute::kScalar;
+  typeMap["Vector"] = xdmGrid::Attribute::kVector;
+  typeMap["Tensor"] = xdmGrid::Attribute::kTensor;
+  typeMap["Tensor6"] = xdmGrid::Attribute::kTensor6;
+  typeMap["Matrix"] = xdmGrid::Attribute::kMatrix;
+  typeMap["GlobalID"] = xdmGrid::Attribute::kGlobalId;
+  return typeMap;
+}
+const AttributeTypeMap sAttributeTypes = makeAttributeTypes();
+
+// Mapping from XDMF XML attribute center values to enumeration of centering.
+typedef std::map< std::string, xdmGrid::Attribute::Center > AttributeCenterMap;
+AttributeCenterMap makeAttributeCenters() {
+  AttributeCenterMap centerMap;
+  centerMap["Node"] = xdmGrid::Attribute::kNode;
+  centerMap["Cell"] = xdmGrid::Attribute::kElement;
+  centerMap["Grid"] = xdmGrid::Attribute::kGrid;
+  centerMap["Face"] = xdmGrid::Attribute::kFace;
+  centerMap["Edge"] = xdmGrid::Attribute::kEdge;
+  return centerMap;
+}
+const AttributeCenterMap sAttributeCenters = makeAttributeCenters();
+
 // Generate an XPath expression that references descendant in the context of
 // ancestor.
 std::string generateXPathExpr(
   xmlDoc * doc,
   xmlNode * descendant,
-  xmlNode * ancestor )
+  xmlNode * ancestor,
+  SiblingPositionCache& cache )
 {
   // Find the path from the descendant to the ancestor.
-  NodePath path = findPathToAncestor( doc, descendant, ancestor );
+  NodePath path = findPathToAncestor( doc, descendant, ancestor, &cache );
   // Reverse the result to get the path from the ancestor to the descendant.
   std::reverse( path.begin(), path.end() );
   // Return the query string.
@@ -121,7 +166,18 @@ TreeBuilder::TreeBuilder(
   xdm::RefPtr< XmlDocumentManager > doc,
   xdm::RefPtr< SharedNodeVector > seriesGrids ) :
   mDoc( doc ),
-  mSeriesGrids( seriesGrids ) {
+  mSeriesGrids( seriesGrids ),
+  mStepGrid( 0 ),
+  mSiblingPositions(),
+  mIncludes() {
+}
+
+TreeBuilder::TreeBuilder( const TreeBuilder& parent ) :
+  mDoc( parent.mDoc ),
+  mSeriesGrids( parent.mSeriesGrids ),
+  mStepGrid( parent.mStepGrid ),
+  mSiblingPositions(),
+  mIncludes( parent.mIncludes ) {
 }
 
 TreeBuilder::~TreeBuilder() {
@@ -137,7 +193,7 @@ xdm::RefPtr< xdm::Item > TreeBuilder::buildTree() {
 //------------------------------------------------------------------------------
 xdm::RefPtr< xdm::UniformDataItem >
 TreeBuilder::buildUniformDataItem( xmlNode * node ) {
-  std::string path = generateXPathExpr( mDoc->get(), node, mSeriesGrids->at( 0 ) );
+  std::string path = itemPath( node );
   // Build the implementation item and return it.
   xdm::RefPtr< UniformDataItem > result( new UniformDataItem(
     mDoc,
@@ -153,24 +209,13 @@ xdm::RefPtr< xdmGrid::Geometry > TreeBuilder::buildGeometry( xmlNode * node ) {
 
   XdmfGeometryType geometryType( INTERLACED_3D );
 
-  // Mapping from 'GeometryType' attribute value to geometry type enum.
-  typedef std::map< std::string, XdmfGeometryType > TypeMap;
-  static TypeMap typeMap;
-  if ( typeMap.empty() ) {
-    typeMap["XYZ"] = INTERLACED_3D;
-    typeMap["XY"] = INTERLACED_2D;
-    typeMap["X_Y_Z"] = MULTI_ARRAY;
-    typeMap["VXVYVZ"] = TENSOR_PRODUCT;
-    typeMap["ORIGIN_DXDYDZ"] = ORIGIN_OFFSET;
-  }
-
   // Get the geometry type from the GeometryType attribute.
   XPathQuery geometryTypeQuery( mDoc->get(), node, "@GeometryType" );
   if ( geometryTypeQuery.size() > 0 ) {
     std::string typeString = geometryTypeQuery.textValue( 0 );
     xdm::toUpper( typeString );
-    TypeMap::const_iterator type = typeMap.find( typeString );
-    if ( type != typeMap.end() ) {
+    GeometryTypeMap::const_iterator type = sGeometryTypes.find( typeString );
+    if ( type != sGeometryTypes.end() ) {
       geometryType = type->second;
     } else {
       XDM_THROW( xdmFormat::ReadError( "Unrecognized XDMF GeometryType." ) );
@@ -440,29 +485,6 @@ xdm::RefPtr< xdmGrid::Topology > TreeBuilder::buildTopology( xmlNode * node ) {
 //------------------------------------------------------------------------------
 xdm::RefPtr< xdmGrid::Attribute >
 TreeBuilder::buildAttribute( xmlNode * node ) {
-  // Mapping from XDMF XML attribute type values to enumeration of types.
-  typedef std::map< std::string, xdmGrid::Attribute::Type > TypeMap;
-  static TypeMap typeMap;
-  if ( typeMap.empty() ) {
-    typeMap["Scalar"] = xdmGrid::Attribute::kScalar;
-    typeMap["Vector"] = xdmGrid::Attribute::kVector;
-    typeMap["Tensor"] = xdmGrid::Attribute::kTensor;
-    typeMap["Tensor6"] = xdmGrid::Attribute::kTensor6;
-    typeMap["Matrix"] = xdmGrid::Attribute::kMatrix;
-    typeMap["GlobalID"] = xdmGrid::Attribute::kGlobalId;
-  }
-
-  // Mapping from XDMF XML attribute center values to enumeration of centering.
-  typedef std::map< std::string, xdmGrid::Attribute::Center > CenterMap;
-  static CenterMap centerMap;
-  if ( centerMap.empty() ) {
-    centerMap["Node"] = xdmGrid::Attribute::kNode;
-    centerMap["Cell"] = xdmGrid::Attribute::kElement;
-    centerMap["Grid"] = xdmGrid::Attribute::kGrid;
-    centerMap["Face"] = xdmGrid::Attribute::kFace;
-    centerMap["Edge"] = xdmGrid::Attribute::kEdge;
-  }
-
   // create the result attribute.
   xdm::RefPtr< xdmGrid::Attribute > result( new xdmGrid::Attribute );
 
@@ -475,8 +497,9 @@ TreeBuilder::buildAttribute( xmlNode * node ) {
   // Get the attribute type
   XPathQuery typeQuery( mDoc->get(), node, "@AttributeType" );
   if ( typeQuery.size() > 0 ) {
-    TypeMap::const_iterator type = typeMap.find( typeQuery.textValue( 0 ) );
-    if ( type != typeMap.end() ) {
+    AttributeTypeMap::const_iterator type =
+      sAttributeTypes.find( typeQuery.textValue( 0 ) );
+    if ( type != sAttributeTypes.end() ) {
       result->setDataType( type->second );
     } else {
       XDM_THROW( xdmFormat::ReadError( "Unrecognized XDMF attribute type" ) );
@@ -489,8 +512,9 @@ TreeBuilder::buildAttribute( xmlNode * node ) {
   // Get the attribute center
   XPathQuery centerQuery( mDoc->get(), node, "@Center" );
   if ( centerQuery.size() > 0 ) {
-    CenterMap::const_iterator center = centerMap.find( centerQuery.textValue( 0 ) );
-    if ( center != centerMap.end() ) {
+    AttributeCenterMap::const_iterator center =
+      sAttributeCenters.find( centerQuery.textValue( 0 ) );
+    if ( center != sAttributeCenters.end() ) {
       result->setCentering( center->second );
     } else {
       XDM_THROW( xdmFormat::ReadError( "Unrecognized XDMF attribute center." ) );
@@ -517,25 +541,27 @@ TreeBuilder::buildUniformGrid( xmlNode * node ) {
 
   xdm::RefPtr< xdmGrid::UniformGrid > result( new xdmGrid::UniformGrid );
 
-  // Get the topology.
-  XPathQuery topologyQuery( mDoc->get(), node, "Topology" );
-  if ( topologyQuery.size() == 0 ) {
+  // Get the topology. It may be included from an earlier Grid.
+  std::vector< xmlNode * > topologyNodes;
+  findChildElements( node, kTopologyTag, topologyNodes );
+  if ( topologyNodes.size() == 0 ) {
     XDM_THROW( xdmFormat::ReadError( "XDMF Grid contains no Topology" ) );
   }
-  if ( topologyQuery.size() > 1 ) {
+  if ( topologyNodes.size() > 1 ) {
     XDM_THROW( xdmFormat::ReadError( "XDMF Grid contains more than one Topology" ) );
   }
-  result->setTopology( buildTopology( topologyQuery.node( 0 ) ) );
+  result->setTopology( buildTopology( topologyNodes[0] ) );
 
-  // Get the geometry.
-  XPathQuery geometryQuery( mDoc->get(), node, "Geometry" );
-  if ( geometryQuery.size() == 0 ) {
+  // Get the geometry. It may be included from an earlier Grid.
+  std::vector< xmlNode * > geometryNodes;
+  findChildElements( node, kGeometryTag, geometryNodes );
+  if ( geometryNodes.size() == 0 ) {
     XDM_THROW( xdmFormat::ReadError( "XDMF Grid contains no geometry." ) );
   }
-  if ( geometryQuery.size() > 1 ) {
+  if ( geometryNodes.size() > 1 ) {
     XDM_THROW( xdmFormat::ReadError( "XDMF Grid contains more than one Geometry" ) );
   }
-  result->setGeometry( buildGeometry( geometryQuery.node( 0 ) ) );
+  result->setGeometry( buildGeometry( geometryNodes[0] ) );
 
   // Read all the attributes.
   XPathQuery attributeQuery( mDoc->get(), node, "Attribute" );
@@ -583,8 +609,37 @@ TreeBuilder::buildSpatialCollectionGrid( xmlNode * node ) {
   xdm::RefPtr< xdmGrid::CollectionGrid > result( new xdmGrid::CollectionGrid );
   // Find all grid children of the node.
   XPathQuery childGridQuery( mDoc->get(), node, "Grid" );
-  for ( size_t i = 0; i < childGridQuery.size(); i++ ) {
-    result->appendGrid( buildGrid( childGridQuery.node( i ) ) );
+  std::vector< xdm::RefPtr< xdmGrid::Grid > > grids( childGridQuery.size() );
+
+#ifdef _OPENMP
+  // The child grids are independent, so build them concurrently. Each thread
+  // has its own builder, and so its own XPath contexts, and only reads the
+  // document. Exceptions may not propagate out of an OpenMP region. Record the
+  // first one and rethrow it once all threads have joined.
+  stepGrid();
+  xdm::ParallelErrorCapture error;
+  long numberOfGrids = static_cast< long >( grids.size() );
+  #pragma omp parallel if ( numberOfGrids > 1 )
+  {
+    TreeBuilder builder( *this );
+    #pragma omp for schedule( dynamic )
+    for ( long i = 0; i < numberOfGrids; ++i ) {
+      try {
+        grids[i] = builder.buildGrid( childGridQuery.node( i ) );
+      } catch ( ... ) {
+        error.capture();
+      }
+    }
+  }
+  error.rethrow();
+#else
+  for ( size_t i = 0; i < grids.size(); i++ ) {
+    grids[i] = buildGrid( childGridQuery.node( i ) );
+  }
+#endif
+
+  for ( size_t i = 0; i < grids.size(); i++ ) {
+    result->appendGrid( grids[i] );
   }
 
   readItem( result, node );
@@ -593,12 +648,85 @@ TreeBuilder::buildSpatialCollectionGrid( xmlNode * node ) {
 
 //------------------------------------------------------------------------------
 xdm::RefPtr< xdmGrid::Time > TreeBuilder::buildTime( xmlNode * node ) {
-  std::string path = generateXPathExpr( mDoc->get(), node, mSeriesGrids->at( 0 ) );
+  std::string path = itemPath( node );
   xdm::RefPtr< Time > result( new Time( mDoc, mSeriesGrids, path ) );
   readItem( result, node );
   return result;
 }
 
+//------------------------------------------------------------------------------
+void TreeBuilder::findChildElements(
+  xmlNode * node,
+  const char * tag,
+  std::vector< xmlNode * >& children ) {
+  for ( xmlNode * child = node->children; child; child = child->next ) {
+    if ( child->type != XML_ELEMENT_NODE ) {
+      continue;
+    }
+    xmlNode * element = child;
+    if ( isXInclude( child ) ) {
+      element = mSeriesGrids->includedElement( child );
+      if ( !element ) {
+        XDM_THROW( xdmFormat::ReadError( "XDMF XInclude refers to no element." ) );
+      }
+    }
+    if ( element->ns == 0 && xmlStrEqual( element->name, BAD_CAST tag ) ) {
+      if ( element != child ) {
+        mIncludes[ element ] = child;
+      }
+      children.push_back( element );
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+xmlNode * TreeBuilder::stepGrid() {
+  if ( !mStepGrid ) {
+    mStepGrid = mSeriesGrids->at( 0 );
+  }
+  return mStepGrid;
+}
+
+//------------------------------------------------------------------------------
+std::string TreeBuilder::itemPath( xmlNode * node ) {
+  xmlNode * stepGrid = this->stepGrid();
+  if ( mIncludes.empty() ) {
+    return generateXPathExpr( mDoc->get(), node, stepGrid, mSiblingPositions );
+  }
+
+  // Follow the parents of the node, jumping from included elements to the
+  // XIncludes they are being built for.
+  NodePath path;
+  xmlNode * descendant = node;
+  for ( xmlNode * ancestor = node; ancestor != stepGrid; ancestor = ancestor->parent ) {
+    if ( ancestor == 0 || ancestor == (xmlNode*)mDoc->get() ) {
+      return std::string();
+    }
+    std::map< xmlNode *, xmlNode * >::const_iterator include = mIncludes.find( ancestor );
+    if ( include == mIncludes.end() ) {
+      continue;
+    }
+    findPathToAncestor( mDoc->get(), descendant, ancestor, path, &mSiblingPositions );
+    // The included element takes the position of the XInclude among the
+    // elements of its name, as SharedNodeVector finds it.
+    std::size_t position = 0;
+    for ( xmlNode * sibling = include->second->prev; sibling; sibling = sibling->prev ) {
+      xmlNode * element = isXInclude( sibling ) ?
+        mSeriesGrids->includedElement( sibling ) : sibling;
+      if ( element && element->type == XML_ELEMENT_NODE
+        && xmlStrEqual( element->name, ancestor->name ) ) {
+        ++position;
+      }
+    }
+    pushNode( ancestor, position, path );
+    descendant = include->second->parent;
+    ancestor = include->second;
+  }
+  findPathToAncestor( mDoc->get(), descendant, stepGrid, path, &mSiblingPositions );
+  std::reverse( path.begin(), path.end() );
+  return makeXPathQuery( path );
+}
+
 //------------------------------------------------------------------------------
 void TreeBuilder::readItem( xdm::RefPtr< xdm::Item > item, xmlNode * node ) {
   XPathQuery nameQuery( mDoc->get(), node, "@Name" );
@@ -28,6 +28,8 @@
 #include <libxml/tree.h>
 #include <libxml/xpath.h>
 
+#include <map>
+#include <string>
 #include <vector>
 
 namespace xdm {
@@ -55,6 +57,10 @@ class XmlDocumentManager;
 
 /// Class to construct an XDM tree given an XML node that points to the root
 /// of an XDMF grid for a single time step.
+///
+/// In OpenMP builds (XDM_OPENMP), the child grids of a spatial collection are
+/// built concurrently, each thread reading the document through its own XPath
+/// contexts. The resulting collection keeps the document order of its grids.
 class TreeBuilder {
 public:
   
@@ -75,6 +81,9 @@ public:
   /// @todo Handle Hyperslab, coordinate, and function grids.
   xdm::RefPtr< xdmGrid::Grid > buildGrid( xmlNode * node );
 
+  /// Build a spatial collection from an XML node pointing to a Grid element.
+  /// The member grids may be built concurrently; an exception thrown building
+  /// one of them is rethrown with its own type when compiled as C++11.
   xdm::RefPtr< xdmGrid::CollectionGrid > buildSpatialCollectionGrid( xmlNode * node );
 
   xdm::RefPtr<xdmGrid::UniformGrid > buildUniformGrid( xmlNode * node );
@@ -100,11 +109,33 @@ public:
   void readItem( xdm::RefPtr< xdm::Item > item, xmlNode * node );
 
 private:
-  TreeBuilder( const TreeBuilder& );
+  // Copying a builder gives a builder for the same series that can build on
+  // another thread. Only the position caches are not shared.
+  TreeBuilder( const TreeBuilder& parent );
   TreeBuilder& operator=( const TreeBuilder& );
 
+  // Get the Grid node of the first step, which item paths are relative to.
+  xmlNode * stepGrid();
+
+  // Find the child elements of a node with a tag, following XIncludes. The
+  // XInclude of each included element is recorded so that paths to the items
+  // built from it go through the XInclude rather than the included element.
+  void findChildElements(
+    xmlNode * node,
+    const char * tag,
+    std::vector< xmlNode * >& children );
+
+  // Generate the path to an item's node relative to the first step Grid.
+  std::string itemPath( xmlNode * node );
+
   xdm::RefPtr< XmlDocumentManager > mDoc;
   xdm::RefPtr< SharedNodeVector > mSeriesGrids;
+  xmlNode * mStepGrid;
+  // Elements are built in document order, so remembering their positions
+  // among their siblings keeps path generation linear in the document size.
+  SiblingPositionCache mSiblingPositions;
+  // Map from included elements to the XInclude they are being built for.
+  std::map< xmlNode *, xmlNode * > mIncludes;
 };
 
 } // namespace impl
@@ -67,16 +67,28 @@ xdm::primitiveType::Value type( const std::string& typeStr, size_t precision ) {
   return xdm::primitiveType::kFloat;
 }
 
+// setContent() is run for every item at every step, so the queries are
+// compiled once. They are compiled during static initialization rather than on
+// first use, which C++03 does not make thread safe, because items may be built
+// from several threads at once.
+const CompiledXPath kNumberTypeExpr( "@NumberType" );
+const CompiledXPath kPrecisionExpr( "@Precision" );
+const CompiledXPath kDimensionsExpr( "@Dimensions" );
+const CompiledXPath kFormatExpr( "@Format" );
+const CompiledXPath kTextExpr( "text()" );
+
 void setContent( UniformDataItem& item, xmlDoc * document, xmlNode * node ) {
+  XPathContext context( document );
+
   // Get the number type from the NumberType attribute.
-  XPathQuery typeQuery( document, node, "@NumberType" );
+  XPathQuery typeQuery( context, node, kNumberTypeExpr );
   std::string typeString;
   if ( typeQuery.size() > 0 ) {
     typeString = typeQuery.textValue( 0 );
   } else {
     typeString = "Float";
   }
-  XPathQuery precisionQuery( document, node, "@Precision" );
+  XPathQuery precisionQuery( context, node, kPrecisionExpr );
   size_t precision;
   if ( precisionQuery.size() > 0 ) {
     precision = precisionQuery.getValue( 0, 4 );
@@ -87,14 +99,14 @@ void setContent( UniformDataItem& item, xmlDoc * document, xmlNode * node ) {
   item.setDataType( dataType );
 
   // Get the shape from the Dimensions attribute.
-  XPathQuery dimensionsQuery( document, node, "@Dimensions" );
+  XPathQuery dimensionsQuery( context, node, kDimensionsExpr );
   if ( dimensionsQuery.size() == 0 ) {
     XDM_THROW( xdmFormat::ReadError( "No dimensions for a UniformDataItem." ) );
   }
   item.setDataspace( xdm::makeShape( dimensionsQuery.textValue( 0 ) ) );
 
   // Get the format string for the dataset.
-  XPathQuery formatQuery( document, node, "@Format" );
+  XPathQuery formatQuery( context, node, kFormatExpr );
   std::string format( "HDF" );
   if ( formatQuery.size() > 0 ) {
     format = formatQuery.textValue( 0 );
@@ -108,7 +120,7 @@ void setContent( UniformDataItem& item, xmlDoc * document, xmlNode * node ) {
     } else {
       itemDataset = new xdmHdf::HdfDataset;
     }
-    XPathQuery datasetInfoQuery( document, node, "text()" );
+    XPathQuery datasetInfoQuery( context, node, kTextExpr );
     if ( datasetInfoQuery.size() == 0 ) {
       XDM_THROW( "No information about requested HDF dataset." );
     }
@@ -158,11 +170,17 @@ UniformDataItem::~UniformDataItem() {
 }
 
 void UniformDataItem::read( xmlNode * node, TreeBuilder& builder ) {
-  setContent( *this, document()->get(), node );
+  setContent( *this, node->doc, node );
 }
 
 void UniformDataItem::updateState( std::size_t seriesIndex ) {
-  setContent( *this, document()->get(), findNode( seriesIndex ) );
+  xmlNode * node = findNode( seriesIndex );
+  // Keep the dataset and any data loaded from it when the step includes the
+  // same element as the last one.
+  if ( includedContentUnchanged( seriesIndex ) ) {
+    return;
+  }
+  setContent( *this, node->doc, node );
 }
 
 } // namespace impl
@@ -25,6 +25,11 @@
 #include <libxml/xpath.h>
 
 #include <deque>
+#if __cplusplus >= 201103L
+#include <unordered_map>
+#else
+#include <map>
+#endif
 #include <sstream>
 #include <string>
 
@@ -75,12 +80,55 @@ inline std::string makeXPathQuery( const NodePath& nodePath ) {
   return result.str();
 }
 
+/// An XPath expression that is compiled once and evaluated many times, for
+/// queries made every time an item is read or updated.
+class CompiledXPath {
+public:
+  explicit CompiledXPath( const char * expression ) :
+    mExpression( xmlXPathCompile( (const xmlChar *)expression ) ) {
+    assert( mExpression );
+  }
+  ~CompiledXPath() {
+    xmlXPathFreeCompExpr( mExpression );
+  }
+
+  xmlXPathCompExprPtr get() const { return mExpression; }
+
+private:
+  CompiledXPath( const CompiledXPath& );
+  CompiledXPath& operator=( const CompiledXPath& );
+
+  xmlXPathCompExprPtr mExpression;
+};
+
+/// An XPath evaluation context for a document that can be shared by several
+/// queries. Creating a context is expensive compared to evaluating a compiled
+/// query, so code making many queries should share one.
+class XPathContext {
+public:
+  explicit XPathContext( xmlDoc * document ) :
+    mContext( xmlXPathNewContext( document ) ) {
+  }
+  ~XPathContext() {
+    xmlXPathFreeContext( mContext );
+  }
+
+  xmlXPathContextPtr get() const { return mContext; }
+
+private:
+  XPathContext( const XPathContext& );
+  XPathContext& operator=( const XPathContext& );
+
+  xmlXPathContextPtr mContext;
+};
+
 /// RAII class to manage an XPath query in LibXml and provide simplified access
 /// to its results. The lifetime of the underlying query object is tied to the
 /// lifetime of the XPathQuery object.
 class XPathQuery {
 private:
   xmlXPathContextPtr mXPathContext;
+  bool mOwnsContext;
   xmlXPathObjectPtr mXPathObject;
   size_t mSize;
 
@@ -92,6 +140,7 @@ public:
     xmlDoc * document,
     xmlNode * node,
     const std::string& query ) :
+    mOwnsContext( true ),
     mXPathObject( NULL )
   {
     mXPathContext = xmlXPathNewContext( document );
@@ -105,9 +154,30 @@ public:
     }
   }
 
+  /// Constructor takes a shared context, an XML node in which to query, and a
+  /// compiled query.
+  XPathQuery(
+    const XPathContext& context,
+    xmlNode * node,
+    const CompiledXPath& query ) :
+    mXPathContext( context.get() ),
+    mOwnsContext( false ),
+    mXPathObject( NULL )
+  {
+    mXPathContext->node = node;
+    mXPathObject = xmlXPathCompiledEval( query.get(), mXPathContext );
+    if ( mXPathObject && mXPathObject->nodesetval ) {
+      mSize = mXPathObject->nodesetval->nodeNr;
+    } else {
+      mSize = 0;
+    }
+  }
+
   ~XPathQuery() {
     xmlXPathFreeObject( mXPathObject );
-    xmlXPathFreeContext( mXPathContext );
+    if ( mOwnsContext ) {
+      xmlXPathFreeContext( mXPathContext );
+    }
   }
 
   size_t size() const {
@@ -151,43 +221,73 @@ public:
   }
 };
 
-/// Find a path to an ancestor (tail recursive implementation).
+/// Positions of element nodes among their siblings of the same name. The
+/// position of a node is counted from the nearest earlier sibling already in
+/// the cache, so finding the positions of every child of a node in document
+/// order visits each child once. Lookups take constant time on average where
+/// std::unordered_map is available and logarithmic time otherwise.
+#if __cplusplus >= 201103L
+typedef std::unordered_map< xmlNode *, size_t > SiblingPositionCache;
+#else
+typedef std::map< xmlNode *, size_t > SiblingPositionCache;
+#endif
+
+/// Get the 0-based position of an element among the elements of the same name
+/// under its parent, as used in XPath position predicates.
+/// @param cache Optional cache of positions, updated with the result.
+inline size_t siblingPosition( xmlNode * node, SiblingPositionCache * cache = 0 ) {
+  size_t position = 0;
+  for ( xmlNode * sibling = node->prev; sibling; sibling = sibling->prev ) {
+    if ( sibling->type != XML_ELEMENT_NODE
+      || sibling->ns != node->ns
+      || !xmlStrEqual( sibling->name, node->name ) ) {
+      continue;
+    }
+    if ( cache ) {
+      SiblingPositionCache::const_iterator known = cache->find( sibling );
+      if ( known != cache->end() ) {
+        position += known->second + 1;
+        break;
+      }
+    }
+    ++position;
+  }
+  if ( cache ) {
+    (*cache)[ node ] = position;
+  }
+  return position;
+}
+
+/// Find a path to an ancestor by walking up the parents of the descendant.
+/// The path is appended to the accumulator from the descendant up, and the
+/// accumulator is cleared if the ancestor is not found.
+/// @param cache Optional cache of sibling positions, see siblingPosition().
 inline void findPathToAncestor(
   xmlDoc * doc,
   xmlNode * descendant,
   xmlNode * ancestor,
-  NodePath& accumulator )
+  NodePath& accumulator,
+  SiblingPositionCache * cache = 0 )
 {
-  if ( descendant == (xmlNode*)doc || descendant == NULL ) {
-    accumulator.clear();
-    return;
-  }
-
-  if ( descendant == ancestor ) {
-    return;
-  }
-
-  // Determine which child of it's parent the descendant is
-  std::string queryString( (char *)descendant->name );
-  XPathQuery child( doc, descendant->parent, queryString );
-  size_t index = 0;
-  while( child.node(index) != descendant ) {
-    index++;
+  for ( ; descendant != ancestor; descendant = descendant->parent ) {
+    if ( descendant == (xmlNode*)doc || descendant == NULL ) {
+      accumulator.clear();
+      return;
+    }
+    // Determine which child of its parent the descendant is.
+    pushNode( descendant, siblingPosition( descendant, cache ), accumulator );
   }
-  pushNode( descendant, index, accumulator );
-
-  // Recurse to find the parent's path.
-  findPathToAncestor(
-    doc,
-    descendant->parent,
-    ancestor,
-    accumulator );
 }
 
-/// Find a path to an ancestor (entry point).
-inline NodePath findPathToAncestor( xmlDoc * doc, xmlNode * descendant, xmlNode * ancestor ) {
+/// Find a path to an ancestor, from the descendant up. The path is empty if
+/// the ancestor is not found.
+inline NodePath findPathToAncestor(
+  xmlDoc * doc,
+  xmlNode * descendant,
+  xmlNode * ancestor,
+  SiblingPositionCache * cache = 0 ) {
   NodePath result;
-  findPathToAncestor( doc, descendant, ancestor, result );
+  findPathToAncestor( doc, descendant, ancestor, result, cache );
   return result;
 }
 
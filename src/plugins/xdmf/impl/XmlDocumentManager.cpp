@@ -0,0 +1,249 @@
+//==============================================================================
+// This software developed by Stellar Science Ltd Co and the U.S. Government.
+// Copyright (C) 2009 Stellar Science. Government-purpose rights granted.
+//
+// This file is part of XDM
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+#include <xdmf/impl/XmlDocumentManager.hpp>
+
+#include <xdmFormat/IoExcept.hpp>
+
+#include <xdm/StreamMetadataOperation.hpp>
+#include <xdm/ThrowMacro.hpp>
+
+#include <sstream>
+
+#include <cstdlib>
+
+namespace xdmf {
+namespace impl {
+
+namespace {
+
+// Parse an XPointer of the form element(/1/2/3) into its child sequence.
+bool parseChildSequence(
+  const std::string& xpointer,
+  std::vector< std::size_t >& childSequence ) {
+  const std::string prefix( "element(/" );
+  if ( xpointer.compare( 0, prefix.size(), prefix ) != 0
+    || xpointer[ xpointer.size() - 1 ] != ')' ) {
+    return false;
+  }
+  childSequence.clear();
+  const char * position = xpointer.c_str() + prefix.size() - 1;
+  while ( *position == '/' ) {
+    char * end;
+    long element = std::strtol( position + 1, &end, 10 );
+    if ( end == position + 1 || element < 1 ) {
+      return false;
+    }
+    childSequence.push_back( element );
+    position = end;
+  }
+  return *position == ')' && position[1] == '\0';
+}
+
+} // namespace
+
+bool isXInclude( xmlNode * node ) {
+  return node->type == XML_ELEMENT_NODE
+    && node->ns
+    && xmlStrEqual( node->ns->href, BAD_CAST xdm::kXIncludeNamespace )
+    && xmlStrEqual( node->name, BAD_CAST "include" );
+}
+
+SharedNodeVector::SharedNodeVector() :
+  VectorBase(),
+  mPaths(),
+  mPathPrefixes(),
+  mHaveResolvedNodes( false ),
+  mResolvedIndex( 0 ),
+  mResolvedNodes(),
+  mResolvedIncludes() {
+}
+
+SharedNodeVector::~SharedNodeVector() {
+}
+
+std::size_t SharedNodeVector::registerPath( const std::string& path ) {
+  std::size_t key = 0;
+#ifdef _OPENMP
+  #pragma omp critical( xdmf_impl_SharedNodeVector )
+#endif
+  {
+    PathMap::const_iterator existing = mPaths.find( path );
+    if ( existing != mPaths.end() ) {
+      key = existing->second;
+    } else {
+      key = mPaths.size();
+      mPaths.insert( std::make_pair( path, key ) );
+      if ( !path.empty() ) {
+        for ( std::size_t slash = path.find( '/' );
+          slash != std::string::npos;
+          slash = path.find( '/', slash + 1 ) ) {
+          mPathPrefixes.insert( path.substr( 0, slash ) );
+        }
+        mPathPrefixes.insert( path );
+      }
+    }
+  }
+  return key;
+}
+
+xmlNode * SharedNodeVector::findNode( std::size_t pathKey, std::size_t index ) {
+  // Items registered since the step was searched are not in the table yet.
+  if ( !mHaveResolvedNodes
+    || mResolvedIndex != index
+    || pathKey >= mResolvedNodes.size() ) {
+    resolveNodes( index );
+  }
+  return mResolvedNodes.at( pathKey );
+}
+
+const std::string& SharedNodeVector::findInclude( std::size_t pathKey, std::size_t index ) {
+  findNode( pathKey, index );
+  return mResolvedIncludes.at( pathKey );
+}
+
+xmlNode * SharedNodeVector::includedElement( xmlNode * include ) {
+  xmlChar * href = xmlGetProp( include, BAD_CAST "href" );
+  xmlChar * xpointer = xmlGetProp( include, BAD_CAST "xpointer" );
+  std::vector< std::size_t > childSequence;
+  bool supported = !href && xpointer
+    && parseChildSequence( reinterpret_cast< const char * >( xpointer ), childSequence );
+  xmlFree( href );
+  xmlFree( xpointer );
+  if ( !supported ) {
+    XDM_THROW( xdmFormat::ReadError(
+      "Only XIncludes of an element() XPointer in the same XDMF document are supported." ) );
+  }
+  // Subclasses may load the document holding the element. Exceptions may not
+  // leave a critical section, so rethrow them after it.
+  xmlNode * element = 0;
+  std::string error;
+#ifdef _OPENMP
+  #pragma omp critical( xdmf_impl_SharedNodeVector )
+#endif
+  {
+    try {
+      element = findElement( include, childSequence );
+    } catch ( const std::exception& e ) {
+      error = e.what();
+    }
+  }
+  if ( !error.empty() ) {
+    XDM_THROW( xdmFormat::ReadError( error ) );
+  }
+  // An element cannot include itself or one of its ancestors.
+  for ( xmlNode * ancestor = include; element && ancestor; ancestor = ancestor->parent ) {
+    if ( ancestor == element ) {
+      return 0;
+    }
+  }
+  return element;
+}
+
+void SharedNodeVector::releaseNodes( std::size_t index ) {
+  if ( mHaveResolvedNodes && mResolvedIndex == index ) {
+    mHaveResolvedNodes = false;
+    mResolvedNodes.clear();
+    mResolvedIncludes.clear();
+  }
+}
+
+xmlNode * SharedNodeVector::findElement(
+  xmlNode * context,
+  const std::vector< std::size_t >& childSequence ) {
+  xmlNode * root = xmlDocGetRootElement( context->doc );
+  if ( !root || childSequence.empty() || childSequence[0] != 1 ) {
+    return 0;
+  }
+  return followChildSequence( root, childSequence, 1 );
+}
+
+xmlNode * SharedNodeVector::followChildSequence(
+  xmlNode * element,
+  const std::vector< std::size_t >& childSequence,
+  std::size_t first ) {
+  for ( std::size_t i = first; element && i < childSequence.size(); ++i ) {
+    std::size_t position = 0;
+    xmlNode * child = element->children;
+    for ( ; child; child = child->next ) {
+      if ( child->type == XML_ELEMENT_NODE && ++position == childSequence[i] ) {
+        break;
+      }
+    }
+    element = child;
+  }
+  return element;
+}
+
+void SharedNodeVector::resolveNodes( std::size_t index ) {
+  xmlNode * gridNode = at( index );
+  mHaveResolvedNodes = false;
+  mResolvedNodes.assign( mPaths.size(), static_cast< xmlNode * >( 0 ) );
+  mResolvedIncludes.assign( mPaths.size(), std::string() );
+  resolveChildNodes( gridNode, std::string(), std::string() );
+  mResolvedIndex = index;
+  mHaveResolvedNodes = true;
+}
+
+void SharedNodeVector::resolveChildNodes(
+  xmlNode * parent,
+  const std::string& parentPath,
+  const std::string& include ) {
+
+  // Count the elements of each name to match the XPath position predicates.
+  std::map< std::string, std::size_t > positions;
+  for ( xmlNode * node = parent->children; node; node = node->next ) {
+    if ( node->type != XML_ELEMENT_NODE ) {
+      continue;
+    }
+    // An included element takes the place of the XInclude.
+    xmlNode * child = node;
+    std::string childInclude( include );
+    if ( isXInclude( node ) ) {
+      child = includedElement( node );
+      if ( !child ) {
+        continue;
+      }
+      xmlChar * xpointer = xmlGetProp( node, BAD_CAST "xpointer" );
+      childInclude = reinterpret_cast< const char * >( xpointer );
+      xmlFree( xpointer );
+    }
+    std::string name( reinterpret_cast< const char * >( child->name ) );
+    std::ostringstream path;
+    if ( !parentPath.empty() ) {
+      path << parentPath << '/';
+    }
+    path << name << '[' << ++positions[name] << ']';
+
+    // Only descend toward registered nodes.
+    if ( mPathPrefixes.count( path.str() ) == 0 ) {
+      continue;
+    }
+    PathMap::const_iterator registered = mPaths.find( path.str() );
+    if ( registered != mPaths.end() ) {
+      mResolvedNodes[ registered->second ] = child;
+      mResolvedIncludes[ registered->second ] = childInclude;
+    }
+    resolveChildNodes( child, path.str(), childInclude );
+  }
+}
+
+} // namespace impl
+} // namespace xdmf
@@ -26,27 +26,111 @@
 
 #include <libxml/tree.h>
 
+#include <map>
+#include <set>
+#include <string>
 #include <vector>
 
 namespace xdmf {
 namespace impl {
 
-/// A reference counted std vector of xmlNodes.
+/// A reference counted vector of the XML Grid nodes for each step of a series,
+/// shared by every item read from the series. Subclasses may load the nodes on
+/// demand, so a node is only guaranteed to be valid until at() is next called
+/// for a different step.
+///
+/// The vector also finds the nodes of the items within each step. Items
+/// register their path relative to the step Grid once, and the nodes for every
+/// registered path are resolved together the first time a step is searched.
+/// Only the nodes of the most recently searched step are kept, which is all an
+/// update of the item tree to a new step needs.
+///
+/// XInclude elements within a step are followed while searching: an element
+/// included from elsewhere in the document is found at the position of the
+/// XInclude, under the name of the included element. Only XIncludes within the
+/// same document with an XPointer element() child sequence are supported.
+///
+/// Items may be built on several threads at once, so registerPath and
+/// includedElement are safe to call concurrently in OpenMP builds. Finding
+/// nodes while the tree is updated is not.
 class SharedNodeVector :
   public xdm::ReferencedObject,
   private std::vector< xmlNode * >
 {
   typedef std::vector< xmlNode * > VectorBase;
 public:
-  SharedNodeVector() : VectorBase() {}
-  virtual ~SharedNodeVector() {}
+  SharedNodeVector();
+  virtual ~SharedNodeVector();
 
   using VectorBase::push_back;
-  using VectorBase::operator[];
-  using VectorBase::size;
-  using VectorBase::at;
+
+  /// Get the number of steps in the series.
+  virtual std::size_t size() const { return VectorBase::size(); }
+  /// Get the Grid node for a step in the series.
+  virtual xmlNode * at( std::size_t index ) { return VectorBase::at( index ); }
+  xmlNode * operator[]( std::size_t index ) { return at( index ); }
+
+  /// Register the path to an item's node relative to the step Grid, as made by
+  /// makeXPathQuery. Items registering the same path share a key.
+  /// @return The key to pass to findNode.
+  std::size_t registerPath( const std::string& path );
+
+  /// Find the node at a registered path within a step.
+  /// @param pathKey The key returned by registerPath.
+  /// @param index The series index of the step.
+  /// @return The node, or 0 if the step has no node at the path.
+  xmlNode * findNode( std::size_t pathKey, std::size_t index );
+
+  /// Get the XPointer of the XInclude that the node at a registered path was
+  /// found through within a step, or an empty string if the node is part of
+  /// the step itself. Nodes found through the same XPointer in different
+  /// steps have the same content.
+  const std::string& findInclude( std::size_t pathKey, std::size_t index );
+
+  /// Find the element included by an XInclude element.
+  /// @return The included element, or 0 if there is no such element.
+  /// @throws xdmFormat::ReadError if the XInclude is not supported.
+  xmlNode * includedElement( xmlNode * include );
+
+protected:
+  /// Forget the nodes found within a step. Subclasses must call this before
+  /// releasing the document holding a step.
+  void releaseNodes( std::size_t index );
+
+  /// Find the element at an XPointer child sequence of 1-based element
+  /// positions, starting with the root element of the document holding a node.
+  /// Subclasses holding the steps in separate documents must override this.
+  virtual xmlNode * findElement(
+    xmlNode * context,
+    const std::vector< std::size_t >& childSequence );
+
+  /// Follow a child sequence down from an element, starting at an offset in
+  /// the sequence. Returns 0 if an element in the sequence does not exist.
+  static xmlNode * followChildSequence(
+    xmlNode * element,
+    const std::vector< std::size_t >& childSequence,
+    std::size_t first );
+
+private:
+  void resolveNodes( std::size_t index );
+  void resolveChildNodes(
+    xmlNode * parent,
+    const std::string& parentPath,
+    const std::string& include );
+
+  typedef std::map< std::string, std::size_t > PathMap;
+  PathMap mPaths;
+  // The paths of every element on the way to a registered node.
+  std::set< std::string > mPathPrefixes;
+  bool mHaveResolvedNodes;
+  std::size_t mResolvedIndex;
+  std::vector< xmlNode * > mResolvedNodes;
+  std::vector< std::string > mResolvedIncludes;
 };
 
+/// Determine whether a node is an XInclude element.
+bool isXInclude( xmlNode * node );
+
 /// A reference counted RAII class for an XML document.
 class XmlDocumentManager : public xdm::ReferencedObject {
 public:
@@ -30,22 +30,30 @@
 #include <xdm/AllDataSelection.hpp>
 #include <xdm/DataSelectionMap.hpp>
 #include <xdm/Dataset.hpp>
+#include <xdm/ItemVisitor.hpp>
 #include <xdm/TypedStructuredArray.hpp>
 #include <xdm/VectorStructuredArray.hpp>
 #include <xdm/UniformDataItem.hpp>
 
 #include <xdmGrid/Attribute.hpp>
+#include <xdmGrid/CollectionGrid.hpp>
 #include <xdmGrid/StructuredTopology.hpp>
 #include <xdmGrid/TensorProductGeometry.hpp>
 #include <xdmGrid/Time.hpp>
 #include <xdmGrid/UniformGrid.hpp>
 #include <xdmGrid/UnstructuredTopology.hpp>
 
+#include <xdmFormat/IoExcept.hpp>
+
 #include <xdmHdf/HdfDataset.hpp>
 
 #include <libxml/parser.h>
 #include <libxml/tree.h>
 
+#include <sstream>
+#include <vector>
+
+
 namespace {
 
 using xdm::RefPtr;
@@ -125,6 +133,167 @@ BOOST_AUTO_TEST_CASE( findPathToAncestorTest ) {
   xmlFreeDoc( document );
 }
 
+BOOST_AUTO_TEST_CASE( siblingPositionCache ) {
+  char const * const kXml =
+    "<grid>"
+    "  <attribute/>"
+    "  <!-- comment -->"
+    "  <dataitem/>"
+    "  <attribute/>"
+    "  <attribute/>"
+    "  <dataitem/>"
+    "  <attribute/>"
+    "</grid>";
+
+  xmlDocPtr document = xmlParseDoc( (xmlChar*)kXml );
+  xmlNode * rootNode = xmlDocGetRootElement( document );
+
+  const size_t answer[] = { 0, 0, 1, 2, 1, 3 };
+  xdmf::impl::SiblingPositionCache cache;
+  size_t i = 0;
+  for ( xmlNode * child = rootNode->children; child; child = child->next ) {
+    if ( child->type == XML_ELEMENT_NODE ) {
+      BOOST_CHECK_EQUAL( answer[i], xdmf::impl::siblingPosition( child ) );
+      BOOST_CHECK_EQUAL( answer[i], xdmf::impl::siblingPosition( child, &cache ) );
+      ++i;
+    }
+  }
+  BOOST_CHECK_EQUAL( 6u, i );
+
+  xmlFreeDoc( document );
+}
+
+// Every item of a grid with many sibling items must find its node.
+BOOST_AUTO_TEST_CASE( buildGridWithManySiblings ) {
+  const int kAttributes = 1000;
+  std::ostringstream xml;
+  xml << "<Grid Name='large'>"
+    "<Topology TopologyType='2DCoRectMesh' Dimensions='3 4'/>"
+    "<Geometry GeometryType='VxVyVz'>"
+    "<DataItem Dimensions='4' NumberType='Float' Precision='8'>data.h5:/x</DataItem>"
+    "<DataItem Dimensions='3' NumberType='Float' Precision='8'>data.h5:/y</DataItem>"
+    "</Geometry>";
+  for ( int i = 0; i < kAttributes; ++i ) {
+    xml << "<Attribute Name='attr" << i << "' Center='Node'>"
+      "<DataItem Dimensions='3 4' NumberType='Float' Precision='8'>data.h5:/attr"
+      << i << "</DataItem></Attribute>";
+  }
+  xml << "</Grid>";
+
+  RefPtr< XmlDocumentManager > doc = loadXml( xml.str().c_str() );
+  RefPtr< SharedNodeVector > nodes( new SharedNodeVector );
+  nodes->push_back( xmlDocGetRootElement( doc->get() ) );
+
+  xdmf::impl::TreeBuilder builder( doc, nodes );
+  xdm::RefPtr< xdmGrid::UniformGrid > grid =
+    xdm::dynamic_pointer_cast< xdmGrid::UniformGrid >( builder.buildTree() );
+  BOOST_REQUIRE( grid );
+  BOOST_REQUIRE_EQUAL( std::size_t( kAttributes ), grid->numberOfAttributes() );
+
+  // Each attribute must find its own node when the tree is updated.
+  xdmGrid::Grid::AttributeIterator attribute = grid->beginAttributes();
+  for ( int i = 0; i < kAttributes; ++i, ++attribute ) {
+    std::ostringstream name;
+    name << "attr" << i;
+    std::ostringstream path;
+    path << "Attribute[" << i + 1 << "]/DataItem[1]";
+    xdm::RefPtr< xdmf::impl::UniformDataItem > item =
+      xdm::dynamic_pointer_cast< xdmf::impl::UniformDataItem >( (*attribute)->dataItem() );
+    BOOST_REQUIRE( item );
+    BOOST_CHECK_EQUAL( name.str(), (*attribute)->name() );
+    BOOST_CHECK_EQUAL( path.str(), item->xpathExpr() );
+  }
+  xdm::RefPtr< xdmf::impl::UniformDataItem > last =
+    xdm::dynamic_pointer_cast< xdmf::impl::UniformDataItem >(
+      (*(grid->endAttributes() - 1))->dataItem() );
+  BOOST_CHECK( last->findNode( 0 ) );
+}
+
+// Collect the uniform grids a collection is made of.
+struct CollectGrids : xdm::ItemVisitor {
+  std::vector< xdm::RefPtr< xdmGrid::UniformGrid > > mGrids;
+  virtual void apply( xdm::Item& item ) {
+    mGrids.push_back( xdm::RefPtr< xdmGrid::UniformGrid >(
+      dynamic_cast< xdmGrid::UniformGrid* >( &item ) ) );
+  }
+};
+
+// Write a spatial collection of uniform grids, each with its own data.
+std::string collectionXml( int grids ) {
+  std::ostringstream xml;
+  xml << "<Grid Name='blocks' GridType='Collection' CollectionType='Spatial'>";
+  for ( int i = 0; i < grids; ++i ) {
+    xml << "<Grid Name='block" << i << "'>"
+      "<Topology TopologyType='Hexahedron' NumberOfElements='2'>"
+      "<DataItem Dimensions='2 8' NumberType='Int' Precision='4'>data.h5:/block"
+      << i << "/connectivity</DataItem></Topology>"
+      "<Geometry GeometryType='XYZ'>"
+      "<DataItem Dimensions='12 3' NumberType='Float' Precision='8'>data.h5:/block"
+      << i << "/xyz</DataItem></Geometry>"
+      "<Attribute Name='temperature' Center='Cell'>"
+      "<DataItem Dimensions='2' NumberType='Float' Precision='8'>data.h5:/block"
+      << i << "/temperature</DataItem></Attribute>"
+      "</Grid>";
+  }
+  xml << "</Grid>";
+  return xml.str();
+}
+
+BOOST_AUTO_TEST_CASE( buildSpatialCollection ) {
+  const int kGrids = 50;
+  RefPtr< XmlDocumentManager > doc = loadXml( collectionXml( kGrids ).c_str() );
+  RefPtr< SharedNodeVector > nodes( new SharedNodeVector );
+  nodes->push_back( xmlDocGetRootElement( doc->get() ) );
+
+  xdmf::impl::TreeBuilder builder( doc, nodes );
+  xdm::RefPtr< xdmGrid::CollectionGrid > collection =
+    xdm::dynamic_pointer_cast< xdmGrid::CollectionGrid >( builder.buildTree() );
+  BOOST_REQUIRE( collection );
+  CollectGrids grids;
+  collection->traverse( grids );
+  BOOST_REQUIRE_EQUAL( std::size_t( kGrids ), grids.mGrids.size() );
+
+  // The grids keep the document order however they were built.
+  for ( int i = 0; i < kGrids; ++i ) {
+    xdm::RefPtr< xdmGrid::UniformGrid > grid = grids.mGrids[i];
+    std::ostringstream name;
+    name << "block" << i;
+    BOOST_CHECK_EQUAL( name.str(), grid->name() );
+
+    std::ostringstream path;
+    path << "Grid[" << i + 1 << "]/Attribute[1]/DataItem[1]";
+    xdm::RefPtr< xdmf::impl::UniformDataItem > data =
+      xdm::dynamic_pointer_cast< xdmf::impl::UniformDataItem >(
+        grid->attributeByName( "temperature" )->dataItem() );
+    BOOST_REQUIRE( data );
+    BOOST_CHECK_EQUAL( path.str(), data->xpathExpr() );
+    BOOST_CHECK( data->findNode( 0 ) );
+
+    xdm::RefPtr< xdmHdf::HdfDataset > dataset =
+      xdm::dynamic_pointer_cast< xdmHdf::HdfDataset >( data->dataset() );
+    BOOST_REQUIRE( dataset );
+    BOOST_CHECK_EQUAL( name.str(), dataset->groupPath().back() );
+  }
+}
+
+// A failure building one member of a collection reaches the caller with its
+// own type, however the members were built.
+BOOST_AUTO_TEST_CASE( buildCollectionBadMember ) {
+  std::string xml = collectionXml( 20 );
+  xml.insert( xml.size() - std::string( "</Grid>" ).size(),
+    "<Grid Name='bad' GridType='Tree'/>" );
+  RefPtr< XmlDocumentManager > doc = loadXml( xml.c_str() );
+  RefPtr< SharedNodeVector > nodes( new SharedNodeVector );
+  nodes->push_back( xmlDocGetRootElement( doc->get() ) );
+
+  xdmf::impl::TreeBuilder builder( doc, nodes );
+#if defined( _OPENMP ) && __cplusplus < 201103L
+  BOOST_CHECK_THROW( builder.buildTree(), std::runtime_error );
+#else
+  BOOST_CHECK_THROW( builder.buildTree(), xdmFormat::ReadError );
+#endif
+}
+
 BOOST_AUTO_TEST_CASE( buildUniformDataItem ) {
   char const * const kXml =
   "<DataItem Name='test' "
@@ -0,0 +1,251 @@
+//==============================================================================
+// This software developed by Stellar Science Ltd Co and the U.S. Government.  
+// Copyright (C) 2009 Stellar Science. Government-purpose rights granted.      
+//                                                                             
+// This file is part of XDM                                                    
+//                                                                             
+// This program is free software: you can redistribute it and/or modify it     
+// under the terms of the GNU Lesser General Public License as published by    
+// the Free Software Foundation, either version 3 of the License, or (at your  
+// option) any later version.                                                  
+//                                                                             
+// This program is distributed in the hope that it will be useful, but WITHOUT 
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        
+// License for more details.                                                   
+//                                                                             
+// You should have received a copy of the GNU Lesser General Public License    
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.       
+//                                                                             
+//------------------------------------------------------------------------------
+#define BOOST_TEST_MODULE TemporalCollection
+#include <boost/test/unit_test.hpp>
+
+#include <xdmf/TemporalCollection.hpp>
+#include <xdmf/XmfReader.hpp>
+
+#include <xdm/FileSystem.hpp>
+#include <xdm/UniformDataItem.hpp>
+
+#include <xdmFormat/IoExcept.hpp>
+
+#include <xdmGrid/RectilinearMesh.hpp>
+#include <xdmGrid/TensorProductGeometry.hpp>
+#include <xdmGrid/Time.hpp>
+#include <xdmGrid/UniformGrid.hpp>
+
+#include <xdmHdf/HdfDataset.hpp>
+
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Build a grid whose data items refer to HDF datasets. Only the metadata is
+// written in these tests.
+xdm::RefPtr< xdmGrid::UniformGrid > buildGrid() {
+  xdm::RefPtr< xdmGrid::UniformGrid > grid( new xdmGrid::UniformGrid );
+  grid->setName( "grid" );
+  grid->setTime( xdm::makeRefPtr( new xdmGrid::Time( 0.0 ) ) );
+
+  xdm::RefPtr< xdmGrid::RectilinearMesh > topology( new xdmGrid::RectilinearMesh );
+  topology->setShape( xdm::makeShape( 3, 2 ) );
+  grid->setTopology( topology );
+
+  xdm::RefPtr< xdmGrid::TensorProductGeometry > geometry(
+    new xdmGrid::TensorProductGeometry( 2 ) );
+  for ( int i = 0; i < 2; ++i ) {
+    xdm::RefPtr< xdmHdf::HdfDataset > dataset( new xdmHdf::HdfDataset );
+    dataset->setFile( "TemporalCollection.h5" );
+    dataset->setDataset( i == 0 ? "x" : "y" );
+    xdm::RefPtr< xdm::UniformDataItem > data(
+      new xdm::UniformDataItem( xdm::primitiveType::kDouble, xdm::makeShape( 4 - i ) ) );
+    data->setDataset( dataset );
+    geometry->setCoordinateValues( i, data );
+  }
+  grid->setGeometry( geometry );
+  return grid;
+}
+
+void writeStep( xdmf::TemporalCollection& series, xdmGrid::UniformGrid& grid, int step ) {
+  xdm::const_pointer_cast< xdmGrid::Time >( grid.time() )->setValue( step );
+  series.writeGridMetadata( xdm::RefPtr< xdmGrid::Grid >( &grid ) );
+}
+
+std::size_t readSteps( const std::string& file ) {
+  xdmf::XmfReader reader;
+  return reader.readItem( xdm::FileSystemPath( file ) ).seriesSteps();
+}
+
+// Read every step of a series, describing each by its time and the names of
+// its coordinate datasets.
+std::vector< std::string > stepContents( const std::string& file, bool streaming ) {
+  xdmf::XmfReader reader;
+  reader.setStreaming( streaming );
+  const xdm::FileSystemPath path( file );
+  xdmFormat::ReadResult result = reader.readItem( path );
+  std::vector< std::string > steps;
+  for ( std::size_t step = 0; step < result.seriesSteps(); ++step ) {
+    reader.update( result.item(), path, step );
+    xdm::RefPtr< xdmGrid::UniformGrid > grid =
+      xdm::dynamic_pointer_cast< xdmGrid::UniformGrid >( result.item() );
+    xdm::RefPtr< xdmGrid::Geometry > geometry = grid->geometry();
+    std::ostringstream description;
+    description << grid->time()->value();
+    for ( int i = 0; i < 2; ++i ) {
+      xdm::RefPtr< xdmHdf::HdfDataset > dataset =
+        xdm::dynamic_pointer_cast< xdmHdf::HdfDataset >(
+          geometry->child( i )->dataset() );
+      description << " " << dataset->dataset();
+    }
+    steps.push_back( description.str() );
+  }
+  return steps;
+}
+
+std::string fileContents( const std::string& file ) {
+  std::ifstream in( file.c_str(), std::ios::in | std::ios::binary );
+  return std::string(
+    std::istreambuf_iterator< char >( in ),
+    std::istreambuf_iterator< char >() );
+}
+
+BOOST_AUTO_TEST_CASE( validAfterEveryStep ) {
+  const std::string file( "TemporalCollection.validAfterEveryStep.xmf" );
+  xdm::RefPtr< xdmGrid::UniformGrid > grid = buildGrid();
+
+  xdm::RefPtr< xdmf::TemporalCollection > series(
+    new xdmf::TemporalCollection( file, xdm::Dataset::kCreate ) );
+  series->open();
+  for ( int step = 0; step < 3; ++step ) {
+    writeStep( *series, *grid, step );
+    // The series is still open, as it would be in a running simulation.
+    BOOST_CHECK_EQUAL( std::size_t( step + 1 ), readSteps( file ) );
+  }
+  std::string beforeClose = fileContents( file );
+  series->close();
+  BOOST_CHECK_EQUAL( beforeClose, fileContents( file ) );
+}
+
+BOOST_AUTO_TEST_CASE( appendToCollection ) {
+  const std::string appended( "TemporalCollection.appended.xmf" );
+  const std::string whole( "TemporalCollection.whole.xmf" );
+  xdm::RefPtr< xdmGrid::UniformGrid > grid = buildGrid();
+
+  {
+    xdmf::TemporalCollection series( whole, xdm::Dataset::kCreate );
+    series.open();
+    for ( int step = 0; step < 4; ++step ) {
+      writeStep( series, *grid, step );
+    }
+    series.close();
+  }
+
+  {
+    // Stop after two steps without closing the series.
+    xdmf::TemporalCollection series( appended, xdm::Dataset::kCreate );
+    series.open();
+    writeStep( series, *grid, 0 );
+    writeStep( series, *grid, 1 );
+  }
+  {
+    xdmf::TemporalCollection series( appended, xdm::Dataset::kModify );
+    series.open();
+    writeStep( series, *grid, 2 );
+    writeStep( series, *grid, 3 );
+    series.close();
+  }
+
+  // The resumed series writes its own Topology and Geometry instead of
+  // including those of the first two steps, so compare what is read back.
+  BOOST_CHECK_EQUAL( std::size_t( 4 ), readSteps( appended ) );
+  BOOST_CHECK( stepContents( whole, false ) == stepContents( appended, false ) );
+
+  // The series records its number of steps instead of reading them back.
+  BOOST_CHECK_NE( std::string::npos, fileContents( appended ).find( "<!-- Steps: 4 -->" ) );
+}
+
+BOOST_AUTO_TEST_CASE( appendWithoutStepCount ) {
+  const std::string file( "TemporalCollection.withoutStepCount.xmf" );
+  xdm::RefPtr< xdmGrid::UniformGrid > grid = buildGrid();
+  {
+    xdmf::TemporalCollection series( file, xdm::Dataset::kCreate );
+    series.open();
+    writeStep( series, *grid, 0 );
+    writeStep( series, *grid, 1 );
+    series.close();
+  }
+
+  // A collection written without the step count comment is scanned instead.
+  std::string contents = fileContents( file );
+  const std::string comment( "<!-- Steps: 2 -->\n" );
+  std::size_t at = contents.find( comment );
+  BOOST_REQUIRE_NE( std::string::npos, at );
+  contents.erase( at, comment.size() );
+  {
+    std::ofstream out( file.c_str(), std::ios::out | std::ios::trunc | std::ios::binary );
+    out << contents;
+  }
+  {
+    xdmf::TemporalCollection series( file, xdm::Dataset::kModify );
+    series.open();
+    writeStep( series, *grid, 2 );
+    series.close();
+  }
+
+  BOOST_CHECK_EQUAL( std::size_t( 3 ), readSteps( file ) );
+  BOOST_CHECK_NE( std::string::npos, fileContents( file ).find( "<!-- Steps: 3 -->" ) );
+  std::vector< std::string > steps = stepContents( file, false );
+  BOOST_REQUIRE_EQUAL( std::size_t( 3 ), steps.size() );
+  BOOST_CHECK_EQUAL( "2 x y", steps[2] );
+}
+
+BOOST_AUTO_TEST_CASE( repeatedElementsIncluded ) {
+  const std::string file( "TemporalCollection.included.xmf" );
+  xdm::RefPtr< xdmGrid::UniformGrid > grid = buildGrid();
+  {
+    xdmf::TemporalCollection series( file, xdm::Dataset::kCreate );
+    series.open();
+    for ( int step = 0; step < 3; ++step ) {
+      writeStep( series, *grid, step );
+    }
+    series.close();
+  }
+
+  // The first step is written in full and later steps include its Topology and
+  // Geometry.
+  std::string contents = fileContents( file );
+  BOOST_CHECK( contents.find( "<Topology" ) < contents.find( "<xi:include" ) );
+  std::size_t includes = 0;
+  for ( std::size_t at = contents.find( "<xi:include" ); at != std::string::npos;
+    at = contents.find( "<xi:include", at + 1 ) ) {
+    ++includes;
+  }
+  BOOST_CHECK_EQUAL( std::size_t( 4 ), includes );
+  BOOST_CHECK_NE( std::string::npos, contents.find( "xpointer='element(/1/1/1/1/2)'" ) );
+  BOOST_CHECK_NE( std::string::npos, contents.find( "xpointer='element(/1/1/1/1/3)'" ) );
+
+  std::vector< std::string > expected;
+  for ( int step = 0; step < 3; ++step ) {
+    std::ostringstream value;
+    value << step << " x y";
+    expected.push_back( value.str() );
+  }
+  BOOST_CHECK( expected == stepContents( file, false ) );
+  BOOST_CHECK( expected == stepContents( file, true ) );
+}
+
+BOOST_AUTO_TEST_CASE( appendToOtherDocument ) {
+  const std::string file( "TemporalCollection.other.xmf" );
+  {
+    std::ofstream out( file.c_str() );
+    out << "<?xml version='1.0'?>\n<Xdmf Version='2.1'>\n</Xdmf>\n";
+  }
+  xdmf::TemporalCollection series( file, xdm::Dataset::kModify );
+  BOOST_CHECK_THROW( series.open(), xdmFormat::WriteError );
+}
+
+} // namespace
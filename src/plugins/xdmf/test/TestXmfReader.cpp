@@ -24,6 +24,8 @@
 #include <xdmf/XmfReader.hpp>
 #include <xdmf/XmfWriter.hpp>
 
+#include <xdmf/impl/StepIndex.hpp>
+
 #include <xdm/ArrayAdapter.hpp>
 #include <xdm/Item.hpp>
 #include <xdm/UniformDataItem.hpp>
@@ -40,6 +42,9 @@
 
 #include <algorithm>
 #include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
 
 #include <cmath>
 
@@ -169,6 +174,342 @@ BOOST_AUTO_TEST_CASE( invalidDocument ) {
     xdmFormat::FileReadError );
 }
 
+// True if reading the file fails schema validation. Documents that skip
+// validation may still fail later, while the tree is built.
+bool failsValidation( xdmf::XmfReader& reader, const xdm::FileSystemPath& path ) {
+  try {
+    reader.readItem( path );
+  } catch ( const xdmFormat::FileReadError& ) {
+    return true;
+  } catch ( const std::exception& ) {
+  }
+  return false;
+}
+
+BOOST_AUTO_TEST_CASE( validationOptions ) {
+  const char * kXml = "<Xdmf Version='2.1'><foo/></Xdmf>";
+  const xdm::FileSystemPath invalidPath( "validationOptionsFile.xmf" );
+  const xdm::FileSystemPath validPath( "test_document1.xmf" );
+  {
+    std::ofstream testfile( invalidPath.pathString().c_str() );
+    testfile << kXml;
+  }
+
+  xdmf::XmfReader reader;
+  BOOST_CHECK_EQUAL( xdmf::XmfReader::kValidateAll, reader.validation() );
+
+  // A document that fails validation does not count as the first one.
+  reader.setValidation( xdmf::XmfReader::kValidateFirst );
+  BOOST_CHECK( failsValidation( reader, invalidPath ) );
+  BOOST_CHECK( reader.readItem( validPath ).item() );
+  BOOST_CHECK( ! failsValidation( reader, invalidPath ) );
+
+  reader.setValidation( xdmf::XmfReader::kValidateAll );
+  BOOST_CHECK( failsValidation( reader, invalidPath ) );
+
+  xdmf::XmfReader trusting;
+  trusting.setValidation( xdmf::XmfReader::kValidateNone );
+  BOOST_CHECK( ! failsValidation( trusting, invalidPath ) );
+}
+
+// Every validation mode must build the same tree from a valid document.
+BOOST_AUTO_TEST_CASE( validationModesAgree ) {
+  const xdm::FileSystemPath path( "test_document1.xmf" );
+
+  xdmf::XmfReader reader;
+  xdmf::XmfReader::Validation modes[] = {
+    xdmf::XmfReader::kValidateAll,
+    xdmf::XmfReader::kValidateFirst,
+    xdmf::XmfReader::kValidateNone };
+  std::string names[3];
+  for ( int mode = 0; mode < 3; ++mode ) {
+    reader.setValidation( modes[mode] );
+    xdmFormat::ReadResult result = reader.readItem( path );
+    BOOST_REQUIRE( result.item() );
+    names[mode] = result.item()->name();
+  }
+  BOOST_CHECK_EQUAL( names[0], names[1] );
+  BOOST_CHECK_EQUAL( names[0], names[2] );
+}
+
+// Write a temporal collection with a uniform grid per step. The data items
+// refer to HDF datasets that do not exist; only the metadata is read.
+void writeTemporalDocument(
+  const xdm::FileSystemPath& path,
+  int numberOfSteps,
+  int numberOfAttributes = 1 ) {
+  std::ofstream file( path.pathString().c_str() );
+  file << "<?xml version='1.0'?>\n"
+    "<Xdmf Version='2.1' xmlns:xi='http://www.w3.org/2001/XInclude'>\n"
+    "  <Domain>\n"
+    "    <Grid GridType='Collection' CollectionType='Temporal' Name='Series'>\n";
+  for ( int step = 0; step < numberOfSteps; ++step ) {
+    file <<
+      "      <Grid GridType='Uniform' Name='Step" << step << "'>\n"
+      "        <Time Value='" << step << "'/>\n"
+      "        <Topology TopologyType='2DCoRectMesh' Dimensions='3 4'/>\n"
+      "        <Geometry GeometryType='VxVyVz'>\n"
+      "          <DataItem Dimensions='4' Format='HDF' NumberType='Float' Precision='8'>"
+      "data.h5:/Geometry/x</DataItem>\n"
+      "          <DataItem Dimensions='3' Format='HDF' NumberType='Float' Precision='8'>"
+      "data.h5:/Geometry/y</DataItem>\n"
+      "        </Geometry>\n"
+      "        <Attribute Name='attr' Center='Node'>\n"
+      "          <DataItem Dimensions='3 4' Format='HDF' NumberType='Float' Precision='8'>"
+      "data.h5:/attr/" << step << "</DataItem>\n"
+      "        </Attribute>\n";
+    for ( int i = 1; i < numberOfAttributes; ++i ) {
+      file <<
+        "        <Attribute Name='attr" << i << "' Center='Node'>\n"
+        "          <DataItem Dimensions='3 4' Format='HDF' NumberType='Float' Precision='8'>"
+        "data.h5:/attr" << i << "/" << step << "</DataItem>\n"
+        "        </Attribute>\n";
+    }
+    file <<
+      "      </Grid>\n";
+  }
+  file <<
+    "    </Grid>\n"
+    "  </Domain>\n"
+    "</Xdmf>\n";
+}
+
+// Get the name of the HDF dataset holding the values of the "attr" attribute.
+std::string attributeDataset( xdm::RefPtr< xdm::Item > item ) {
+  xdm::RefPtr< xdmGrid::Grid > grid = xdm::dynamic_pointer_cast< xdmGrid::Grid >( item );
+  xdm::RefPtr< xdmHdf::HdfDataset > dataset = xdm::dynamic_pointer_cast< xdmHdf::HdfDataset >(
+    grid->attributeByName( "attr" )->dataItem()->dataset() );
+  return dataset->dataset();
+}
+
+BOOST_AUTO_TEST_CASE( streamingTemporalCollection ) {
+  const xdm::FileSystemPath path( "streamingTemporalCollection.xmf" );
+  const int kSteps = 5;
+  writeTemporalDocument( path, kSteps );
+
+  xdmf::XmfReader domReader;
+  xdmf::XmfReader streamReader;
+  streamReader.setStreaming( true );
+  BOOST_CHECK( streamReader.streaming() );
+
+  xdmFormat::ReadResult domResult = domReader.readItem( path );
+  xdmFormat::ReadResult streamResult = streamReader.readItem( path );
+  BOOST_REQUIRE( streamResult.item() );
+  BOOST_CHECK_EQUAL( domResult.seriesSteps(), streamResult.seriesSteps() );
+  BOOST_CHECK_EQUAL( std::size_t( kSteps ), streamResult.seriesSteps() );
+  BOOST_CHECK_EQUAL( "Step0", streamResult.item()->name() );
+
+  // Visit the steps out of order to load and release step documents.
+  const int order[] = { 3, 1, 4, 0, 2, 2 };
+  for ( int i = 0; i < 6; ++i ) {
+    BOOST_REQUIRE( domReader.update( domResult.item(), path, order[i] ) );
+    BOOST_REQUIRE( streamReader.update( streamResult.item(), path, order[i] ) );
+    xdm::RefPtr< xdmGrid::Grid > grid =
+      xdm::dynamic_pointer_cast< xdmGrid::Grid >( streamResult.item() );
+    BOOST_CHECK_EQUAL( double( order[i] ), grid->time()->value() );
+    BOOST_CHECK_EQUAL(
+      attributeDataset( domResult.item() ),
+      attributeDataset( streamResult.item() ) );
+  }
+  BOOST_CHECK( !streamReader.update( streamResult.item(), path, kSteps ) );
+}
+
+BOOST_AUTO_TEST_CASE( streamingSingleGrid ) {
+  xdmf::XmfReader reader;
+  reader.setStreaming( true );
+  xdmFormat::ReadResult result = reader.readItem(
+    xdm::FileSystemPath( "test_document2.xmf" ) );
+  BOOST_REQUIRE( result.item() );
+  BOOST_CHECK_EQUAL( 1u, result.seriesSteps() );
+  BOOST_CHECK_EQUAL( "Particles", result.item()->name() );
+}
+
+BOOST_AUTO_TEST_CASE( streamingInvalidDocument ) {
+  const xdm::FileSystemPath path( "streamingInvalidDocument.xmf" );
+  {
+    std::ofstream testfile( path.pathString().c_str() );
+    testfile << "<Xdmf Version='2.1'><foo/></Xdmf>";
+  }
+  xdmf::XmfReader reader;
+  reader.setStreaming( true );
+  BOOST_CHECK_THROW( reader.readItem( path ), xdmFormat::FileReadError );
+}
+
+// Get the names of the HDF datasets holding the values of every attribute.
+std::vector< std::string > attributeDatasets( xdm::RefPtr< xdm::Item > item ) {
+  xdm::RefPtr< xdmGrid::Grid > grid = xdm::dynamic_pointer_cast< xdmGrid::Grid >( item );
+  std::vector< std::string > result;
+  for ( xdmGrid::Grid::AttributeIterator it = grid->beginAttributes();
+    it != grid->endAttributes(); ++it ) {
+    xdm::RefPtr< xdmHdf::HdfDataset > dataset = xdm::dynamic_pointer_cast< xdmHdf::HdfDataset >(
+      (*it)->dataItem()->dataset() );
+    result.push_back( (*it)->name() + ":" + dataset->dataset() );
+  }
+  return result;
+}
+
+// A streamed document must build the same tree as a document held in memory at
+// every step of the series.
+BOOST_AUTO_TEST_CASE( streamingMatchesDocument ) {
+  const xdm::FileSystemPath path( "streamingMatchesDocument.xmf" );
+  const int kSteps = 12;
+  writeTemporalDocument( path, kSteps, 3 );
+
+  xdmf::XmfReader domReader;
+  xdmf::XmfReader streamReader;
+  streamReader.setStreaming( true );
+  xdmFormat::ReadResult domResult = domReader.readItem( path );
+  xdmFormat::ReadResult streamResult = streamReader.readItem( path );
+  BOOST_REQUIRE( streamResult.item() );
+  BOOST_REQUIRE_EQUAL( domResult.seriesSteps(), streamResult.seriesSteps() );
+
+  for ( int step = 0; step < kSteps; ++step ) {
+    BOOST_REQUIRE( domReader.update( domResult.item(), path, step ) );
+    BOOST_REQUIRE( streamReader.update( streamResult.item(), path, step ) );
+    xdm::RefPtr< xdmGrid::Grid > domGrid =
+      xdm::dynamic_pointer_cast< xdmGrid::Grid >( domResult.item() );
+    xdm::RefPtr< xdmGrid::Grid > streamGrid =
+      xdm::dynamic_pointer_cast< xdmGrid::Grid >( streamResult.item() );
+    BOOST_REQUIRE( streamGrid );
+    BOOST_CHECK_EQUAL( domGrid->time()->value(), streamGrid->time()->value() );
+    BOOST_CHECK_EQUAL( domGrid->numberOfElements(), streamGrid->numberOfElements() );
+
+    std::vector< std::string > expected = attributeDatasets( domResult.item() );
+    std::vector< std::string > actual = attributeDatasets( streamResult.item() );
+    BOOST_REQUIRE_EQUAL( 3u, actual.size() );
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+      expected.begin(), expected.end(), actual.begin(), actual.end() );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( streamingIndex ) {
+  const xdm::FileSystemPath path( "streamingIndex.xmf" );
+  const xdm::FileSystemPath indexPath( "streamingIndex.xmf.idx" );
+  xdm::remove( indexPath );
+  writeTemporalDocument( path, 5 );
+
+  xdmf::XmfReader reader;
+  reader.setStreaming( true );
+  BOOST_CHECK( !reader.indexing() );
+  reader.readItem( path );
+  BOOST_CHECK( !xdm::exists( indexPath ) );
+
+  // The first read writes the index and the second one uses it.
+  reader.setIndexing( true );
+  for ( int read = 0; read < 2; ++read ) {
+    xdmFormat::ReadResult result = reader.readItem( path );
+    BOOST_CHECK( xdm::exists( indexPath ) );
+    BOOST_CHECK_EQUAL( 5u, result.seriesSteps() );
+    for ( int step = 4; step >= 0; --step ) {
+      BOOST_REQUIRE( reader.update( result.item(), path, step ) );
+      std::ostringstream expected;
+      expected << step;
+      BOOST_CHECK_EQUAL( expected.str(), attributeDataset( result.item() ) );
+    }
+  }
+
+  // A stale index is replaced.
+  writeTemporalDocument( path, 7 );
+  BOOST_CHECK_EQUAL( 7u, reader.readItem( path ).seriesSteps() );
+  BOOST_CHECK_EQUAL( 7u, reader.readItem( path ).seriesSteps() );
+
+  // So is an unreadable one.
+  {
+    std::ofstream index( indexPath.pathString().c_str() );
+    index << "XDMF step index";
+  }
+  BOOST_CHECK_EQUAL( 7u, reader.readItem( path ).seriesSteps() );
+  BOOST_CHECK_EQUAL( 7u, reader.readItem( path ).seriesSteps() );
+}
+
+// Check that a streaming read with indexing sees every step of a document
+// written by writeTemporalDocument.
+void checkIndexedRead( const xdm::FileSystemPath& path, int numberOfSteps ) {
+  xdmf::XmfReader reader;
+  reader.setStreaming( true );
+  reader.setIndexing( true );
+  xdmFormat::ReadResult result = reader.readItem( path );
+  BOOST_REQUIRE_EQUAL( std::size_t( numberOfSteps ), result.seriesSteps() );
+  for ( int step = numberOfSteps - 1; step >= 0; --step ) {
+    BOOST_REQUIRE( reader.update( result.item(), path, step ) );
+    std::ostringstream expected;
+    expected << step;
+    BOOST_CHECK_EQUAL( expected.str(), attributeDataset( result.item() ) );
+  }
+}
+
+// A truncated or corrupt index is ignored, and the document is scanned instead.
+BOOST_AUTO_TEST_CASE( corruptIndex ) {
+  const xdm::FileSystemPath path( "corruptIndex.xmf" );
+  const xdm::FileSystemPath indexPath( "corruptIndex.xmf.idx" );
+  const int kSteps = 6;
+  xdm::remove( indexPath );
+  writeTemporalDocument( path, kSteps );
+  checkIndexedRead( path, kSteps );
+  BOOST_REQUIRE( xdm::exists( indexPath ) );
+
+  std::string index;
+  {
+    std::ifstream file( indexPath.pathString().c_str(), std::ios::binary );
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    index = contents.str();
+  }
+
+  // Cut the index off in the middle of the steps.
+  {
+    std::ofstream file( indexPath.pathString().c_str(), std::ios::binary | std::ios::trunc );
+    file.write( index.data(), index.size() - 5 );
+  }
+  xdmf::impl::StepIndex truncated;
+  BOOST_CHECK( !truncated.read( path ) );
+  BOOST_CHECK( truncated.stepRanges.empty() );
+  checkIndexedRead( path, kSteps );
+
+  // Claim far more steps than the index holds. The count follows the magic
+  // string, the version, and the size and time of the document.
+  const std::size_t countOffset = std::string( "XDMF step index" ).size() + 1
+    + sizeof( unsigned int ) + sizeof( unsigned long ) + 2 * sizeof( long )
+    + sizeof( bool );
+  std::string corrupt = index;
+  corrupt.replace( countOffset, sizeof( unsigned long ), sizeof( unsigned long ), '\xff' );
+  {
+    std::ofstream file( indexPath.pathString().c_str(), std::ios::binary | std::ios::trunc );
+    file.write( corrupt.data(), corrupt.size() );
+  }
+  xdmf::impl::StepIndex oversized;
+  BOOST_CHECK( !oversized.read( path ) );
+  BOOST_CHECK( oversized.stepRanges.empty() );
+  checkIndexedRead( path, kSteps );
+}
+
+// Updating a grid with many data items must move every one of them to the
+// requested step.
+BOOST_AUTO_TEST_CASE( updateManyDataItems ) {
+  const xdm::FileSystemPath path( "updateManyDataItems.xmf" );
+  const int kSteps = 4;
+  const int kAttributes = 50;
+  writeTemporalDocument( path, kSteps, kAttributes );
+
+  xdmf::XmfReader reader;
+  reader.setValidation( xdmf::XmfReader::kValidateNone );
+  xdmFormat::ReadResult result = reader.readItem( path );
+  for ( int step = kSteps - 1; step >= 0; --step ) {
+    BOOST_REQUIRE( reader.update( result.item(), path, step ) );
+    std::vector< std::string > datasets = attributeDatasets( result.item() );
+    BOOST_REQUIRE_EQUAL( std::size_t( kAttributes ), datasets.size() );
+    for ( int i = 0; i < kAttributes; ++i ) {
+      std::ostringstream expected;
+      if ( i == 0 ) {
+        expected << "attr:" << step;
+      } else {
+        expected << "attr" << i << ":" << step;
+      }
+      BOOST_CHECK_EQUAL( expected.str(), datasets[i] );
+    }
+  }
+}
+
 BOOST_AUTO_TEST_CASE( grid2DRoundtrip ) {
   const xdm::FileSystemPath testFilePath( "grid2DRoundtrip.xmf" );
   const xdm::FileSystemPath testHdfFilePath( "grid2DRoundtrip.xmf.h5" );
@@ -265,6 +606,43 @@ BOOST_AUTO_TEST_CASE( temporalCollectionRoundtrip ) {
   BOOST_CHECK_EQUAL( data->atLocation< double >( 2, 5 ), 2.0 );
 }
 
+BOOST_AUTO_TEST_CASE( staticDataWrittenOnce ) {
+  const xdm::FileSystemPath path( "staticDataWrittenOnce.xmf" );
+  xdm::RefPtr< xdmGrid::UniformGrid > grid = build2DGrid();
+  xdm::RefPtr< xdmGrid::Geometry > geometry = grid->geometry();
+  xdm::RefPtr< xdm::UniformDataItem > attr = grid->attributeByName( "attr" )->dataItem();
+
+  const std::size_t geometryBytes = ( kMeshSize[0] + kMeshSize[1] ) * sizeof( float );
+  const std::size_t attrBytes = kMeshSize[0] * kMeshSize[1] * sizeof( double );
+
+  xdmf::XmfWriter writer;
+  writer.open( path, xdm::Dataset::kCreate );
+  for ( int step = 0; step < 4; ++step ) {
+    // Mark the mesh as changed, as reading it again for each step would.
+    for ( int i = 0; i < 2; ++i ) {
+      geometry->child( i )->data()->setNeedsUpdate( true );
+    }
+    writer.write( grid, step );
+    BOOST_CHECK_EQUAL( step == 0 ? geometryBytes + attrBytes : attrBytes,
+      writer.bytesWritten() );
+    // The mesh is skipped by marking it written, not by changing its data.
+    BOOST_CHECK_EQUAL( step > 0, geometry->child( 0 )->alreadyWritten() );
+    BOOST_CHECK( !attr->alreadyWritten() );
+
+    // The mesh is in the shared group, the attribute in the group of the step.
+    xdm::RefPtr< xdmHdf::HdfDataset > dataset =
+      xdm::dynamic_pointer_cast< xdmHdf::HdfDataset >( geometry->child( 0 )->dataset() );
+    BOOST_REQUIRE( dataset );
+    BOOST_CHECK_EQUAL( "All", dataset->groupPath().front() );
+    dataset = xdm::dynamic_pointer_cast< xdmHdf::HdfDataset >( attr->dataset() );
+    BOOST_REQUIRE( dataset );
+    std::ostringstream stepGroup;
+    stepGroup << step;
+    BOOST_CHECK_EQUAL( stepGroup.str(), dataset->groupPath().front() );
+  }
+  writer.close();
+}
+
 BOOST_AUTO_TEST_CASE( readThenWrite ) {
   char const * const kReadFileName = "readThenWriteInput.xmf";
   char const * const kReadFileData = "readThenWriteInput.xmf.h5";
@@ -25,6 +25,8 @@
 
 #include <cstdlib>
 
+#include <sys/stat.h>
+
 namespace xdm {
 
 FileSystemPath::FileSystemPath() :
@@ -78,6 +80,25 @@ size_t size( const FileSystemPath& path )
   return ( file.tellg() - beginpos );
 }
 
+std::time_t lastWriteTime( const FileSystemPath& path, long * nanoseconds )
+{
+  if ( nanoseconds ) {
+    *nanoseconds = 0;
+  }
+  struct stat buf;
+  if ( stat( path.pathString().c_str(), &buf ) != 0 ) {
+    return 0;
+  }
+  if ( nanoseconds ) {
+#if defined( __APPLE__ )
+    *nanoseconds = buf.st_mtimespec.tv_nsec;
+#elif !defined( _WIN32 )
+    *nanoseconds = buf.st_mtim.tv_nsec;
+#endif
+  }
+  return buf.st_mtime;
+}
+
 bool remove( const FileSystemPath& path )
 {
   if ( !exists( path ) ) {
@@ -23,6 +23,8 @@
 
 #include <string>
 
+#include <ctime>
+
 
 
 namespace xdm {
@@ -53,6 +55,12 @@ bool exists( const FileSystemPath& path );
 /// @return The size of the file in bytes.
 size_t size( const FileSystemPath& path );
 
+/// Determine when a file on disk was last modified.
+/// @param nanoseconds If not null, set to the fraction of the second of the
+/// modification time in nanoseconds, or 0 where the platform does not record it.
+/// @return The modification time of the file, or 0 if it does not exist.
+std::time_t lastWriteTime( const FileSystemPath& path, long * nanoseconds = 0 );
+
 /// Delete the file if it exists. If the file does not exist, then nothing is
 /// done and the function returns false.
 /// @return True if deleted, false otherwise.
@@ -0,0 +1,76 @@
+//==============================================================================
+// This software developed by Stellar Science Ltd Co and the U.S. Government.
+// Copyright (C) 2010 Stellar Science. Government-purpose rights granted.
+//
+// This file is part of XDM
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+
+#include <xdm/ParallelErrorCapture.hpp>
+#include <xdm/ThrowMacro.hpp>
+
+#include <stdexcept>
+
+namespace xdm {
+
+ParallelErrorCapture::ParallelErrorCapture() :
+  mHasError( false )
+{
+}
+
+ParallelErrorCapture::~ParallelErrorCapture()
+{
+}
+
+void ParallelErrorCapture::capture()
+{
+#ifdef _OPENMP
+  #pragma omp critical( xdm_ParallelErrorCapture )
+#endif
+  if ( ! mHasError ) {
+#if __cplusplus >= 201103L
+    mError = std::current_exception();
+#else
+    try {
+      throw;
+    } catch ( const std::exception& e ) {
+      mMessage = e.what();
+    } catch ( ... ) {
+      mMessage = "Unknown exception in a parallel region.";
+    }
+#endif
+    mHasError = true;
+  }
+}
+
+bool ParallelErrorCapture::empty() const
+{
+  return ! mHasError;
+}
+
+void ParallelErrorCapture::rethrow() const
+{
+  if ( ! mHasError ) {
+    return;
+  }
+#if __cplusplus >= 201103L
+  std::rethrow_exception( mError );
+#else
+  XDM_THROW( std::runtime_error( mMessage ) );
+#endif
+}
+
+} // namespace xdm
@@ -0,0 +1,81 @@
+//==============================================================================
+// This software developed by Stellar Science Ltd Co and the U.S. Government.
+// Copyright (C) 2010 Stellar Science. Government-purpose rights granted.
+//
+// This file is part of XDM
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+#ifndef xdm_ParallelErrorCapture_hpp
+#define xdm_ParallelErrorCapture_hpp
+
+#include <string>
+
+#if __cplusplus >= 201103L
+#include <exception>
+#endif
+
+
+
+namespace xdm {
+
+/// Holds on to the first exception thrown by the threads of an OpenMP parallel
+/// region, or inside an OpenMP critical section, so that it can be thrown again
+/// once the threads have joined. Exceptions may not propagate out of either
+/// construct.
+///
+/// @code
+/// ParallelErrorCapture error;
+/// #pragma omp parallel for
+/// for ( long i = 0; i < n; ++i ) {
+///   try {
+///     work( i );
+///   } catch ( ... ) {
+///     error.capture();
+///   }
+/// }
+/// error.rethrow();
+/// @endcode
+class ParallelErrorCapture
+{
+public:
+  ParallelErrorCapture();
+  ~ParallelErrorCapture();
+
+  /// Record the exception that is currently being handled, unless an exception
+  /// has already been recorded. Must be called from within a catch block. Safe
+  /// to call from several threads at once.
+  void capture();
+
+  /// Determine if an exception has been recorded.
+  bool empty() const;
+
+  /// Throw the recorded exception again, or do nothing if there is none. When
+  /// compiled as C++11 the original exception is thrown with its own type;
+  /// otherwise a std::runtime_error carrying its message is thrown.
+  void rethrow() const;
+
+private:
+  bool mHasError;
+#if __cplusplus >= 201103L
+  std::exception_ptr mError;
+#else
+  std::string mMessage;
+#endif
+};
+
+} // namespace xdm
+
+#endif // xdm_ParallelErrorCapture_hpp
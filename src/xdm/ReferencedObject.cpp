@@ -36,18 +36,28 @@ ReferencedObject::~ReferencedObject() {
 }
 
 void ReferencedObject::addReference() const {
+#ifdef _OPENMP
+  #pragma omp atomic
+#endif
   mReferenceCount++;
 }
 
 void ReferencedObject::removeReference() const {
-  mReferenceCount--;
-  if ( mReferenceCount <= 0 ) {
+  int referenceCount;
+#ifdef _OPENMP
+  #pragma omp atomic capture
+#endif
+  referenceCount = --mReferenceCount;
+  if ( referenceCount <= 0 ) {
     // when deleting the object, cast away it's constness.
     deleteReferencedObject( const_cast< ReferencedObject* >( this ) );
   }
 }
 
 void ReferencedObject::removeReferenceWithoutDelete() const {
+#ifdef _OPENMP
+  #pragma omp atomic
+#endif
   mReferenceCount--;
 }
 
@@ -30,6 +30,10 @@ namespace xdm {
 /// Base class for all reference counted objects. Operations that affect only
 /// the reference count for subclasses of ReferencedObject are considered to
 /// be const.
+///
+/// When the library is built with OpenMP (XDM_OPENMP), the reference count is
+/// updated atomically, so references to an object may be added and removed
+/// from several threads at once.
 class ReferencedObject {
 public:
   ReferencedObject();
@@ -20,19 +20,21 @@
 //------------------------------------------------------------------------------
 #include <xdm/SerializeDataOperation.hpp>
 
+#include <xdm/StructuredArray.hpp>
 #include <xdm/UniformDataItem.hpp>
 
 namespace xdm {
 
 SerializeDataOperation::SerializeDataOperation( const Dataset::InitializeMode& mode ) :
-  mMode( mode ) {
+  mMode( mode ),
+  mBytesWritten( 0 ) {
 }
 
 SerializeDataOperation::~SerializeDataOperation() {
 }
 
 void SerializeDataOperation::apply( UniformDataItem& udi ) {
-  if ( udi.serializationRequired() ) {
+  if ( udi.serializationRequired() && ! udi.alreadyWritten() ) {
     if ( !udi.data()->isMemoryResident() ) {
       udi.initializeDataset( Dataset::kRead );
       udi.deserializeData();
@@ -42,8 +44,13 @@ void SerializeDataOperation::apply( UniformDataItem& udi ) {
     udi.initializeDataset( mMode );
     udi.serializeData();
     udi.finalizeDataset();
+    mBytesWritten += udi.data()->array()->memorySize();
   }
 }
 
+std::size_t SerializeDataOperation::bytesWritten() const {
+  return mBytesWritten;
+}
+
 } // namespace xdm
 
@@ -24,6 +24,8 @@
 #include <xdm/Dataset.hpp>
 #include <xdm/ItemVisitor.hpp>
 
+#include <cstddef>
+
 
 
 namespace xdm {
@@ -40,11 +42,16 @@ public:
   SerializeDataOperation( const Dataset::InitializeMode& mode = Dataset::kCreate );
   virtual ~SerializeDataOperation();
 
-  /// Serialize a UniformDataItem's array into its dataset.
+  /// Serialize a UniformDataItem's array into its dataset, unless it is marked
+  /// as already written.
   virtual void apply( UniformDataItem& udi );
 
+  /// Get the number of bytes of array data serialized by this operation.
+  std::size_t bytesWritten() const;
+
 private:
   Dataset::InitializeMode mMode;
+  std::size_t mBytesWritten;
 };
 
 } // namespace xdm
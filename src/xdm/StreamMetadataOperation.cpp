@@ -0,0 +1,247 @@
+//==============================================================================
+// This software developed by Stellar Science Ltd Co and the U.S. Government.
+// Copyright (C) 2010 Stellar Science. Government-purpose rights granted.
+//
+// This file is part of XDM
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+#include <xdm/StreamMetadataOperation.hpp>
+
+#include <xdm/BinaryStreamOperations.hpp>
+#include <xdm/XmlMetadataWrapper.hpp>
+
+#include <sstream>
+
+namespace xdm {
+
+namespace {
+
+// Hash the text from an offset to its end with FNV-1a.
+std::size_t hashText( const std::string& text, std::size_t begin ) {
+  std::size_t hash = 2166136261u;
+  for ( std::size_t i = begin; i < text.size(); ++i ) {
+    hash ^= static_cast< unsigned char >( text[i] );
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+} // namespace
+
+const std::size_t StreamMetadataOperation::kDefaultIncludeMemoryLimit;
+
+StreamMetadataOperation::StreamMetadataOperation(
+  std::ostream& output,
+  int indentLevel ) :
+  mOutput( output ),
+  mIndentLevel( indentLevel ),
+  mDepth( 0 ),
+  mElement(),
+  mTags(),
+  mText(),
+  mChildCounts(),
+  mIncludeTags(),
+  mRootPosition(),
+  mOccurrences(),
+  mOccurrenceIndex(),
+  mOccurrenceBytes( 0 ),
+  mIncludeMemoryLimit( kDefaultIncludeMemoryLimit ),
+  mTreeOccurrences() {
+}
+
+StreamMetadataOperation::~StreamMetadataOperation() {
+}
+
+void StreamMetadataOperation::apply( Item& item ) {
+  if ( mDepth == 0 ) {
+    // a new tree.
+    mText.clear();
+    mTreeOccurrences.clear();
+    limitOccurrences();
+  }
+
+  // Count the element among its siblings, and start counting its children.
+  if ( mChildCounts.size() < mDepth + 2 ) {
+    mChildCounts.resize( mDepth + 2 );
+  }
+  ++mChildCounts[mDepth];
+  mChildCounts[ mDepth + 1 ] = 0;
+
+  const std::size_t begin = mText.size();
+  const int indent = mIndentLevel + int( mDepth );
+  mElement.clear();
+  XmlMetadataWrapper wrapper( mElement );
+  item.writeMetadata( wrapper );
+  mElement.printHeader( mText, indent );
+  mElement.printTextContent( mText, indent + 1 );
+
+  // Only the tag is needed to close the element once the children are done.
+  if ( mTags.size() == mDepth ) {
+    mTags.push_back( std::string() );
+  }
+  mTags[mDepth] = mElement.tag();
+
+  ++mDepth;
+  try {
+    traverse( item );
+  } catch ( ... ) {
+    reset();
+    throw;
+  }
+  --mDepth;
+
+  appendIndent( mText, indent );
+  mText += "</";
+  mText += mTags[mDepth];
+  mText += ">\n";
+
+  if ( !mRootPosition.empty() && mIncludeTags.count( mTags[mDepth] ) != 0 ) {
+    includeRepeatedElement( begin );
+  }
+
+  if ( mDepth == 0 ) {
+    mOutput.write( mText.data(), mText.size() );
+    mTreeOccurrences.clear();
+  }
+}
+
+void StreamMetadataOperation::captureState( BinaryOStream& ostr ) {
+  ostr << mText;
+}
+
+void StreamMetadataOperation::restoreState( BinaryIStream& istr ) {
+  std::string gathered;
+  istr >> gathered;
+
+  // The gathered text is indented for the root of a tree. Indent it further
+  // for the current depth.
+  std::string indented;
+  std::string::size_type begin = 0;
+  while ( begin < gathered.size() ) {
+    std::string::size_type end = gathered.find( '\n', begin );
+    end = ( end == std::string::npos ) ? gathered.size() : end + 1;
+    appendIndent( indented, int( mDepth ) );
+    indented.append( gathered, begin, end - begin );
+    begin = end;
+  }
+
+  if ( mDepth == 0 ) {
+    mOutput.write( indented.data(), indented.size() );
+  } else {
+    mText += indented;
+    ++mChildCounts[mDepth];
+  }
+}
+
+void StreamMetadataOperation::reset() {
+  forgetTreeOccurrences( 0 );
+  mDepth = 0;
+  mText.clear();
+}
+
+void StreamMetadataOperation::addIncludeTag( const std::string& tag ) {
+  mIncludeTags.insert( tag );
+}
+
+void StreamMetadataOperation::setRootPosition( const std::string& childSequence ) {
+  mRootPosition = childSequence;
+}
+
+void StreamMetadataOperation::clearIncludes() {
+  mOccurrences.clear();
+  mOccurrenceIndex.clear();
+  mOccurrenceBytes = 0;
+  mTreeOccurrences.clear();
+}
+
+void StreamMetadataOperation::setIncludeMemoryLimit( std::size_t bytes ) {
+  mIncludeMemoryLimit = bytes;
+}
+
+std::size_t StreamMetadataOperation::includeMemoryLimit() const {
+  return mIncludeMemoryLimit;
+}
+
+void StreamMetadataOperation::includeRepeatedElement( std::size_t begin ) {
+  const std::size_t hash = hashText( mText, begin );
+  std::pair< OccurrenceIndex::iterator, OccurrenceIndex::iterator > candidates =
+    mOccurrenceIndex.equal_range( hash );
+  OccurrenceIndex::iterator first = candidates.first;
+  // Different elements may have the same hash, so the text decides.
+  while ( first != candidates.second &&
+    mText.compare( begin, std::string::npos, first->second->mText ) != 0 ) {
+    ++first;
+  }
+
+  if ( first == candidates.second ) {
+    // The first occurrence. Remember where it is for later elements.
+    std::ostringstream sequence;
+    sequence << mRootPosition;
+    for ( std::size_t depth = 1; depth <= mDepth; ++depth ) {
+      sequence << '/' << mChildCounts[depth];
+    }
+    mOccurrences.push_back( Occurrence() );
+    Occurrence& occurrence = mOccurrences.back();
+    occurrence.mHash = hash;
+    occurrence.mText.assign( mText, begin, std::string::npos );
+    occurrence.mChildSequence = sequence.str();
+    mOccurrenceBytes += occurrence.mText.size();
+    first = mOccurrenceIndex.insert( std::make_pair( hash, --mOccurrences.end() ) );
+    mTreeOccurrences.push_back( std::make_pair( begin, first ) );
+    return;
+  }
+
+  // Elements within this one are no longer written, so they cannot be
+  // included.
+  forgetTreeOccurrences( begin );
+
+  const int indent = mIndentLevel + int( mDepth );
+  mText.erase( begin );
+  appendIndent( mText, indent );
+  mText += "<xi:include xmlns:xi='";
+  mText += kXIncludeNamespace;
+  mText += "' xpointer='element(";
+  mText += first->second->mChildSequence;
+  mText += ")'>\n";
+  appendIndent( mText, indent );
+  mText += "</xi:include>\n";
+}
+
+void StreamMetadataOperation::forgetTreeOccurrences( std::size_t begin ) {
+  while ( !mTreeOccurrences.empty() && mTreeOccurrences.back().first >= begin ) {
+    forgetOccurrence( mTreeOccurrences.back().second );
+    mTreeOccurrences.pop_back();
+  }
+}
+
+void StreamMetadataOperation::forgetOccurrence( OccurrenceIndex::iterator occurrence ) {
+  mOccurrenceBytes -= occurrence->second->mText.size();
+  mOccurrences.erase( occurrence->second );
+  mOccurrenceIndex.erase( occurrence );
+}
+
+void StreamMetadataOperation::limitOccurrences() {
+  while ( mOccurrenceBytes > mIncludeMemoryLimit ) {
+    OccurrenceList::iterator oldest = mOccurrences.begin();
+    OccurrenceIndex::iterator entry = mOccurrenceIndex.lower_bound( oldest->mHash );
+    while ( entry->second != oldest ) {
+      ++entry;
+    }
+    forgetOccurrence( entry );
+  }
+}
+
+} // namespace xdm
@@ -0,0 +1,168 @@
+//==============================================================================
+// This software developed by Stellar Science Ltd Co and the U.S. Government.
+// Copyright (C) 2010 Stellar Science. Government-purpose rights granted.
+//
+// This file is part of XDM
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+#ifndef xdm_StreamMetadataOperation_hpp
+#define xdm_StreamMetadataOperation_hpp
+
+#include <xdm/ItemVisitor.hpp>
+#include <xdm/XmlMetadataBuffer.hpp>
+
+#include <list>
+#include <map>
+#include <ostream>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace xdm {
+
+/// The namespace of XInclude elements, written by StreamMetadataOperation and
+/// followed by the readers of the documents it writes.
+char const * const kXIncludeNamespace = "http://www.w3.org/2001/XInclude";
+
+/// Operation that writes the metadata of a tree of items directly to a stream
+/// as XML. It produces the same text as collecting the tree with
+/// CollectMetadataOperation and writing the resulting XmlObject, but it does not
+/// build an XmlObject for each item: every item writes its metadata through
+/// the same XmlMetadataBuffer, and the elements are formatted into a string
+/// that keeps its memory between traversals. When an operation is reused for
+/// each time step, writing the metadata does not allocate once the buffers
+/// have grown to fit the largest step.
+///
+/// The text for a tree is written to the stream in one piece when the root
+/// item is complete, so nothing is written if an item fails to produce its
+/// metadata.
+///
+/// The operation can be used with distributed trees: captureState sends the
+/// text of the last tree written, and restoreState writes a gathered tree at
+/// the current position. Since the enclosing elements have already been
+/// started, gathered results are written as siblings of the items being
+/// visited. Use CollectMetadataOperation to assemble the gathered results into
+/// an XmlObject tree instead.
+///
+/// Elements that repeat earlier output can be replaced by an XInclude of the
+/// first occurrence. When a tag is registered with addIncludeTag and a root
+/// position is set, an element with that tag whose text, including its
+/// children, matches an element written before is written as
+///
+///   <xi:include xmlns:xi='http://www.w3.org/2001/XInclude' xpointer='element(/1/1/2/1)'>
+///   </xi:include>
+///
+/// where the XPointer is the element's child sequence in the document. Only
+/// elements written at the same indentation can match. Elements are looked up
+/// by a hash of their text, and the text kept to compare them is bounded by
+/// includeMemoryLimit().
+class StreamMetadataOperation : public ItemVisitor {
+public:
+  /// Construct an operation that writes to a stream.
+  /// @param output The stream to write the XML to.
+  /// @param indentLevel The indentation of the root item.
+  explicit StreamMetadataOperation( std::ostream& output, int indentLevel = 0 );
+  virtual ~StreamMetadataOperation();
+
+  /// The default number of bytes of element text kept to find repeated
+  /// elements.
+  static const std::size_t kDefaultIncludeMemoryLimit = 16 * 1024 * 1024;
+
+  /// Set the indentation of the root item.
+  void setIndentLevel( int indentLevel ) { mIndentLevel = indentLevel; }
+  /// Get the indentation of the root item.
+  int indentLevel() const { return mIndentLevel; }
+
+  /// Write the metadata of an item, then the metadata of its children, to the
+  /// stream.
+  virtual void apply( Item& item );
+
+  virtual void captureState( BinaryOStream& ostr );
+  virtual void restoreState( BinaryIStream& istr );
+  virtual void reset();
+
+  /// Get the text of the last tree written.
+  const std::string& result() const { return mText; }
+
+  /// Replace repeated elements with the given tag by an XInclude of their
+  /// first occurrence.
+  void addIncludeTag( const std::string& tag );
+
+  /// Set the position of the next root item in the document as an XPointer
+  /// child sequence, such as "/1/1/4" for the fourth element in the first
+  /// element of the root element. Elements are only replaced by XIncludes
+  /// while a root position is set. Elements written in earlier trees remain
+  /// available to include.
+  void setRootPosition( const std::string& childSequence );
+
+  /// Forget the elements written so far, so that none of them are included
+  /// again.
+  void clearIncludes();
+
+  /// Set the number of bytes of element text kept to find repeated elements.
+  /// When a tree starts and the elements kept take more, the oldest of them
+  /// are forgotten, and later repeats of those are written in full. With a
+  /// limit of zero, only repeats within a tree are included.
+  void setIncludeMemoryLimit( std::size_t bytes );
+  /// Get the number of bytes of element text kept to find repeated elements.
+  std::size_t includeMemoryLimit() const;
+
+private:
+  // An element written in full, which later elements may include.
+  struct Occurrence {
+    std::size_t mHash;
+    std::string mText;
+    std::string mChildSequence;
+  };
+  // The occurrences, oldest first.
+  typedef std::list< Occurrence > OccurrenceList;
+  // The occurrences by the hash of their text.
+  typedef std::multimap< std::size_t, OccurrenceList::iterator > OccurrenceIndex;
+
+  // Replace the element starting at an offset in mText, and ending at the end
+  // of the text, by an XInclude if it matches an earlier element.
+  void includeRepeatedElement( std::size_t begin );
+  // Forget the elements first written in the current tree.
+  void forgetTreeOccurrences( std::size_t begin );
+  // Forget an element so that it is not included again.
+  void forgetOccurrence( OccurrenceIndex::iterator occurrence );
+  // Forget the oldest elements until the rest fit in the memory limit.
+  void limitOccurrences();
+
+  std::ostream& mOutput;
+  int mIndentLevel;
+  std::size_t mDepth;
+  XmlMetadataBuffer mElement;
+  std::vector< std::string > mTags;
+  std::string mText;
+
+  // The number of children started by the open element at each depth.
+  std::vector< std::size_t > mChildCounts;
+  std::set< std::string > mIncludeTags;
+  std::string mRootPosition;
+  OccurrenceList mOccurrences;
+  OccurrenceIndex mOccurrenceIndex;
+  // The number of bytes of text in mOccurrences.
+  std::size_t mOccurrenceBytes;
+  std::size_t mIncludeMemoryLimit;
+  // The offsets in mText of the elements first written in the current tree.
+  std::vector< std::pair< std::size_t, OccurrenceIndex::iterator > > mTreeOccurrences;
+};
+
+} // namespace xdm
+
+#endif // xdm_StreamMetadataOperation_hpp
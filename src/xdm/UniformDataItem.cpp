@@ -37,7 +37,8 @@ UniformDataItem::UniformDataItem() :
   mDataType( primitiveType::kFloat ),
   mDataspace(),
   mDataset(),
-  mData() {
+  mData(),
+  mAlreadyWritten( false ) {
 }
 
 UniformDataItem::UniformDataItem(
@@ -46,7 +47,8 @@ UniformDataItem::UniformDataItem(
   mDataType( dataType ),
   mDataspace( dataspace ),
   mDataset(),
-  mData() {
+  mData(),
+  mAlreadyWritten( false ) {
 }
 
 UniformDataItem::~UniformDataItem() {
@@ -62,6 +64,7 @@ RefPtr< const Dataset > UniformDataItem::dataset() const {
 
 void UniformDataItem::setDataset( RefPtr< Dataset > ds ) {
   mDataset = ds;
+  mAlreadyWritten = false;
 }
 
 void UniformDataItem::setDataType( primitiveType::Value dataType ) {
@@ -179,6 +182,14 @@ bool UniformDataItem::serializationRequired() const {
   return mData->requiresWrite();
 }
 
+void UniformDataItem::setAlreadyWritten( bool alreadyWritten ) {
+  mAlreadyWritten = alreadyWritten;
+}
+
+bool UniformDataItem::alreadyWritten() const {
+  return mAlreadyWritten;
+}
+
 bool UniformDataItem::validateBounds( const xdm::DataShape<>& shape ) const {
   if ( shape.rank() != mDataspace.rank() ) return false;
   for ( xdm::DataShape<>::size_type i = 0; i < mDataspace.rank(); ++i ) {
@@ -200,6 +211,10 @@ RefPtr< const StructuredArray > UniformDataItem::array() const {
   return mData->array();
 }
 
+RefPtr< const StructuredArray > UniformDataItem::untypedArray() const {
+  return array();
+}
+
 RefPtr< StructuredArray > UniformDataItem::array() {
   return xdm::const_pointer_cast< StructuredArray >(
     static_cast< const UniformDataItem& >(*this).array()
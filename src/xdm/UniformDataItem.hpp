@@ -100,6 +100,11 @@ public:
   template< typename T >
   RefPtr< const TypedStructuredArray< T > > typedArray() const;
 
+  /// Get the data as an untyped structured array, for clients that accept
+  /// several types and dispatch on the dataType() of the array itself.
+  /// @throws DataAccessError if the item's data cannot be found.
+  RefPtr< const StructuredArray > untypedArray() const;
+
   /// Get a value by reference indexed contiguously in the underlying data.
   template< typename T >
   T& atIndex( std::size_t index );
@@ -162,6 +167,14 @@ public:
   /// true if any of the item's MemoryAdapter's is in need of an update.
   bool serializationRequired() const;
 
+  /// Mark the item's values as already written to its dataset, such as static
+  /// data shared by every step of a series. SerializeDataOperation skips items
+  /// marked so, whatever the state of their MemoryAdapter. Setting a new
+  /// dataset clears the mark.
+  void setAlreadyWritten( bool alreadyWritten );
+  /// Determine if the item's values are marked as already written.
+  bool alreadyWritten() const;
+
 protected:
 
   /// Get the underlying data array as an untyped StructuredArray. Calls to this
@@ -183,6 +196,7 @@ private:
   DataShape<> mDataspace;
   RefPtr< Dataset > mDataset;
   RefPtr< MemoryAdapter > mData;
+  bool mAlreadyWritten;
 };
 
 // -----------------------------------------------------------------------------
@@ -77,8 +77,9 @@ private:
 /// provides a common interface for that case as well as arrays where node coordinates are
 /// stored as xyzxyzxyzxyz, and so on.
 ///
-/// Currently, VectorRef ALWAYS refers to persistent data, and there are no Impementations
-/// of VectorRefImp that are self-contained. The copy constructor preserves the reference
+/// A VectorRef generally refers to persistent data; the only Impementations of VectorRefImp
+/// that are self-contained are those for data that is computed rather than stored, such as
+/// the connectivity of a structured topology. The copy constructor preserves the reference
 /// semantics. Thus, if a self-contained vector is necessary, the user should copy the data
 ///  out of the VectorRef into a more suitable vector.
 template< typename T >
@@ -272,14 +273,13 @@ template< typename T >
 const T& TensorProductArraysImp< T >::at( std::size_t baseIndex, std::size_t i ) const {
   // choose a convention for indexing multi-dimension structured data and
   // stick with it. Following XDMF, let's say z is always considered to be
-  // the slowest varying dimension, y next, x fastest.
+  // the slowest varying dimension, y next, x fastest. Only the location along
+  // axis i is needed, so there is no need to decompose the full index.
   std::size_t blockSize = 1;
-  std::vector< std::size_t > location( mSize );
-  for ( std::size_t dimension = 0; dimension < mSize; ++dimension ) {
-    location[ dimension ] = baseIndex / blockSize % mAxisSizes[ dimension ];
+  for ( std::size_t dimension = 0; dimension < i; ++dimension ) {
     blockSize *= mAxisSizes[ dimension ];
   }
-  return mCoordinateAxisValues[i][location[i]];
+  return mCoordinateAxisValues[i][ baseIndex / blockSize % mAxisSizes[i] ];
 }
 
 template< typename T >
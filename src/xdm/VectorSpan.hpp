@@ -0,0 +1,257 @@
+//==============================================================================
+// This software developed by Stellar Science Ltd Co and the U.S. Government.
+// Copyright (C) 2010 Stellar Science. Government-purpose rights granted.
+//
+// This file is part of XDM
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+#ifndef xdm_VectorSpan_hpp
+#define xdm_VectorSpan_hpp
+
+#include <xdm/ThrowMacro.hpp>
+
+#include <stdexcept>
+#include <vector>
+
+#include <cassert>
+#include <cstddef>
+
+
+
+namespace xdm {
+
+// The spans in this file are non-virtual, typed counterparts of the
+// VectorRefImp implementations in VectorRef.hpp. A VectorRef pays a virtual
+// call for every component it accesses, which is fine for occasional access
+// but dominates loops over every node of a large mesh. The spans are cheap to
+// copy value types that are intended to be obtained once, outside of a loop,
+// and then used inside the loop with inlined access. Each span also provides
+// a bulk gather() that copies a list of vectors into an interlaced output
+// array using loops that the compiler is able to vectorize.
+//
+// Like VectorRef, a span refers to persistent data and does not own it. The
+// template parameter may be const qualified to provide read-only access.
+
+/// Span over vectors stored in a single interlaced array, xyzxyzxyz... The
+/// distance between the beginning of consecutive vectors may be larger than
+/// the number of elements per vector to allow views of padded records.
+template< typename T >
+class InterlacedVectorSpan {
+public:
+  /// @param data Pointer to the first element of the first vector.
+  /// @param elementsPerVector The number of elements in each vector.
+  /// @param stride The distance between consecutive vectors. A value of 0
+  ///        means the vectors are tightly packed.
+  InterlacedVectorSpan( T* data, std::size_t elementsPerVector, std::size_t stride = 0 ) :
+    mData( data ),
+    mSize( elementsPerVector ),
+    mStride( stride == 0 ? elementsPerVector : stride ) {}
+
+  /// @returns The number of elements in each vector.
+  std::size_t size() const { return mSize; }
+
+  /// @returns The distance between the beginning of consecutive vectors.
+  std::size_t stride() const { return mStride; }
+
+  /// Access element i of the vector at baseIndex.
+  T& at( std::size_t baseIndex, std::size_t i ) const {
+    assert( i < mSize );
+    return mData[ mStride * baseIndex + i ];
+  }
+
+  /// Get a pointer to the first element of the vector at baseIndex.
+  T* vector( std::size_t baseIndex ) const {
+    return mData + mStride * baseIndex;
+  }
+
+  /// Copy the vectors referenced by a list of indices into an interlaced output
+  /// array. The output must have room for count * size() values.
+  template< typename IndexT, typename OutT >
+  void gather( const IndexT* indices, std::size_t count, OutT* out ) const {
+    switch ( mSize ) {
+    case 1:
+      for ( std::size_t k = 0; k < count; ++k ) {
+        out[k] = mData[ mStride * indices[k] ];
+      }
+      break;
+    case 2:
+      for ( std::size_t k = 0; k < count; ++k ) {
+        const T* v = mData + mStride * indices[k];
+        out[2*k+0] = v[0];
+        out[2*k+1] = v[1];
+      }
+      break;
+    case 3:
+      for ( std::size_t k = 0; k < count; ++k ) {
+        const T* v = mData + mStride * indices[k];
+        out[3*k+0] = v[0];
+        out[3*k+1] = v[1];
+        out[3*k+2] = v[2];
+      }
+      break;
+    default:
+      for ( std::size_t k = 0; k < count; ++k ) {
+        const T* v = mData + mStride * indices[k];
+        for ( std::size_t i = 0; i < mSize; ++i ) {
+          out[ mSize * k + i ] = v[i];
+        }
+      }
+      break;
+    }
+  }
+
+private:
+  T* mData;
+  std::size_t mSize;
+  std::size_t mStride;
+};
+
+/// Span over vectors stored in multiple arrays, one array per vector element:
+/// x1x2x3x4.... y1y2y3y4.... z1z2z3z4....
+template< typename T >
+class MultipleArrayVectorSpan {
+public:
+  /// The maximum number of elements per vector supported by the span. The array
+  /// pointers are held inline so that copying the span does not allocate.
+  static const std::size_t kMaximumSize = 4;
+
+  /// @param arrays One pointer per vector element.
+  /// @throws std::length_error if there are more than kMaximumSize arrays.
+  MultipleArrayVectorSpan( const std::vector< T* >& arrays ) :
+    mSize( arrays.size() ) {
+    if ( mSize > kMaximumSize ) {
+      XDM_THROW( std::length_error( "Too many arrays for a MultipleArrayVectorSpan" ) );
+    }
+    for ( std::size_t i = 0; i < kMaximumSize; ++i ) {
+      mArrays[i] = ( i < mSize ) ? arrays[i] : 0;
+    }
+  }
+
+  /// @returns The number of elements in each vector.
+  std::size_t size() const { return mSize; }
+
+  /// Access element i of the vector at baseIndex.
+  T& at( std::size_t baseIndex, std::size_t i ) const {
+    assert( i < mSize );
+    return mArrays[i][baseIndex];
+  }
+
+  /// Get the array holding element i of every vector.
+  T* array( std::size_t i ) const {
+    assert( i < mSize );
+    return mArrays[i];
+  }
+
+  /// Copy the vectors referenced by a list of indices into an interlaced output
+  /// array. The output must have room for count * size() values. The gather is
+  /// performed one component array at a time to keep each pass streaming
+  /// through a single input array.
+  template< typename IndexT, typename OutT >
+  void gather( const IndexT* indices, std::size_t count, OutT* out ) const {
+    for ( std::size_t i = 0; i < mSize; ++i ) {
+      const T* component = mArrays[i];
+      for ( std::size_t k = 0; k < count; ++k ) {
+        out[ mSize * k + i ] = component[ indices[k] ];
+      }
+    }
+  }
+
+private:
+  T* mArrays[ kMaximumSize ];
+  std::size_t mSize;
+};
+
+template< typename T >
+const std::size_t MultipleArrayVectorSpan< T >::kMaximumSize;
+
+/// Analytic evaluator for vectors that are the tensor product of coordinate
+/// axis values. Following the convention of TensorProductArraysImp, the first
+/// axis varies fastest when the vectors are indexed linearly. The stride of
+/// every axis is precomputed so that evaluating an element does not allocate
+/// or loop over the other axes.
+template< typename T >
+class TensorProductVectorEvaluator {
+public:
+  /// The maximum number of axes supported by the evaluator.
+  static const std::size_t kMaximumSize = 4;
+
+  /// @param coordinateAxisValues One array of values per axis.
+  /// @param axisSizes The number of values on each axis.
+  /// @throws std::length_error if there are more than kMaximumSize axes.
+  TensorProductVectorEvaluator(
+    const std::vector< T* >& coordinateAxisValues,
+    const std::vector< std::size_t >& axisSizes ) :
+    mSize( axisSizes.size() ) {
+    assert( coordinateAxisValues.size() == axisSizes.size() );
+    if ( mSize > kMaximumSize ) {
+      XDM_THROW( std::length_error( "Too many axes for a TensorProductVectorEvaluator" ) );
+    }
+    std::size_t blockSize = 1;
+    for ( std::size_t i = 0; i < kMaximumSize; ++i ) {
+      if ( i < mSize ) {
+        mAxes[i] = coordinateAxisValues[i];
+        mAxisSizes[i] = axisSizes[i];
+        mStrides[i] = blockSize;
+        blockSize *= axisSizes[i];
+      } else {
+        mAxes[i] = 0;
+        mAxisSizes[i] = 1;
+        mStrides[i] = blockSize;
+      }
+    }
+  }
+
+  /// @returns The number of elements in each vector.
+  std::size_t size() const { return mSize; }
+
+  /// @returns The index along axis i of the vector at baseIndex.
+  std::size_t axisIndex( std::size_t baseIndex, std::size_t i ) const {
+    return baseIndex / mStrides[i] % mAxisSizes[i];
+  }
+
+  /// Access element i of the vector at baseIndex.
+  T& at( std::size_t baseIndex, std::size_t i ) const {
+    assert( i < mSize );
+    return mAxes[i][ axisIndex( baseIndex, i ) ];
+  }
+
+  /// Evaluate the vectors referenced by a list of indices into an interlaced
+  /// output array. The output must have room for count * size() values.
+  template< typename IndexT, typename OutT >
+  void gather( const IndexT* indices, std::size_t count, OutT* out ) const {
+    for ( std::size_t i = 0; i < mSize; ++i ) {
+      const T* axis = mAxes[i];
+      const std::size_t stride = mStrides[i];
+      const std::size_t axisSize = mAxisSizes[i];
+      for ( std::size_t k = 0; k < count; ++k ) {
+        out[ mSize * k + i ] = axis[ indices[k] / stride % axisSize ];
+      }
+    }
+  }
+
+private:
+  T* mAxes[ kMaximumSize ];
+  std::size_t mAxisSizes[ kMaximumSize ];
+  std::size_t mStrides[ kMaximumSize ];
+  std::size_t mSize;
+};
+
+template< typename T >
+const std::size_t TensorProductVectorEvaluator< T >::kMaximumSize;
+
+} // namespace xdm
+
+#endif // xdm_VectorSpan_hpp
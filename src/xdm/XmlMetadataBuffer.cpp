@@ -0,0 +1,165 @@
+//==============================================================================
+// This software developed by Stellar Science Ltd Co and the U.S. Government.
+// Copyright (C) 2010 Stellar Science. Government-purpose rights granted.
+//
+// This file is part of XDM
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+#include <xdm/XmlMetadataBuffer.hpp>
+
+#include <xdm/XmlExcept.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <xdm/ThrowMacro.hpp>
+
+namespace xdm {
+
+namespace {
+
+// Order attribute slots by name, the order std::map gives XmlObject.
+struct AttributeNameLess {
+  const std::vector< std::pair< std::string, std::string > >& mAttributes;
+  AttributeNameLess( const std::vector< std::pair< std::string, std::string > >& attributes ) :
+    mAttributes( attributes ) {}
+  bool operator()( std::size_t lhs, std::size_t rhs ) const {
+    return mAttributes[lhs].first < mAttributes[rhs].first;
+  }
+};
+
+} // namespace
+
+XmlMetadataBuffer::XmlMetadataBuffer() :
+  mTag(),
+  mAttributes(),
+  mAttributeCount( 0 ),
+  mContent(),
+  mContentCount( 0 ),
+  mAttributeOrder(),
+  mFormat() {
+}
+
+XmlMetadataBuffer::~XmlMetadataBuffer() {
+}
+
+void XmlMetadataBuffer::clear() {
+  mTag.clear();
+  mAttributeCount = 0;
+  mContentCount = 0;
+}
+
+void XmlMetadataBuffer::setAttribute(
+  const std::string& name,
+  const std::string& value ) {
+  attributeValue( name ) = value;
+}
+
+void XmlMetadataBuffer::setAttribute( const std::string& name, const char* value ) {
+  attributeValue( name ) = value;
+}
+
+bool XmlMetadataBuffer::hasAttribute( const std::string& name ) const {
+  return findAttribute( name ) != mAttributeCount;
+}
+
+const std::string& XmlMetadataBuffer::attribute( const std::string& name ) const {
+  std::size_t index = findAttribute( name );
+  if ( index == mAttributeCount ) {
+    XDM_THROW( AttributeDoesNotExist( mTag, name ) );
+  }
+  return mAttributes[index].second;
+}
+
+void XmlMetadataBuffer::appendContent( const std::string& text ) {
+  if ( mContentCount == mContent.size() ) {
+    mContent.push_back( std::string() );
+  }
+  mContent[ mContentCount++ ] = text;
+}
+
+const std::string& XmlMetadataBuffer::contentLine( unsigned int line ) const {
+  if ( line >= mContentCount ) {
+    std::stringstream msg;
+    msg << "Content line out of range: " << line;
+    XDM_THROW( std::runtime_error( msg.str() ) );
+  }
+  return mContent[line];
+}
+
+void XmlMetadataBuffer::printHeader( std::string& output, int indentLevel ) const {
+  if ( mTag.empty() ) {
+    XDM_THROW( std::runtime_error( "XmlObject is empty" ) );
+  }
+
+  // Sort indices rather than the attributes themselves so that the strings
+  // are not copied.
+  mAttributeOrder.resize( mAttributeCount );
+  for ( std::size_t i = 0; i < mAttributeCount; ++i ) {
+    mAttributeOrder[i] = i;
+  }
+  std::sort( mAttributeOrder.begin(), mAttributeOrder.end(),
+    AttributeNameLess( mAttributes ) );
+
+  appendIndent( output, indentLevel );
+  output += '<';
+  output += mTag;
+  for ( std::size_t i = 0; i < mAttributeCount; ++i ) {
+    const Attribute& attribute = mAttributes[ mAttributeOrder[i] ];
+    output += ' ';
+    output += attribute.first;
+    output += "='";
+    output += attribute.second;
+    output += '\'';
+  }
+  output += ">\n";
+}
+
+void XmlMetadataBuffer::printTextContent( std::string& output, int indentLevel ) const {
+  for ( std::size_t line = 0; line < mContentCount; ++line ) {
+    appendIndent( output, indentLevel );
+    output += mContent[line];
+    output += '\n';
+  }
+}
+
+std::string& XmlMetadataBuffer::attributeValue( const std::string& name ) {
+  std::size_t index = findAttribute( name );
+  if ( index == mAttributeCount ) {
+    if ( mAttributeCount == mAttributes.size() ) {
+      mAttributes.push_back( Attribute() );
+    }
+    mAttributes[index].first = name;
+    ++mAttributeCount;
+  }
+  return mAttributes[index].second;
+}
+
+std::size_t XmlMetadataBuffer::findAttribute( const std::string& name ) const {
+  std::size_t index = 0;
+  while ( index < mAttributeCount && mAttributes[index].first != name ) {
+    ++index;
+  }
+  return index;
+}
+
+void appendIndent( std::string& output, int indentLevel ) {
+  if ( indentLevel > 0 ) {
+    output.append( 2 * indentLevel, ' ' );
+  }
+}
+
+} // namespace xdm
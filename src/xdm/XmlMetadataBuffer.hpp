@@ -0,0 +1,111 @@
+//==============================================================================
+// This software developed by Stellar Science Ltd Co and the U.S. Government.
+// Copyright (C) 2010 Stellar Science. Government-purpose rights granted.
+//
+// This file is part of XDM
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+#ifndef xdm_XmlMetadataBuffer_hpp
+#define xdm_XmlMetadataBuffer_hpp
+
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+
+namespace xdm {
+
+/// Reusable storage for the metadata of a single XML element: its tag, its
+/// attributes and its lines of text content. This is the target of an
+/// XmlMetadataWrapper when metadata is written straight to a stream instead of
+/// being collected into an XmlObject tree. Clearing the buffer keeps the
+/// memory held by the strings, so writing the metadata of many items through
+/// one buffer does not allocate once the buffer has grown to fit them.
+///
+/// The buffer prints exactly the same text as the equivalent XmlObject.
+class XmlMetadataBuffer {
+public:
+  XmlMetadataBuffer();
+  ~XmlMetadataBuffer();
+
+  /// Remove the tag, attributes and content, keeping the allocated memory.
+  void clear();
+
+  /// Set the tag of the element.
+  void setTag( const std::string& tag ) { mTag = tag; }
+  /// Get the tag of the element.
+  const std::string& tag() const { return mTag; }
+
+  /// Set the attribute with the given name to the given value. If the
+  /// attribute already exists, it is overwritten.
+  void setAttribute( const std::string& name, const std::string& value );
+  /// Set an attribute from a C string.
+  void setAttribute( const std::string& name, const char* value );
+  /// Set an attribute from any type with the stream insertion operator.
+  template< typename T >
+  void setAttribute( const std::string& name, const T& value ) {
+    mFormat.str( std::string() );
+    mFormat.clear();
+    mFormat << value;
+    setAttribute( name, mFormat.str() );
+  }
+
+  /// Determine if the element has the specified attribute.
+  bool hasAttribute( const std::string& name ) const;
+  /// Get the value of the specified attribute.
+  /// @throw AttributeDoesNotExist The element has no such attribute.
+  const std::string& attribute( const std::string& name ) const;
+
+  /// Append a line of text content to the element.
+  void appendContent( const std::string& text );
+  /// Get the numbered line of text content.
+  const std::string& contentLine( unsigned int line ) const;
+
+  /// Append the start tag of the element to a string, in the same format as
+  /// XmlObject::printHeader.
+  void printHeader( std::string& output, int indentLevel ) const;
+  /// Append the text content of the element to a string, in the same format as
+  /// XmlObject::printTextContent.
+  void printTextContent( std::string& output, int indentLevel ) const;
+
+private:
+  typedef std::pair< std::string, std::string > Attribute;
+
+  // Get the value of an attribute, adding the attribute if it is not set.
+  std::string& attributeValue( const std::string& name );
+  // Find an attribute among the ones in use, or return mAttributeCount.
+  std::size_t findAttribute( const std::string& name ) const;
+
+  std::string mTag;
+  std::vector< Attribute > mAttributes;
+  std::size_t mAttributeCount;
+  std::vector< std::string > mContent;
+  std::size_t mContentCount;
+  mutable std::vector< std::size_t > mAttributeOrder;
+  std::ostringstream mFormat;
+
+  XmlMetadataBuffer( const XmlMetadataBuffer& );
+  XmlMetadataBuffer& operator=( const XmlMetadataBuffer& );
+};
+
+/// Append the indentation for a line at the given level to a string.
+void appendIndent( std::string& output, int indentLevel );
+
+} // namespace xdm
+
+#endif // xdm_XmlMetadataBuffer_hpp
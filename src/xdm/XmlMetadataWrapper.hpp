@@ -40,21 +40,34 @@ class XmlMetadataWrapper : public XmlTextContent {
 public:
   /// Constructor takes an XmlObject to wrap.
   XmlMetadataWrapper( RefPtr< XmlObject > xml ) : XmlTextContent( xml ) {}
+  /// Constructor takes an XmlMetadataBuffer to wrap. This is used to write
+  /// metadata to a stream without building an XmlObject for each item.
+  XmlMetadataWrapper( XmlMetadataBuffer& buffer ) : XmlTextContent( buffer ) {}
   ~XmlMetadataWrapper() {}
 
   /// Set the tag for the underlying XmlObject.
-  void setTag( const std::string& name ) { mXml->setTag( name ); }
+  void setTag( const std::string& name ) {
+    if ( mBuffer ) {
+      mBuffer->setTag( name );
+    } else {
+      mXml->setTag( name );
+    }
+  }
   /// Get the tag for the underlying XmlOBject.
-  const std::string& tag() const { return mXml->tag(); }
+  const std::string& tag() const { return mBuffer ? mBuffer->tag() : mXml->tag(); }
 
   /// Set an attribute with the given name to the given value.
   template< typename T >
   void setAttribute( const std::string& key, const T& value ) {
-    appendAttribute( *mXml, key, value );
+    if ( mBuffer ) {
+      mBuffer->setAttribute( key, value );
+    } else {
+      appendAttribute( *mXml, key, value );
+    }
   }
   /// Get a named attribute for the underlying XmlObject.
   const std::string& attribute( const std::string& key ) const {
-    return mXml->attribute( key );
+    return mBuffer ? mBuffer->attribute( key ) : mXml->attribute( key );
   }
 };
 
@@ -60,7 +60,7 @@ void XmlOutputStream::openContext( RefPtr< XmlObject > obj ) {
   obj->printTextContent( mOutput, mContextStack.size() );
 
   // now push the object onto the context stack.
-  mContextStack.push( obj );
+  mContextStack.push_back( obj );
 
   if( obj->hasChildren() ) {
     // write the complete body of all but the final child to the stream
@@ -83,11 +83,11 @@ void XmlOutputStream::closeCurrentContext() {
   assert( !mContextStack.empty() );
 
   // Save a reference to the current top of the stack.
-  RefPtr< XmlObject > top = mContextStack.top();
+  RefPtr< XmlObject > top = mContextStack.back();
 
   // pop the stack, we follow the reverse order of openContext so that the
   // indentation level is managed by the size of the stack.
-  mContextStack.pop();
+  mContextStack.pop_back();
 
   // now print the footer of the closed object to the stream.
   top->printFooter( mOutput, mContextStack.size() );
@@ -99,5 +99,20 @@ void XmlOutputStream::closeStream() {
   }
 }
 
+void XmlOutputStream::resumeContext( RefPtr< XmlObject > obj ) {
+  mContextStack.push_back( obj );
+  if ( obj->hasChildren() ) {
+    XmlObject::ChildIterator finalChild = obj->endChildren();
+    --finalChild;
+    resumeContext( *finalChild );
+  }
+}
+
+void XmlOutputStream::printFooters( std::ostream& ostr ) const {
+  for ( std::size_t level = mContextStack.size(); level > 0; --level ) {
+    mContextStack[ level - 1 ]->printFooter( ostr, level - 1 );
+  }
+}
+
 } // namespace xdm
 
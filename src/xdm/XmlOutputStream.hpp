@@ -24,7 +24,7 @@
 #include <xdm/RefPtr.hpp>
 
 #include <ostream>
-#include <stack>
+#include <vector>
 
 
 
@@ -57,9 +57,24 @@ public:
   /// Close the stream, completing all open contexts.
   void closeStream();
 
+  /// Resume a stream context whose header was written earlier, to continue an
+  /// existing document. The contexts are opened as by openContext, but nothing
+  /// is written to the stream.
+  void resumeContext( RefPtr< XmlObject > obj );
+
+  /// Print the footers of all open contexts to a stream without closing them.
+  /// Writing them to the output stream completes the document so far; the
+  /// output must then be positioned back over them before anything else is
+  /// written.
+  void printFooters( std::ostream& ostr ) const;
+
+  /// Get the number of open contexts, which is the indent level of objects
+  /// written within the current context.
+  std::size_t contextDepth() const { return mContextStack.size(); }
+
 private:
   std::ostream& mOutput;
-  std::stack< RefPtr< XmlObject > > mContextStack;
+  std::vector< RefPtr< XmlObject > > mContextStack;
 };
 
 } // namespace xdm
@@ -22,34 +22,44 @@
 #define xdm_XmlTextContent_hpp
 
 #include <xdm/RefPtr.hpp>
+#include <xdm/XmlMetadataBuffer.hpp>
 #include <xdm/XmlObject.hpp>
 
 
 
 namespace xdm {
 
-/// Wrapper object that exposes only the text content of an XmlObject.
+/// Wrapper object that exposes only the text content of an XmlObject, or of
+/// an XmlMetadataBuffer when the metadata is written directly to a stream.
 class XmlTextContent {
 protected:
   RefPtr< XmlObject > mXml;
+  XmlMetadataBuffer* mBuffer;
 
 public:
   /// Constructor takes an XmlObject to wrap.
-  XmlTextContent( RefPtr< XmlObject > xml ) : mXml( xml ) {}
+  XmlTextContent( RefPtr< XmlObject > xml ) : mXml( xml ), mBuffer( 0 ) {}
+  /// Constructor takes an XmlMetadataBuffer to wrap.
+  XmlTextContent( XmlMetadataBuffer& buffer ) : mXml(), mBuffer( &buffer ) {}
   ~XmlTextContent() {}
 
   /// Append a line of content to the XmlObject.
   void appendContentLine( const std::string& line ) { 
-    mXml->appendContent( line );
+    if ( mBuffer ) {
+      mBuffer->appendContent( line );
+    } else {
+      mXml->appendContent( line );
+    }
   }
 
   /// Query a line of content from the XmlObject.
   const std::string& contentLine( unsigned int line ) const {
-    return mXml->contentLine( line );
+    return mBuffer ? mBuffer->contentLine( line ) : mXml->contentLine( line );
   }
 
   /// Return the full XmlObject that this content belongs to. This is provided
-  /// for special cases only.
+  /// for special cases only. When wrapping an XmlMetadataBuffer there is no
+  /// XmlObject, and the result is null.
   RefPtr< XmlObject > completeObject() { return mXml; }
 };
 
@@ -0,0 +1,84 @@
+//==============================================================================
+// This software developed by Stellar Science Ltd Co and the U.S. Government.
+// Copyright (C) 2010 Stellar Science. Government-purpose rights granted.
+//
+// This file is part of XDM
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+#define BOOST_TEST_MODULE ParallelErrorCapture
+#include <boost/test/unit_test.hpp>
+
+#include <xdm/ParallelErrorCapture.hpp>
+
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+void captureAll( xdm::ParallelErrorCapture& error ) {
+  const long numberOfTasks = 16;
+#ifdef _OPENMP
+  #pragma omp parallel for
+#endif
+  for ( long task = 0; task < numberOfTasks; ++task ) {
+    try {
+      if ( task % 4 == 3 ) {
+        throw std::out_of_range( "task out of range" );
+      }
+    } catch ( ... ) {
+      error.capture();
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( noError ) {
+  xdm::ParallelErrorCapture error;
+  BOOST_CHECK( error.empty() );
+  BOOST_CHECK_NO_THROW( error.rethrow() );
+}
+
+BOOST_AUTO_TEST_CASE( rethrowFirstError ) {
+  xdm::ParallelErrorCapture error;
+  captureAll( error );
+  BOOST_CHECK( ! error.empty() );
+#if __cplusplus >= 201103L
+  BOOST_CHECK_THROW( error.rethrow(), std::out_of_range );
+#else
+  BOOST_CHECK_THROW( error.rethrow(), std::runtime_error );
+#endif
+}
+
+BOOST_AUTO_TEST_CASE( keepMessage ) {
+  xdm::ParallelErrorCapture error;
+  try {
+    throw std::invalid_argument( "bad argument" );
+  } catch ( ... ) {
+    error.capture();
+  }
+  try {
+    throw std::runtime_error( "second error" );
+  } catch ( ... ) {
+    error.capture();
+  }
+  try {
+    error.rethrow();
+    BOOST_ERROR( "Expected an exception." );
+  } catch ( const std::exception& e ) {
+    BOOST_CHECK_EQUAL( std::string( "bad argument" ), e.what() );
+  }
+}
+
+} // namespace
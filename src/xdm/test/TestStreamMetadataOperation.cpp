@@ -0,0 +1,294 @@
+//==============================================================================
+// This software developed by Stellar Science Ltd Co and the U.S. Government.
+// Copyright (C) 2010 Stellar Science. Government-purpose rights granted.
+//
+// This file is part of XDM
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+#define BOOST_TEST_MODULE StreamMetadataOperation
+#include <boost/test/unit_test.hpp>
+
+#include <xdm/StreamMetadataOperation.hpp>
+
+#include <xdm/BinaryIOStream.hpp>
+#include <xdm/BinaryStreamBuffer.hpp>
+#include <xdm/CollectMetadataOperation.hpp>
+#include <xdm/Item.hpp>
+#include <xdm/XmlMetadataWrapper.hpp>
+#include <xdm/XmlObject.hpp>
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+struct AggregateItem : xdm::Item {
+  std::vector< xdm::RefPtr< Item > > mItems;
+  void appendChild( xdm::RefPtr< xdm::Item > i ) { mItems.push_back( i ); }
+  virtual void traverse( xdm::ItemVisitor& iv ) {
+    std::for_each( mItems.begin(), mItems.end(), xdm::ApplyVisitor( iv ) );
+  }
+};
+
+// An item that exercises every part of the metadata interface.
+struct DescribedItem : AggregateItem {
+  int mIndex;
+  std::string mTag;
+  DescribedItem( int index, const std::string& tag = "Described" ) :
+    mIndex( index ), mTag( tag ) {}
+  virtual void writeMetadata( xdm::XmlMetadataWrapper& xml ) {
+    xml.setTag( mTag );
+    xml.setAttribute( "Name", "item" );
+    xml.setAttribute( "Index", mIndex );
+    xml.setAttribute( "Scale", 0.5 * mIndex );
+    xml.setAttribute( "Center", std::string( "Node" ) );
+    // Setting an attribute again replaces its value.
+    xml.setAttribute( "Name", std::string( "described" ) );
+    xml.appendContentLine( "data.h5:/values" );
+    xml.appendContentLine( "second line" );
+  }
+};
+
+// Build a tree of items a few levels deep.
+xdm::RefPtr< AggregateItem > buildTree( std::size_t children ) {
+  xdm::RefPtr< AggregateItem > root( new AggregateItem );
+  for ( std::size_t i = 0; i < children; ++i ) {
+    xdm::RefPtr< DescribedItem > child( new DescribedItem( i ) );
+    child->appendChild( xdm::makeRefPtr( new DescribedItem( -int( i ), "Leaf" ) ) );
+    child->appendChild( xdm::makeRefPtr( new xdm::Item ) );
+    root->appendChild( child );
+  }
+  return root;
+}
+
+std::string collectedText( xdm::Item& item, int indentLevel ) {
+  xdm::CollectMetadataOperation collect;
+  item.accept( collect );
+  std::stringstream result;
+  xdm::writeIndent( result, *collect.result(), indentLevel );
+  return result.str();
+}
+
+BOOST_AUTO_TEST_CASE( matchesCollectMetadata ) {
+  xdm::RefPtr< AggregateItem > tree = buildTree( 3 );
+
+  std::stringstream result;
+  xdm::StreamMetadataOperation op( result );
+  tree->accept( op );
+  BOOST_CHECK_EQUAL( collectedText( *tree, 0 ), result.str() );
+  BOOST_CHECK_EQUAL( result.str(), op.result() );
+
+  // A second traversal is written after the first.
+  tree->accept( op );
+  BOOST_CHECK_EQUAL( collectedText( *tree, 0 ) + collectedText( *tree, 0 ), result.str() );
+}
+
+BOOST_AUTO_TEST_CASE( indentLevel ) {
+  DescribedItem item( 7 );
+  std::stringstream result;
+  xdm::StreamMetadataOperation op( result, 2 );
+  item.accept( op );
+
+  char const * const answer =
+    "    <Described Center='Node' Index='7' Name='described' Scale='3.5'>\n"
+    "      data.h5:/values\n"
+    "      second line\n"
+    "    </Described>\n";
+  BOOST_CHECK_EQUAL( answer, result.str() );
+  BOOST_CHECK_EQUAL( collectedText( item, 2 ), result.str() );
+}
+
+struct FailingItem : xdm::Item {
+  virtual void writeMetadata( xdm::XmlMetadataWrapper& ) {
+    throw std::runtime_error( "no metadata" );
+  }
+};
+
+BOOST_AUTO_TEST_CASE( failureWritesNothing ) {
+  xdm::RefPtr< AggregateItem > tree = buildTree( 2 );
+  tree->appendChild( xdm::makeRefPtr( new FailingItem ) );
+
+  std::stringstream result;
+  xdm::StreamMetadataOperation op( result );
+  BOOST_CHECK_THROW( tree->accept( op ), std::runtime_error );
+  BOOST_CHECK( result.str().empty() );
+
+  // The operation is usable again afterwards.
+  xdm::RefPtr< AggregateItem > good = buildTree( 2 );
+  good->accept( op );
+  BOOST_CHECK_EQUAL( collectedText( *good, 0 ), result.str() );
+}
+
+BOOST_AUTO_TEST_CASE( captureAndRestore ) {
+  // A remote process writes a subtree and sends it.
+  DescribedItem remote( 3 );
+  std::stringstream remoteOutput;
+  xdm::StreamMetadataOperation remoteOp( remoteOutput, 1 );
+  remoteOp.reset();
+  remote.accept( remoteOp );
+
+  xdm::BinaryStreamBuffer buffer( 1024 );
+  xdm::BinaryIOStream stream( &buffer );
+  remoteOp.captureState( stream );
+  stream.flush();
+
+  // Restoring at the root writes the subtree after the current tree.
+  std::stringstream result;
+  xdm::StreamMetadataOperation op( result, 1 );
+  op.restoreState( stream );
+  BOOST_CHECK_EQUAL( collectedText( remote, 1 ), result.str() );
+}
+
+struct RestoringItem : AggregateItem {
+  xdm::BinaryIStream& mInput;
+  RestoringItem( xdm::BinaryIStream& input ) : mInput( input ) {}
+  virtual void traverse( xdm::ItemVisitor& iv ) {
+    AggregateItem::traverse( iv );
+    iv.restoreState( mInput );
+  }
+};
+
+BOOST_AUTO_TEST_CASE( restoreWithinTree ) {
+  DescribedItem remote( 3 );
+  std::stringstream remoteOutput;
+  xdm::StreamMetadataOperation remoteOp( remoteOutput );
+  remote.accept( remoteOp );
+
+  xdm::BinaryStreamBuffer buffer( 1024 );
+  xdm::BinaryIOStream stream( &buffer );
+  remoteOp.captureState( stream );
+  stream.flush();
+
+  // The gathered subtree is written as a child of the item being visited.
+  xdm::RefPtr< RestoringItem > local( new RestoringItem( stream ) );
+  local->appendChild( xdm::makeRefPtr( new DescribedItem( 1 ) ) );
+  std::stringstream result;
+  xdm::StreamMetadataOperation op( result );
+  local->accept( op );
+
+  xdm::RefPtr< AggregateItem > expected( new AggregateItem );
+  expected->appendChild( xdm::makeRefPtr( new DescribedItem( 1 ) ) );
+  expected->appendChild( xdm::makeRefPtr( new DescribedItem( 3 ) ) );
+  BOOST_CHECK_EQUAL( collectedText( *expected, 0 ), result.str() );
+}
+
+BOOST_AUTO_TEST_CASE( includeRepeatedElements ) {
+  std::stringstream result;
+  xdm::StreamMetadataOperation op( result, 1 );
+  op.addIncludeTag( "Leaf" );
+
+  // Write three trees as the first three children of the root element. The
+  // second repeats the leaf of the first.
+  const int leaves[] = { 7, 7, 8 };
+  for ( int tree = 0; tree < 3; ++tree ) {
+    DescribedItem root( tree );
+    root.appendChild( xdm::makeRefPtr( new DescribedItem( 1 ) ) );
+    root.appendChild( xdm::makeRefPtr( new DescribedItem( leaves[tree], "Leaf" ) ) );
+    std::stringstream position;
+    position << "/1/" << tree + 1;
+    op.setRootPosition( position.str() );
+    op.reset();
+    root.accept( op );
+  }
+
+  DescribedItem first( 0 );
+  first.appendChild( xdm::makeRefPtr( new DescribedItem( 1 ) ) );
+  first.appendChild( xdm::makeRefPtr( new DescribedItem( 7, "Leaf" ) ) );
+  std::string expected = collectedText( first, 1 );
+  DescribedItem second( 1 );
+  second.appendChild( xdm::makeRefPtr( new DescribedItem( 1 ) ) );
+  std::string secondText = collectedText( second, 1 );
+  // Splice the include in before the closing tag of the second tree.
+  secondText.insert( secondText.rfind( "  </Described>" ),
+    "    <xi:include xmlns:xi='http://www.w3.org/2001/XInclude'"
+    " xpointer='element(/1/1/2)'>\n"
+    "    </xi:include>\n" );
+  expected += secondText;
+  DescribedItem third( 2 );
+  third.appendChild( xdm::makeRefPtr( new DescribedItem( 1 ) ) );
+  third.appendChild( xdm::makeRefPtr( new DescribedItem( 8, "Leaf" ) ) );
+  expected += collectedText( third, 1 );
+  BOOST_CHECK_EQUAL( expected, result.str() );
+
+  // Forgetting the written elements writes the leaf again.
+  op.clearIncludes();
+  DescribedItem leaf( 7, "Leaf" );
+  op.setRootPosition( "/1/4" );
+  op.reset();
+  leaf.accept( op );
+  BOOST_CHECK_EQUAL( collectedText( leaf, 1 ), op.result() );
+}
+
+// The text kept to find repeated elements is bounded. Elements forgotten to
+// stay within the bound are written in full when they repeat.
+BOOST_AUTO_TEST_CASE( includeMemoryLimit ) {
+  std::stringstream result;
+  xdm::StreamMetadataOperation op( result, 1 );
+  BOOST_CHECK_EQUAL(
+    xdm::StreamMetadataOperation::kDefaultIncludeMemoryLimit, op.includeMemoryLimit() );
+  op.addIncludeTag( "Leaf" );
+  op.setIncludeMemoryLimit( 0 );
+
+  // Repeats within a tree are still included.
+  DescribedItem root( 0 );
+  root.appendChild( xdm::makeRefPtr( new DescribedItem( 7, "Leaf" ) ) );
+  root.appendChild( xdm::makeRefPtr( new DescribedItem( 7, "Leaf" ) ) );
+  op.setRootPosition( "/1/1" );
+  root.accept( op );
+  DescribedItem expectedRoot( 0 );
+  expectedRoot.appendChild( xdm::makeRefPtr( new DescribedItem( 7, "Leaf" ) ) );
+  std::string expected = collectedText( expectedRoot, 1 );
+  expected.insert( expected.rfind( "  </Described>" ),
+    "    <xi:include xmlns:xi='http://www.w3.org/2001/XInclude'"
+    " xpointer='element(/1/1/1)'>\n"
+    "    </xi:include>\n" );
+  BOOST_CHECK_EQUAL( expected, op.result() );
+
+  // The leaves of the first tree are forgotten when the next tree starts.
+  DescribedItem leaf( 7, "Leaf" );
+  op.setRootPosition( "/1/2" );
+  leaf.accept( op );
+  BOOST_CHECK_EQUAL( collectedText( leaf, 1 ), op.result() );
+
+  // With room for one leaf, the last one written is kept.
+  op.setIncludeMemoryLimit( collectedText( leaf, 1 ).size() );
+  op.setRootPosition( "/1/3" );
+  leaf.accept( op );
+  BOOST_CHECK_EQUAL( "  <xi:include xmlns:xi='http://www.w3.org/2001/XInclude'"
+    " xpointer='element(/1/2)'>\n"
+    "  </xi:include>\n", op.result() );
+}
+
+// Writing the metadata of a tree repeatedly, as a time series does for every
+// step, must write the same text each time.
+BOOST_AUTO_TEST_CASE( repeatedTraversals ) {
+  const std::size_t steps = 5;
+  xdm::RefPtr< AggregateItem > tree = buildTree( 50 );
+  const std::string expected = collectedText( *tree, 0 );
+
+  std::stringstream output;
+  xdm::StreamMetadataOperation stream( output );
+  std::string all;
+  for ( std::size_t step = 0; step < steps; ++step ) {
+    tree->accept( stream );
+    BOOST_CHECK_EQUAL( expected, stream.result() );
+    all += expected;
+  }
+  BOOST_CHECK_EQUAL( all, output.str() );
+}
+
+} // namespace
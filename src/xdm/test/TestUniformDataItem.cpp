@@ -27,6 +27,7 @@
 #include <xdm/UniformDataItem.hpp>
 #include <xdm/VectorStructuredArray.hpp>
 #include <xdm/ArrayAdapter.hpp>
+#include <xdm/SerializeDataOperation.hpp>
 
 #include <algorithm>
 
@@ -108,4 +109,26 @@ BOOST_AUTO_TEST_CASE( valueAtLocation ) {
   BOOST_CHECK_EQUAL( item->atLocation<int>( 1, 1, 2 ), answer[1][1][2] );
 }
 
+BOOST_AUTO_TEST_CASE( alreadyWritten ) {
+  int values[] = { 1, 2, 3 };
+  xdm::RefPtr< xdm::UniformDataItem > item =
+    test::createUniformDataItem( values, 3, xdm::primitiveType::kInt );
+  BOOST_CHECK( !item->alreadyWritten() );
+
+  // Marked items are skipped even though their data needs an update.
+  item->setAlreadyWritten( true );
+  item->data()->setNeedsUpdate( true );
+  xdm::SerializeDataOperation skipped;
+  item->accept( skipped );
+  BOOST_CHECK_EQUAL( 0u, skipped.bytesWritten() );
+  BOOST_CHECK( item->data()->needsUpdate() );
+
+  // A new dataset clears the mark.
+  item->setDataset( xdm::makeRefPtr( new test::DummyDataset ) );
+  BOOST_CHECK( !item->alreadyWritten() );
+  xdm::SerializeDataOperation written;
+  item->accept( written );
+  BOOST_CHECK_EQUAL( 3 * sizeof( int ), written.bytesWritten() );
+}
+
 } // namespace
@@ -0,0 +1,271 @@
+//==============================================================================
+// This software developed by Stellar Science Ltd Co and the U.S. Government.
+// Copyright (C) 2010 Stellar Science. Government-purpose rights granted.
+//
+// This file is part of XDM
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+#define BOOST_TEST_MODULE VectorSpan
+#include <boost/test/unit_test.hpp>
+
+#include <xdm/VectorRef.hpp>
+#include <xdm/VectorSpan.hpp>
+
+#include <ctime>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+BOOST_AUTO_TEST_CASE( interlaced ) {
+  double data[20]; // to be indexed as [10][2], i.e. 10 2D vectors.
+  for ( int i = 0; i < 20; ++i ) {
+    data[i] = i;
+  }
+
+  xdm::InterlacedVectorSpan< double > span( data, 2 );
+  BOOST_CHECK_EQUAL( 2, span.size() );
+  BOOST_CHECK_EQUAL( 10.0, span.at( 5, 0 ) );
+  BOOST_CHECK_EQUAL( 11.0, span.at( 5, 1 ) );
+
+  span.at( 5, 0 ) = 0.25;
+  BOOST_CHECK_EQUAL( 0.25, data[10] );
+
+  std::size_t indices[] = { 7, 1, 5 };
+  double out[6];
+  span.gather( indices, 3, out );
+  BOOST_CHECK_EQUAL( 14.0, out[0] );
+  BOOST_CHECK_EQUAL( 15.0, out[1] );
+  BOOST_CHECK_EQUAL( 2.0, out[2] );
+  BOOST_CHECK_EQUAL( 3.0, out[3] );
+  BOOST_CHECK_EQUAL( 0.25, out[4] );
+  BOOST_CHECK_EQUAL( 11.0, out[5] );
+}
+
+BOOST_AUTO_TEST_CASE( interlacedStride ) {
+  // Records of 4 values with only the first 3 making up the vector.
+  double data[16];
+  for ( int i = 0; i < 16; ++i ) {
+    data[i] = i;
+  }
+
+  xdm::InterlacedVectorSpan< const double > span( data, 3, 4 );
+  BOOST_CHECK_EQUAL( 3, span.size() );
+  BOOST_CHECK_EQUAL( 4, span.stride() );
+  BOOST_CHECK_EQUAL( 9.0, span.at( 2, 1 ) );
+
+  int indices[] = { 3, 0 };
+  float out[6];
+  span.gather( indices, 2, out );
+  BOOST_CHECK_EQUAL( 12.f, out[0] );
+  BOOST_CHECK_EQUAL( 13.f, out[1] );
+  BOOST_CHECK_EQUAL( 14.f, out[2] );
+  BOOST_CHECK_EQUAL( 0.f, out[3] );
+  BOOST_CHECK_EQUAL( 1.f, out[4] );
+  BOOST_CHECK_EQUAL( 2.f, out[5] );
+}
+
+BOOST_AUTO_TEST_CASE( multiArray ) {
+  double x[10];
+  double y[10];
+  for ( int i = 0; i < 10; ++i ) {
+    x[i] = i;
+    y[i] = -i;
+  }
+
+  std::vector< double* > arrays;
+  arrays.push_back( x );
+  arrays.push_back( y );
+  xdm::MultipleArrayVectorSpan< double > span( arrays );
+  BOOST_CHECK_EQUAL( 2, span.size() );
+  BOOST_CHECK_EQUAL( 5.0, span.at( 5, 0 ) );
+  BOOST_CHECK_EQUAL( -5.0, span.at( 5, 1 ) );
+
+  std::size_t indices[] = { 9, 2 };
+  double out[4];
+  span.gather( indices, 2, out );
+  BOOST_CHECK_EQUAL( 9.0, out[0] );
+  BOOST_CHECK_EQUAL( -9.0, out[1] );
+  BOOST_CHECK_EQUAL( 2.0, out[2] );
+  BOOST_CHECK_EQUAL( -2.0, out[3] );
+}
+
+BOOST_AUTO_TEST_CASE( tensorProductMatchesImp ) {
+  std::vector< double > x( 5 ), y( 3 ), z( 4 );
+  for ( std::size_t i = 0; i < x.size(); ++i ) x[i] = 1.0 + i;
+  for ( std::size_t i = 0; i < y.size(); ++i ) y[i] = 10.0 + i;
+  for ( std::size_t i = 0; i < z.size(); ++i ) z[i] = 100.0 + i;
+
+  std::vector< double* > axes;
+  axes.push_back( &x[0] );
+  axes.push_back( &y[0] );
+  axes.push_back( &z[0] );
+  std::vector< std::size_t > sizes;
+  sizes.push_back( x.size() );
+  sizes.push_back( y.size() );
+  sizes.push_back( z.size() );
+
+  xdm::RefPtr< xdm::TensorProductArraysImp< double > > imp(
+    new xdm::TensorProductArraysImp< double >( axes, sizes ) );
+  xdm::TensorProductVectorEvaluator< double > evaluator( axes, sizes );
+
+  std::size_t numberOfNodes = x.size() * y.size() * z.size();
+  std::vector< std::size_t > indices( numberOfNodes );
+  for ( std::size_t node = 0; node < numberOfNodes; ++node ) {
+    indices[node] = numberOfNodes - node - 1;
+  }
+  std::vector< double > out( 3 * numberOfNodes );
+  evaluator.gather( &indices[0], numberOfNodes, &out[0] );
+
+  for ( std::size_t k = 0; k < numberOfNodes; ++k ) {
+    xdm::ConstVectorRef< double > reference( imp, indices[k] );
+    for ( std::size_t i = 0; i < 3; ++i ) {
+      BOOST_CHECK_EQUAL( reference[i], evaluator.at( indices[k], i ) );
+      BOOST_CHECK_EQUAL( reference[i], out[ 3 * k + i ] );
+    }
+  }
+}
+
+// The spans must gather the same values as the VectorRef interface, in a
+// scattered order as a connectivity array would visit the nodes.
+BOOST_AUTO_TEST_CASE( gatherMatchesVectorRef ) {
+  const std::size_t numberOfNodes = 101;
+
+  std::vector< double > xyz( 3 * numberOfNodes );
+  std::vector< double > x( numberOfNodes ), y( numberOfNodes ), z( numberOfNodes );
+  for ( std::size_t node = 0; node < numberOfNodes; ++node ) {
+    x[node] = xyz[3*node+0] = node;
+    y[node] = xyz[3*node+1] = 2.0 * node;
+    z[node] = xyz[3*node+2] = 3.0 * node;
+  }
+  std::vector< double* > arrays;
+  arrays.push_back( &x[0] );
+  arrays.push_back( &y[0] );
+  arrays.push_back( &z[0] );
+
+  std::vector< std::size_t > indices( numberOfNodes );
+  for ( std::size_t k = 0; k < numberOfNodes; ++k ) {
+    indices[k] = ( k * 37 ) % numberOfNodes;
+  }
+
+  xdm::RefPtr< xdm::VectorRefImp< double > > interlacedImp(
+    new xdm::SingleArrayOfVectorsImp< double >( &xyz[0], 3 ) );
+  xdm::RefPtr< xdm::VectorRefImp< double > > multiImp(
+    new xdm::MultipleArraysOfVectorElementsImp< double >( arrays ) );
+  xdm::InterlacedVectorSpan< double > interlacedSpan( &xyz[0], 3 );
+  xdm::MultipleArrayVectorSpan< double > multiSpan( arrays );
+
+  std::vector< double > viaInterlaced( 3 * numberOfNodes );
+  std::vector< double > viaMulti( 3 * numberOfNodes );
+  interlacedSpan.gather( &indices[0], numberOfNodes, &viaInterlaced[0] );
+  multiSpan.gather( &indices[0], numberOfNodes, &viaMulti[0] );
+
+  for ( std::size_t k = 0; k < numberOfNodes; ++k ) {
+    xdm::ConstVectorRef< double > interlacedNode( interlacedImp, indices[k] );
+    xdm::ConstVectorRef< double > multiNode( multiImp, indices[k] );
+    for ( std::size_t i = 0; i < 3; ++i ) {
+      BOOST_CHECK_EQUAL( interlacedNode[i], viaInterlaced[3*k+i] );
+      BOOST_CHECK_EQUAL( multiNode[i], viaMulti[3*k+i] );
+    }
+  }
+}
+
+// Compare the time to gather a large number of nodes through the VectorRef
+// interface against the bulk gather of the spans.
+BOOST_AUTO_TEST_CASE( gatherBenchmark ) {
+  const std::size_t numberOfNodes = 1 << 18;
+  const std::size_t passes = 8;
+
+  std::vector< double > xyz( 3 * numberOfNodes );
+  std::vector< double > x( numberOfNodes ), y( numberOfNodes ), z( numberOfNodes );
+  for ( std::size_t node = 0; node < numberOfNodes; ++node ) {
+    x[node] = xyz[3*node+0] = node;
+    y[node] = xyz[3*node+1] = 2.0 * node;
+    z[node] = xyz[3*node+2] = 3.0 * node;
+  }
+  std::vector< double* > arrays;
+  arrays.push_back( &x[0] );
+  arrays.push_back( &y[0] );
+  arrays.push_back( &z[0] );
+
+  // Visit the nodes in a scattered order, as a connectivity array would.
+  std::vector< std::size_t > indices( numberOfNodes );
+  for ( std::size_t k = 0; k < numberOfNodes; ++k ) {
+    indices[k] = ( k * 7919 ) % numberOfNodes;
+  }
+
+  xdm::RefPtr< xdm::VectorRefImp< double > > interlacedImp(
+    new xdm::SingleArrayOfVectorsImp< double >( &xyz[0], 3 ) );
+  xdm::RefPtr< xdm::VectorRefImp< double > > multiImp(
+    new xdm::MultipleArraysOfVectorElementsImp< double >( arrays ) );
+  xdm::InterlacedVectorSpan< double > interlacedSpan( &xyz[0], 3 );
+  xdm::MultipleArrayVectorSpan< double > multiSpan( arrays );
+
+  std::vector< double > viaRef( 3 * numberOfNodes );
+  std::vector< double > viaSpan( 3 * numberOfNodes );
+
+  std::clock_t start = std::clock();
+  for ( std::size_t pass = 0; pass < passes; ++pass ) {
+    for ( std::size_t k = 0; k < numberOfNodes; ++k ) {
+      xdm::ConstVectorRef< double > node( interlacedImp, indices[k] );
+      for ( std::size_t i = 0; i < 3; ++i ) {
+        viaRef[3*k+i] = node[i];
+      }
+    }
+  }
+  std::clock_t refTime = std::clock() - start;
+
+  start = std::clock();
+  for ( std::size_t pass = 0; pass < passes; ++pass ) {
+    interlacedSpan.gather( &indices[0], numberOfNodes, &viaSpan[0] );
+  }
+  std::clock_t spanTime = std::clock() - start;
+  BOOST_CHECK( viaRef == viaSpan );
+  BOOST_TEST_MESSAGE( "Interlaced gather of " << passes * numberOfNodes << " nodes: VectorRef "
+    << refTime << " clocks, InterlacedVectorSpan " << spanTime << " clocks" );
+
+  start = std::clock();
+  for ( std::size_t pass = 0; pass < passes; ++pass ) {
+    for ( std::size_t k = 0; k < numberOfNodes; ++k ) {
+      xdm::ConstVectorRef< double > node( multiImp, indices[k] );
+      for ( std::size_t i = 0; i < 3; ++i ) {
+        viaRef[3*k+i] = node[i];
+      }
+    }
+  }
+  refTime = std::clock() - start;
+
+  start = std::clock();
+  for ( std::size_t pass = 0; pass < passes; ++pass ) {
+    multiSpan.gather( &indices[0], numberOfNodes, &viaSpan[0] );
+  }
+  spanTime = std::clock() - start;
+  BOOST_CHECK( viaRef == viaSpan );
+  BOOST_TEST_MESSAGE( "Multiple array gather of " << passes * numberOfNodes << " nodes: VectorRef "
+    << refTime << " clocks, MultipleArrayVectorSpan " << spanTime << " clocks" );
+}
+
+BOOST_AUTO_TEST_CASE( tooManyComponents ) {
+  double values[1] = { 0.0 };
+  std::vector< double* > arrays( 5, values );
+  BOOST_CHECK_THROW( xdm::MultipleArrayVectorSpan< double > span( arrays ), std::length_error );
+
+  std::vector< std::size_t > sizes( 5, 1 );
+  BOOST_CHECK_THROW(
+    xdm::TensorProductVectorEvaluator< double > evaluator( arrays, sizes ), std::length_error );
+}
+
+} // namespace
@@ -111,5 +111,62 @@ BOOST_AUTO_TEST_CASE( closeStream ) {
   test.closeStream();
 }
 
+BOOST_AUTO_TEST_CASE( printFooters ) {
+  RefPtr< XmlObject > obj( new XmlObject( "obj" ) );
+  RefPtr< XmlObject > chi( new XmlObject( "chi" ) );
+  obj->appendChild( chi );
+
+  std::stringstream result;
+  XmlOutputStream test( result );
+  test.openContext( obj );
+  std::streampos footer = result.tellp();
+  test.printFooters( result );
+
+  char const * const answer_footers =
+    "<?xml version='1.0'?>\n"
+    "<obj>\n"
+    "  <chi>\n"
+    "  </chi>\n"
+    "</obj>\n";
+  BOOST_CHECK_EQUAL( answer_footers, result.str() );
+
+  // Writing over the footers continues the document.
+  result.seekp( footer );
+  test.writeObject( RefPtr< XmlObject >( new XmlObject( "gra" ) ) );
+  test.closeStream();
+
+  char const * const answer_complete =
+    "<?xml version='1.0'?>\n"
+    "<obj>\n"
+    "  <chi>\n"
+    "    <gra>\n"
+    "    </gra>\n"
+    "  </chi>\n"
+    "</obj>\n";
+  BOOST_CHECK_EQUAL( answer_complete, result.str() );
+}
+
+BOOST_AUTO_TEST_CASE( resumeContext ) {
+  RefPtr< XmlObject > obj( new XmlObject( "obj" ) );
+  RefPtr< XmlObject > chi( new XmlObject( "chi" ) );
+  obj->appendChild( chi );
+
+  std::stringstream result;
+  XmlOutputStream test( result );
+  result.str( "" );
+  test.resumeContext( obj );
+  BOOST_CHECK_EQUAL( "", result.str() );
+
+  test.writeObject( RefPtr< XmlObject >( new XmlObject( "gra" ) ) );
+  test.closeStream();
+
+  char const * const answer =
+    "    <gra>\n"
+    "    </gra>\n"
+    "  </chi>\n"
+    "</obj>\n";
+  BOOST_CHECK_EQUAL( answer, result.str() );
+}
+
 } // namespace
 
@@ -42,6 +42,9 @@ CollectionGrid::CollectionGrid() :
   mElementIndices(),
   mFaceEdgeIndices(),
   mElementOffsets(),
+  mOffsetsValid( false ),
+  mUseElementTable( false ),
+  mElementTable(),
   mReferenceTypes() {
 }
 
@@ -59,6 +62,7 @@ void CollectionGrid::appendGrid( xdm::RefPtr< Grid > grid ) {
   mElementIndices.push_back( xdm::RefPtr< xdm::UniformDataItem >() );
   mFaceEdgeIndices.push_back( xdm::RefPtr< xdm::UniformDataItem >() );
   mReferenceTypes.push_back( kElement );
+  invalidateOffsets();
 }
 
 void CollectionGrid::appendGrid(
@@ -80,6 +84,7 @@ void CollectionGrid::appendGrid(
   mElementIndices.push_back( elementIndices );
   mFaceEdgeIndices.push_back( xdm::RefPtr< xdm::UniformDataItem >() );
   mReferenceTypes.push_back( kElement );
+  invalidateOffsets();
 }
 
 void CollectionGrid::appendGridFaces(
@@ -112,6 +117,7 @@ void CollectionGrid::appendGridFaces(
   mElementIndices.push_back( elementIndices );
   mFaceEdgeIndices.push_back( faceIndices );
   mReferenceTypes.push_back( kFace );
+  invalidateOffsets();
 }
 
 void CollectionGrid::appendGridEdges(
@@ -140,6 +146,7 @@ void CollectionGrid::appendGridEdges(
   mElementIndices.push_back( elementIndices );
   mFaceEdgeIndices.push_back( edgeIndices );
   mReferenceTypes.push_back( kEdge );
+  invalidateOffsets();
 }
 
 xdm::RefPtr< Attribute > CollectionGrid::createAttribute(
@@ -199,10 +206,12 @@ xdm::RefPtr< Attribute > CollectionGrid::createAttribute(
 }
 
 std::size_t CollectionGrid::numberOfElements() const {
-  if ( mElementOffsets.size() != mGrids.size() ) {
+  // Checking the offsets costs one count per referenced grid, which is small
+  // next to any use of the elements.
+  if ( ! offsetsAreCurrent() ) {
     updateOffsets();
   }
-  return mElementOffsets.back();
+  return mElementOffsets.empty() ? 0 : mElementOffsets.back();
 }
 
 Element CollectionGrid::element( const std::size_t& elementIndex ) const
@@ -216,16 +225,85 @@ Element CollectionGrid::element( const std::size_t& elementIndex ) const
     element = mElementIndices[ found.first ]->atIndex< std::size_t >( found.second );
   }
 
-  switch( mReferenceTypes[ found.first ] ) {
-  case kFace:
-    return mGrids[ found.first ]->element( element ).face(
-      mFaceEdgeIndices[ found.first ]->atIndex< std::size_t >( found.second ) );
-  case kEdge:
-    return mGrids[ found.first ]->element( element ).edge(
-      mFaceEdgeIndices[ found.first ]->atIndex< std::size_t >( found.second ) );
-   default:
-    return mGrids[ found.first ]->element( element );
+  std::size_t faceEdgeIndex = 0;
+  if ( mFaceEdgeIndices[ found.first ] ) {
+    faceEdgeIndex = mFaceEdgeIndices[ found.first ]->atIndex< std::size_t >( found.second );
+  }
+
+  return referencedElement( found.first, element, faceEdgeIndex );
+}
+
+void CollectionGrid::invalidateOffsets() {
+  mOffsetsValid = false;
+}
+
+void CollectionGrid::setUseElementTable( bool useElementTable ) {
+  mUseElementTable = useElementTable;
+  invalidateOffsets();
+}
+
+bool CollectionGrid::useElementTable() const {
+  return mUseElementTable;
+}
+
+void CollectionGrid::partitionElementBlocks(
+  std::size_t maximumBlockSize,
+  std::vector< ElementBlockRange >& ranges ) const {
+
+  // Refresh the offsets if they are out of date so that filling blocks
+  // concurrently only reads them.
+  if ( ! offsetsAreCurrent() ) {
+    updateOffsets();
+  }
+  for ( std::size_t gridIndex = 0; gridIndex < mGrids.size(); ++gridIndex ) {
+    std::size_t offset = ( gridIndex > 0 ) ? mElementOffsets[ gridIndex - 1 ] : 0;
+    std::size_t begin = ranges.size();
+
+    if ( mReferenceTypes[ gridIndex ] != kElement ) {
+      // Faces and edges are only available through Element, so there is no
+      // faster path than inspecting each of them. The index arrays are
+      // loaded here so that filling blocks concurrently only reads them.
+      loadIndexArrays( gridIndex );
+      partitionElementRange( offset, mElementOffsets[ gridIndex ], maximumBlockSize, ranges );
+      continue;
+    }
+
+    if ( mElementIndices[ gridIndex ] ) {
+      mGrids[ gridIndex ]->partitionIndexedElementBlocks(
+        elementIndexArray( gridIndex ),
+        mElementOffsets[ gridIndex ] - offset,
+        maximumBlockSize,
+        ranges );
+    } else {
+      mGrids[ gridIndex ]->partitionElementBlocks( maximumBlockSize, ranges );
+    }
+
+    // Shift the new ranges from the numbering of the referenced grid into the
+    // numbering of the collection.
+    for ( std::size_t i = begin; i < ranges.size(); ++i ) {
+      ranges[i].first += offset;
+    }
+  }
+}
+
+void CollectionGrid::fillElementBlock(
+  std::size_t firstElement,
+  std::size_t count,
+  ElementBlock& block ) const {
+
+  std::pair< std::size_t, std::size_t > found = findGrid( firstElement );
+  if ( mReferenceTypes[ found.first ] != kElement ) {
+    Grid::fillElementBlock( firstElement, count, block );
+    return;
+  }
+
+  if ( mElementIndices[ found.first ] ) {
+    mGrids[ found.first ]->fillIndexedElementBlock(
+      elementIndexArray( found.first ) + found.second, count, block );
+  } else {
+    mGrids[ found.first ]->fillElementBlock( found.second, count, block );
   }
+  block.setFirstElement( firstElement );
 }
 
 void CollectionGrid::traverse( xdm::ItemVisitor& iv ) {
@@ -253,10 +331,15 @@ void CollectionGrid::writeMetadata( xdm::XmlMetadataWrapper& xml ) {
 // Finds the grid index and element offset index.
 std::pair< std::size_t, std::size_t > CollectionGrid::findGrid( const std::size_t& elementIndex ) const {
 
-  if ( mElementOffsets.size() != mGrids.size() ) {
+  if ( ! mOffsetsValid ) {
     updateOffsets();
   }
 
+  if ( mUseElementTable ) {
+    assert( elementIndex < mElementTable.size() );
+    return mElementTable[ elementIndex ];
+  }
+
   std::vector< std::size_t >::const_iterator found =
     std::upper_bound( mElementOffsets.begin(), mElementOffsets.end(), elementIndex );
   // Code Review Matter (open): assert vs exception
@@ -282,25 +365,77 @@ std::pair< std::size_t, std::size_t > CollectionGrid::findGrid( const std::size_
     offsetIndex );
 }
 
+// Get an element, face, or edge from a referenced grid.
+Element CollectionGrid::referencedElement(
+  std::size_t gridIndex,
+  std::size_t element,
+  std::size_t faceEdgeIndex ) const {
+
+  switch( mReferenceTypes[ gridIndex ] ) {
+  case kFace:
+    return mGrids[ gridIndex ]->element( element ).face( faceEdgeIndex );
+  case kEdge:
+    return mGrids[ gridIndex ]->element( element ).edge( faceEdgeIndex );
+  default:
+    return mGrids[ gridIndex ]->element( element );
+  }
+}
+
+// Get the element index array for a referenced grid as a contiguous array.
+const std::size_t* CollectionGrid::elementIndexArray( std::size_t gridIndex ) const {
+  return mElementIndices[ gridIndex ]->typedArray< std::size_t >()->begin();
+}
+
+// Get the face or edge index array for a referenced grid as a contiguous array.
+const std::size_t* CollectionGrid::faceEdgeIndexArray( std::size_t gridIndex ) const {
+  return mFaceEdgeIndices[ gridIndex ]->typedArray< std::size_t >()->begin();
+}
+
+// Load the index arrays of a referenced grid if they are read on demand.
+void CollectionGrid::loadIndexArrays( std::size_t gridIndex ) const {
+  if ( mElementIndices[ gridIndex ] ) {
+    elementIndexArray( gridIndex );
+  }
+  if ( mFaceEdgeIndices[ gridIndex ] ) {
+    faceEdgeIndexArray( gridIndex );
+  }
+}
+
+// Get the number of elements the collection references from one grid.
+std::size_t CollectionGrid::referencedElementCount( std::size_t gridIndex ) const {
+  // A null entry in mElementIndices means that every element of the grid is referenced.
+  if ( mElementIndices[ gridIndex ] ) {
+    return mElementIndices[ gridIndex ]->dataspace()[0];
+  }
+  return mGrids[ gridIndex ]->numberOfElements();
+}
+
+// Determine if mElementOffsets matches the grids and index arrays as they are now.
+bool CollectionGrid::offsetsAreCurrent() const {
+  if ( ! mOffsetsValid || mElementOffsets.size() != mGrids.size() ) {
+    return false;
+  }
+  std::size_t first = 0;
+  for ( std::size_t gridIndex = 0; gridIndex < mGrids.size(); ++gridIndex ) {
+    if ( mElementOffsets[ gridIndex ] - first != referencedElementCount( gridIndex ) ) {
+      return false;
+    }
+    first = mElementOffsets[ gridIndex ];
+  }
+  return true;
+}
+
 void CollectionGrid::updateOffsets() const {
 
   // This routine updates mElementOffsets to coincide with whatever grids are currently
   // being referenced by the collection. This is a cumulative index, so we are basically
   // just adding the number of elements we want from each grid to the previous index.
-  // However, there are a few conditional branches because 1) a null entry in
-  // mElementIndices means we use the whole grid (every element will become part of the
-  // CollectionGrid) and 2) the first grid does not have a previous grid.
+  // The first grid does not have a previous grid, so it is treated separately.
 
   mElementOffsets.clear();
   for ( std::size_t arrayIndex = 0; arrayIndex < mElementIndices.size(); ++arrayIndex ) {
-    if ( mElementIndices[ arrayIndex ] ) {
-      // First get the number of elements that will be referenced from the grid.
-      mElementOffsets.push_back( mElementIndices[ arrayIndex ]->dataspace()[0] );
-    } else {
-      // Special treatment if the pointer is null: this means that the whole
-      // grid is being used. Thus, we add every element from that grid.
-      mElementOffsets.push_back( mGrids[ arrayIndex ]->numberOfElements() );
-    }
+    // First get the number of elements that will be referenced from the grid.
+    mElementOffsets.push_back( referencedElementCount( arrayIndex ) );
 
     // The entry in mElementOffsets is the cumulative size of the CollectionGrid, so
     // for every entry other than the first entry, we need to add the sum of all of
@@ -309,6 +444,71 @@ void CollectionGrid::updateOffsets() const {
       mElementOffsets[ arrayIndex ] += mElementOffsets[ arrayIndex - 1 ];
     }
   }
+
+  // Fill the element table by walking each grid in turn.
+  mElementTable.clear();
+  if ( mUseElementTable && ! mElementOffsets.empty() ) {
+    mElementTable.reserve( mElementOffsets.back() );
+    std::size_t first = 0;
+    for ( std::size_t gridIndex = 0; gridIndex < mElementOffsets.size(); ++gridIndex ) {
+      for ( std::size_t local = 0; local < mElementOffsets[ gridIndex ] - first; ++local ) {
+        mElementTable.push_back( std::make_pair( gridIndex, local ) );
+      }
+      first = mElementOffsets[ gridIndex ];
+    }
+  }
+
+  mOffsetsValid = true;
+}
+
+//--------------------------------------------------------------------------------------------------
+CollectionGrid::ElementCursor::ElementCursor( const CollectionGrid& grid ) :
+  mGrid( grid ),
+  mGridIndex( 0 ),
+  mLocalIndex( 0 ),
+  mLocalCount( 0 ),
+  mIndex( 0 ),
+  mElementIndices( 0 ),
+  mFaceEdgeIndices( 0 ) {
+
+  mGrid.numberOfElements();
+  enterGrid();
+}
+
+Element CollectionGrid::ElementCursor::element() const {
+  assert( valid() );
+  std::size_t element = mElementIndices ? mElementIndices[ mLocalIndex ] : mLocalIndex;
+  std::size_t faceEdgeIndex = mFaceEdgeIndices ? mFaceEdgeIndices[ mLocalIndex ] : 0;
+  return mGrid.referencedElement( mGridIndex, element, faceEdgeIndex );
+}
+
+void CollectionGrid::ElementCursor::next() {
+  assert( valid() );
+  ++mIndex;
+  if ( ++mLocalIndex == mLocalCount ) {
+    ++mGridIndex;
+    mLocalIndex = 0;
+    enterGrid();
+  }
+}
+
+// Skip grids that reference no elements, then look up the index arrays of the
+// grid the cursor arrived at.
+void CollectionGrid::ElementCursor::enterGrid() {
+  for ( ; valid(); ++mGridIndex ) {
+    std::size_t first = ( mGridIndex > 0 ) ? mGrid.mElementOffsets[ mGridIndex - 1 ] : 0;
+    mLocalCount = mGrid.mElementOffsets[ mGridIndex ] - first;
+    if ( mLocalCount > 0 ) {
+      break;
+    }
+  }
+  if ( ! valid() ) {
+    return;
+  }
+  mElementIndices = mGrid.mElementIndices[ mGridIndex ] ?
+    mGrid.elementIndexArray( mGridIndex ) : 0;
+  mFaceEdgeIndices = mGrid.mFaceEdgeIndices[ mGridIndex ] ?
+    mGrid.faceEdgeIndexArray( mGridIndex ) : 0;
 }
 
 } // namespace xdmGrid
@@ -112,14 +112,83 @@ public:
     xdm::primitiveType::Value dataType );
 
   /// Since the CollectionGrid can contain subsets of many different topologies,
-  /// this function returns the total number of referenced elements. This is an
-  /// expensive call because it recomputes the total number of elements at each
-  /// function call.
+  /// this function returns the total number of referenced elements. The cached
+  /// number of elements referenced from each grid is checked against the
+  /// referenced grids and index arrays on every call and rebuilt if any of them
+  /// changed size, so the count is always current.
   virtual std::size_t numberOfElements() const;
 
   /// Get an element by index. All elements are const in that they only have const functions.
+  /// This searches for the referenced grid containing the element unless the element table
+  /// is enabled. Use ElementCursor to visit every element in order without searching.
   virtual Element element( const std::size_t& elementIndex ) const;
 
+  /// Discard the cached number of elements referenced from each grid. Appending a grid
+  /// does this automatically, and numberOfElements(), partitionElementBlocks(), and
+  /// ElementCursor rebuild the cache when a referenced grid or index array changed size.
+  /// Only element() trusts the cache, to keep lookups cheap; call this or
+  /// numberOfElements() after changing a referenced grid and before looking up elements.
+  void invalidateOffsets();
+
+  /// Enable or disable a table mapping every element index of the collection directly to
+  /// the referenced grid and the index within it. This makes element() constant time at a
+  /// cost of two std::size_t per element, and is worthwhile for random access into
+  /// collections of many grids. The table is built the first time it is needed.
+  void setUseElementTable( bool useElementTable );
+  /// Determine whether element lookups use the element table.
+  bool useElementTable() const;
+
+  /// Sequential access to the elements of a CollectionGrid in index order. The cursor
+  /// walks the referenced grids one after another, so no search is needed per element, and
+  /// it reads the index arrays of each grid through plain pointers.
+  ///
+  /// @code
+  /// for ( CollectionGrid::ElementCursor c( grid ); c.valid(); c.next() ) {
+  ///   Element e = c.element();
+  /// }
+  /// @endcode
+  class ElementCursor {
+  public:
+    explicit ElementCursor( const CollectionGrid& grid );
+
+    /// Determine if the cursor refers to an element or has passed the last one.
+    bool valid() const { return mGridIndex < mGrid.mGrids.size(); }
+
+    /// Get the index of the current element in the collection.
+    std::size_t index() const { return mIndex; }
+
+    /// Get the current element.
+    Element element() const;
+
+    /// Advance to the next element.
+    void next();
+
+  private:
+    void enterGrid();
+
+    const CollectionGrid& mGrid;
+    std::size_t mGridIndex;
+    std::size_t mLocalIndex;
+    std::size_t mLocalCount;
+    std::size_t mIndex;
+    const std::size_t* mElementIndices;
+    const std::size_t* mFaceEdgeIndices;
+  };
+
+  /// Redefinition from Grid that partitions each referenced grid separately so
+  /// that no block spans more than one of them. The cached number of elements
+  /// referenced from each grid is rebuilt if it no longer matches the grids.
+  virtual void partitionElementBlocks(
+    std::size_t maximumBlockSize,
+    std::vector< ElementBlockRange >& ranges ) const;
+
+  /// Redefinition from Grid that delegates to the referenced grid when whole
+  /// elements are referenced.
+  virtual void fillElementBlock(
+    std::size_t firstElement,
+    std::size_t count,
+    ElementBlock& block ) const;
+
   /// Definition of visitor traversal.
   virtual void traverse( xdm::ItemVisitor& iv );
 
@@ -157,6 +226,11 @@ private:
   // 2 elements from the 3rd grid, then we have:
   //   mElementOffsets == { 3, 8, 10 }
   mutable std::vector< std::size_t > mElementOffsets;
+  mutable bool mOffsetsValid;
+
+  // When enabled, mElementTable holds the result of findGrid for every element.
+  bool mUseElementTable;
+  mutable std::vector< std::pair< std::size_t, std::size_t > > mElementTable;
 
   // For each grid in mGrids, mReferenceTypes indicates whether we are accessing elements,
   // faces, or edges on the elements in that grid. This allows the use of heterogeneous
@@ -167,6 +241,15 @@ private:
   std::vector< ReferenceType > mReferenceTypes;
 
   std::pair< std::size_t, std::size_t > findGrid( const std::size_t& elementIndex ) const;
+  const std::size_t* elementIndexArray( std::size_t gridIndex ) const;
+  const std::size_t* faceEdgeIndexArray( std::size_t gridIndex ) const;
+  void loadIndexArrays( std::size_t gridIndex ) const;
+  std::size_t referencedElementCount( std::size_t gridIndex ) const;
+  bool offsetsAreCurrent() const;
+  Element referencedElement(
+    std::size_t gridIndex,
+    std::size_t element,
+    std::size_t faceEdgeIndex ) const;
   void updateOffsets() const;
 };
 
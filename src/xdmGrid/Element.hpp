@@ -72,6 +72,16 @@ public:
     return mConnectivity->geometry( mIndex ).node( nodeIndexInGeometry( nodeIndex ) );
   }
 
+  /// Get the topology of this element.
+  xdm::RefPtr< const ElementTopology > elementTopology() const {
+    return mTopo;
+  }
+
+  /// Get the geometry that the nodes of this element refer to.
+  const Geometry& geometry() const {
+    return mConnectivity->geometry( mIndex );
+  }
+
   /// Get the type of shape.
   ElementShape::Type shape() const {
     return mTopo->shape();
@@ -0,0 +1,87 @@
+//==============================================================================
+// This software developed by Stellar Science Ltd Co and the U.S. Government.
+// Copyright (C) 2010 Stellar Science. Government-purpose rights granted.
+//
+// This file is part of XDM
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+#include <xdmGrid/ElementBlock.hpp>
+
+#include <xdmGrid/Geometry.hpp>
+
+#include <algorithm>
+
+namespace xdmGrid {
+
+ElementBlock::ElementBlock() :
+  mTopology(),
+  mGeometry( 0 ),
+  mFirstElement( 0 ),
+  mNumberOfElements( 0 ),
+  mNodesPerElement( 0 ),
+  mDimension( 0 ),
+  mConnectivity(),
+  mCoordinates() {
+}
+
+ElementBlock::~ElementBlock() {
+}
+
+void ElementBlock::reset(
+  xdm::RefPtr< const ElementTopology > topology,
+  const Geometry& geometry,
+  std::size_t firstElement,
+  std::size_t numberOfElements ) {
+
+  mTopology = topology;
+  mGeometry = &geometry;
+  mFirstElement = firstElement;
+  mNumberOfElements = numberOfElements;
+  mNodesPerElement = topology->numberOfNodes();
+  mDimension = geometry.dimension();
+  mConnectivity.resize( mNumberOfElements * mNodesPerElement );
+  mCoordinates.resize( mConnectivity.size() * mDimension );
+}
+
+void ElementBlock::gatherCoordinates() {
+  if ( ! mConnectivity.empty() ) {
+    mGeometry->gatherNodes( &mConnectivity[0], mConnectivity.size(), &mCoordinates[0] );
+  }
+}
+
+void ElementBlock::applyLocalNodeOrder() {
+  bool isIdentity = true;
+  for ( std::size_t i = 0; i < mNodesPerElement; ++i ) {
+    isIdentity = isIdentity && ( mTopology->node( i ) == i );
+  }
+  if ( isIdentity ) {
+    return;
+  }
+
+  std::vector< std::size_t > element( mNodesPerElement );
+  for ( std::size_t e = 0; e < mNumberOfElements; ++e ) {
+    std::size_t* connections = &mConnectivity[ e * mNodesPerElement ];
+    std::copy( connections, connections + mNodesPerElement, element.begin() );
+    for ( std::size_t i = 0; i < mNodesPerElement; ++i ) {
+      connections[i] = element[ mTopology->node( i ) ];
+    }
+  }
+}
+
+ElementBlockVisitor::~ElementBlockVisitor() {
+}
+
+} // namespace xdmGrid
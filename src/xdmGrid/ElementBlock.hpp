@@ -0,0 +1,146 @@
+//==============================================================================
+// This software developed by Stellar Science Ltd Co and the U.S. Government.
+// Copyright (C) 2010 Stellar Science. Government-purpose rights granted.
+//
+// This file is part of XDM
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+#ifndef xdmGrid_ElementBlock_hpp
+#define xdmGrid_ElementBlock_hpp
+
+#include <xdmGrid/ElementTopology.hpp>
+#include <xdmGrid/Forward.hpp>
+
+#include <xdm/RefPtr.hpp>
+
+#include <utility>
+#include <vector>
+
+#include <cassert>
+
+
+
+namespace xdmGrid {
+
+/// A range of elements [first, first + count) in the element numbering of a
+/// Grid.
+typedef std::pair< std::size_t, std::size_t > ElementBlockRange;
+
+/// A block of consecutive elements from a Grid that all share the same
+/// ElementTopology and Geometry. The block holds the global node indices of
+/// every element and the coordinates of those nodes in two contiguous arrays,
+/// so that whole-mesh algorithms can work on many elements at once instead of
+/// constructing an Element and resolving each node individually.
+///
+/// The connectivity array holds nodesPerElement() node indices per element,
+/// in the local node order of the element topology. The coordinate array holds
+/// dimension() values per entry of the connectivity array, interlaced.
+class ElementBlock {
+public:
+  ElementBlock();
+  ~ElementBlock();
+
+  /// Prepare the block to hold a number of elements of a single type. This
+  /// resizes the internal storage, reusing memory held from previous blocks.
+  /// @param topology The topology shared by all of the elements in the block.
+  /// @param geometry The geometry that the node indices refer to.
+  /// @param firstElement The index of the first element in the visited Grid.
+  /// @param numberOfElements The number of elements in the block.
+  void reset(
+    xdm::RefPtr< const ElementTopology > topology,
+    const Geometry& geometry,
+    std::size_t firstElement,
+    std::size_t numberOfElements );
+
+  /// Fill the coordinate array from the geometry using the connectivity array.
+  void gatherCoordinates();
+
+  /// Reorder the node indices of every element by the local node map of the
+  /// element topology (see ElementTopology::node()). Grid implementations that
+  /// copy raw Topology connectivity into the block call this before
+  /// gatherCoordinates() so that the block matches Element::nodeIndexInGeometry.
+  void applyLocalNodeOrder();
+
+  /// Set the index of the first element of the block in the visited Grid.
+  void setFirstElement( std::size_t firstElement ) { mFirstElement = firstElement; }
+
+  /// Get the topology shared by all of the elements in the block.
+  xdm::RefPtr< const ElementTopology > elementTopology() const { return mTopology; }
+
+  /// Get the geometry that the node indices refer to.
+  const Geometry& geometry() const { assert( mGeometry ); return *mGeometry; }
+
+  /// Get the index of the first element of the block in the visited Grid.
+  std::size_t firstElement() const { return mFirstElement; }
+
+  /// Get the number of elements in the block.
+  std::size_t numberOfElements() const { return mNumberOfElements; }
+
+  /// Get the number of nodes on each element.
+  std::size_t nodesPerElement() const { return mNodesPerElement; }
+
+  /// Get the number of coordinate values per node.
+  unsigned int dimension() const { return mDimension; }
+
+  /// Get the global node indices of every element in the block.
+  const std::size_t* connectivity() const { return mConnectivity.empty() ? 0 : &mConnectivity[0]; }
+  /// Get the mutable node indices. Intended for use by Grid implementations.
+  std::size_t* connectivity() { return mConnectivity.empty() ? 0 : &mConnectivity[0]; }
+
+  /// Get the node coordinates for every node of every element in the block.
+  const double* coordinates() const { return mCoordinates.empty() ? 0 : &mCoordinates[0]; }
+
+  /// Get the global node indices for a single element in the block.
+  /// @param element The index of the element relative to the block.
+  const std::size_t* elementConnectivity( std::size_t element ) const {
+    assert( element < mNumberOfElements );
+    return &mConnectivity[ element * mNodesPerElement ];
+  }
+
+  /// Get the coordinates of a node on an element in the block.
+  /// @param element The index of the element relative to the block.
+  /// @param localNode The local index of the node on the element.
+  const double* nodeCoordinates( std::size_t element, std::size_t localNode ) const {
+    assert( element < mNumberOfElements && localNode < mNodesPerElement );
+    return &mCoordinates[ ( element * mNodesPerElement + localNode ) * mDimension ];
+  }
+
+private:
+  xdm::RefPtr< const ElementTopology > mTopology;
+  const Geometry* mGeometry;
+  std::size_t mFirstElement;
+  std::size_t mNumberOfElements;
+  std::size_t mNodesPerElement;
+  unsigned int mDimension;
+  std::vector< std::size_t > mConnectivity;
+  std::vector< double > mCoordinates;
+};
+
+/// Interface for operations applied to the ElementBlocks of a Grid.
+/// @see Grid::forEachElementBlock
+class ElementBlockVisitor {
+public:
+  virtual ~ElementBlockVisitor();
+
+  /// Apply the operation to a block of elements. When used with
+  /// Grid::forEachElementBlockParallel, this is called concurrently from
+  /// multiple threads with different blocks.
+  virtual void apply( const ElementBlock& block ) = 0;
+};
+
+} // namespace xdmGrid
+
+#endif // xdmGrid_ElementBlock_hpp
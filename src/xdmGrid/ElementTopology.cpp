@@ -194,35 +194,59 @@ xdm::RefPtr< const ElementTopology > elementFactory(
     std::map< std::size_t,              // order
       xdm::RefPtr< const ElementTopology > > > elementMap;
 
-  xdm::RefPtr< const ElementTopology > element = elementMap[ shape ][ order ];
-
-  if ( ! element ) {
-    switch ( shape ) {
-    case ElementShape::Vertex:
-      element = vertexFactory( order );
-      break;
-    case ElementShape::Curve:
-      element = curveFactory( order );
-      break;
-    case ElementShape::Triangle:
-      element = triangleFactory( order );
-      break;
-    case ElementShape::Quadrilateral:
-      element = quadrilateralFactory( order );
-      break;
-    case ElementShape::Tetrahedron:
-      element = tetrahedronFactory( order );
-      break;
-    case ElementShape::Pyramid:
-      element = pyramidFactory( order );
-      break;
-    case ElementShape::Wedge:
-      element = wedgeFactory( order );
-      break;
-    case ElementShape::Hexahedron:
-      element = hexahedronFactory( order );
-      break;
+  xdm::RefPtr< const ElementTopology > element;
+
+  // Readers may build topologies on several threads, and the map is shared.
+  // Building an element may throw, which must not happen inside a critical
+  // section, so the element is built outside of it and then inserted.
+#ifdef _OPENMP
+  #pragma omp critical( xdmGrid_elementFactory )
+#endif
+  {
+    element = elementMap[ shape ][ order ];
+  }
+  if ( element ) {
+    return element;
+  }
+
+  switch ( shape ) {
+  case ElementShape::Vertex:
+    element = vertexFactory( order );
+    break;
+  case ElementShape::Curve:
+    element = curveFactory( order );
+    break;
+  case ElementShape::Triangle:
+    element = triangleFactory( order );
+    break;
+  case ElementShape::Quadrilateral:
+    element = quadrilateralFactory( order );
+    break;
+  case ElementShape::Tetrahedron:
+    element = tetrahedronFactory( order );
+    break;
+  case ElementShape::Pyramid:
+    element = pyramidFactory( order );
+    break;
+  case ElementShape::Wedge:
+    element = wedgeFactory( order );
+    break;
+  case ElementShape::Hexahedron:
+    element = hexahedronFactory( order );
+    break;
+  }
+
+  // Another thread may have inserted the same element in the meantime, in which
+  // case every caller gets that one.
+#ifdef _OPENMP
+  #pragma omp critical( xdmGrid_elementFactory )
+#endif
+  {
+    xdm::RefPtr< const ElementTopology >& cached = elementMap[ shape ][ order ];
+    if ( ! cached ) {
+      cached = element;
     }
+    element = cached;
   }
 
   return element;
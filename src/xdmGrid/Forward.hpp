@@ -29,6 +29,8 @@ class Attribute;
 class CollectionGrid;
 class Domain;
 class Element;
+class ElementBlock;
+class ElementBlockVisitor;
 class ElementTopology;
 class ElementSharedConnectivityLookup;
 class Geometry;
@@ -77,6 +77,43 @@ Node Geometry::node( std::size_t nodeIndex )
   return Node( mSharedVectorImp, nodeIndex );
 }
 
+void Geometry::prepareConcurrentAccess() const
+{
+  // The constant node accessor creates the shared lookup.
+  node( 0 );
+}
+
+void Geometry::gatherNodes(
+  const std::size_t* nodeIndices,
+  std::size_t count,
+  double* out ) const
+{
+  gatherNodesImplementation( nodeIndices, count, out );
+}
+
+void Geometry::gatherNodes(
+  const std::vector< std::size_t >& nodeIndices,
+  std::vector< double >& out ) const
+{
+  out.resize( nodeIndices.size() * mDimension );
+  if ( ! nodeIndices.empty() ) {
+    gatherNodesImplementation( &nodeIndices[0], nodeIndices.size(), &out[0] );
+  }
+}
+
+void Geometry::gatherNodesImplementation(
+  const std::size_t* nodeIndices,
+  std::size_t count,
+  double* out ) const
+{
+  for ( std::size_t k = 0; k < count; ++k ) {
+    ConstNode n = node( nodeIndices[k] );
+    for ( unsigned int i = 0; i < mDimension; ++i ) {
+      out[ mDimension * k + i ] = n[i];
+    }
+  }
+}
+
 void Geometry::traverse( xdm::ItemVisitor& iv ) {
   std::for_each( begin(), end(), xdm::ApplyVisitor( iv ) );
 }
@@ -29,6 +29,8 @@
 #include <xdm/ObjectCompositionMixin.hpp>
 #include <xdm/VectorRef.hpp>
 
+#include <vector>
+
 
 
 namespace xdmGrid {
@@ -70,6 +72,25 @@ public:
   /// Get a constant shared node by index.
   ConstNode node( std::size_t nodeIndex ) const;
 
+  /// Create the node lookup that is otherwise created on first use. Call this
+  /// before accessing the nodes from several threads at once.
+  virtual void prepareConcurrentAccess() const;
+
+  /// Copy the coordinates of many nodes into an interlaced output array. This
+  /// is the preferred way to access a large number of nodes: the geometry
+  /// representation is resolved once for the whole batch rather than with a
+  /// virtual call for every coordinate value.
+  /// @param nodeIndices The indices of the nodes to gather.
+  /// @param count The number of indices in nodeIndices.
+  /// @param out Output array with room for count * dimension() values.
+  void gatherNodes( const std::size_t* nodeIndices, std::size_t count, double* out ) const;
+
+  /// Copy the coordinates of many nodes into an interlaced output vector. The
+  /// output vector is resized to hold nodeIndices.size() * dimension() values.
+  void gatherNodes(
+    const std::vector< std::size_t >& nodeIndices,
+    std::vector< double >& out ) const;
+
   virtual void traverse( xdm::ItemVisitor& iv );
 
   /// Write geometry metadata.
@@ -87,6 +108,14 @@ protected:
   /// their internal geometry representation.
   virtual xdm::RefPtr< xdm::VectorRefImp< double > > createVectorImp() = 0;
 
+  /// Gather node coordinates for gatherNodes(). The default implementation
+  /// goes through the shared VectorRefImp; subclasses should override this
+  /// method to gather directly from their internal representation.
+  virtual void gatherNodesImplementation(
+    const std::size_t* nodeIndices,
+    std::size_t count,
+    double* out ) const;
+
 private:
   std::size_t mNumberOfNodes;
   unsigned int mDimension;
@@ -19,9 +19,15 @@
 //
 //------------------------------------------------------------------------------
 #include <xdmGrid/Grid.hpp>
+#include <xdmGrid/Element.hpp>
 #include <xdmGrid/Time.hpp>
 
+#include <xdm/ParallelErrorCapture.hpp>
+
 #include <algorithm>
+#include <string>
+
+#include <cassert>
 
 namespace xdmGrid {
 
@@ -81,6 +87,148 @@ std::size_t Grid::numberOfAttributes() const {
   return mAttributes.size();
 }
 
+const std::size_t Grid::kDefaultElementBlockSize;
+
+void Grid::forEachElementBlock(
+  ElementBlockVisitor& visitor,
+  std::size_t maximumBlockSize ) const {
+
+  std::vector< ElementBlockRange > ranges;
+  partitionElementBlocks( maximumBlockSize, ranges );
+
+  ElementBlock block;
+  for ( std::size_t i = 0; i < ranges.size(); ++i ) {
+    fillElementBlock( ranges[i].first, ranges[i].second, block );
+    visitor.apply( block );
+  }
+}
+
+void Grid::forEachElementBlockParallel(
+  ElementBlockVisitor& visitor,
+  std::size_t maximumBlockSize ) const {
+
+#ifdef _OPENMP
+  // Partitioning is done up front on a single thread. This also resolves any
+  // lazily loaded data so that filling blocks only reads shared state.
+  std::vector< ElementBlockRange > ranges;
+  partitionElementBlocks( maximumBlockSize, ranges );
+
+  // Exceptions may not propagate out of an OpenMP region. Record the first one
+  // and rethrow it once all threads have joined.
+  xdm::ParallelErrorCapture error;
+  long numberOfRanges = static_cast< long >( ranges.size() );
+  #pragma omp parallel
+  {
+    ElementBlock block;
+    #pragma omp for schedule( dynamic )
+    for ( long i = 0; i < numberOfRanges; ++i ) {
+      try {
+        fillElementBlock( ranges[i].first, ranges[i].second, block );
+        visitor.apply( block );
+      } catch ( ... ) {
+        error.capture();
+      }
+    }
+  }
+  error.rethrow();
+#else
+  forEachElementBlock( visitor, maximumBlockSize );
+#endif
+}
+
+void Grid::partitionElementBlocks(
+  std::size_t maximumBlockSize,
+  std::vector< ElementBlockRange >& ranges ) const {
+
+  partitionElementRange( 0, numberOfElements(), maximumBlockSize, ranges );
+}
+
+void Grid::partitionIndexedElementBlocks(
+  const std::size_t* elementIndices,
+  std::size_t count,
+  std::size_t maximumBlockSize,
+  std::vector< ElementBlockRange >& ranges ) const {
+
+  assert( maximumBlockSize > 0 );
+  std::size_t first = 0;
+  xdm::RefPtr< const ElementTopology > topology;
+  const Geometry* geometry = 0;
+  for ( std::size_t k = 0; k < count; ++k ) {
+    Element e = element( elementIndices[k] );
+    if ( k > first && ( k - first == maximumBlockSize
+      || e.elementTopology() != topology || &e.geometry() != geometry ) ) {
+      ranges.push_back( ElementBlockRange( first, k - first ) );
+      first = k;
+    }
+    topology = e.elementTopology();
+    geometry = &e.geometry();
+  }
+  if ( count > first ) {
+    ranges.push_back( ElementBlockRange( first, count - first ) );
+  }
+}
+
+void Grid::fillElementBlock(
+  std::size_t firstElement,
+  std::size_t count,
+  ElementBlock& block ) const {
+
+  assert( count > 0 );
+  Element first = element( firstElement );
+  block.reset( first.elementTopology(), first.geometry(), firstElement, count );
+  std::size_t* connections = block.connectivity();
+  for ( std::size_t k = 0; k < count; ++k ) {
+    Element e = element( firstElement + k );
+    for ( std::size_t i = 0; i < block.nodesPerElement(); ++i ) {
+      *connections++ = e.nodeIndexInGeometry( i );
+    }
+  }
+  block.gatherCoordinates();
+}
+
+void Grid::fillIndexedElementBlock(
+  const std::size_t* elementIndices,
+  std::size_t count,
+  ElementBlock& block ) const {
+
+  assert( count > 0 );
+  Element first = element( elementIndices[0] );
+  block.reset( first.elementTopology(), first.geometry(), 0, count );
+  std::size_t* connections = block.connectivity();
+  for ( std::size_t k = 0; k < count; ++k ) {
+    Element e = element( elementIndices[k] );
+    for ( std::size_t i = 0; i < block.nodesPerElement(); ++i ) {
+      *connections++ = e.nodeIndexInGeometry( i );
+    }
+  }
+  block.gatherCoordinates();
+}
+
+void Grid::partitionElementRange(
+  std::size_t firstElement,
+  std::size_t endElement,
+  std::size_t maximumBlockSize,
+  std::vector< ElementBlockRange >& ranges ) const {
+
+  assert( maximumBlockSize > 0 );
+  std::size_t first = firstElement;
+  xdm::RefPtr< const ElementTopology > topology;
+  const Geometry* geometry = 0;
+  for ( std::size_t elementIndex = firstElement; elementIndex < endElement; ++elementIndex ) {
+    Element e = element( elementIndex );
+    if ( elementIndex > first && ( elementIndex - first == maximumBlockSize
+      || e.elementTopology() != topology || &e.geometry() != geometry ) ) {
+      ranges.push_back( ElementBlockRange( first, elementIndex - first ) );
+      first = elementIndex;
+    }
+    topology = e.elementTopology();
+    geometry = &e.geometry();
+  }
+  if ( endElement > first ) {
+    ranges.push_back( ElementBlockRange( first, endElement - first ) );
+  }
+}
+
 void Grid::traverse( xdm::ItemVisitor& iv ) {
   if ( mTime.valid() ) {
     mTime->accept( iv );
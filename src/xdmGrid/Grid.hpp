@@ -22,6 +22,7 @@
 #define xdm_Grid_hpp
 
 #include <xdmGrid/Attribute.hpp>
+#include <xdmGrid/ElementBlock.hpp>
 #include <xdmGrid/Forward.hpp>
 
 #include <xdm/Forward.hpp>
@@ -122,11 +123,76 @@ public:
   /// Get an element by index. All elements are const in that they only have const functions.
   virtual Element element( const std::size_t& elementIndex ) const = 0;
 
+  /// The default maximum number of elements in an ElementBlock.
+  static const std::size_t kDefaultElementBlockSize = 1024;
+
+  /// Apply a visitor to every element of the grid, a block of elements at a
+  /// time. This is the preferred way to run whole-mesh algorithms: the blocks
+  /// provide the connectivity and node coordinates of many elements in
+  /// contiguous arrays, so there is no per element or per node virtual call.
+  /// The blocks are visited in element order.
+  /// @param visitor The operation to apply to each block.
+  /// @param maximumBlockSize The maximum number of elements in each block.
+  void forEachElementBlock(
+    ElementBlockVisitor& visitor,
+    std::size_t maximumBlockSize = kDefaultElementBlockSize ) const;
+
+  /// Apply a visitor to every element of the grid, a block of elements at a
+  /// time, distributing the blocks across threads. The visitor must be safe to
+  /// call concurrently, and the blocks are visited in no particular order.
+  /// Without OpenMP support (XDM_OPENMP), this is the same as
+  /// forEachElementBlock. If filling or visiting a block throws, the first
+  /// exception is thrown again once every thread has finished.
+  void forEachElementBlockParallel(
+    ElementBlockVisitor& visitor,
+    std::size_t maximumBlockSize = kDefaultElementBlockSize ) const;
+
+  /// Divide the elements of the grid into ranges that can be filled as
+  /// ElementBlocks, and append them to a list. All of the elements in a range
+  /// share an ElementTopology and Geometry. Implementations must also resolve
+  /// any lazily loaded state needed by fillElementBlock, because blocks may be
+  /// filled concurrently. The default implementation inspects every element.
+  virtual void partitionElementBlocks(
+    std::size_t maximumBlockSize,
+    std::vector< ElementBlockRange >& ranges ) const;
+
+  /// Divide a list of element indices into ranges of the list that can be
+  /// filled with fillIndexedElementBlock, and append them to a list.
+  virtual void partitionIndexedElementBlocks(
+    const std::size_t* elementIndices,
+    std::size_t count,
+    std::size_t maximumBlockSize,
+    std::vector< ElementBlockRange >& ranges ) const;
+
+  /// Fill an ElementBlock with a range of elements from a partition of the
+  /// grid. The default implementation goes through element().
+  virtual void fillElementBlock(
+    std::size_t firstElement,
+    std::size_t count,
+    ElementBlock& block ) const;
+
+  /// Fill an ElementBlock with a list of elements from a range produced by
+  /// partitionIndexedElementBlocks. The first element of the block is set to 0;
+  /// callers are responsible for setting it in their own element numbering.
+  virtual void fillIndexedElementBlock(
+    const std::size_t* elementIndices,
+    std::size_t count,
+    ElementBlock& block ) const;
+
   virtual void traverse( xdm::ItemVisitor& iv );
 
   /// Write grid metadata.
   virtual void writeMetadata( xdm::XmlMetadataWrapper& xml );
 
+protected:
+  /// Partition the elements [firstElement, endElement) by inspecting each
+  /// element, splitting wherever the ElementTopology or Geometry changes.
+  void partitionElementRange(
+    std::size_t firstElement,
+    std::size_t endElement,
+    std::size_t maximumBlockSize,
+    std::vector< ElementBlockRange >& ranges ) const;
+
 public:
   std::vector< xdm::RefPtr< Attribute > > mAttributes;
   xdm::RefPtr< Time > mTime;
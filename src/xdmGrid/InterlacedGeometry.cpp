@@ -45,6 +45,12 @@ void InterlacedGeometry::setCoordinateValues( xdm::RefPtr< xdm::UniformDataItem
   setChild( 0, data );
 }
 
+xdm::InterlacedVectorSpan< const double > InterlacedGeometry::nodeSpan() const {
+  return xdm::InterlacedVectorSpan< const double >(
+    child( 0 )->typedArray< double >()->begin(),
+    dimension() );
+}
+
 void InterlacedGeometry::writeMetadata( xdm::XmlMetadataWrapper& xml ) {
   Geometry::writeMetadata( xml );
 
@@ -73,6 +79,14 @@ xdm::RefPtr< xdm::VectorRefImp< double > > InterlacedGeometry::createVectorImp()
       dimension() ) );
 }
 
+void InterlacedGeometry::gatherNodesImplementation(
+  const std::size_t* nodeIndices,
+  std::size_t count,
+  double* out ) const
+{
+  nodeSpan().gather( nodeIndices, count, out );
+}
+
 void InterlacedGeometry::updateDimension() {
   // do nothing.
 }
@@ -25,6 +25,7 @@
 
 #include <xdm/UniformDataItem.hpp>
 #include <xdm/VectorRef.hpp>
+#include <xdm/VectorSpan.hpp>
 #include <xdm/RefPtr.hpp>
 
 
@@ -53,11 +54,20 @@ public:
   /// @throws std::logic_error if called after coordinate values have already been set.
   void setCoordinateValues( xdm::RefPtr< xdm::UniformDataItem > data );
 
+  /// Get a non-virtual view of the node coordinates for use in loops over many
+  /// nodes. The span refers to the current coordinate array and should be
+  /// obtained again if the coordinate data is reallocated.
+  xdm::InterlacedVectorSpan< const double > nodeSpan() const;
+
   virtual void writeMetadata( xdm::XmlMetadataWrapper& xml );
 
 protected:
   virtual void updateDimension();
   virtual xdm::RefPtr< xdm::VectorRefImp< double > > createVectorImp();
+  virtual void gatherNodesImplementation(
+    const std::size_t* nodeIndices,
+    std::size_t count,
+    double* out ) const;
 
 };
 
@@ -75,6 +75,14 @@ void MultiArrayGeometry::setCoordinateValues(
   }
 }
 
+xdm::MultipleArrayVectorSpan< const double > MultiArrayGeometry::nodeSpan() const {
+  std::vector< const double* > arrays( dimension() );
+  for ( std::size_t dim = 0; dim < dimension(); dim++ ) {
+    arrays[dim] = child( dim )->typedArray< double >()->begin();
+  }
+  return xdm::MultipleArrayVectorSpan< const double >( arrays );
+}
+
 void MultiArrayGeometry::writeMetadata( xdm::XmlMetadataWrapper& xml ) {
   Geometry::writeMetadata( xml );
 
@@ -105,6 +113,14 @@ xdm::RefPtr< xdm::VectorRefImp< double > > MultiArrayGeometry::createVectorImp()
     new xdm::MultipleArraysOfVectorElementsImp< double >( arrays ) );
 }
 
+void MultiArrayGeometry::gatherNodesImplementation(
+  const std::size_t* nodeIndices,
+  std::size_t count,
+  double* out ) const
+{
+  nodeSpan().gather( nodeIndices, count, out );
+}
+
 void MultiArrayGeometry::updateDimension() {
   setNumberOfChildren( dimension() );
 }
@@ -25,6 +25,7 @@
 
 #include <xdm/UniformDataItem.hpp>
 #include <xdm/VectorRef.hpp>
+#include <xdm/VectorSpan.hpp>
 #include <xdm/RefPtr.hpp>
 
 
@@ -58,11 +59,21 @@ public:
   /// @throws std::runtime_error if the arrays are not all the same size.
   void setCoordinateValues( unsigned int dim, xdm::RefPtr< xdm::UniformDataItem > data );
 
+  /// Get a non-virtual view of the node coordinates for use in loops over many
+  /// nodes. The span refers to the current coordinate arrays and should be
+  /// obtained again if the coordinate data is reallocated.
+  /// @throws std::length_error if the geometry has more than four dimensions.
+  xdm::MultipleArrayVectorSpan< const double > nodeSpan() const;
+
   virtual void writeMetadata( xdm::XmlMetadataWrapper& xml );
 
 protected:
   virtual void updateDimension();
   virtual xdm::RefPtr< xdm::VectorRefImp< double > > createVectorImp();
+  virtual void gatherNodesImplementation(
+    const std::size_t* nodeIndices,
+    std::size_t count,
+    double* out ) const;
 
 };
 
@@ -29,70 +29,42 @@
 
 #include <xdm/ThrowMacro.hpp>
 
-namespace xdmGrid {
-
-StructuredTopologyVectorRefImpFactory::StructuredTopologyVectorRefImpFactory(
-  StructuredTopology& topology ) :
-  mTopology( topology ) 
-{
+#include <cassert>
+
+namespace {
+
+// Write the connectivity of consecutive elements along a row in x. Within a
+// row, the first node of each element is one more than that of the previous
+// element. The number of nodes N is fixed at compile time so that the inner
+// loop is unrolled and the outer loop can be vectorized.
+template< std::size_t N >
+std::size_t* fillRow(
+  std::size_t firstNode,
+  std::size_t count,
+  const std::size_t* offsets,
+  std::size_t* out ) {
+
+  for ( std::size_t k = 0; k < count; ++k ) {
+    for ( std::size_t i = 0; i < N; ++i ) {
+      out[ N * k + i ] = firstNode + k + offsets[i];
+    }
+  }
+  return out + N * count;
 }
 
-StructuredTopologyVectorRefImpFactory::~StructuredTopologyVectorRefImpFactory()
-{
-}
+} // anon namespace
 
-xdm::RefPtr< xdm::VectorRefImp< std::size_t > > 
-StructuredTopologyVectorRefImpFactory::createVectorRefImp()
-{
-  mTopology.mNodes.clear();
-  switch( mTopology.mShape.rank() ) {
-    case 2:
-      for ( std::size_t y = 0; y < mTopology.mShape[1]; ++y ) {
-        for ( std::size_t x = 0; x < mTopology.mShape[0]; ++x ) {
-          std::size_t xNodes = mTopology.mShape[0] + 1;
-          mTopology.mNodes.push_back( ( x + 0 ) + ( y + 0 ) * xNodes );
-          mTopology.mNodes.push_back( ( x + 1 ) + ( y + 0 ) * xNodes );
-          mTopology.mNodes.push_back( ( x + 1 ) + ( y + 1 ) * xNodes );
-          mTopology.mNodes.push_back( ( x + 0 ) + ( y + 1 ) * xNodes );
-        }
-      }
-      break;
-    case 3:
-      for ( std::size_t z = 0; z < mTopology.mShape[2]; ++z ) {
-        for ( std::size_t y = 0; y < mTopology.mShape[1]; ++y ) {
-          for ( std::size_t x = 0; x < mTopology.mShape[0]; ++x ) {
-            std::size_t xNodes = mTopology.mShape[0] + 1;
-            std::size_t yNodes = mTopology.mShape[1] + 1;
-            mTopology.mNodes.push_back( ( x + 0 ) + ( y + 0 ) * xNodes + ( z + 0 ) * xNodes * yNodes );
-            mTopology.mNodes.push_back( ( x + 1 ) + ( y + 0 ) * xNodes + ( z + 0 ) * xNodes * yNodes );
-            mTopology.mNodes.push_back( ( x + 1 ) + ( y + 1 ) * xNodes + ( z + 0 ) * xNodes * yNodes );
-            mTopology.mNodes.push_back( ( x + 0 ) + ( y + 1 ) * xNodes + ( z + 0 ) * xNodes * yNodes );
-            mTopology.mNodes.push_back( ( x + 0 ) + ( y + 0 ) * xNodes + ( z + 1 ) * xNodes * yNodes );
-            mTopology.mNodes.push_back( ( x + 1 ) + ( y + 0 ) * xNodes + ( z + 1 ) * xNodes * yNodes );
-            mTopology.mNodes.push_back( ( x + 1 ) + ( y + 1 ) * xNodes + ( z + 1 ) * xNodes * yNodes );
-            mTopology.mNodes.push_back( ( x + 0 ) + ( y + 1 ) * xNodes + ( z + 1 ) * xNodes * yNodes );
-          }
-        }
-      }
-      break;
-    default:
-      std::stringstream ss;
-      ss << "The rank of the DataShape represents an unknown structured mesh topology (something"
-        " other than 2D or 3D). The rank was " << mTopology.mShape.rank();
-      XDM_THROW( std::runtime_error( ss.str() ) );
-  }
-
-  return xdm::RefPtr< xdm::VectorRefImp< std::size_t > >(
-    new xdm::SingleArrayOfVectorsImp< std::size_t >( 
-      &mTopology.mNodes[0], 
-      mTopology.mElementTopology->numberOfNodes() ) );
-}
+namespace xdmGrid {
 
 // -------------------------------------------------------------------------------------------------
+const std::size_t StructuredTopology::kMaximumNodes;
+
 StructuredTopology::StructuredTopology() :
-  Topology( xdm::makeRefPtr( new StructuredTopologyVectorRefImpFactory( *this ) ) ),
+  Topology( xdm::RefPtr< xdm::VectorRefImpFactory< std::size_t > >() ),
   mShape(),
   mElementTopology() {
+  std::fill( mNodeStrides, mNodeStrides + 2, 0 );
+  std::fill( mNodeOffsets, mNodeOffsets + kMaximumNodes, 0 );
 }
 
 StructuredTopology::~StructuredTopology() {
@@ -105,7 +77,7 @@ NodeOrderingConvention::Type StructuredTopology::nodeOrdering() const {
 void StructuredTopology::setShape( const xdm::DataShape<>& shape ) {
   mShape = shape;
   setNumberOfElements(
-    std::accumulate( shape.begin(), shape.end(), 1, std::multiplies< std::size_t>() ) );
+    std::accumulate( shape.begin(), shape.end(), std::size_t( 1 ), std::multiplies< std::size_t>() ) );
   std::size_t rank = mShape.rank();
   switch( rank ) {
     case 2:
@@ -120,6 +92,23 @@ void StructuredTopology::setShape( const xdm::DataShape<>& shape ) {
         " other than 2D or 3D). The rank was " << rank;
       XDM_THROW( std::runtime_error( ss.str() ) );
   }
+
+  // Nodes are numbered with x varying fastest, and there is one more node
+  // than elements in each direction.
+  std::size_t xNodes = mShape[0] + 1;
+  std::size_t yNodes = mShape[1] + 1;
+  mNodeStrides[0] = xNodes;
+  mNodeStrides[1] = xNodes * yNodes;
+
+  // The nodes of a quadrilateral, then the nodes of the opposite face of a
+  // hexahedron.
+  mNodeOffsets[0] = 0;
+  mNodeOffsets[1] = 1;
+  mNodeOffsets[2] = 1 + xNodes;
+  mNodeOffsets[3] = xNodes;
+  for ( std::size_t i = 0; i < 4; ++i ) {
+    mNodeOffsets[ i + 4 ] = mNodeOffsets[i] + mNodeStrides[1];
+  }
 }
 
 const xdm::DataShape<>& StructuredTopology::shape() const {
@@ -132,6 +121,64 @@ xdm::RefPtr< const ElementTopology > StructuredTopology::elementTopology(
   return mElementTopology;
 }
 
+ConstElementConnectivity StructuredTopology::elementConnections(
+  std::size_t elementIndex ) const {
+
+  return copiedElementConnections( elementIndex, mElementTopology->numberOfNodes() );
+}
+
+std::size_t StructuredTopology::connection(
+  std::size_t elementIndex,
+  std::size_t nodeIndex ) const {
+
+  assert( nodeIndex < mElementTopology->numberOfNodes() );
+  return firstNode( elementIndex ) + mNodeOffsets[ nodeIndex ];
+}
+
+void StructuredTopology::gatherConnections(
+  std::size_t firstElement,
+  std::size_t count,
+  std::size_t* out ) const {
+
+  // Work a row at a time. The first node only has to be computed with
+  // divisions where a row starts.
+  std::size_t rowLength = mShape[0];
+  std::size_t element = firstElement;
+  std::size_t end = firstElement + count;
+  while ( element < end ) {
+    std::size_t rowCount = std::min( rowLength - element % rowLength, end - element );
+    if ( mShape.rank() == 2 ) {
+      out = fillRow< 4 >( firstNode( element ), rowCount, mNodeOffsets, out );
+    } else {
+      out = fillRow< 8 >( firstNode( element ), rowCount, mNodeOffsets, out );
+    }
+    element += rowCount;
+  }
+}
+
+void StructuredTopology::gatherIndexedConnections(
+  const std::size_t* elementIndices,
+  std::size_t count,
+  std::size_t* out ) const {
+
+  for ( std::size_t k = 0; k < count; ++k ) {
+    if ( mShape.rank() == 2 ) {
+      out = fillRow< 4 >( firstNode( elementIndices[k] ), 1, mNodeOffsets, out );
+    } else {
+      out = fillRow< 8 >( firstNode( elementIndices[k] ), 1, mNodeOffsets, out );
+    }
+  }
+}
+
+std::size_t StructuredTopology::firstNode( std::size_t elementIndex ) const {
+  assert( elementIndex < numberOfElements() );
+  std::size_t x = elementIndex % mShape[0];
+  std::size_t yz = elementIndex / mShape[0];
+  std::size_t y = yz % mShape[1];
+  std::size_t z = yz / mShape[1];
+  return x + y * mNodeStrides[0] + z * mNodeStrides[1];
+}
+
 void StructuredTopology::writeMetadata( xdm::XmlMetadataWrapper& xml ) {
   Topology::writeMetadata( xml );
 
@@ -32,11 +32,13 @@
 
 namespace xdmGrid {
 
-class StructuredTopologyVectorRefImpFactory;
-
 /// Grid topology for which connectivity is implicit.  Namely, node i is
 /// connected to node i+1.  Examples of structured topologies are grid
 /// topologies in two or three dimensions.
+///
+/// The connectivity is never stored. The node indices of an element are
+/// computed from the element index and the shape, so the topology uses the
+/// same small amount of memory regardless of the number of elements.
 class StructuredTopology : public Topology {
 public:
   StructuredTopology();
@@ -67,27 +69,41 @@ public:
   virtual xdm::RefPtr< const ElementTopology > elementTopology(
     const std::size_t& elementIndex ) const;
 
+  /// Get the connectivity of a single element. The returned vector holds its
+  /// own copy of the node indices of the element, computed when it is created.
+  virtual ConstElementConnectivity elementConnections( std::size_t elementIndex ) const;
+
+  /// Compute the global index of a node on an element.
+  virtual std::size_t connection( std::size_t elementIndex, std::size_t nodeIndex ) const;
+
+  /// Compute the connectivity of a contiguous range of elements. The elements
+  /// are walked in order so that only additions are needed per element.
+  virtual void gatherConnections(
+    std::size_t firstElement,
+    std::size_t count,
+    std::size_t* out ) const;
+
+  /// Compute the connectivity of a list of elements.
+  virtual void gatherIndexedConnections(
+    const std::size_t* elementIndices,
+    std::size_t count,
+    std::size_t* out ) const;
+
   virtual void writeMetadata( xdm::XmlMetadataWrapper& xml );
 
 private:
-  friend class StructuredTopologyVectorRefImpFactory;
-  std::vector< std::size_t > mNodes;
+  // The maximum number of nodes on an element, for a hexahedron.
+  static const std::size_t kMaximumNodes = 8;
+
   xdm::DataShape<> mShape;
   xdm::RefPtr< const ElementTopology > mElementTopology;
-};
+  // The number of nodes along x and the number of nodes in an xy plane.
+  std::size_t mNodeStrides[2];
+  // The index of each node of an element relative to its first node.
+  std::size_t mNodeOffsets[ kMaximumNodes ];
 
-/// Implementation class to define the shared vector reference implementation for 
-/// StructuredTopology.
-class StructuredTopologyVectorRefImpFactory :
-  public xdm::VectorRefImpFactory< std::size_t >
-{
-public:
-  StructuredTopologyVectorRefImpFactory( StructuredTopology& topology );
-  virtual ~StructuredTopologyVectorRefImpFactory();
-  virtual xdm::RefPtr< xdm::VectorRefImp< std::size_t > > createVectorRefImp();
-
-private:
-  StructuredTopology& mTopology;
+  // Get the index of the first node of an element.
+  std::size_t firstNode( std::size_t elementIndex ) const;
 };
 
 } // namespace xdmGrid
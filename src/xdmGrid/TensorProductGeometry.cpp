@@ -69,6 +69,19 @@ std::size_t TensorProductGeometry::numberOfCoordinates( const std::size_t& dim )
   }
 }
 
+xdm::TensorProductVectorEvaluator< const double > TensorProductGeometry::nodeEvaluator() const {
+  std::vector< const double* > coordinateArrays( dimension() );
+  std::vector< std::size_t > coordinateArraySizes( dimension() );
+  for ( std::size_t i = 0; i < dimension(); i++ ) {
+    xdm::RefPtr< const xdm::TypedStructuredArray< double > > axis =
+      child( i )->typedArray< double >();
+    coordinateArrays[i] = axis->begin();
+    coordinateArraySizes[i] = axis->size();
+  }
+  return xdm::TensorProductVectorEvaluator< const double >(
+    coordinateArrays, coordinateArraySizes );
+}
+
 void TensorProductGeometry::writeMetadata( xdm::XmlMetadataWrapper& xml ) {
   Geometry::writeMetadata( xml );
 
@@ -98,6 +111,14 @@ xdm::RefPtr< xdm::VectorRefImp< double > > TensorProductGeometry::createVectorIm
       coordinateArrays, coordinateArraySizes ) );
 }
 
+void TensorProductGeometry::gatherNodesImplementation(
+  const std::size_t* nodeIndices,
+  std::size_t count,
+  double* out ) const
+{
+  nodeEvaluator().gather( nodeIndices, count, out );
+}
+
 void TensorProductGeometry::updateDimension() {
   setNumberOfChildren( dimension() );
 }
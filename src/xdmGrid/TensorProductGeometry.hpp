@@ -24,6 +24,7 @@
 #include <xdmGrid/Geometry.hpp>
 
 #include <xdm/VectorRef.hpp>
+#include <xdm/VectorSpan.hpp>
 #include <xdm/RefPtr.hpp>
 
 
@@ -57,11 +58,21 @@ public:
   /// @param dim The dimension.
   std::size_t numberOfCoordinates( const std::size_t& dim ) const;
 
+  /// Get a non-virtual evaluator for the node coordinates for use in loops over
+  /// many nodes. The evaluator refers to the current axis arrays and should be
+  /// obtained again if the coordinate data is reallocated.
+  /// @throws std::length_error if the geometry has more than four axes.
+  xdm::TensorProductVectorEvaluator< const double > nodeEvaluator() const;
+
   virtual void writeMetadata( xdm::XmlMetadataWrapper& xml );
 
 protected:
   virtual void updateDimension();
   virtual xdm::RefPtr< xdm::VectorRefImp< double > > createVectorImp();
+  virtual void gatherNodesImplementation(
+    const std::size_t* nodeIndices,
+    std::size_t count,
+    double* out ) const;
 
 };
 
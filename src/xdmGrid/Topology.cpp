@@ -21,12 +21,37 @@
 #include <xdmGrid/Topology.hpp>
 
 #include <algorithm>
+#include <vector>
+
+#include <cassert>
 
 namespace xdmGrid {
 
+/// VectorRef implementation holding its own copy of the node indices of a
+/// single Element.
+class CopiedConnectivityImp : public xdm::VectorRefImp< std::size_t > {
+public:
+  CopiedConnectivityImp() : mNodes() {}
+
+  std::vector< std::size_t >& nodes() { return mNodes; }
+
+  virtual const std::size_t& at( std::size_t /* baseIndex */, std::size_t i ) const {
+    assert( i < mNodes.size() );
+    return mNodes[i];
+  }
+
+  virtual std::size_t size() const {
+    return mNodes.size();
+  }
+
+private:
+  std::vector< std::size_t > mNodes;
+};
+
 Topology::Topology(
   xdm::RefPtr< xdm::VectorRefImpFactory< std::size_t > > sharedVectorFactory ) :
   xdm::Item(),
+  mCopiedConnections(),
   mSharedVectorFactory( sharedVectorFactory ),
   mSharedVectorImp(),
   mNumberOfElements( 0 ) {
@@ -50,6 +75,67 @@ ConstElementConnectivity Topology::elementConnections( std::size_t elementIndex
   return ConstElementConnectivity( mSharedVectorImp, elementIndex );
 }
 
+std::size_t Topology::connection( std::size_t elementIndex, std::size_t nodeIndex ) const {
+  return elementConnections( elementIndex )[ nodeIndex ];
+}
+
+void Topology::gatherConnections(
+  std::size_t firstElement,
+  std::size_t count,
+  std::size_t* out ) const {
+
+  for ( std::size_t k = 0; k < count; ++k ) {
+    ConstElementConnectivity connections = elementConnections( firstElement + k );
+    std::size_t nodes = connections.size();
+    for ( std::size_t i = 0; i < nodes; ++i ) {
+      *out++ = connections[i];
+    }
+  }
+}
+
+void Topology::gatherIndexedConnections(
+  const std::size_t* elementIndices,
+  std::size_t count,
+  std::size_t* out ) const {
+
+  for ( std::size_t k = 0; k < count; ++k ) {
+    ConstElementConnectivity connections = elementConnections( elementIndices[k] );
+    std::size_t nodes = connections.size();
+    for ( std::size_t i = 0; i < nodes; ++i ) {
+      *out++ = connections[i];
+    }
+  }
+}
+
+ConstElementConnectivity Topology::copiedElementConnections(
+  std::size_t elementIndex,
+  std::size_t numberOfNodes ) const {
+
+  xdm::RefPtr< CopiedConnectivityImp > imp;
+  // The copy of the previous call may be refilled only if this topology holds
+  // the last reference to it.
+#ifdef _OPENMP
+  #pragma omp critical( xdmGrid_Topology_copiedElementConnections )
+#endif
+  {
+    if ( ! mCopiedConnections || mCopiedConnections->referenceCount() > 1 ) {
+      mCopiedConnections = new CopiedConnectivityImp;
+    }
+    imp = mCopiedConnections;
+  }
+  imp->nodes().resize( numberOfNodes );
+  if ( numberOfNodes > 0 ) {
+    gatherConnections( elementIndex, 1, &imp->nodes()[0] );
+  }
+  return ConstElementConnectivity( imp, 0 );
+}
+
+void Topology::prepareConcurrentAccess() const {
+  if ( ! mSharedVectorImp && mSharedVectorFactory ) {
+    mSharedVectorImp = mSharedVectorFactory->createVectorRefImp();
+  }
+}
+
 void Topology::traverse( xdm::ItemVisitor& iv ) {
   std::for_each( begin(), end(), xdm::ApplyVisitor( iv ) );
 }
@@ -33,6 +33,8 @@
 
 namespace xdmGrid {
 
+class CopiedConnectivityImp;
+
 typedef xdm::VectorRef< std::size_t > ElementConnectivity;
 typedef xdm::ConstVectorRef< std::size_t > ConstElementConnectivity;
 
@@ -58,8 +60,38 @@ public:
   /// Get the number of Elements in the topology.
   virtual std::size_t numberOfElements() const;
 
-  /// Get the const connectivity of a single Element.
-  ConstElementConnectivity elementConnections( std::size_t elementIndex ) const;
+  /// Get the const connectivity of a single Element. The default implementation
+  /// refers to the shared vector implementation created by the factory given
+  /// to the constructor.
+  virtual ConstElementConnectivity elementConnections( std::size_t elementIndex ) const;
+
+  /// Get the global node index of a single node on an Element, by value. The
+  /// default implementation goes through elementConnections(); subclasses
+  /// should override it when their connectivity is not stored as std::size_t.
+  /// @param elementIndex The index of the Element.
+  /// @param nodeIndex The index of the node in the connectivity of the Element.
+  virtual std::size_t connection( std::size_t elementIndex, std::size_t nodeIndex ) const;
+
+  /// Copy the connectivity of a contiguous range of Elements into an output
+  /// array. The Elements are assumed to share a single ElementTopology, and the
+  /// output must have room for count times its number of nodes. The default
+  /// implementation goes through elementConnections(); subclasses should
+  /// override it when they can copy directly from their representation.
+  virtual void gatherConnections(
+    std::size_t firstElement,
+    std::size_t count,
+    std::size_t* out ) const;
+
+  /// Copy the connectivity of a list of Elements into an output array. The
+  /// same requirements as for gatherConnections() apply.
+  virtual void gatherIndexedConnections(
+    const std::size_t* elementIndices,
+    std::size_t count,
+    std::size_t* out ) const;
+
+  /// Create the connectivity lookups that are otherwise created on first use.
+  /// Call this before accessing the connectivity from several threads at once.
+  virtual void prepareConcurrentAccess() const;
 
   /// Get the type of a particular Element.
   virtual xdm::RefPtr< const ElementTopology > elementTopology(
@@ -71,7 +103,17 @@ public:
 
   virtual void writeMetadata( xdm::XmlMetadataWrapper& xml );
 
+protected:
+  /// Get the connectivity of an Element as a copy made with gatherConnections(),
+  /// for topologies that do not store their connectivity as std::size_t. The
+  /// copy is reused by the next call once no caller refers to it, so a loop
+  /// over the Elements does not allocate for each one.
+  ConstElementConnectivity copiedElementConnections(
+    std::size_t elementIndex,
+    std::size_t numberOfNodes ) const;
+
 private:
+  mutable xdm::RefPtr< CopiedConnectivityImp > mCopiedConnections;
   mutable xdm::RefPtr< xdm::VectorRefImpFactory< std::size_t > > mSharedVectorFactory;
   mutable xdm::RefPtr< xdm::VectorRefImp< std::size_t > > mSharedVectorImp;
   std::size_t mNumberOfElements;
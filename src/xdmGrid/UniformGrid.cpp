@@ -47,7 +47,7 @@ public:
     mGeometry( g ), mTopology( t ) {}
 
   virtual std::size_t at( const std::size_t& elementIndex, const std::size_t& nodeIndex ) const {
-    return mTopology->elementConnections( elementIndex )[ nodeIndex ];
+    return mTopology->connection( elementIndex, nodeIndex );
   }
 
   virtual const xdmGrid::Geometry& geometry( const std::size_t& elementIndex ) const {
@@ -211,12 +211,76 @@ ConstNode UniformGrid::node( std::size_t nodeIndex ) const {
   return mGeometry->node( nodeIndex );
 }
 
+void UniformGrid::partitionElementBlocks(
+  std::size_t maximumBlockSize,
+  std::vector< ElementBlockRange >& ranges ) const {
+
+  // A UniformGrid refers to a single Geometry, and every Topology in the
+  // library uses a single ElementTopology, so the only reason to split is the
+  // block size.
+  std::size_t size = numberOfElements();
+  prepareConcurrentAccess();
+  for ( std::size_t first = 0; first < size; first += maximumBlockSize ) {
+    ranges.push_back( ElementBlockRange( first, std::min( maximumBlockSize, size - first ) ) );
+  }
+}
+
+void UniformGrid::partitionIndexedElementBlocks(
+  const std::size_t* elementIndices,
+  std::size_t count,
+  std::size_t maximumBlockSize,
+  std::vector< ElementBlockRange >& ranges ) const {
+
+  const std::size_t size = numberOfElements();
+  for ( std::size_t k = 0; k < count; ++k ) {
+    if ( elementIndices[k] >= size ) {
+      XDM_THROW( std::out_of_range( "Element index out of range for the grid." ) );
+    }
+  }
+  prepareConcurrentAccess();
+  for ( std::size_t first = 0; first < count; first += maximumBlockSize ) {
+    ranges.push_back( ElementBlockRange( first, std::min( maximumBlockSize, count - first ) ) );
+  }
+}
+
+void UniformGrid::fillElementBlock(
+  std::size_t firstElement,
+  std::size_t count,
+  ElementBlock& block ) const {
+
+  block.reset( mTopology->elementTopology( firstElement ), *mGeometry, firstElement, count );
+  mTopology->gatherConnections( firstElement, count, block.connectivity() );
+  block.applyLocalNodeOrder();
+  block.gatherCoordinates();
+}
+
+void UniformGrid::fillIndexedElementBlock(
+  const std::size_t* elementIndices,
+  std::size_t count,
+  ElementBlock& block ) const {
+
+  block.reset( mTopology->elementTopology( elementIndices[0] ), *mGeometry, 0, count );
+  mTopology->gatherIndexedConnections( elementIndices, count, block.connectivity() );
+  block.applyLocalNodeOrder();
+  block.gatherCoordinates();
+}
+
+void UniformGrid::prepareConcurrentAccess() const {
+  mTopology->prepareConcurrentAccess();
+  mGeometry->prepareConcurrentAccess();
+}
+
 void UniformGrid::traverse( xdm::ItemVisitor& iv ) {
   Grid::traverse( iv );
 
-  // apply the visitor to my internal geometry and topology items
-  mTopology->accept( iv );
-  mGeometry->accept( iv );
+  // apply the visitor to my internal geometry and topology items, which a grid that is still
+  // being built may not have yet
+  if ( mTopology.valid() ) {
+    mTopology->accept( iv );
+  }
+  if ( mGeometry.valid() ) {
+    mGeometry->accept( iv );
+  }
 }
 
 void UniformGrid::writeMetadata( xdm::XmlMetadataWrapper& xml ) {
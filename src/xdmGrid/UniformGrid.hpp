@@ -95,6 +95,33 @@ public:
   /// not into the grid with a node order specified by the topology.
   ConstNode node( std::size_t nodeIndex ) const;
 
+  /// Redefinition from Grid that splits the elements into equal sized blocks.
+  virtual void partitionElementBlocks(
+    std::size_t maximumBlockSize,
+    std::vector< ElementBlockRange >& ranges ) const;
+
+  /// Redefinition from Grid that splits the list into equal sized blocks.
+  /// @throws std::out_of_range if an index is not an element of the grid.
+  virtual void partitionIndexedElementBlocks(
+    const std::size_t* elementIndices,
+    std::size_t count,
+    std::size_t maximumBlockSize,
+    std::vector< ElementBlockRange >& ranges ) const;
+
+  /// Redefinition from Grid that copies directly from the Topology and
+  /// Geometry.
+  virtual void fillElementBlock(
+    std::size_t firstElement,
+    std::size_t count,
+    ElementBlock& block ) const;
+
+  /// Redefinition from Grid that copies directly from the Topology and
+  /// Geometry.
+  virtual void fillIndexedElementBlock(
+    const std::size_t* elementIndices,
+    std::size_t count,
+    ElementBlock& block ) const;
+
   /// Redefinition of visitor traversal from xdm::Item.
   virtual void traverse( xdm::ItemVisitor& iv );
 
@@ -102,6 +129,10 @@ public:
   virtual void writeMetadata( xdm::XmlMetadataWrapper& xml );
 
 private:
+  // Build the lazily created lookups of the topology and geometry so that
+  // blocks can be filled from several threads at once.
+  void prepareConcurrentAccess() const;
+
   xdm::RefPtr< Geometry > mGeometry;
   xdm::RefPtr< Topology > mTopology;
   mutable xdm::RefPtr< ElementSharedConnectivityLookup > mElementImp;
@@ -20,7 +20,96 @@
 //------------------------------------------------------------------------------
 #include <xdmGrid/UnstructuredTopology.hpp>
 
+#include <xdm/ThrowMacro.hpp>
+
+#include <algorithm>
 #include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// Check that connectivity values are stored in one of the supported types.
+void checkConnectivityType( xdm::primitiveType::Value type ) {
+  switch ( type ) {
+  case xdm::primitiveType::kInt:
+  case xdm::primitiveType::kUnsignedInt:
+  case xdm::primitiveType::kLongInt:
+  case xdm::primitiveType::kLongUnsignedInt:
+    break;
+  default:
+    XDM_THROW( std::runtime_error( "Connectivity values must be of an integer type." ) );
+    break;
+  }
+}
+
+// Call a function object with a pointer to the connectivity values in the
+// type they are stored in. The function object provides a templated
+// operator() so that each supported type gets its own widening loop.
+template< typename Function >
+void applyToConnectivity( xdm::primitiveType::Value type, const void* values, Function& f ) {
+  switch ( type ) {
+  case xdm::primitiveType::kInt:
+    f( static_cast< const int* >( values ) );
+    break;
+  case xdm::primitiveType::kUnsignedInt:
+    f( static_cast< const unsigned int* >( values ) );
+    break;
+  case xdm::primitiveType::kLongInt:
+    f( static_cast< const long int* >( values ) );
+    break;
+  default:
+    f( static_cast< const long unsigned int* >( values ) );
+    break;
+  }
+}
+
+// Copies a contiguous range of connectivity values.
+struct CopyRange {
+  std::size_t mBegin;
+  std::size_t mSize;
+  std::size_t* mOut;
+  CopyRange( std::size_t begin, std::size_t size, std::size_t* out ) :
+    mBegin( begin ), mSize( size ), mOut( out ) {}
+  template< typename IndexT > void operator()( const IndexT* connections ) {
+    std::copy( connections + mBegin, connections + mBegin + mSize, mOut );
+  }
+};
+
+// Copies the connectivity values of a list of elements.
+struct CopyIndexed {
+  const std::size_t* mElementIndices;
+  std::size_t mCount;
+  std::size_t mNodesPerElement;
+  std::size_t* mOut;
+  CopyIndexed(
+    const std::size_t* elementIndices,
+    std::size_t count,
+    std::size_t nodesPerElement,
+    std::size_t* out ) :
+    mElementIndices( elementIndices ),
+    mCount( count ),
+    mNodesPerElement( nodesPerElement ),
+    mOut( out ) {}
+  template< typename IndexT > void operator()( const IndexT* connections ) {
+    for ( std::size_t k = 0; k < mCount; ++k ) {
+      const IndexT* element = connections + mElementIndices[k] * mNodesPerElement;
+      std::copy( element, element + mNodesPerElement, mOut + k * mNodesPerElement );
+    }
+  }
+};
+
+// Reads a single connectivity value.
+struct ReadValue {
+  std::size_t mIndex;
+  std::size_t mValue;
+  ReadValue( std::size_t index ) : mIndex( index ), mValue( 0 ) {}
+  template< typename IndexT > void operator()( const IndexT* connections ) {
+    mValue = connections[ mIndex ];
+  }
+};
+
+} // anon namespace
 
 namespace xdmGrid {
 
@@ -39,7 +128,7 @@ UnstructuredTopologyVectorRefImpFactory::createVectorRefImp()
 {
   return xdm::RefPtr< xdm::VectorRefImp< std::size_t > >(
     new xdm::SingleArrayOfVectorsImp< std::size_t >(
-      mTopology.mConnectivity->typedArray< std::size_t >()->begin(),
+      const_cast< std::size_t* >( mTopology.connectivityArray< std::size_t >() ),
       mTopology.mElementTopology->numberOfNodes() ) );
 }
 
@@ -78,6 +167,71 @@ void UnstructuredTopology::setConnectivity( xdm::RefPtr< xdm::UniformDataItem >
   mConnectivity = connectivity;
 }
 
+xdm::primitiveType::Value UnstructuredTopology::connectivityType() const {
+  if ( ! mConnectivity.valid() ) {
+    return xdm::primitiveType::kLongUnsignedInt;
+  }
+  return connectivityValues()->dataType();
+}
+
+xdm::RefPtr< const xdm::StructuredArray > UnstructuredTopology::connectivityValues() const {
+  // The array is looked up on every access: it may have been replaced since the
+  // last one, or be read from its dataset on demand.
+  xdm::RefPtr< const xdm::StructuredArray > values = mConnectivity->untypedArray();
+  checkConnectivityType( values->dataType() );
+  return values;
+}
+
+ConstElementConnectivity UnstructuredTopology::elementConnections(
+  std::size_t elementIndex ) const {
+
+  if ( connectivityType() == xdm::primitiveType::kLongUnsignedInt ) {
+    return Topology::elementConnections( elementIndex );
+  }
+  return copiedElementConnections( elementIndex, mElementTopology->numberOfNodes() );
+}
+
+std::size_t UnstructuredTopology::connectivityBytesPerElement() const {
+  return mElementTopology->numberOfNodes() * xdm::typeSize( connectivityType() );
+}
+
+void UnstructuredTopology::prepareConcurrentAccess() const {
+  if ( mConnectivity.valid() ) {
+    connectivityValues();
+  }
+}
+
+std::size_t UnstructuredTopology::connection(
+  std::size_t elementIndex,
+  std::size_t nodeIndex ) const {
+
+  ReadValue read( elementIndex * mElementTopology->numberOfNodes() + nodeIndex );
+  xdm::RefPtr< const xdm::StructuredArray > values = connectivityValues();
+  applyToConnectivity( values->dataType(), values->data(), read );
+  return read.mValue;
+}
+
+void UnstructuredTopology::gatherConnections(
+  std::size_t firstElement,
+  std::size_t count,
+  std::size_t* out ) const {
+
+  std::size_t nodesPerElement = mElementTopology->numberOfNodes();
+  CopyRange copy( firstElement * nodesPerElement, count * nodesPerElement, out );
+  xdm::RefPtr< const xdm::StructuredArray > values = connectivityValues();
+  applyToConnectivity( values->dataType(), values->data(), copy );
+}
+
+void UnstructuredTopology::gatherIndexedConnections(
+  const std::size_t* elementIndices,
+  std::size_t count,
+  std::size_t* out ) const {
+
+  CopyIndexed copy( elementIndices, count, mElementTopology->numberOfNodes(), out );
+  xdm::RefPtr< const xdm::StructuredArray > values = connectivityValues();
+  applyToConnectivity( values->dataType(), values->data(), copy );
+}
+
 void UnstructuredTopology::traverse( xdm::ItemVisitor& iv ) {
   if ( mConnectivity.valid() ) {
     mConnectivity->accept( iv );
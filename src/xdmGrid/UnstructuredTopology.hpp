@@ -24,6 +24,7 @@
 #include <xdmGrid/ElementTopology.hpp>
 #include <xdmGrid/Topology.hpp>
 
+#include <xdm/PrimitiveType.hpp>
 #include <xdm/RefPtr.hpp>
 #include <xdm/UniformDataItem.hpp>
 
@@ -57,14 +58,75 @@ public:
 
   /// Set the connectivity values to the input DataItem. If the connectivity
   /// is not specified, then there is a default connectivity determined by the
-  /// topology type.
+  /// topology type. The values may be stored as int, unsigned int, long int, or
+  /// std::size_t. For meshes with fewer than 2^32 nodes, 32 bit values halve
+  /// the memory used by the connectivity; they are widened to std::size_t as
+  /// they are read through connection() and gatherConnections(). The type is
+  /// taken from the array of the item each time the values are read, so the
+  /// array may be replaced after the item is set.
   void setConnectivity( xdm::RefPtr< xdm::UniformDataItem > connectivity );
 
+  /// Get the type of the values stored in the connectivity array, loading the
+  /// values if necessary. Without connectivity, this is std::size_t.
+  /// @throws std::runtime_error if the values are not of an integer type.
+  xdm::primitiveType::Value connectivityType() const;
+
+  /// Get the number of bytes used to store the connectivity of one Element.
+  std::size_t connectivityBytesPerElement() const;
+
+  /// Get the connectivity values in the type they are stored in, for callers
+  /// that want to work on narrow indices directly.
+  /// @pre IndexT matches connectivityType().
+  template< typename IndexT >
+  const IndexT* connectivityArray() const {
+    assert( xdm::PrimitiveTypeInfo< IndexT >::kValue == connectivityType() );
+    return static_cast< const IndexT* >( connectivityValues()->data() );
+  }
+
+  /// Get the connectivity values in the type they are stored in, for callers
+  /// that modify them in place.
+  /// @pre IndexT matches connectivityType().
+  template< typename IndexT >
+  IndexT* connectivityArray() {
+    assert( xdm::PrimitiveTypeInfo< IndexT >::kValue == connectivityType() );
+    return mConnectivity->typedArray< IndexT >()->begin();
+  }
+
+  /// Redefinition from Topology that loads the connectivity values, which are
+  /// read directly rather than through the shared vector implementation.
+  virtual void prepareConcurrentAccess() const;
+
+  /// Redefinition from Topology. Connectivity stored as std::size_t is
+  /// referenced in place; narrower connectivity is widened into a copy of the
+  /// Element's values only.
+  virtual ConstElementConnectivity elementConnections( std::size_t elementIndex ) const;
+
+  /// Read a single connectivity value, widening it from the stored type.
+  virtual std::size_t connection( std::size_t elementIndex, std::size_t nodeIndex ) const;
+
+  /// Copy a contiguous range of the connectivity array, widening it from the
+  /// stored type.
+  virtual void gatherConnections(
+    std::size_t firstElement,
+    std::size_t count,
+    std::size_t* out ) const;
+
+  /// Copy the connectivity array entries for a list of Elements, widening them
+  /// from the stored type.
+  virtual void gatherIndexedConnections(
+    const std::size_t* elementIndices,
+    std::size_t count,
+    std::size_t* out ) const;
+
   virtual void traverse( xdm::ItemVisitor& iv );
 
   virtual void writeMetadata( xdm::XmlMetadataWrapper& xml );
 
 private:
+  // Get the current array of connectivity values, loading them if necessary.
+  // @throws std::runtime_error if the values are not of an integer type.
+  xdm::RefPtr< const xdm::StructuredArray > connectivityValues() const;
+
   friend class UnstructuredTopologyVectorRefImpFactory;
   xdm::RefPtr< xdm::UniformDataItem > mConnectivity;
   xdm::RefPtr< const ElementTopology > mElementTopology;
@@ -72,7 +134,9 @@ private:
 };
 
 /// Implementation class to define the shared vector reference implementation for unstructured
-/// topologies.
+/// topologies. VectorRef access requires std::size_t references, so the shared
+/// implementation is only used when the connectivity is stored as std::size_t; other types
+/// are widened per Element by UnstructuredTopology::elementConnections().
 class UnstructuredTopologyVectorRefImpFactory : 
   public xdm::VectorRefImpFactory< std::size_t >
 {
@@ -33,6 +33,7 @@
 #include <xdm/test/TestHelpers.hpp>
 
 #include <algorithm>
+#include <vector>
 
 namespace {
 
@@ -330,5 +331,132 @@ BOOST_AUTO_TEST_CASE( edgeAccess ) {
   }
 }
 
+// Check that two elements refer to the same nodes.
+void checkSameNodes( const xdmGrid::Element& expected, const xdmGrid::Element& actual ) {
+  BOOST_REQUIRE_EQUAL( expected.numberOfNodes(), actual.numberOfNodes() );
+  for ( std::size_t i = 0; i < expected.numberOfNodes(); ++i ) {
+    BOOST_CHECK_EQUAL( expected.nodeIndexInGeometry( i ), actual.nodeIndexInGeometry( i ) );
+  }
+}
+
+xdm::RefPtr< xdmGrid::CollectionGrid > mixedCollection( xdm::RefPtr< xdmGrid::Grid > grid ) {
+  static std::size_t elements[] = { 4, 0, 2 };
+  static std::size_t faceElements[] = { 1, 3 };
+  static std::size_t faces[] = { 2, 0 };
+  xdm::RefPtr< xdmGrid::CollectionGrid > collection( new xdmGrid::CollectionGrid );
+  collection->appendGrid( grid, test::createUniformDataItem(
+    elements, 3, xdm::primitiveType::kLongUnsignedInt ) );
+  // A grid that references no elements must be skipped.
+  collection->appendGrid( grid, test::createUniformDataItem(
+    elements, 0, xdm::primitiveType::kLongUnsignedInt ) );
+  collection->appendGrid( grid );
+  collection->appendGridFaces( grid,
+    test::createUniformDataItem( faceElements, 2, xdm::primitiveType::kLongUnsignedInt ),
+    test::createUniformDataItem( faces, 2, xdm::primitiveType::kLongUnsignedInt ) );
+  return collection;
+}
+
+BOOST_AUTO_TEST_CASE( elementCursor ) {
+  CubeOfTets cube;
+  xdm::RefPtr< xdmGrid::CollectionGrid > collection = mixedCollection( cubeGrid( cube ) );
+  BOOST_REQUIRE_EQUAL( 10, collection->numberOfElements() );
+
+  std::size_t count = 0;
+  for ( xdmGrid::CollectionGrid::ElementCursor c( *collection ); c.valid(); c.next() ) {
+    BOOST_CHECK_EQUAL( count, c.index() );
+    checkSameNodes( collection->element( c.index() ), c.element() );
+    ++count;
+  }
+  BOOST_CHECK_EQUAL( 10, count );
+
+  // An empty collection has no elements to visit.
+  xdmGrid::CollectionGrid empty;
+  BOOST_CHECK_EQUAL( 0, empty.numberOfElements() );
+  BOOST_CHECK( ! xdmGrid::CollectionGrid::ElementCursor( empty ).valid() );
+}
+
+BOOST_AUTO_TEST_CASE( elementTable ) {
+  CubeOfTets cube;
+  xdm::RefPtr< xdmGrid::UniformGrid > grid = cubeGrid( cube );
+  xdm::RefPtr< xdmGrid::CollectionGrid > searched = mixedCollection( grid );
+  xdm::RefPtr< xdmGrid::CollectionGrid > tabled = mixedCollection( grid );
+  tabled->setUseElementTable( true );
+  BOOST_CHECK( tabled->useElementTable() );
+
+  BOOST_REQUIRE_EQUAL( searched->numberOfElements(), tabled->numberOfElements() );
+  for ( std::size_t e = 0; e < searched->numberOfElements(); ++e ) {
+    checkSameNodes( searched->element( e ), tabled->element( e ) );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( invalidateOffsets ) {
+  CubeOfTets cube;
+  xdm::RefPtr< xdmGrid::UniformGrid > grid = cubeGrid( cube );
+  xdmGrid::CollectionGrid collection;
+  collection.setUseElementTable( true );
+  collection.appendGrid( grid );
+  BOOST_CHECK_EQUAL( 5, collection.numberOfElements() );
+
+  // Appending invalidates the offsets.
+  collection.appendGrid( grid );
+  BOOST_CHECK_EQUAL( 10, collection.numberOfElements() );
+  checkSameNodes( grid->element( 4 ), collection.element( 9 ) );
+
+  // Counting the elements notices a change to a referenced grid by itself.
+  grid->topology()->setNumberOfElements( 3 );
+  BOOST_CHECK_EQUAL( 6, collection.numberOfElements() );
+  checkSameNodes( grid->element( 0 ), collection.element( 3 ) );
+
+  // So does an explicit invalidation.
+  grid->topology()->setNumberOfElements( 2 );
+  collection.invalidateOffsets();
+  checkSameNodes( grid->element( 1 ), collection.element( 3 ) );
+  BOOST_CHECK_EQUAL( 4, collection.numberOfElements() );
+
+  // Partitioning checks the offsets against the referenced grids itself.
+  grid->topology()->setNumberOfElements( 4 );
+  std::vector< xdmGrid::ElementBlockRange > ranges;
+  collection.partitionElementBlocks( 3, ranges );
+  BOOST_REQUIRE_EQUAL( 4, ranges.size() );
+  BOOST_CHECK_EQUAL( 4, ranges[2].first );
+  BOOST_CHECK_EQUAL( 8, ranges[3].first + ranges[3].second );
+  BOOST_CHECK_EQUAL( 8, collection.numberOfElements() );
+  checkSameNodes( grid->element( 0 ), collection.element( 4 ) );
+}
+
+// Searching, the element table, and the cursor must visit the same elements of
+// a collection of many small grids.
+BOOST_AUTO_TEST_CASE( lookupMethodsAgree ) {
+  CubeOfTets cube;
+  xdm::RefPtr< xdmGrid::UniformGrid > grid = cubeGrid( cube );
+  xdmGrid::CollectionGrid collection;
+  for ( int i = 0; i < 20; ++i ) {
+    collection.appendGrid( grid );
+  }
+  std::size_t numberOfElements = collection.numberOfElements();
+  BOOST_REQUIRE_EQUAL( 100, numberOfElements );
+
+  std::vector< std::size_t > searched;
+  for ( std::size_t e = 0; e < numberOfElements; ++e ) {
+    searched.push_back( collection.element( e ).nodeIndexInGeometry( 0 ) );
+  }
+
+  std::vector< std::size_t > visited;
+  for ( xdmGrid::CollectionGrid::ElementCursor c( collection ); c.valid(); c.next() ) {
+    BOOST_CHECK_EQUAL( visited.size(), c.index() );
+    visited.push_back( c.element().nodeIndexInGeometry( 0 ) );
+  }
+
+  collection.setUseElementTable( true );
+  std::vector< std::size_t > tabled;
+  for ( std::size_t e = 0; e < numberOfElements; ++e ) {
+    tabled.push_back( collection.element( e ).nodeIndexInGeometry( 0 ) );
+  }
+
+  BOOST_CHECK( searched == visited );
+  BOOST_CHECK( searched == tabled );
+  BOOST_CHECK_EQUAL( grid->element( 3 ).nodeIndexInGeometry( 0 ), searched[ 48 ] );
+}
+
 } // namespace
 
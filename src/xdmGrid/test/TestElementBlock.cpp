@@ -0,0 +1,253 @@
+//==============================================================================
+// This software developed by Stellar Science Ltd Co and the U.S. Government.
+// Copyright (C) 2009-2010 Stellar Science. Government-purpose rights granted.
+//
+// This file is part of XDM
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+#define BOOST_TEST_MODULE ElementBlock
+#include <boost/test/unit_test.hpp>
+
+#include <xdmGrid/CollectionGrid.hpp>
+#include <xdmGrid/Element.hpp>
+#include <xdmGrid/ElementBlock.hpp>
+#include <xdmGrid/ElementTopology.hpp>
+#include <xdmGrid/InterlacedGeometry.hpp>
+#include <xdmGrid/UniformGrid.hpp>
+#include <xdmGrid/UnstructuredTopology.hpp>
+
+#include <xdmGrid/test/Cube.hpp>
+
+#include <xdm/test/TestHelpers.hpp>
+
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+xdm::RefPtr< xdmGrid::UniformGrid > createGrid(
+  double* nodes,
+  std::size_t numberOfNodes,
+  std::size_t* connectivity,
+  std::size_t numberOfElements ) {
+
+  xdm::RefPtr< xdmGrid::InterlacedGeometry > g( new xdmGrid::InterlacedGeometry( 3 ) );
+  g->setCoordinateValues( test::createUniformDataItem(
+    nodes, numberOfNodes * 3, xdm::primitiveType::kDouble ) );
+
+  xdm::RefPtr< xdmGrid::UnstructuredTopology > t( new xdmGrid::UnstructuredTopology() );
+  t->setConnectivity( test::createUniformDataItem(
+    connectivity, numberOfElements * 4, xdm::primitiveType::kLongUnsignedInt ) );
+  t->setNumberOfElements( numberOfElements );
+  t->setElementTopology( xdmGrid::elementFactory( xdmGrid::ElementShape::Tetrahedron, 1 ) );
+
+  xdm::RefPtr< xdmGrid::UniformGrid > grid( new xdmGrid::UniformGrid );
+  grid->setGeometry( g );
+  grid->setTopology( t );
+  return grid;
+}
+
+// Checks that every block matches the element by element access of the grid,
+// and records which elements were visited.
+class CompareToElements : public xdmGrid::ElementBlockVisitor {
+public:
+  CompareToElements( const xdmGrid::Grid& grid ) :
+    mGrid( grid ), mVisits( grid.numberOfElements(), 0 ), mBlocks( 0 ) {}
+
+  virtual void apply( const xdmGrid::ElementBlock& block ) {
+    ++mBlocks;
+    for ( std::size_t e = 0; e < block.numberOfElements(); ++e ) {
+      std::size_t elementIndex = block.firstElement() + e;
+      ++mVisits.at( elementIndex );
+      xdmGrid::Element element = mGrid.element( elementIndex );
+      BOOST_CHECK( element.elementTopology() == block.elementTopology() );
+      BOOST_CHECK( &element.geometry() == &block.geometry() );
+      for ( std::size_t i = 0; i < block.nodesPerElement(); ++i ) {
+        BOOST_CHECK_EQUAL( element.nodeIndexInGeometry( i ), block.elementConnectivity( e )[i] );
+        for ( std::size_t dim = 0; dim < block.dimension(); ++dim ) {
+          BOOST_CHECK_EQUAL( element.node( i )[dim], block.nodeCoordinates( e, i )[dim] );
+        }
+      }
+    }
+  }
+
+  const xdmGrid::Grid& mGrid;
+  std::vector< int > mVisits;
+  std::size_t mBlocks;
+};
+
+// Counts the visited elements. Each element is written by exactly one block, so
+// this is safe to use from multiple threads.
+class MarkElements : public xdmGrid::ElementBlockVisitor {
+public:
+  MarkElements( std::size_t numberOfElements ) : mVisits( numberOfElements, 0 ) {}
+
+  virtual void apply( const xdmGrid::ElementBlock& block ) {
+    for ( std::size_t e = 0; e < block.numberOfElements(); ++e ) {
+      ++mVisits[ block.firstElement() + e ];
+    }
+  }
+
+  std::vector< int > mVisits;
+};
+
+// Sums the coordinates of all nodes of all elements.
+class SumCoordinates : public xdmGrid::ElementBlockVisitor {
+public:
+  SumCoordinates() : mSum( 0.0 ) {}
+
+  virtual void apply( const xdmGrid::ElementBlock& block ) {
+    std::size_t size = block.numberOfElements() * block.nodesPerElement() * block.dimension();
+    const double* coordinates = block.coordinates();
+    for ( std::size_t i = 0; i < size; ++i ) {
+      mSum += coordinates[i];
+    }
+  }
+
+  double mSum;
+};
+
+BOOST_AUTO_TEST_CASE( uniformGrid ) {
+  CubeOfTets cube;
+  xdm::RefPtr< xdmGrid::UniformGrid > grid = createGrid(
+    cube.nodeArray(), cube.numberOfNodes(),
+    cube.connectivityArray(), cube.numberOfElements() );
+
+  std::vector< xdmGrid::ElementBlockRange > ranges;
+  grid->partitionElementBlocks( 2, ranges );
+  BOOST_REQUIRE_EQUAL( 3, ranges.size() );
+  BOOST_CHECK_EQUAL( 4, ranges[2].first );
+  BOOST_CHECK_EQUAL( 1, ranges[2].second );
+
+  CompareToElements visitor( *grid );
+  grid->forEachElementBlock( visitor, 2 );
+  BOOST_CHECK_EQUAL( 3, visitor.mBlocks );
+  BOOST_CHECK( std::vector< int >( 5, 1 ) == visitor.mVisits );
+}
+
+BOOST_AUTO_TEST_CASE( collectionGrid ) {
+  CubeOfTets cube;
+  xdm::RefPtr< xdmGrid::UniformGrid > grid = createGrid(
+    cube.nodeArray(), cube.numberOfNodes(),
+    cube.connectivityArray(), cube.numberOfElements() );
+
+  std::size_t elements[] = { 4, 0, 2 };
+  std::size_t faceElements[] = { 1, 1, 3 };
+  std::size_t faces[] = { 0, 2, 1 };
+
+  xdmGrid::CollectionGrid collection;
+  collection.appendGrid( grid, test::createUniformDataItem(
+    elements, 3, xdm::primitiveType::kLongUnsignedInt ) );
+  collection.appendGrid( grid );
+  collection.appendGridFaces( grid,
+    test::createUniformDataItem( faceElements, 3, xdm::primitiveType::kLongUnsignedInt ),
+    test::createUniformDataItem( faces, 3, xdm::primitiveType::kLongUnsignedInt ) );
+  BOOST_REQUIRE_EQUAL( 11, collection.numberOfElements() );
+
+  // No block may span more than one of the referenced grids, and each face of
+  // a tetrahedron has its own local node map, so the faces are separate blocks.
+  CompareToElements visitor( collection );
+  collection.forEachElementBlock( visitor, 4 );
+  BOOST_CHECK_EQUAL( 6, visitor.mBlocks );
+  BOOST_CHECK( std::vector< int >( 11, 1 ) == visitor.mVisits );
+}
+
+BOOST_AUTO_TEST_CASE( parallel ) {
+  CubeOfTets cube;
+  xdm::RefPtr< xdmGrid::UniformGrid > grid = createGrid(
+    cube.nodeArray(), cube.numberOfNodes(),
+    cube.connectivityArray(), cube.numberOfElements() );
+
+  xdmGrid::CollectionGrid collection;
+  for ( int i = 0; i < 20; ++i ) {
+    collection.appendGrid( grid );
+  }
+
+  MarkElements visitor( collection.numberOfElements() );
+  collection.forEachElementBlockParallel( visitor, 3 );
+  BOOST_CHECK( std::vector< int >( 100, 1 ) == visitor.mVisits );
+}
+
+// Visiting the blocks must see the same coordinates as visiting the elements
+// one at a time, with nodes referenced in a scattered order.
+BOOST_AUTO_TEST_CASE( sumMatchesElements ) {
+  const std::size_t numberOfNodes = 64;
+  const std::size_t numberOfElements = 300;
+
+  std::vector< double > nodes( 3 * numberOfNodes );
+  for ( std::size_t i = 0; i < nodes.size(); ++i ) {
+    nodes[i] = static_cast< double >( i % 17 );
+  }
+  std::vector< std::size_t > connectivity( 4 * numberOfElements );
+  for ( std::size_t i = 0; i < connectivity.size(); ++i ) {
+    connectivity[i] = ( i * 37 ) % numberOfNodes;
+  }
+  xdm::RefPtr< xdmGrid::UniformGrid > grid = createGrid(
+    &nodes[0], numberOfNodes, &connectivity[0], numberOfElements );
+
+  double elementSum = 0.0;
+  for ( std::size_t e = 0; e < numberOfElements; ++e ) {
+    xdmGrid::Element element = grid->element( e );
+    for ( std::size_t i = 0; i < 4; ++i ) {
+      xdmGrid::ConstNode node = element.node( i );
+      elementSum += node[0] + node[1] + node[2];
+    }
+  }
+
+  SumCoordinates visitor;
+  grid->forEachElementBlock( visitor, 64 );
+  BOOST_CHECK_EQUAL( elementSum, visitor.mSum );
+}
+
+// Throws from the visit of one block.
+class ThrowOnBlock : public xdmGrid::ElementBlockVisitor {
+public:
+  ThrowOnBlock( std::size_t firstElement ) : mFirstElement( firstElement ) {}
+
+  virtual void apply( const xdmGrid::ElementBlock& block ) {
+    if ( block.firstElement() == mFirstElement ) {
+      throw std::out_of_range( "visited the failing block" );
+    }
+  }
+
+  std::size_t mFirstElement;
+};
+
+BOOST_AUTO_TEST_CASE( parallelKeepsExceptionType ) {
+  CubeOfTets cube;
+  xdm::RefPtr< xdmGrid::UniformGrid > grid = createGrid(
+    cube.nodeArray(), cube.numberOfNodes(),
+    cube.connectivityArray(), cube.numberOfElements() );
+
+  ThrowOnBlock visitor( 2 );
+  BOOST_CHECK_THROW( grid->forEachElementBlockParallel( visitor, 1 ), std::out_of_range );
+}
+
+BOOST_AUTO_TEST_CASE( indexedOutOfRange ) {
+  CubeOfTets cube;
+  xdm::RefPtr< xdmGrid::UniformGrid > grid = createGrid(
+    cube.nodeArray(), cube.numberOfNodes(),
+    cube.connectivityArray(), cube.numberOfElements() );
+
+  std::size_t elements[] = { 1, 5 };
+  std::vector< xdmGrid::ElementBlockRange > ranges;
+  BOOST_CHECK_THROW(
+    grid->partitionIndexedElementBlocks( elements, 2, 4, ranges ), std::out_of_range );
+  BOOST_CHECK_NO_THROW( grid->partitionIndexedElementBlocks( elements, 1, 4, ranges ) );
+  BOOST_CHECK_EQUAL( 1, ranges.size() );
+}
+
+} // namespace
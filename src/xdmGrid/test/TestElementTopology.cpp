@@ -23,6 +23,8 @@
 
 #include <xdmGrid/ElementTopology.hpp>
 
+#include <stdexcept>
+
 namespace {
 
 BOOST_AUTO_TEST_CASE( curve ) {
@@ -606,4 +608,18 @@ BOOST_AUTO_TEST_CASE( hex ) {
   }
 }
 
+BOOST_AUTO_TEST_CASE( factoryReusesElements ) {
+  xdm::RefPtr< const xdmGrid::ElementTopology > first =
+    xdmGrid::elementFactory( xdmGrid::ElementShape::Wedge, 1 );
+  xdm::RefPtr< const xdmGrid::ElementTopology > second =
+    xdmGrid::elementFactory( xdmGrid::ElementShape::Wedge, 1 );
+  BOOST_CHECK_EQUAL( first.get(), second.get() );
+
+  // An order that cannot be built throws and leaves the factory usable.
+  BOOST_CHECK_THROW( xdmGrid::elementFactory( xdmGrid::ElementShape::Wedge, 3 ),
+    std::domain_error );
+  BOOST_CHECK_EQUAL( first.get(),
+    xdmGrid::elementFactory( xdmGrid::ElementShape::Wedge, 1 ).get() );
+}
+
 } // namespace
@@ -64,5 +64,29 @@ BOOST_AUTO_TEST_CASE( nodeAccess ) {
   BOOST_CHECK_EQUAL( 1., g.node( 7 )[2] );
 }
 
+BOOST_AUTO_TEST_CASE( gatherNodes ) {
+  xdmGrid::MultiArrayGeometry g(3);
+
+  CubeOfTets cube;
+  g.setCoordinateValues( 0, test::createUniformDataItem(
+    cube.nodeX(), cube.numberOfNodes(), xdm::primitiveType::kDouble ) );
+  g.setCoordinateValues( 1, test::createUniformDataItem(
+    cube.nodeY(), cube.numberOfNodes(), xdm::primitiveType::kDouble ) );
+  g.setCoordinateValues( 2, test::createUniformDataItem(
+    cube.nodeZ(), cube.numberOfNodes(), xdm::primitiveType::kDouble ) );
+
+  std::vector< std::size_t > indices( cube.connectivityArray(), cube.connectivityArray() + 20 );
+  std::vector< double > xyz;
+  g.gatherNodes( indices, xyz );
+
+  BOOST_REQUIRE_EQUAL( 60, xyz.size() );
+  for ( std::size_t k = 0; k < indices.size(); ++k ) {
+    for ( std::size_t i = 0; i < 3; ++i ) {
+      BOOST_CHECK_EQUAL( g.node( indices[k] )[i], xyz[ 3 * k + i ] );
+      BOOST_CHECK_EQUAL( g.node( indices[k] )[i], g.nodeSpan().at( indices[k], i ) );
+    }
+  }
+}
+
 } // namespace
 
@@ -23,6 +23,9 @@
 
 #include <xdmGrid/StructuredTopology.hpp>
 
+#include <algorithm>
+#include <vector>
+
 namespace {
 
 BOOST_AUTO_TEST_CASE( writeMetadata ) {
@@ -46,5 +49,109 @@ BOOST_AUTO_TEST_CASE( writeMetadata ) {
   BOOST_CHECK_EQUAL( "4 3 2", xml.attribute( "Dimensions" ) );
 }
 
+// The connectivity as it used to be stored: 8 node indices per hexahedron.
+std::vector< std::size_t > explicitConnectivity( std::size_t nx, std::size_t ny, std::size_t nz ) {
+  std::vector< std::size_t > nodes;
+  std::size_t xNodes = nx + 1;
+  std::size_t yNodes = ny + 1;
+  for ( std::size_t z = 0; z < nz; ++z ) {
+    for ( std::size_t y = 0; y < ny; ++y ) {
+      for ( std::size_t x = 0; x < nx; ++x ) {
+        for ( std::size_t layer = 0; layer < 2; ++layer ) {
+          std::size_t base = ( z + layer ) * xNodes * yNodes;
+          nodes.push_back( base + ( x + 0 ) + ( y + 0 ) * xNodes );
+          nodes.push_back( base + ( x + 1 ) + ( y + 0 ) * xNodes );
+          nodes.push_back( base + ( x + 1 ) + ( y + 1 ) * xNodes );
+          nodes.push_back( base + ( x + 0 ) + ( y + 1 ) * xNodes );
+        }
+      }
+    }
+  }
+  return nodes;
+}
+
+BOOST_AUTO_TEST_CASE( connectivity2D ) {
+  xdmGrid::StructuredTopology t;
+  t.setShape( xdm::makeShape( 3, 2 ) );
+  BOOST_REQUIRE_EQUAL( 6, t.numberOfElements() );
+
+  // Element 4 is at x = 1, y = 1 with 4 nodes along x.
+  BOOST_CHECK_EQUAL( 5, t.connection( 4, 0 ) );
+  BOOST_CHECK_EQUAL( 6, t.connection( 4, 1 ) );
+  BOOST_CHECK_EQUAL( 10, t.connection( 4, 2 ) );
+  BOOST_CHECK_EQUAL( 9, t.connection( 4, 3 ) );
+
+  xdmGrid::ConstElementConnectivity connections = t.elementConnections( 4 );
+  BOOST_REQUIRE_EQUAL( 4, connections.size() );
+  BOOST_CHECK_EQUAL( 10, connections[2] );
+
+  std::vector< std::size_t > out( 4 * 6 );
+  t.gatherConnections( 0, 6, &out[0] );
+  for ( std::size_t e = 0; e < 6; ++e ) {
+    for ( std::size_t i = 0; i < 4; ++i ) {
+      BOOST_CHECK_EQUAL( t.connection( e, i ), out[ 4 * e + i ] );
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( connectivity3D ) {
+  const std::size_t nx = 4, ny = 3, nz = 5;
+  xdmGrid::StructuredTopology t;
+  t.setShape( xdm::makeShape( nx, ny, nz ) );
+  std::vector< std::size_t > expected = explicitConnectivity( nx, ny, nz );
+  std::size_t numberOfElements = nx * ny * nz;
+  BOOST_REQUIRE_EQUAL( numberOfElements, t.numberOfElements() );
+
+  for ( std::size_t e = 0; e < numberOfElements; ++e ) {
+    xdmGrid::ConstElementConnectivity connections = t.elementConnections( e );
+    for ( std::size_t i = 0; i < 8; ++i ) {
+      BOOST_CHECK_EQUAL( expected[ 8 * e + i ], t.connection( e, i ) );
+      BOOST_CHECK_EQUAL( expected[ 8 * e + i ], connections[i] );
+    }
+  }
+
+  // A range that starts and ends in the middle of a row.
+  std::vector< std::size_t > out( 8 * 23 );
+  t.gatherConnections( 6, 23, &out[0] );
+  BOOST_CHECK( std::equal( out.begin(), out.end(), expected.begin() + 8 * 6 ) );
+
+  std::size_t elements[] = { 59, 0, 17 };
+  t.gatherIndexedConnections( elements, 3, &out[0] );
+  for ( std::size_t k = 0; k < 3; ++k ) {
+    BOOST_CHECK( std::equal( out.begin() + 8 * k, out.begin() + 8 * k + 8,
+      expected.begin() + 8 * elements[k] ) );
+  }
+}
+
+// Gathering the connectivity of the whole mesh must match the explicit array
+// the topology used to build.
+BOOST_AUTO_TEST_CASE( gatherWholeMesh ) {
+  const std::size_t n = 8;
+  xdmGrid::StructuredTopology t;
+  t.setShape( xdm::makeShape( n, n, n ) );
+  std::size_t numberOfElements = t.numberOfElements();
+
+  std::vector< std::size_t > expected = explicitConnectivity( n, n, n );
+  std::vector< std::size_t > out( expected.size() );
+  t.gatherConnections( 0, numberOfElements, &out[0] );
+  BOOST_CHECK( out == expected );
+}
+
+// Connectivity of one element that is still referenced must not change when
+// the connectivity of another element is requested.
+BOOST_AUTO_TEST_CASE( heldConnectivity ) {
+  xdmGrid::StructuredTopology t;
+  t.setShape( xdm::makeShape( 3, 2 ) );
+
+  xdmGrid::ConstElementConnectivity first = t.elementConnections( 0 );
+  xdmGrid::ConstElementConnectivity second = t.elementConnections( 4 );
+  xdmGrid::ConstElementConnectivity third = t.elementConnections( 1 );
+  for ( std::size_t i = 0; i < 4; ++i ) {
+    BOOST_CHECK_EQUAL( t.connection( 0, i ), first[i] );
+    BOOST_CHECK_EQUAL( t.connection( 4, i ), second[i] );
+    BOOST_CHECK_EQUAL( t.connection( 1, i ), third[i] );
+  }
+}
+
 } // namespace 
 
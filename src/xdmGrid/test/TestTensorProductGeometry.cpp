@@ -72,5 +72,30 @@ BOOST_AUTO_TEST_CASE( nodeAccess3D ) {
   BOOST_CHECK_CLOSE( 0.30, g.node( 17 )[2], 1.e-8 );
 }
 
+BOOST_AUTO_TEST_CASE( gatherNodes ) {
+  xdmGrid::TensorProductGeometry g(3);
+
+  StructuredCube cube;
+  for ( std::size_t dim = 0; dim < 3; ++dim ) {
+    g.setCoordinateValues( dim, test::createUniformDataItem(
+      cube.axis( dim ), cube.axisSize( dim ), xdm::primitiveType::kDouble ) );
+  }
+
+  std::vector< std::size_t > indices;
+  for ( std::size_t node = cube.numberOfNodes(); node > 0; --node ) {
+    indices.push_back( node - 1 );
+  }
+  std::vector< double > xyz;
+  g.gatherNodes( indices, xyz );
+
+  BOOST_REQUIRE_EQUAL( 3 * cube.numberOfNodes(), xyz.size() );
+  for ( std::size_t k = 0; k < indices.size(); ++k ) {
+    for ( std::size_t i = 0; i < 3; ++i ) {
+      BOOST_CHECK_EQUAL( g.node( indices[k] )[i], xyz[ 3 * k + i ] );
+      BOOST_CHECK_EQUAL( g.node( indices[k] )[i], g.nodeEvaluator().at( indices[k], i ) );
+    }
+  }
+}
+
 } // namespace
 
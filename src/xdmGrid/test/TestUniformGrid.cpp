@@ -183,6 +183,41 @@ BOOST_AUTO_TEST_CASE( elementTopology ) {
   }
 }
 
+BOOST_AUTO_TEST_CASE( elementAccessRectilinear ) {
+  double xvalues[] = { 0.0, 1.0, 2.0 };
+  double yvalues[] = { 0.0, 1.0 };
+
+  xdmGrid::UniformGrid grid;
+
+  xdm::RefPtr< xdmGrid::TensorProductGeometry > g( new xdmGrid::TensorProductGeometry(2) );
+  g->setCoordinateValues(
+    0, test::createUniformDataItem( xvalues, 3, xdm::primitiveType::kDouble ) );
+  g->setCoordinateValues(
+    1, test::createUniformDataItem( yvalues, 2, xdm::primitiveType::kDouble ) );
+  grid.setGeometry( g );
+
+  xdm::RefPtr< xdmGrid::StructuredTopology > t( new xdmGrid::StructuredTopology );
+  t->setShape( xdm::makeShape( 2, 1 ) );
+  grid.setTopology( t );
+
+  // The second quad has nodes 1, 2, 5, and 4.
+  xdmGrid::Element element = grid.element( 1 );
+  BOOST_CHECK_EQUAL( element.nodeIndexInGeometry( 0 ), 1 );
+  BOOST_CHECK_EQUAL( element.nodeIndexInGeometry( 1 ), 2 );
+  BOOST_CHECK_EQUAL( element.nodeIndexInGeometry( 2 ), 5 );
+  BOOST_CHECK_EQUAL( element.nodeIndexInGeometry( 3 ), 4 );
+  BOOST_CHECK_EQUAL( element.node( 2 )[0], 2.0 );
+  BOOST_CHECK_EQUAL( element.node( 2 )[1], 1.0 );
+  BOOST_CHECK_EQUAL( element.node( 3 )[0], 1.0 );
+  BOOST_CHECK_EQUAL( element.node( 3 )[1], 1.0 );
+
+  // Partitioning prepares the topology for concurrent access, and a structured
+  // topology has no shared connectivity vector.
+  std::vector< xdmGrid::ElementBlockRange > ranges;
+  grid.partitionElementBlocks( 1, ranges );
+  BOOST_CHECK_EQUAL( 2, ranges.size() );
+}
+
 BOOST_AUTO_TEST_CASE( createAttribute ) {
   std::vector< double > xvalues( 3 );
   xvalues[0] = 0.0;
@@ -24,8 +24,13 @@
 #include <xdmGrid/UnstructuredTopology.hpp>
 #include <xdmGrid/ElementTopology.hpp>
 
+#include <xdm/ArrayAdapter.hpp>
 #include <xdm/test/TestHelpers.hpp>
 
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
 BOOST_AUTO_TEST_CASE( writeMetadata ) {
   xdmGrid::UnstructuredTopology t;
   xdm::XmlMetadataWrapper xml( xdm::makeRefPtr( new xdm::XmlObject ) );
@@ -40,3 +45,102 @@ BOOST_AUTO_TEST_CASE( writeMetadata ) {
   BOOST_CHECK_EQUAL( "4", xml.attribute( "NodesPerElement" ) );
 }
 
+// Connectivity stored as 32 bit values must read the same as std::size_t
+// values through every access path.
+BOOST_AUTO_TEST_CASE( narrowConnectivity ) {
+  const std::size_t numberOfElements = 6;
+  std::vector< std::size_t > wide( 4 * numberOfElements );
+  std::vector< unsigned int > narrow( wide.size() );
+  for ( std::size_t i = 0; i < wide.size(); ++i ) {
+    wide[i] = ( i * 7 ) % 11;
+    narrow[i] = static_cast< unsigned int >( wide[i] );
+  }
+
+  xdmGrid::UnstructuredTopology wideTopology;
+  wideTopology.setNumberOfElements( numberOfElements );
+  wideTopology.setElementTopology( xdmGrid::elementFactory( xdmGrid::ElementShape::Tetrahedron, 1 ) );
+  wideTopology.setConnectivity( test::createUniformDataItem(
+    &wide[0], wide.size(), xdm::primitiveType::kLongUnsignedInt ) );
+
+  xdmGrid::UnstructuredTopology narrowTopology;
+  narrowTopology.setNumberOfElements( numberOfElements );
+  narrowTopology.setElementTopology( xdmGrid::elementFactory( xdmGrid::ElementShape::Tetrahedron, 1 ) );
+  narrowTopology.setConnectivity( test::createUniformDataItem(
+    &narrow[0], narrow.size(), xdm::primitiveType::kUnsignedInt ) );
+
+  BOOST_CHECK_EQUAL( xdm::primitiveType::kUnsignedInt, narrowTopology.connectivityType() );
+  BOOST_CHECK_EQUAL( &narrow[0], narrowTopology.connectivityArray< unsigned int >() );
+  BOOST_CHECK_EQUAL( 4 * sizeof( std::size_t ), wideTopology.connectivityBytesPerElement() );
+  BOOST_CHECK_EQUAL( 4 * sizeof( unsigned int ), narrowTopology.connectivityBytesPerElement() );
+
+  for ( std::size_t e = 0; e < numberOfElements; ++e ) {
+    xdmGrid::ConstElementConnectivity connections = narrowTopology.elementConnections( e );
+    for ( std::size_t i = 0; i < 4; ++i ) {
+      BOOST_CHECK_EQUAL( wide[ 4 * e + i ], narrowTopology.connection( e, i ) );
+      BOOST_CHECK_EQUAL( wide[ 4 * e + i ], connections[i] );
+    }
+  }
+
+  std::vector< std::size_t > out( 8 );
+  narrowTopology.gatherConnections( 3, 2, &out[0] );
+  BOOST_CHECK( std::equal( out.begin(), out.end(), wide.begin() + 12 ) );
+
+  std::size_t elements[] = { 5, 1 };
+  narrowTopology.gatherIndexedConnections( elements, 2, &out[0] );
+  BOOST_CHECK( std::equal( out.begin(), out.begin() + 4, wide.begin() + 20 ) );
+  BOOST_CHECK( std::equal( out.begin() + 4, out.end(), wide.begin() + 4 ) );
+}
+
+// Connectivity of one Element that is still referenced must not change when
+// the connectivity of another Element is requested.
+BOOST_AUTO_TEST_CASE( heldNarrowConnectivity ) {
+  int values[] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+  xdmGrid::UnstructuredTopology t;
+  t.setNumberOfElements( 2 );
+  t.setElementTopology( xdmGrid::elementFactory( xdmGrid::ElementShape::Tetrahedron, 1 ) );
+  t.setConnectivity( test::createUniformDataItem( values, 8, xdm::primitiveType::kInt ) );
+
+  xdmGrid::ConstElementConnectivity first = t.elementConnections( 0 );
+  xdmGrid::ConstElementConnectivity second = t.elementConnections( 1 );
+  for ( std::size_t i = 0; i < 4; ++i ) {
+    BOOST_CHECK_EQUAL( i, first[i] );
+    BOOST_CHECK_EQUAL( i + 4, second[i] );
+  }
+}
+
+// The type of the values is checked when they are read.
+BOOST_AUTO_TEST_CASE( nonIntegerConnectivity ) {
+  double values[] = { 0.0, 1.0, 2.0, 3.0 };
+  xdmGrid::UnstructuredTopology t;
+  t.setNumberOfElements( 1 );
+  t.setElementTopology( xdmGrid::elementFactory( xdmGrid::ElementShape::Tetrahedron, 1 ) );
+  t.setConnectivity( test::createUniformDataItem( values, 4, xdm::primitiveType::kDouble ) );
+  BOOST_CHECK_THROW( t.connectivityType(), std::runtime_error );
+  BOOST_CHECK_THROW( t.connection( 0, 0 ), std::runtime_error );
+}
+
+// The type follows the array of the item, which may be replaced after the
+// item is set, whatever type the item was created with.
+BOOST_AUTO_TEST_CASE( replacedConnectivity ) {
+  xdmGrid::UnstructuredTopology t;
+  BOOST_CHECK_EQUAL( xdm::primitiveType::kLongUnsignedInt, t.connectivityType() );
+  t.setNumberOfElements( 1 );
+  t.setElementTopology( xdmGrid::elementFactory( xdmGrid::ElementShape::Tetrahedron, 1 ) );
+
+  int intValues[] = { 3, 2, 1, 0 };
+  xdm::RefPtr< xdm::ArrayAdapter > adapter(
+    new xdm::ArrayAdapter( xdm::createStructuredArray( intValues, 4 ) ) );
+  xdm::RefPtr< xdm::UniformDataItem > item( new xdm::UniformDataItem );
+  item->setData( adapter );
+  t.setConnectivity( item );
+  BOOST_CHECK_EQUAL( xdm::primitiveType::kInt, t.connectivityType() );
+  BOOST_CHECK_EQUAL( 1u, t.connection( 0, 2 ) );
+
+  std::size_t wideValues[] = { 7, 6, 5, 4 };
+  adapter->setArray( xdm::createStructuredArray( wideValues, 4 ) );
+  BOOST_CHECK_EQUAL( xdm::primitiveType::kLongUnsignedInt, t.connectivityType() );
+  BOOST_CHECK_EQUAL( 5u, t.connection( 0, 2 ) );
+  std::vector< std::size_t > out( 4 );
+  t.gatherConnections( 0, 1, &out[0] );
+  BOOST_CHECK( std::equal( out.begin(), out.end(), wideValues ) );
+}